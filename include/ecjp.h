@@ -40,6 +40,7 @@ extern "C" {
 #include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
+#include <stdint.h>
 
 #include "ecjp_limit.h"
 
@@ -84,6 +85,7 @@ typedef enum {
     ECJP_NO_SPACE_IN_BUFFER_VALUE,
     ECJP_INDEX_OUT_OF_BOUNDS,
     ECJP_INDEX_NOT_FOUND,
+    ECJP_STOPPED,
     ECJP_MAX_ERROR
 } ecjp_return_code_t;
 
@@ -96,6 +98,7 @@ typedef enum {
     ECJP_TYPE_BOOL,
     ECJP_TYPE_NULL,
     ECJP_TYPE_KEY_VALUE_PAIR,
+    ECJP_TYPE_KEY,
     ECJP_TYPE_MAX_TYPES  
 } ecjp_value_type_t;
 
@@ -112,6 +115,19 @@ typedef enum {
     ECJP_PS_MAX_STATUS
 } ecjp_parse_status_t;
 
+typedef enum {
+    ECJP_NUMBER_INTEGER = 0,
+    ECJP_NUMBER_REAL
+} ecjp_number_kind_t;
+
+typedef enum {
+    ECJP_SIMD_SCALAR = 0,
+    ECJP_SIMD_SSE2,
+    ECJP_SIMD_AVX2,
+    ECJP_SIMD_AVX512,
+    ECJP_SIMD_MAX_LEVEL
+} ecjp_simd_level_t;
+
 typedef enum {
     ECJP_PA_START = 0,
     ECJP_PA_IN_ARRAY,
@@ -127,12 +143,49 @@ typedef enum {
     ECJP_PA_MAX_STATUS
 } ecjp_parse_array_status_t;
 
+typedef enum {
+    ECJP_PT_START = 0,
+    ECJP_PT_WAIT_KEY_OR_END,
+    ECJP_PT_WAIT_KEY,
+    ECJP_PT_WAIT_COLON,
+    ECJP_PT_WAIT_VALUE_OR_END,
+    ECJP_PT_WAIT_VALUE,
+    ECJP_PT_WAIT_COMMA_OR_END,
+    ECJP_PT_ERROR,
+    ECJP_PT_END,
+    ECJP_PT_MAX_STATUS
+} ecjp_parse_tape_status_t;
+
+typedef enum {
+    ECJP_SK_NONE = 0,
+    ECJP_SK_STRING,
+    ECJP_SK_ESCAPE,
+    ECJP_SK_UNICODE,
+    ECJP_SK_LITERAL,
+    ECJP_SK_NUMBER,
+    ECJP_SK_MAX_TOKEN
+} ecjp_stream_token_t;
+
+typedef enum {
+    ECJP_SN_MINUS = 0,
+    ECJP_SN_ZERO,
+    ECJP_SN_INT,
+    ECJP_SN_DOT,
+    ECJP_SN_FRAC,
+    ECJP_SN_EXP,
+    ECJP_SN_EXP_SIGN,
+    ECJP_SN_EXP_INT,
+    ECJP_SN_MAX_STATUS
+} ecjp_stream_number_status_t;
+
 /*
  * Structures and type definitions
  * for keys list used to parse a Json-like input string
  * This list doesn't store the key and its value, but only
  * the position, length and type of each key found in the input string.
  * To retrieve the value associated to a key, use ecjp_get_key() or ecjp_read_key()
+ * The elements are stored in a contiguous vector, they can be walked with the next pointer
+ * or accessed by index with ecjp_get_key_token().
 */
 typedef struct key_token {
     ECJP_TYPE_POS_KEY   start_pos;
@@ -145,6 +198,169 @@ typedef struct key_elem {
     struct key_elem *next;
 } ecjp_key_elem_t;
 
+/*
+ * Structures and type definitions
+ * for the hash index of the keys (see ecjp_check_and_load_indexed()).
+ * The index is a table with open addressing: each slot stores the hash of the key name
+ * and a copy of the key token; the slots not used have type ECJP_TYPE_UNDEFINED.
+ * The policy sets which key is kept when the same name is found more than once.
+*/
+typedef enum {
+    ECJP_DUP_FIRST_WINS = 0,
+    ECJP_DUP_LAST_WINS
+} ecjp_dup_policy_t;
+
+typedef struct key_slot {
+    unsigned int        hash;
+    ecjp_key_token_t    key;
+} ecjp_key_slot_t;
+
+typedef struct key_index {
+    ecjp_key_slot_t     *slot;
+    int                 capacity;
+    int                 count;
+    ecjp_dup_policy_t   policy;
+} ecjp_key_index_t;
+
+/*
+ * Structures and type definitions
+ * for the index of the elements of an array (see ecjp_index_array()).
+ * The array string is parsed once: each element stores the offset from the start of the array
+ * string, the length and the type of the element, so it can be read in constant time with
+ * ecjp_read_array_index() or walked in order from elem[0] to elem[count - 1].
+*/
+typedef struct array_elem_token {
+    unsigned int        offset;
+    unsigned int        length;
+    unsigned char       type;
+} ecjp_array_elem_token_t;
+
+typedef struct array_index {
+    ecjp_array_elem_token_t *elem;
+    int                     capacity;
+    int                     count;
+} ecjp_array_index_t;
+
+/*
+ * Structures and type definitions
+ * for the tape of a whole document (see ecjp_load_tape()).
+ * The tape is a flat array with one entry for every key, value, object and array at every level,
+ * in the order they are found in the input string. Each entry stores the position and length of
+ * its characters in the input string (keys and strings without quotes, objects and arrays from the
+ * opening to the closing bracket) and the index of the next entry at the same level: for objects
+ * and arrays it's the entry after their whole content, so a subtree is skipped in constant time.
+ * The entries of an object are its keys (type ECJP_TYPE_KEY) each followed by its value.
+*/
+typedef struct tape_entry {
+    unsigned int        pos;
+    unsigned int        length;
+    int                 next;
+    unsigned char       type;
+} ecjp_tape_entry_t;
+
+typedef struct tape {
+    ecjp_tape_entry_t   *entry;
+    int                 capacity;
+    int                 count;
+} ecjp_tape_t;
+
+/*
+ * Structures and type definitions
+ * for the projections (see ecjp_projection_compile()).
+ * The paths are compiled once in a tree with one node for each step: the paths with the same
+ * first steps share their nodes, so each key of the input is compared only with the keys that
+ * can follow it. The keys are stored decoded in names. A projection is not changed by
+ * ecjp_project(), so it can be used by many threads at the same time.
+*/
+typedef struct ecjp_projection_node {
+    int                 parent;
+    int                 first_child;
+    int                 next_sibling;
+    int                 path;           // first path that ends at this node, -1 if none
+    int                 num_below;      // number of nodes below this one where a path ends
+    int                 index;          // the step as an array index, -1 if it's not an index
+    unsigned int        key_pos;        // the step as a key: position and length in names
+    unsigned int        key_len;
+    ecjp_bool_t         array_only;     // the step is an index in brackets (dotted syntax)
+} ecjp_projection_node_t;
+
+typedef struct ecjp_projection {
+    ecjp_projection_node_t  *node;
+    int                     num_nodes;
+    int                     *next_path;     // next path that ends at the same node, -1 if none
+    int                     num_paths;
+    int                     num_targets;    // number of nodes where a path ends
+    char                    *names;
+} ecjp_projection_t;
+
+/*
+ * Structures and type definitions
+ * for the streaming parser (see ecjp_stream_feed()).
+ * The document is received in chunks of any size: the stream keeps the status of the parser
+ * between the chunks, also in the middle of a string, an escape sequence, a number or a literal.
+ * Its size depends only on ECJP_MAX_PARSE_STACK_DEPTH, not on the size of the document.
+ * The positions (err_pos, tape entries) count the characters from the start of the stream.
+*/
+typedef struct ecjp_stream {
+    ecjp_parse_tape_status_t    status;
+    ecjp_stream_token_t         token;
+    unsigned char               step;           // hex digits of a unicode escape, characters of a literal or status of a number
+    ecjp_bool_t                 is_key;
+    const char                  *literal;
+    int                         token_start;
+    int                         pos;
+    int                         top;
+    char                        container[ECJP_MAX_PARSE_STACK_DEPTH];
+    int                         entry[ECJP_MAX_PARSE_STACK_DEPTH];
+    int                         num_keys;
+    ecjp_struct_type_t          struct_type;
+    ecjp_return_code_t          error;
+    int                         err_pos;
+    ecjp_tape_t                 *tape;
+} ecjp_stream_t;
+
+/*
+ * Structures and type definitions
+ * for the documents of a multi-document input, e.g. NDJSON (see ecjp_check_documents()).
+ * Each document is checked on its own: start and length delimit its characters in the input
+ * string, err_pos is the position of the error from the start of the input string (-1 if none).
+ * A document not valid goes on up to the next line that begins a document ('{' or '[' in the first
+ * column, or after all its brackets are closed) and contains the error, unless the error is the
+ * first character of the next document or the input ends first.
+ * The callback is called once for each document; it returns ECJP_BOOL_FALSE to stop the parsing.
+*/
+typedef struct ecjp_document {
+    int                 start;
+    int                 length;
+    ecjp_return_code_t  error;
+    int                 err_pos;
+    ECJP_TYPE_POS_KEY   num_keys;
+    ecjp_struct_type_t  struct_type;
+} ecjp_document_t;
+
+typedef ecjp_bool_t (*ecjp_document_cb_t)(const char *input, const ecjp_document_t *doc, void *user_data);
+
+/*
+ * Handler of the events sent by ecjp_sax_parse().
+ * Each callback receives the position and the length of the characters of the event in the input
+ * string: the bracket for the start and the end of objects and arrays, the characters between the
+ * quotes for keys and strings (the escape sequences are not decoded), all the characters of numbers
+ * and literals. A callback returns ECJP_BOOL_FALSE to stop the parsing; a NULL callback is skipped.
+*/
+typedef ecjp_bool_t (*ecjp_sax_cb_t)(const char *input, int pos, int length, void *user_data);
+
+typedef struct ecjp_sax_handler {
+    ecjp_sax_cb_t       start_object;
+    ecjp_sax_cb_t       end_object;
+    ecjp_sax_cb_t       start_array;
+    ecjp_sax_cb_t       end_array;
+    ecjp_sax_cb_t       key;
+    ecjp_sax_cb_t       string;
+    ecjp_sax_cb_t       number;
+    ecjp_sax_cb_t       boolean;
+    ecjp_sax_cb_t       null;
+} ecjp_sax_handler_t;
+
 /*
  * Structures and type definitions
  * for items list used to store values read from a Json-like input string
@@ -153,6 +369,8 @@ typedef struct key_elem {
  * No need to scan again the input string to retrieve the value.
  * This implementation use dynamic memory allocation for the value field and use much more memory than
  * the keys list implementation.
+ * The elements are stored in a contiguous vector, they can be walked with the next pointer
+ * or accessed by index with ecjp_get_item_token().
 */
 typedef struct item_token {
     ecjp_value_type_t   type;
@@ -210,6 +428,95 @@ typedef struct ecjp_outdata {
     unsigned int        value_size;
 } ecjp_outdata_t;
 
+/*
+ * View of a value inside the input string (see ecjp_read_key_view()).
+ * The value is not copied: ptr points to its first character in the input string
+ * and len is the number of characters, the value is not NUL-terminated.
+ * The view is valid as long as the input string is.
+*/
+typedef struct ecjp_value_view {
+    const char          *ptr;
+    size_t              len;
+    ecjp_value_type_t   type;
+} ecjp_value_view_t;
+
+/*
+ * Number decoded by ecjp_read_number().
+ * An integer without fraction and exponent that fits 64 bits is stored in integer
+ * (kind ECJP_NUMBER_INTEGER); real is the double nearest to the number, for every kind.
+*/
+typedef struct ecjp_number {
+    ecjp_number_kind_t  kind;
+    int64_t             integer;
+    double              real;
+} ecjp_number_t;
+
+/*
+ * String decoded by ecjp_read_string().
+ * ptr and len are the decoded characters, in the buffer of the caller (NUL-terminated) or in the
+ * input string when no buffer is given and the string has no escape sequences (escaped is
+ * ECJP_BOOL_FALSE): in that case the input is already the decoded string and it's not copied.
+ * raw_len is the number of characters of the string in the input, without the quotes.
+*/
+typedef struct ecjp_string {
+    const char          *ptr;
+    size_t              len;
+    size_t              raw_len;
+    ecjp_bool_t         escaped;
+} ecjp_string_t;
+
+/*
+ * Allocator used by the library for all its memory (see ecjp_set_allocator()).
+ * The functions receive user_data as last parameter; they have the same behavior of
+ * malloc(), realloc() and free() (free_fn() is never called with NULL).
+*/
+typedef struct ecjp_allocator {
+    void                *(*malloc_fn)(size_t size, void *user_data);
+    void                *(*realloc_fn)(void *ptr, size_t size, void *user_data);
+    void                (*free_fn)(void *ptr, void *user_data);
+    void                *user_data;
+} ecjp_allocator_t;
+
+/*
+ * Counters of the parser (see ecjp_get_stats()).
+ * They are counted only when the library is built with ECJP_STATS (see --enable-stats),
+ * otherwise they cost nothing and stay zero. They are per thread or per context, except
+ * with ECJP_RUN_ON_MCU where a stats build is single-threaded.
+*/
+typedef struct ecjp_stats {
+    uint64_t            bytes_scanned;                      // bytes of the inputs given to the parsers
+    uint64_t            transitions[ECJP_PS_MAX_STATUS];    // changes of the parse status, by the status entered
+    int                 max_depth;                          // deepest nesting of the parse stack
+    uint64_t            nodes_allocated;                    // elements added to the lists and entries to the tapes
+    uint64_t            bytes_copied;                       // bytes copied in the value of an ecjp_outdata_t
+    uint64_t            bytes_rescanned;                    // bytes read again by the lookup functions
+    uint64_t            nodes_revisited;                    // elements of the lists walked again by the lookup functions
+} ecjp_stats_t;
+
+/*
+ * Callback of the quadratic access detector (see ecjp_set_rescan_callback()), called by the
+ * thread that set it (with ECJP_RUN_ON_MCU the detector is shared, as the counters).
+ * It's called when the lookups on the same buffer (an input string or a list) read again more
+ * than ratio times its size: function is the lookup that crossed the ratio, revisited the bytes
+ * (or the list elements) read again since the first lookup and size the size of the buffer.
+*/
+typedef void (*ecjp_rescan_cb_t)(const char *function, const void *buffer, uint64_t revisited, uint64_t size, void *user_data);
+
+/*
+ * Parse context (see ecjp_init_ctx()).
+ * The context owns the scratch memory used while parsing: it's allocated at the first call
+ * with the size needed by the input and reused by the next calls, grown only when a larger
+ * input needs it. A context is used by one thread at a time.
+ * The calls with the context count in its own counters (see ecjp_get_stats()) and validate
+ * the input as UTF-8 when utf8_validation is set (disabled by ecjp_init_ctx()).
+*/
+typedef struct ecjp_ctx {
+    char                *scratch;
+    size_t              scratch_size;
+    ecjp_bool_t         utf8_validation;
+    ecjp_stats_t        stats;
+} ecjp_ctx_t;
+
 typedef struct ecjp_indata {
     char                key[ECJP_MAX_KEY_LEN];
     ecjp_value_type_t   type;
@@ -218,33 +525,114 @@ typedef struct ecjp_indata {
 } ecjp_indata_t;
 
 
-extern char *ecjp_type[ECJP_TYPE_MAX_TYPES];
+extern const char *const ecjp_type[ECJP_TYPE_MAX_TYPES];
+
+// built-in allocators (see ecjp_set_allocator())
+extern const ecjp_allocator_t ecjp_pool_allocator;
+#ifdef ECJP_RUN_ON_PC
+extern const ecjp_allocator_t ecjp_thread_cache_allocator;
+#endif
 
 // Function declarations (public API)
 ecjp_return_code_t ecjp_dummy(void);
 ecjp_return_code_t ecjp_get_version(int *major, int *minor, int *patch);
 ecjp_return_code_t ecjp_get_version_string(char *version_string, int max_length);
 ecjp_return_code_t ecjp_show_error(const char *input, int err_pos);
+ecjp_return_code_t ecjp_show_error_n(const char *input, size_t len, int err_pos);
+ecjp_simd_level_t ecjp_get_simd_level(void);
+ecjp_return_code_t ecjp_set_simd_level(ecjp_simd_level_t level);
+ecjp_return_code_t ecjp_set_allocator(const ecjp_allocator_t *allocator);
+ecjp_return_code_t ecjp_get_allocator(ecjp_allocator_t *allocator);
+ecjp_return_code_t ecjp_init_ctx(ecjp_ctx_t *ctx);
+ecjp_return_code_t ecjp_free_ctx(ecjp_ctx_t *ctx);
+ecjp_return_code_t ecjp_get_stats(const ecjp_ctx_t *ctx, ecjp_stats_t *stats);
+ecjp_return_code_t ecjp_reset_stats(ecjp_ctx_t *ctx);
+ecjp_return_code_t ecjp_set_rescan_callback(ecjp_rescan_cb_t callback, unsigned int ratio, void *user_data);
+ecjp_return_code_t ecjp_init_tape(ecjp_tape_t *tape);
+ecjp_return_code_t ecjp_free_tape(ecjp_tape_t *tape);
+ecjp_return_code_t ecjp_load_tape(const char *input, ecjp_tape_t *tape, ecjp_check_result_t *res);
+ecjp_return_code_t ecjp_load_tape_n(const char *input, size_t len, ecjp_tape_t *tape, ecjp_check_result_t *res);
+ecjp_return_code_t ecjp_load_tape_ctx(ecjp_ctx_t *ctx, const char *input, size_t len, ecjp_tape_t *tape, ecjp_check_result_t *res);
+ecjp_return_code_t ecjp_tape_find_key(const ecjp_tape_t *tape, const char *input, int object, const char *key, int *entry);
+ecjp_return_code_t ecjp_tape_get_element(const ecjp_tape_t *tape, int array, int index, int *entry);
+ecjp_return_code_t ecjp_tape_view(const ecjp_tape_t *tape, const char *input, int entry, ecjp_value_view_t *view);
+ecjp_return_code_t ecjp_query(const char *input, size_t len, const char *path, ecjp_value_view_t *view);
+ecjp_return_code_t ecjp_projection_compile(ecjp_projection_t *proj, const char *const paths[], int num_paths);
+ecjp_return_code_t ecjp_free_projection(ecjp_projection_t *proj);
+ecjp_return_code_t ecjp_project(const ecjp_projection_t *proj, const char *input, size_t len, ecjp_value_view_t views[]);
+ecjp_return_code_t ecjp_read_number(const char *input, size_t len, ecjp_number_t *number);
+ecjp_return_code_t ecjp_read_string(const char *input, size_t len, char *buffer, size_t buffer_size, ecjp_string_t *string);
+ecjp_return_code_t ecjp_stream_init(ecjp_stream_t *stream, ecjp_tape_t *tape);
+ecjp_return_code_t ecjp_stream_feed(ecjp_stream_t *stream, const char *chunk, size_t len);
+ecjp_return_code_t ecjp_stream_finish(ecjp_stream_t *stream, ecjp_check_result_t *res);
+ecjp_return_code_t ecjp_check_documents(const char *input, ecjp_document_cb_t callback, void *user_data, int *num_documents);
+ecjp_return_code_t ecjp_check_documents_n(const char *input, size_t len, ecjp_document_cb_t callback, void *user_data, int *num_documents);
+ecjp_return_code_t ecjp_sax_parse(const char *input, size_t len, const ecjp_sax_handler_t *handler, void *user_data);
 
 #ifdef ECJP_TOKEN_LIST
 // alternative functions using items list
 ecjp_return_code_t ecjp_free_item_list(ecjp_item_elem_t **item_list);
+int ecjp_get_item_count(ecjp_item_elem_t *item_list);
+ecjp_item_token_t *ecjp_get_item_token(ecjp_item_elem_t *item_list, int index);
 ecjp_return_code_t ecjp_check_syntax_2(const char *input, ecjp_check_result_t *res);
 ecjp_return_code_t ecjp_load_2(const char *input, ecjp_item_elem_t **item_list, ecjp_check_result_t *res);
 ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **item_list, ecjp_check_result_t *res);
+ecjp_return_code_t ecjp_check_and_load_2_arena(const char *input, ecjp_item_elem_t **item_list, ecjp_check_result_t *res);
 ecjp_return_code_t ecjp_read_element(ecjp_item_elem_t *item_list, int index, ecjp_outdata_t *out);
 ecjp_return_code_t ecjp_split_key_and_value(ecjp_item_elem_t *item_list, char *key, char *value, ecjp_bool_t leave_quotes);
 ecjp_return_code_t ecjp_read_key_2(ecjp_item_elem_t *item_list, const char *key, unsigned int index, ecjp_outdata_t *out);
+// length-delimited input (the input doesn't need to be NUL-terminated)
+ecjp_return_code_t ecjp_check_syntax_2_n(const char *input, size_t len, ecjp_check_result_t *res);
+ecjp_return_code_t ecjp_load_2_n(const char *input, size_t len, ecjp_item_elem_t **item_list, ecjp_check_result_t *res);
+ecjp_return_code_t ecjp_check_and_load_2_n(const char *input, size_t len, ecjp_item_elem_t **item_list, ecjp_check_result_t *res);
+ecjp_return_code_t ecjp_check_and_load_2_arena_n(const char *input, size_t len, ecjp_item_elem_t **item_list, ecjp_check_result_t *res);
+// the scratch memory is reused from the context
+ecjp_return_code_t ecjp_check_syntax_2_ctx(ecjp_ctx_t *ctx, const char *input, size_t len, ecjp_check_result_t *res);
+ecjp_return_code_t ecjp_check_and_load_2_ctx(ecjp_ctx_t *ctx, const char *input, size_t len, ecjp_item_elem_t **item_list, ecjp_check_result_t *res);
 #else
 ecjp_return_code_t ecjp_print_keys(const char *input, ecjp_key_elem_t *key_list);
 ecjp_return_code_t ecjp_free_key_list(ecjp_key_elem_t **key_list);
+int ecjp_get_key_count(ecjp_key_elem_t *key_list);
+ecjp_key_token_t *ecjp_get_key_token(ecjp_key_elem_t *key_list, int index);
+ecjp_return_code_t ecjp_init_key_index(ecjp_key_index_t *key_index, ecjp_dup_policy_t policy);
+ecjp_return_code_t ecjp_free_key_index(ecjp_key_index_t *key_index);
+ecjp_return_code_t ecjp_find_key(const ecjp_key_index_t *key_index, const char *input, const char *key, ecjp_outdata_t *out);
+ecjp_return_code_t ecjp_check_and_load_indexed(const char *input, ecjp_key_elem_t **key_list, ecjp_key_index_t *key_index, ecjp_check_result_t *res, unsigned short int level);
 ecjp_return_code_t ecjp_get_key(const char input[],char *key,ecjp_key_elem_t **key_list,ECJP_TYPE_POS_KEY start,ecjp_outdata_t *out);
 ecjp_return_code_t ecjp_read_key(const char input[],ecjp_indata_t *in,ecjp_outdata_t *out);
 ecjp_return_code_t ecjp_read_array_element(const char input[],int index,ecjp_outdata_t *out);
+ecjp_return_code_t ecjp_init_array_index(ecjp_array_index_t *array_index);
+ecjp_return_code_t ecjp_free_array_index(ecjp_array_index_t *array_index);
+ecjp_return_code_t ecjp_index_array(const char input[],ecjp_array_index_t *array_index);
+ecjp_return_code_t ecjp_read_array_index(const char input[],const ecjp_array_index_t *array_index,int index,ecjp_outdata_t *out);
+// zero-copy variants: the value is not copied, the view points inside the input string
+ecjp_return_code_t ecjp_read_key_view(const char input[],ecjp_indata_t *in,ecjp_value_view_t *view);
+ecjp_return_code_t ecjp_read_array_element_view(const char input[],int index,ecjp_value_view_t *view);
+ecjp_return_code_t ecjp_read_array_index_view(const char input[],const ecjp_array_index_t *array_index,int index,ecjp_value_view_t *view);
+// typed values, decoded without copying them
+ecjp_return_code_t ecjp_read_key_number(const char input[],ecjp_indata_t *in,ecjp_number_t *number);
+ecjp_return_code_t ecjp_read_key_bool(const char input[],ecjp_indata_t *in,ecjp_bool_t *value);
+ecjp_return_code_t ecjp_read_key_string(const char input[],ecjp_indata_t *in,char *buffer,size_t buffer_size,ecjp_string_t *string);
 ecjp_return_code_t ecjp_get_keys_and_value(char *ptr,ecjp_key_elem_t *key_list);
 ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_list, ecjp_check_result_t *res, unsigned short int level);
 ecjp_return_code_t ecjp_check_syntax(const char *input, ecjp_check_result_t *res);
 ecjp_return_code_t ecjp_load(const char *input, ecjp_key_elem_t **key_list, ecjp_check_result_t *res, unsigned short int level);
+// length-delimited input (the input doesn't need to be NUL-terminated)
+ecjp_return_code_t ecjp_read_key_n(const char input[],size_t len,ecjp_indata_t *in,ecjp_outdata_t *out);
+ecjp_return_code_t ecjp_read_array_element_n(const char input[],size_t len,int index,ecjp_outdata_t *out);
+ecjp_return_code_t ecjp_index_array_n(const char input[],size_t len,ecjp_array_index_t *array_index);
+ecjp_return_code_t ecjp_read_key_view_n(const char input[],size_t len,ecjp_indata_t *in,ecjp_value_view_t *view);
+ecjp_return_code_t ecjp_read_array_element_view_n(const char input[],size_t len,int index,ecjp_value_view_t *view);
+ecjp_return_code_t ecjp_read_key_number_n(const char input[],size_t len,ecjp_indata_t *in,ecjp_number_t *number);
+ecjp_return_code_t ecjp_read_key_bool_n(const char input[],size_t len,ecjp_indata_t *in,ecjp_bool_t *value);
+ecjp_return_code_t ecjp_read_key_string_n(const char input[],size_t len,ecjp_indata_t *in,char *buffer,size_t buffer_size,ecjp_string_t *string);
+ecjp_return_code_t ecjp_check_and_load_n(const char *input, size_t len, ecjp_key_elem_t **key_list, ecjp_check_result_t *res, unsigned short int level);
+ecjp_return_code_t ecjp_check_and_load_indexed_n(const char *input, size_t len, ecjp_key_elem_t **key_list, ecjp_key_index_t *key_index, ecjp_check_result_t *res, unsigned short int level);
+ecjp_return_code_t ecjp_check_syntax_n(const char *input, size_t len, ecjp_check_result_t *res);
+ecjp_return_code_t ecjp_load_n(const char *input, size_t len, ecjp_key_elem_t **key_list, ecjp_check_result_t *res, unsigned short int level);
+// the settings and the counters are the ones of the context
+ecjp_return_code_t ecjp_check_syntax_ctx(ecjp_ctx_t *ctx, const char *input, size_t len, ecjp_check_result_t *res);
+ecjp_return_code_t ecjp_check_and_load_ctx(ecjp_ctx_t *ctx, const char *input, size_t len, ecjp_key_elem_t **key_list, ecjp_check_result_t *res, unsigned short int level);
 #endif  // ECJP_TOKEN_LIST
 
 
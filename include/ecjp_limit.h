@@ -36,7 +36,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #ifdef ECJP_RUN_ON_PC
 #define ECJP_MAX_INPUT_SIZE          5*1024*1024 // 5 MB
-// NOTE: if I set ECJP_MAX_INPUT_SIZE too high, 10 MB for example, the stack allocation fails
+// NOTE: the input is not copied on the stack anymore, so its size is not limited by the stack
 #define ECJP_MAX_PRINT_COLUMNS       80
 #define ECJP_MAX_PARSE_STACK_DEPTH   2048
 #define ECJP_MAX_KEY_LEN             512
@@ -44,6 +44,12 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define ECJP_MAX_ARRAY_ELEM_LEN      1024*100// 100 kB
 #define ECJP_MAX_ITEM_LEN            1024*100// 100 kB
 #define ECJP_MAX_NESTED_LEVEL        1024
+#define ECJP_LIST_MIN_CAPACITY       64
+#define ECJP_ARENA_BLOCK_SIZE        1024*64 // 64 kB
+#define ECJP_POOL_SIZE               1024*1024 // 1 MB, power of 2
+#define ECJP_THREAD_CACHE_CLASSES    8       // cached sizes: 32 bytes to 4 kB
+#define ECJP_THREAD_CACHE_DEPTH      64      // blocks cached for each size
+#define ECJP_NUMBER_MAX_DIGITS       800     // digits of the slow path of the number conversion
 
 #define ECJP_TYPE_POS_KEY            unsigned short int
 #define ECJP_TYPE_LEN_KEY            unsigned short int  
@@ -58,6 +64,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
         #define ECJP_MAX_ARRAY_ELEM_LEN      256
         #define ECJP_MAX_ITEM_LEN            512
         #define ECJP_MAX_NESTED_LEVEL        8
+        #define ECJP_LIST_MIN_CAPACITY       4
+        #define ECJP_ARENA_BLOCK_SIZE        256
+        #define ECJP_POOL_SIZE               1024*8 // 8 kB, power of 2
+        #define ECJP_NUMBER_MAX_DIGITS       64  // less than 800: the last bit can be wrong for very long numbers
 
         #define ECJP_TYPE_POS_KEY            unsigned short int  
         #define ECJP_TYPE_LEN_KEY            unsigned char  
@@ -72,6 +82,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
         #define ECJP_MAX_ITEM_LEN            512
         #define ECJP_MAX_ARRAY_ELEM_LEN      1024
         #define ECJP_MAX_NESTED_LEVEL        12
+        #define ECJP_LIST_MIN_CAPACITY       16
+        #define ECJP_ARENA_BLOCK_SIZE        1024 // 1 kB
+        #define ECJP_POOL_SIZE               1024*64 // 64 kB, power of 2
+        #define ECJP_NUMBER_MAX_DIGITS       800 // digits of the slow path of the number conversion
 
         #define ECJP_TYPE_POS_KEY            unsigned short int  
         #define ECJP_TYPE_LEN_KEY            unsigned char  
@@ -0,0 +1,57 @@
+#!/bin/bash
+
+# Usage: ./gen_corpus.sh <ecjp_gen> <folder> [max size] [seed]
+# Example: ./gen_corpus.sh ../build/src/ecjp_gen ./corpus 16m
+
+GENERATOR="$1"
+CARTELLA="$2"
+MAX_SIZE="${3:-1m}"
+SEED="${4:-1}"
+
+# sizes of the documents, the ones larger than max size are skipped
+SIZES="1k 64k 1m 16m 256m 1g"
+SHAPES="wide_object records numbers escapes deep"
+
+# Parameter check
+if [ -z "$GENERATOR" ] || [ -z "$CARTELLA" ]; then
+    echo "Usage: $0 <ecjp_gen> <folder> [max size] [seed]"
+    exit 1
+fi
+
+if [ ! -x "$GENERATOR" ]; then
+    echo "Error: $GENERATOR is not executable!"
+    exit 1
+fi
+
+# size in bytes of a size with suffix k, m or g
+to_bytes() {
+    case "$1" in
+        *k) echo $(( ${1%k} * 1024 )) ;;
+        *m) echo $(( ${1%m} * 1024 * 1024 )) ;;
+        *g) echo $(( ${1%g} * 1024 * 1024 * 1024 )) ;;
+        *)  echo "$1" ;;
+    esac
+}
+
+# the NDJSON streams have many documents: they are in a subfolder, test_all.sh doesn't run them
+mkdir -p "$CARTELLA/ndjson" || exit 1
+MAX_BYTES=$(to_bytes "$MAX_SIZE")
+
+for SIZE in $SIZES; do
+    if [ $(to_bytes "$SIZE") -gt $MAX_BYTES ]; then
+        continue
+    fi
+    for SHAPE in $SHAPES; do
+        echo "Generating $SHAPE of size $SIZE ..."
+        "$GENERATOR" $SHAPE $SIZE $SEED > "$CARTELLA/valid_gen_${SHAPE}_${SIZE}.json" || exit 1
+    done
+    echo "Generating ndjson of size $SIZE ..."
+    "$GENERATOR" ndjson $SIZE $SEED > "$CARTELLA/ndjson/valid_gen_ndjson_${SIZE}.ndjson" || exit 1
+done
+
+# inputs at the limits of the parser, named by the result expected from the syntax check
+echo "Generating the inputs at the limits ..."
+"$GENERATOR" depth_limit > "$CARTELLA/valid_gen_depth_limit.json" || exit 1
+"$GENERATOR" depth_over > "$CARTELLA/invalid_gen_depth_over.json" || exit 1
+"$GENERATOR" key_pos_limit > "$CARTELLA/valid_gen_key_pos_limit.json" || exit 1
+"$GENERATOR" key_pos_over > "$CARTELLA/valid_gen_key_pos_over.json" || exit 1
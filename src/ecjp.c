@@ -31,6 +31,25 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "ecjp.h"
 
+#include <stdint.h>
+#include <stddef.h>
+#include <limits.h>
+#include <float.h>
+#ifdef ECJP_RUN_ON_PC
+#include <pthread.h>
+#endif
+
+#if !defined(ECJP_NO_SIMD) && !defined(ECJP_RUN_ON_MCU) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ECJP_HAVE_X86_SIMD          1
+#include <immintrin.h>
+#endif
+
+#define ECJP_BLOCK_SIZE             64
+
+// FNV-1a hash of the key names
+#define ECJP_HASH_INIT              2166136261U
+#define ECJP_HASH_PRIME             16777619U
+
 #ifdef ECJP_RUN_ON_PC
     #if DEBUG
         #define ecjp_printf(format, ...)    printf(format, __VA_ARGS__)
@@ -54,8 +73,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
     #endif // ECJP_RUN_ON_MCU
 #endif // ECJP_RUN_ON_PC
 
-
-char *ecjp_type[ECJP_TYPE_MAX_TYPES] = {
+// names of the value types (read-only). The writable globals read while parsing are the settings
+// of ecjp_set_allocator() and ecjp_set_simd_level(), set before the threads start, the state of the
+// pool allocator (not thread-safe) and, with ECJP_RUN_ON_MCU, the counters and the rescan detector
+const char *const ecjp_type[ECJP_TYPE_MAX_TYPES] = {
     "UNDEFINED",
     "STRING",
     "NUMBER",
@@ -63,9 +84,132 @@ char *ecjp_type[ECJP_TYPE_MAX_TYPES] = {
     "ARRAY",
     "BOOL",
     "NULL",
-    "KEY_VALUE_PAIR"
+    "KEY_VALUE_PAIR",
+    "KEY"
 };
 
+#ifdef ECJP_STATS
+/*
+ * Counters of the parser (see ecjp_get_stats()).
+ * The counters are per thread: ecjp_stats_cur points to the counters of the context of the
+ * running call, NULL for the calls without a context that count in the ones of the thread.
+ * On a MCU the library runs in a single thread and they are plain globals.
+*/
+#ifndef ECJP_RUN_ON_MCU
+static __thread ecjp_stats_t ecjp_thread_stats;
+static __thread ecjp_stats_t *ecjp_stats_cur;
+#else
+static ecjp_stats_t ecjp_thread_stats;
+static ecjp_stats_t *ecjp_stats_cur;
+#endif
+
+static inline ecjp_stats_t *ecjp_stats_in_use(void)
+{
+    return (ecjp_stats_cur != NULL) ? ecjp_stats_cur : &ecjp_thread_stats;
+}
+
+    // the calls with a context count in its counters, then restore the previous ones
+    #define ECJP_STATS_USE(stats)               (ecjp_stats_cur = (stats))
+
+    #define ECJP_STATS_ADD(counter, n)          (ecjp_stats_in_use()->counter += (uint64_t)(n))
+    #define ECJP_STATS_DEPTH(depth)             do { \
+                                                    if ((int)(depth) > ecjp_stats_in_use()->max_depth) { \
+                                                        ecjp_stats_in_use()->max_depth = (int)(depth); \
+                                                    } \
+                                                } while (0)
+    // last is the status counted before: a status is counted only when it changes
+    #define ECJP_STATS_STATUS(last, status)     do { \
+                                                    if ((int)(status) != (last)) { \
+                                                        (last) = (int)(status); \
+                                                        ecjp_stats_in_use()->transitions[(last)]++; \
+                                                    } \
+                                                } while (0)
+
+/*
+ * Quadratic access detector (see ecjp_set_rescan_callback()).
+ * The lookups on the last ECJP_RESCAN_BUFFERS buffers of the thread are summed: the size of a
+ * buffer is taken when it's first looked up, the oldest buffer is replaced by a new one.
+ * The detector is per thread as the counters, a plain global on a MCU.
+*/
+#define ECJP_RESCAN_BUFFERS     4
+
+typedef struct ecjp_rescan_buffer {
+    const void          *buffer;
+    uint64_t            size;
+    uint64_t            revisited;
+    ecjp_bool_t         reported;
+} ecjp_rescan_buffer_t;
+
+typedef struct ecjp_rescan_detector {
+    ecjp_rescan_cb_t        callback;
+    void                    *user_data;
+    unsigned int            ratio;
+    int                     oldest;
+    ecjp_rescan_buffer_t    buffers[ECJP_RESCAN_BUFFERS];
+} ecjp_rescan_detector_t;
+
+#ifndef ECJP_RUN_ON_MCU
+static __thread ecjp_rescan_detector_t ecjp_rescan;
+#else
+static ecjp_rescan_detector_t ecjp_rescan;
+#endif
+
+static ecjp_rescan_buffer_t *ecjp_rescan_find(const void *buffer)
+{
+    int i;
+
+    for (i = 0; i < ECJP_RESCAN_BUFFERS; i++) {
+        if (ecjp_rescan.buffers[i].buffer == buffer) {
+            return &ecjp_rescan.buffers[i];
+        }
+    }
+    return NULL;
+}
+
+static ecjp_rescan_buffer_t *ecjp_rescan_start(const void *buffer, uint64_t size)
+{
+    ecjp_rescan_buffer_t *b = &ecjp_rescan.buffers[ecjp_rescan.oldest];
+
+    ecjp_rescan.oldest = (ecjp_rescan.oldest + 1) % ECJP_RESCAN_BUFFERS;
+    b->buffer = buffer;
+    b->size = size;
+    b->revisited = 0;
+    b->reported = ECJP_BOOL_FALSE;
+    return b;
+}
+
+static void ecjp_rescan_add(ecjp_rescan_buffer_t *b, const char *function, uint64_t n)
+{
+    b->revisited += n;
+    // reported once for each buffer
+    if ((b->reported == ECJP_BOOL_FALSE) && (b->size > 0) && (b->revisited > (uint64_t)ecjp_rescan.ratio * b->size)) {
+        b->reported = ECJP_BOOL_TRUE;
+        ecjp_rescan.callback(function, b->buffer, b->revisited, b->size, ecjp_rescan.user_data);
+    }
+}
+
+    // function is the lookup called by the user, size is computed only when the buffer is first looked up
+    #define ECJP_STATS_RESCAN(function, counter, buffer, size, n) do { \
+                                                    ecjp_rescan_buffer_t *rescan_buffer; \
+                                                    ecjp_stats_in_use()->counter += (uint64_t)(n); \
+                                                    if ((ecjp_rescan.callback != NULL) && ((buffer) != NULL)) { \
+                                                        rescan_buffer = ecjp_rescan_find(buffer); \
+                                                        if (rescan_buffer == NULL) { \
+                                                            rescan_buffer = ecjp_rescan_start((buffer), (uint64_t)(size)); \
+                                                        } \
+                                                        ecjp_rescan_add(rescan_buffer, (function), (uint64_t)(n)); \
+                                                    } \
+                                                } while (0)
+    // size of an input that ends at end, or at the null terminator if end is NULL
+    #define ECJP_INPUT_SIZE(input, end)         (((end) != NULL) ? (size_t)((end) - (input)) : strlen(input))
+#else
+    #define ECJP_STATS_USE(stats)
+    #define ECJP_STATS_ADD(counter, n)
+    #define ECJP_STATS_DEPTH(depth)
+    #define ECJP_STATS_STATUS(last, status)
+    #define ECJP_STATS_RESCAN(function, counter, buffer, size, n)
+#endif // ECJP_STATS
+
 /* Internal function definitions */
 
 /*
@@ -146,6 +290,7 @@ ecjp_bool_t ecjp_push_parse_stack(ecjp_parse_stack_item_t *s, char c)
     }
     s->top++;
     s->char_value[s->top] = c;
+    ECJP_STATS_DEPTH(s->top + 1);
     return ECJP_BOOL_TRUE;
 };
 
@@ -224,265 +369,6298 @@ int ecjp_get_level_parse_stack(ecjp_parse_stack_item_t *s)
     return s->top;
 };
 
-#ifdef DEBUG_VERBOSE
-/* 
- * Function: ecjp_print_check_summary()
-        This function prints a summary of the parsing process for debugging purposes.
-        Parameters:
-        - p: Pointer to the parser data structure.
-*/
-void ecjp_print_check_summary(ecjp_parser_data_t *p)
-{
-    ecjp_flags_t flags = p->flags;
-    ecjp_print("Parsing summary:\n");
-    ecjp_printf("  Total characters processed: %d\n", p->index);
-    ecjp_printf("  Final parser status: %d\n", p->status);
-    ecjp_printf("  Total objects: %d\n", p->num_objects);
-    ecjp_printf("  Total arrays: %d\n", p->num_arrays);
-    ecjp_printf("  Final open brackets count: %d\n", p->open_brackets);
-    ecjp_printf("  Final open square brackets count: %d\n", p->open_square_brackets);
-    ecjp_print("Flags status:\n");
-    ecjp_printf("  in_string: %d\n", flags.in_string);
-    ecjp_printf("  in_key: %d\n", flags.in_key);
-    ecjp_printf("  in_value: %d\n", flags.in_value);
-    ecjp_printf("  in_number: %d\n", flags.in_number);
-    ecjp_printf("  trailing_comma: %d\n", flags.trailing_comma);
-    ecjp_print("Stack:\n");
-    ecjp_printf("  Stack top index: %d\n", p->parse_stack.top);
-    return;
-};
-#endif
-
-
-/* Public function definitions */
-
 /*
-    Function: ecjp_dummy()
-        A simple dummy function to test library linkage.
+ * Function: ecjp_has_char()
+        This function checks if ptr points to a character of the input.
+        The input ends at end or at the first '\0' (end is NULL for a NUL-terminated string).
+        Parameters:
+        - ptr: Pointer to the character to check.
+        - end: Pointer to the first character after the input, or NULL.
         Returns:
-        - ECJP_NO_ERROR on success.
+        - ECJP_BOOL_TRUE if ptr is inside the input.
+        - ECJP_BOOL_FALSE otherwise.
 */
-ecjp_return_code_t ecjp_dummy(void)
+static inline ecjp_bool_t ecjp_has_char(const char *ptr, const char *end)
 {
-    ecjp_printf("%s: Hello ecjp library!\n",__FUNCTION__);
-    return ECJP_NO_ERROR;
-};
+    if ((ptr == end) || (*ptr == '\0')) {
+        return ECJP_BOOL_FALSE;
+    }
+    return ECJP_BOOL_TRUE;
+}
 
 /*
-    Function: ecjp_get_version()
-        This function retrieves the version of the eCjp library.
-        Parameters:
-        - major: Pointer to an integer to store the major version number.
-        - minor: Pointer to an integer to store the minor version number.
-        - patch: Pointer to an integer to store the patch version number.
-        Returns:
-        - ECJP_NO_ERROR on success.
+ * Function: ecjp_has_chars()
+        This function checks if n characters starting from ptr can be compared without reading past end.
+        A NUL-terminated string (end is NULL) always passes: strncmp() stops at the '\0'.
 */
-ecjp_return_code_t ecjp_get_version(int *major, int *minor, int *patch)
+static inline ecjp_bool_t ecjp_has_chars(const char *ptr, const char *end, int n)
 {
-    if (major != NULL) {
-        *major = ECJP_VERSION_MAJOR;
-    }
-    if (minor != NULL) {
-        *minor = ECJP_VERSION_MINOR;
-    }
-    if (patch != NULL) {
-        *patch = ECJP_VERSION_PATCH;
+    if ((end != NULL) && ((end - ptr) < n)) {
+        return ECJP_BOOL_FALSE;
     }
-    return ECJP_NO_ERROR;
-};
+    return ECJP_BOOL_TRUE;
+}
 
 /*
-    Function: ecjp_get_version_string()
-        This function retrieves the version of the eCjp library as a string.
+ * Function: ecjp_hash_update()
+        This function adds n characters to a FNV-1a hash.
         Parameters:
-        - version_string: Pointer to a character array to store the version string.
-        - max_length: Maximum length of the version string buffer.
+        - h: The current hash (ECJP_HASH_INIT for an empty string).
+        - s: Pointer to the characters.
+        - n: Number of characters.
         Returns:
-        - ECJP_NO_ERROR on success.
-        - ECJP_NULL_POINTER if version_string is NULL or max_length is 0.
+        - The updated hash.
 */
-ecjp_return_code_t ecjp_get_version_string(char *version_string, int max_length)
+static inline unsigned int ecjp_hash_update(unsigned int h, const char *s, int n)
 {
-    if (version_string == NULL || max_length == 0) {
-        return ECJP_NULL_POINTER;
+    int i;
+
+    for (i = 0; i < n; i++) {
+        h ^= (unsigned char)s[i];
+        h *= ECJP_HASH_PRIME;
     }
-    snprintf(version_string, max_length, "%d.%d.%d", ECJP_VERSION_MAJOR, ECJP_VERSION_MINOR, ECJP_VERSION_PATCH);
-    return ECJP_NO_ERROR;
-};
+    return h;
+}
 
 /*
-    Function: ecjp_show_error()
-        This function displays the input string with an indicator pointing to the error position.
-        Parameters:
-        - input: The JSON-like input string.
-        - err_pos: The position of the error in the input string.
-        Returns:
-        - ECJP_NO_ERROR on success.
+ * Memory allocation
+ * All the memory of the library is allocated with ecjp_malloc(), ecjp_calloc() and ecjp_realloc()
+ * and released with ecjp_free(): they call the allocator set with ecjp_set_allocator(), the
+ * functions of the standard library by default.
 */
-ecjp_return_code_t ecjp_show_error(const char *input, int err_pos)
+static void *ecjp_std_malloc(size_t size, void *user_data)
 {
-    int row, i, j, err_row, err_column;
-    char input_no_newline[ECJP_MAX_INPUT_SIZE];
+    (void)user_data;
+    return malloc(size);
+}
 
-    // Remove newlines from input for proper error display
-    j = 0;
-    memset(input_no_newline, 0, ECJP_MAX_INPUT_SIZE);
-    for (i = 0; i < strlen(input) && j < ECJP_MAX_INPUT_SIZE - 1; i++) {
-        if (input[i] != '\n' && input[i] != '\r') {
-            input_no_newline[j++] = input[i];
-        }
-        else {
-            // Replace newline with space to maintain character positions
-            input_no_newline[j++] = ' ';
-        }
-    }
-    input_no_newline[j] = '\0';
-#ifdef DEBUG_VERBOSE
-    ecjp_printf("%s - %d: j = %d - i= %d -input len = %ld\n",__FUNCTION__,__LINE__,j,i,strlen(input));
-    ecjp_printf("%s - %d: Input without newlines for error display:\n%s\n",__FUNCTION__,__LINE__,input_no_newline);
-#endif
+static void *ecjp_std_realloc(void *ptr, size_t size, void *user_data)
+{
+    (void)user_data;
+    return realloc(ptr, size);
+}
 
-    row = strlen(input) / ECJP_MAX_PRINT_COLUMNS;
-    err_row = err_pos / ECJP_MAX_PRINT_COLUMNS;
-    err_column = err_pos % ECJP_MAX_PRINT_COLUMNS;
+static void ecjp_std_free(void *ptr, void *user_data)
+{
+    (void)user_data;
+    free(ptr);
+}
 
-    ecjp_printf("%s - %d: Error at position %d (row %d, column %d):\n", __FUNCTION__,__LINE__,err_pos, err_row + 1, err_column + 1);
+static const ecjp_allocator_t ecjp_std_allocator = {
+    ecjp_std_malloc,
+    ecjp_std_realloc,
+    ecjp_std_free,
+    NULL
+};
 
-    int remain;
-    for (i = 0; i <= row; i++) {
-        remain = strlen(input_no_newline) - (i * ECJP_MAX_PRINT_COLUMNS);
-        remain = (remain > ECJP_MAX_PRINT_COLUMNS) ? ECJP_MAX_PRINT_COLUMNS : remain;
-        ecjp_printf("%.*s\n",remain, &input_no_newline[i * ECJP_MAX_PRINT_COLUMNS]);
-        if(i == err_row) {
-            for (j = 0; j < err_column; j++) {
-                ecjp_print("-");
-            }
-            ecjp_print("^\n");
-        }
-    }
-    return ECJP_NO_ERROR;
+static ecjp_allocator_t ecjp_allocator = {
+    ecjp_std_malloc,
+    ecjp_std_realloc,
+    ecjp_std_free,
+    NULL
 };
 
+static inline void *ecjp_malloc(size_t size)
+{
+    return ecjp_allocator.malloc_fn(size, ecjp_allocator.user_data);
+}
 
-#ifdef ECJP_TOKEN_LIST
+static inline void *ecjp_realloc(void *ptr, size_t size)
+{
+    if (ptr == NULL) {
+        return ecjp_allocator.malloc_fn(size, ecjp_allocator.user_data);
+    }
+    return ecjp_allocator.realloc_fn(ptr, size, ecjp_allocator.user_data);
+}
 
-/******* ALTERNATIVE IMPLEMENTATION *********/
-/* 
-In this implementation, we parse the input string and extract item tokens (values) instead of keys.
-We store these item tokens in a linked list passed as a parameter.
-This implementation is useful when the focus is on the values rather than the keys but use much more memory.
+static inline void ecjp_free(void *ptr)
+{
+    if (ptr != NULL) {
+        ecjp_allocator.free_fn(ptr, ecjp_allocator.user_data);
+    }
+}
+
+static inline void *ecjp_calloc(size_t count, size_t size)
+{
+    void *ptr;
+
+    if ((size != 0) && (count > (size_t)-1 / size)) {
+        return NULL;
+    }
+    ptr = ecjp_malloc(count * size);
+    if (ptr != NULL) {
+        memset(ptr, 0, count * size);
+    }
+    return ptr;
+}
+
+/*
+ * Stage 1: structural pre-scan
+ * The input is classified in blocks of ECJP_BLOCK_SIZE bytes: every byte of a block is mapped
+ * to one bit of a set of masks (quotes, backslashes, structural characters, whitespace and
+ * control characters). The escaped characters are resolved on the backslash mask and the
+ * regions inside strings are computed with a prefix XOR of the unescaped quotes (carry-less
+ * multiplication when the CPU supports it).
+ * The state machines use the resulting masks to jump over the runs of characters that can't
+ * change their status: whitespace outside strings and plain characters inside strings.
+ * The kernel used to classify a block is selected at runtime (see ecjp_set_simd_level()).
 */
 
-/* Internal API functions */
+typedef struct ecjp_block_masks {
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t structural;
+    uint64_t whitespace;
+    uint64_t ctrl;
+} ecjp_block_masks_t;
+
+typedef void (*ecjp_classify_fn_t)(const unsigned char *block, ecjp_block_masks_t *m);
+typedef uint64_t (*ecjp_prefix_xor_fn_t)(uint64_t x);
+typedef ecjp_bool_t (*ecjp_utf8_fn_t)(const unsigned char *block, const unsigned char *tail);
+
+typedef struct ecjp_stage1 {
+    const char              *input;
+    int                     len;
+    ecjp_bool_t             open_end;       // NUL-terminated input: len is known when the last block is classified
+    int                     block;          // index of the last classified block, -1 if none
+    uint64_t                whitespace;     // whitespace outside strings
+    uint64_t                plain;          // characters inside strings that are not quote, backslash or control
+    uint64_t                structural;     // structural characters outside strings
+    uint64_t                in_string;      // characters inside strings (opening quote included)
+    uint64_t                prev_escaped;   // carry: the first character of the next block is escaped
+    uint64_t                prev_in_string; // carry: all ones if the next block starts inside a string
+    ecjp_classify_fn_t      classify;
+    ecjp_prefix_xor_fn_t    prefix_xor;
+    ecjp_utf8_fn_t          utf8;           // UTF-8 kernel, NULL if the input is not validated
+    unsigned char           utf8_tail[3];   // carry: the last bytes of the last validated block
+    int                     utf8_err_pos;   // position of the first invalid UTF-8 sequence, -1 if none
+} ecjp_stage1_t;
 
 /*
- *  Function: ecjp_store_tmp_item()
-    This function store a character in the temporary buffer for building an item token value.
-    Parameters:
-    - buffer: The temporary buffer to store the character.
-    - p_buffer: Pointer to the current position in the buffer.
-    - c: The character to be stored.
-    Returns:
-    - ECJP_NO_ERROR if the character is stored successfully.
-    - ECJP_NO_SPACE_IN_BUFFER_VALUE if the buffer exceeds maximum length.
+ * Function: ecjp_ctz64()
+        This function counts the trailing zero bits of a 64 bit mask.
+        Parameters:
+        - x: The mask, must be not zero.
+        Returns:
+        - The index of the lowest bit set.
 */
-ecjp_return_code_t ecjp_store_tmp_item(char *buffer, int *p_buffer, char c)
+static inline int ecjp_ctz64(uint64_t x)
 {
-    if(*p_buffer >= (ECJP_MAX_ITEM_LEN - 1)) {
-        ecjp_printf("%s - %d: Item length exceeds maximum limit (p_buffer = %d, limit = %d)\n", __FUNCTION__,__LINE__, *p_buffer, ECJP_MAX_ITEM_LEN);
-        return ECJP_NO_SPACE_IN_BUFFER_VALUE;
+#ifdef __GNUC__
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while ((x & 1) == 0) {
+        x >>= 1;
+        n++;
     }
-    buffer[*p_buffer] = c;
-    (*p_buffer)++;
-#ifdef DEBUG_VERBOSE    
-    ecjp_printf("%s - %d: Stored char '%c' in tmp buffer at position %d\n", __FUNCTION__,__LINE__, c, *p_buffer - 1);
+    return n;
 #endif
-    return ECJP_NO_ERROR;
 }
 
 /*
- *  Function: ecjp_load_item()
-    This function load an item token from the temporary buffer.
-    Parameters:
-    - token: Pointer to the item token structure to be loaded.
-    - tmp_buffer: The temporary buffer containing the item value.
-    - p_buffer: The size of the item value in the buffer.
-    Returns:
-    - The length of the loaded item token value.
-    - 0 if there is a memory allocation error.
+ * Function: ecjp_classify_scalar()
+        Portable kernel: classify a block of ECJP_BLOCK_SIZE bytes one byte at a time.
+        Parameters:
+        - block: Pointer to the block.
+        - m: Pointer to the masks to fill.
 */
-int ecjp_load_item(ecjp_item_token_t *token, char *tmp_buffer, int p_buffer)
+static void ecjp_classify_scalar(const unsigned char *block, ecjp_block_masks_t *m)
 {
-    int len = (p_buffer + 1);
-
-    // allocate memory for token value, copy tmp_buffer to token value
-    // in tmp_buffer there are no more than ECJP_MAX_ITEM_LEN characters
-    token->value = malloc(len);
-    if (token->value == NULL) {
-        ecjp_printf("%s - %d: Memory allocation error for item token value\n", __FUNCTION__,__LINE__);
-        token->value_size = 0;
-        return 0;
-    }   
-    // null terminate the string
-    tmp_buffer[p_buffer] = '\0';
-    token->value_size = len;
-    strncpy(token->value, tmp_buffer, len);
-
-    ecjp_printf("%s - %d: Loaded item token of type %s, size %u, value: %s\n", __FUNCTION__,__LINE__, ecjp_type[token->type], token->value_size, (char *)token->value);
-    return len;
+    int i;
+    uint64_t bit;
+
+    memset(m, 0, sizeof(ecjp_block_masks_t));
+    for (i = 0; i < ECJP_BLOCK_SIZE; i++) {
+        bit = (uint64_t)1 << i;
+        switch (block[i]) {
+            case '"':
+                m->quote |= bit;
+                break;
+            case '\\':
+                m->backslash |= bit;
+                break;
+            case '{':
+            case '}':
+            case '[':
+            case ']':
+            case ':':
+            case ',':
+                m->structural |= bit;
+                break;
+            case ' ':
+            case '\n':
+            case '\r':
+            case '\t':
+                m->whitespace |= bit;
+                break;
+            default:
+                // same set of characters rejected by ecjp_is_ctrl()
+                if ((block[i] < 0x20) || (block[i] == 0x7F)) {
+                    m->ctrl |= bit;
+                }
+                break;
+        }
+    }
 }
 
 /*
- *  Function: ecjp_reset_tmp_buffer()
-    This function reset the temporary buffer for building an item token value.
-    Parameters:
-    - tmp_buffer: The temporary buffer to be reset.
-    - p_buffer: Pointer to the current position in the buffer to be reset.
+ * Function: ecjp_prefix_xor_scalar()
+        Portable prefix XOR: bit i of the result is the XOR of the bits 0..i of x.
 */
-void ecjp_reset_tmp_buffer(char *tmp_buffer, int *p_buffer)
+static uint64_t ecjp_prefix_xor_scalar(uint64_t x)
 {
-    memset(tmp_buffer, 0, ECJP_MAX_ITEM_LEN);
-    *p_buffer = 0;
-    return;
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
 }
 
+#ifdef ECJP_HAVE_X86_SIMD
+
 /*
- *  Function: ecjp_init_item_token()
-    This function initialize an item token structure.
-    Parameters:
-    - token: Pointer to the item token structure to be initialized.
+ * Function: ecjp_prefix_xor_clmul()
+        Prefix XOR computed as carry-less multiplication by an all ones operand.
 */
-void ecjp_init_item_token(ecjp_item_token_t *token)
+__attribute__((target("pclmul,sse2")))
+static uint64_t ecjp_prefix_xor_clmul(uint64_t x)
 {
-    token->type = ECJP_TYPE_UNDEFINED;
-    token->value = NULL;
-    token->value_size = 0;
-    return;
+    uint64_t r;
+    __m128i v;
+
+    v = _mm_clmulepi64_si128(_mm_set_epi64x(0, (long long)x), _mm_set1_epi8((char)0xFF), 0);
+    _mm_storel_epi64((__m128i *)&r, v);
+    return r;
 }
 
 /*
- *  Function: ecjp_free_item_token()
-    This function free the memory allocated for an item token structure.
-    Parameters:
-    - token: Pointer to the item token structure to be freed.
+ * Function: ecjp_classify_sse2()
+        SSE2 kernel: classify a block as four vectors of 16 bytes.
 */
-void ecjp_free_item_token(ecjp_item_token_t *token)
+__attribute__((target("sse2")))
+static void ecjp_classify_sse2(const unsigned char *block, ecjp_block_masks_t *m)
 {
-    if (token->value != NULL) {
-        free(token->value);
-        token->value = NULL;
+    int i;
+    __m128i v, lower, ws, ctrl;
+
+    memset(m, 0, sizeof(ecjp_block_masks_t));
+    for (i = 0; i < ECJP_BLOCK_SIZE / 16; i++) {
+        v = _mm_loadu_si128((const __m128i *)(block + 16 * i));
+        // '[' and '{' (and ']' and '}') differ only for bit 0x20
+        lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))),
+                          _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))));
+        // unsigned v <= 0x1F, excluding the whitespace, plus DEL
+        ctrl = _mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8(0x1F)), _mm_set1_epi8(0x1F));
+        ctrl = _mm_or_si128(_mm_andnot_si128(ws, ctrl), _mm_cmpeq_epi8(v, _mm_set1_epi8(0x7F)));
+
+        m->quote |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('"'))) << (16 * i);
+        m->backslash |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))) << (16 * i);
+        m->structural |= (uint64_t)(uint16_t)_mm_movemask_epi8(
+                            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(lower, _mm_set1_epi8('{')), _mm_cmpeq_epi8(lower, _mm_set1_epi8('}'))),
+                                         _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(':')), _mm_cmpeq_epi8(v, _mm_set1_epi8(','))))) << (16 * i);
+        m->whitespace |= (uint64_t)(uint16_t)_mm_movemask_epi8(ws) << (16 * i);
+        m->ctrl |= (uint64_t)(uint16_t)_mm_movemask_epi8(ctrl) << (16 * i);
     }
-    token->value_size = 0;
+}
+
+/*
+ * Function: ecjp_classify_avx2()
+        AVX2 kernel: classify a block as two vectors of 32 bytes.
+*/
+__attribute__((target("avx2")))
+static void ecjp_classify_avx2(const unsigned char *block, ecjp_block_masks_t *m)
+{
+    int i;
+    __m256i v, lower, ws, ctrl;
+
+    memset(m, 0, sizeof(ecjp_block_masks_t));
+    for (i = 0; i < ECJP_BLOCK_SIZE / 32; i++) {
+        v = _mm256_loadu_si256((const __m256i *)(block + 32 * i));
+        lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+        ws = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))),
+                             _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))));
+        ctrl = _mm256_cmpeq_epi8(_mm256_max_epu8(v, _mm256_set1_epi8(0x1F)), _mm256_set1_epi8(0x1F));
+        ctrl = _mm256_or_si256(_mm256_andnot_si256(ws, ctrl), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x7F)));
+
+        m->quote |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'))) << (32 * i);
+        m->backslash |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))) << (32 * i);
+        m->structural |= (uint64_t)(uint32_t)_mm256_movemask_epi8(
+                            _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(lower, _mm256_set1_epi8('{')), _mm256_cmpeq_epi8(lower, _mm256_set1_epi8('}'))),
+                                            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(','))))) << (32 * i);
+        m->whitespace |= (uint64_t)(uint32_t)_mm256_movemask_epi8(ws) << (32 * i);
+        m->ctrl |= (uint64_t)(uint32_t)_mm256_movemask_epi8(ctrl) << (32 * i);
+    }
+}
+
+/*
+ * Function: ecjp_classify_avx512()
+        AVX-512BW kernel: classify a block as a single vector of 64 bytes.
+*/
+__attribute__((target("avx512f,avx512bw")))
+static void ecjp_classify_avx512(const unsigned char *block, ecjp_block_masks_t *m)
+{
+    __m512i v, lower;
+    uint64_t ws;
+
+    v = _mm512_loadu_si512((const void *)block);
+    lower = _mm512_or_si512(v, _mm512_set1_epi8(0x20));
+    ws = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(' ')) | _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\n')) |
+         _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\r')) | _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\t'));
+
+    m->quote = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('"'));
+    m->backslash = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\\'));
+    m->structural = _mm512_cmpeq_epi8_mask(lower, _mm512_set1_epi8('{')) | _mm512_cmpeq_epi8_mask(lower, _mm512_set1_epi8('}')) |
+                    _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(':')) | _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(','));
+    m->whitespace = ws;
+    m->ctrl = (_mm512_cmple_epu8_mask(v, _mm512_set1_epi8(0x1F)) & ~ws) | _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(0x7F));
+}
+
+#endif // ECJP_HAVE_X86_SIMD
+
+static const ecjp_classify_fn_t ecjp_classify_kernel[ECJP_SIMD_MAX_LEVEL] = {
+    ecjp_classify_scalar,
+#ifdef ECJP_HAVE_X86_SIMD
+    ecjp_classify_sse2,
+    ecjp_classify_avx2,
+    ecjp_classify_avx512
+#else
+    NULL,
+    NULL,
+    NULL
+#endif
+};
+
+/*
+ * UTF-8 validation (see the utf8_validation field of ecjp_ctx_t)
+ * When it's enabled every block classified by stage 1 is also validated as UTF-8, so the
+ * input is read once. The vector kernel is the lookup algorithm of Keiser and Lemire: three
+ * tables indexed by the nibbles of each byte and of the byte before it give the errors of
+ * every pair of bytes; the continuation bytes expected after a 3 or 4 byte lead are checked
+ * with the bytes two and three positions before. A block that is all ASCII is checked only
+ * for a sequence left incomplete by the block before.
+ * The last 3 bytes of each block are the carry to the next one; the position of the first
+ * error is found again one byte at a time, only in the block that has it.
+*/
+
+#define ECJP_UTF8_TAIL              3       // bytes of a block carried to the next one
+
+/*
+ * Function: ecjp_utf8_incomplete()
+        This function checks if the last bytes of a block end inside a multibyte sequence.
+        Parameters:
+        - tail: The last ECJP_UTF8_TAIL bytes of the block.
+        Returns:
+        - The index in tail of the lead byte of the incomplete sequence, ECJP_UTF8_TAIL if none.
+*/
+static inline int ecjp_utf8_incomplete(const unsigned char *tail)
+{
+    if (tail[2] >= 0xC0) {
+        return 2;
+    }
+    if (tail[1] >= 0xE0) {
+        return 1;
+    }
+    if (tail[0] >= 0xF0) {
+        return 0;
+    }
+    return ECJP_UTF8_TAIL;
+}
+
+/*
+ * Function: ecjp_utf8_first_error()
+        This function validates UTF-8 one sequence at a time: overlong forms, surrogates and
+        code points above U+10FFFF are errors. A sequence cut by the end of the bytes is not an
+        error, it's completed by the next block.
+        Parameters:
+        - buf: The bytes to validate.
+        - i: The index of the first byte (the start of a sequence).
+        - n: The number of bytes.
+        Returns:
+        - The index of the first byte of the first invalid sequence, -1 if none.
+*/
+static int ecjp_utf8_first_error(const unsigned char *buf, int i, int n)
+{
+    unsigned char c, lo, hi;
+    int k, len;
+
+    while (i < n) {
+        c = buf[i];
+        if (c < 0x80) {
+            i++;
+            continue;
+        }
+        if (c < 0xC2) {
+            // continuation without lead, or overlong 2 byte form
+            return i;
+        } else if (c < 0xE0) {
+            len = 2;
+            lo = 0x80;
+            hi = 0xBF;
+        } else if (c < 0xF0) {
+            len = 3;
+            lo = (c == 0xE0) ? 0xA0 : 0x80;     // overlong
+            hi = (c == 0xED) ? 0x9F : 0xBF;     // surrogates
+        } else if (c < 0xF5) {
+            len = 4;
+            lo = (c == 0xF0) ? 0x90 : 0x80;     // overlong
+            hi = (c == 0xF4) ? 0x8F : 0xBF;     // above U+10FFFF
+        } else {
+            return i;
+        }
+        for (k = 1; k < len; k++) {
+            if (i + k >= n) {
+                return -1;
+            }
+            if ((buf[i + k] < lo) || (buf[i + k] > hi)) {
+                return i;
+            }
+            lo = 0x80;
+            hi = 0xBF;
+        }
+        i += len;
+    }
+    return -1;
+}
+
+/*
+ * Function: ecjp_utf8_block_error()
+        This function finds the first invalid sequence of a block, starting from a sequence
+        left incomplete by the block before.
+        Parameters:
+        - block: Pointer to the block of ECJP_BLOCK_SIZE bytes.
+        - tail: The last ECJP_UTF8_TAIL bytes of the block before (zeros for the first block).
+        Returns:
+        - The offset of the error from the start of the block (negative if the invalid sequence
+          starts in the block before), ECJP_BLOCK_SIZE if the block is valid.
+*/
+static int ecjp_utf8_block_error(const unsigned char *block, const unsigned char *tail)
+{
+    unsigned char buf[ECJP_UTF8_TAIL + ECJP_BLOCK_SIZE];
+    int pos;
+
+    memcpy(buf, tail, ECJP_UTF8_TAIL);
+    memcpy(&buf[ECJP_UTF8_TAIL], block, ECJP_BLOCK_SIZE);
+    pos = ecjp_utf8_first_error(buf, ecjp_utf8_incomplete(tail), ECJP_UTF8_TAIL + ECJP_BLOCK_SIZE);
+    return (pos < 0) ? ECJP_BLOCK_SIZE : (pos - ECJP_UTF8_TAIL);
+}
+
+/*
+ * Function: ecjp_utf8_scalar()
+        Portable kernel: a block of ASCII characters is found 8 bytes at a time, the others are
+        validated one sequence at a time.
+        Parameters:
+        - block: Pointer to the block of ECJP_BLOCK_SIZE bytes.
+        - tail: The last ECJP_UTF8_TAIL bytes of the block before.
+        Returns:
+        - ECJP_BOOL_TRUE if the block is valid.
+*/
+static ecjp_bool_t ecjp_utf8_scalar(const unsigned char *block, const unsigned char *tail)
+{
+    uint64_t w, high = 0;
+    int i;
+
+    for (i = 0; i < ECJP_BLOCK_SIZE; i += 8) {
+        memcpy(&w, &block[i], 8);
+        high |= w;
+    }
+    if ((high & 0x8080808080808080ULL) == 0) {
+        return (ecjp_utf8_incomplete(tail) == ECJP_UTF8_TAIL) ? ECJP_BOOL_TRUE : ECJP_BOOL_FALSE;
+    }
+    return (ecjp_utf8_block_error(block, tail) == ECJP_BLOCK_SIZE) ? ECJP_BOOL_TRUE : ECJP_BOOL_FALSE;
+}
+
+#ifdef ECJP_HAVE_X86_SIMD
+
+// errors of a pair of bytes (byte 1 followed by byte 2) found by the tables
+#define ECJP_UTF8_TOO_SHORT         (1 << 0)    // lead not followed by a continuation
+#define ECJP_UTF8_TOO_LONG          (1 << 1)    // ASCII followed by a continuation
+#define ECJP_UTF8_OVERLONG_3        (1 << 2)    // 11100000 100_____
+#define ECJP_UTF8_TOO_LARGE         (1 << 3)    // 11110100 1001____, 11110100 101_____, 11110101 and above
+#define ECJP_UTF8_SURROGATE         (1 << 4)    // 11101101 101_____
+#define ECJP_UTF8_OVERLONG_2        (1 << 5)    // 1100000_ 10______
+#define ECJP_UTF8_TOO_LARGE_1000    (1 << 6)    // 11110101 1000____ and above
+#define ECJP_UTF8_OVERLONG_4        (1 << 6)    // 11110000 1000____
+#define ECJP_UTF8_TWO_CONTS         (1 << 7)    // two continuations: valid only after a 3 or 4 byte lead
+#define ECJP_UTF8_CARRY             (ECJP_UTF8_TOO_SHORT | ECJP_UTF8_TOO_LONG | ECJP_UTF8_TWO_CONTS)
+
+// tables indexed by the high nibble of byte 1, the low nibble of byte 1 and the high nibble of byte 2
+static const unsigned char ecjp_utf8_byte_1_high[16] = {
+    // 0_______ ________: ASCII
+    ECJP_UTF8_TOO_LONG, ECJP_UTF8_TOO_LONG, ECJP_UTF8_TOO_LONG, ECJP_UTF8_TOO_LONG,
+    ECJP_UTF8_TOO_LONG, ECJP_UTF8_TOO_LONG, ECJP_UTF8_TOO_LONG, ECJP_UTF8_TOO_LONG,
+    // 10______ ________: continuation
+    ECJP_UTF8_TWO_CONTS, ECJP_UTF8_TWO_CONTS, ECJP_UTF8_TWO_CONTS, ECJP_UTF8_TWO_CONTS,
+    // 1100____ ________, 1101____ ________: 2 byte lead
+    ECJP_UTF8_TOO_SHORT | ECJP_UTF8_OVERLONG_2,
+    ECJP_UTF8_TOO_SHORT,
+    // 1110____ ________: 3 byte lead
+    ECJP_UTF8_TOO_SHORT | ECJP_UTF8_OVERLONG_3 | ECJP_UTF8_SURROGATE,
+    // 1111____ ________: 4 byte lead
+    ECJP_UTF8_TOO_SHORT | ECJP_UTF8_TOO_LARGE | ECJP_UTF8_TOO_LARGE_1000 | ECJP_UTF8_OVERLONG_4
+};
+
+static const unsigned char ecjp_utf8_byte_1_low[16] = {
+    // ____0000 ________
+    ECJP_UTF8_CARRY | ECJP_UTF8_OVERLONG_3 | ECJP_UTF8_OVERLONG_2 | ECJP_UTF8_OVERLONG_4,
+    // ____0001 ________
+    ECJP_UTF8_CARRY | ECJP_UTF8_OVERLONG_2,
+    // ____001_ ________
+    ECJP_UTF8_CARRY,
+    ECJP_UTF8_CARRY,
+    // ____0100 ________
+    ECJP_UTF8_CARRY | ECJP_UTF8_TOO_LARGE,
+    // ____0101 ________ and above
+    ECJP_UTF8_CARRY | ECJP_UTF8_TOO_LARGE | ECJP_UTF8_TOO_LARGE_1000,
+    ECJP_UTF8_CARRY | ECJP_UTF8_TOO_LARGE | ECJP_UTF8_TOO_LARGE_1000,
+    ECJP_UTF8_CARRY | ECJP_UTF8_TOO_LARGE | ECJP_UTF8_TOO_LARGE_1000,
+    ECJP_UTF8_CARRY | ECJP_UTF8_TOO_LARGE | ECJP_UTF8_TOO_LARGE_1000,
+    ECJP_UTF8_CARRY | ECJP_UTF8_TOO_LARGE | ECJP_UTF8_TOO_LARGE_1000,
+    ECJP_UTF8_CARRY | ECJP_UTF8_TOO_LARGE | ECJP_UTF8_TOO_LARGE_1000,
+    ECJP_UTF8_CARRY | ECJP_UTF8_TOO_LARGE | ECJP_UTF8_TOO_LARGE_1000,
+    ECJP_UTF8_CARRY | ECJP_UTF8_TOO_LARGE | ECJP_UTF8_TOO_LARGE_1000,
+    // ____1101 ________
+    ECJP_UTF8_CARRY | ECJP_UTF8_TOO_LARGE | ECJP_UTF8_TOO_LARGE_1000 | ECJP_UTF8_SURROGATE,
+    ECJP_UTF8_CARRY | ECJP_UTF8_TOO_LARGE | ECJP_UTF8_TOO_LARGE_1000,
+    ECJP_UTF8_CARRY | ECJP_UTF8_TOO_LARGE | ECJP_UTF8_TOO_LARGE_1000
+};
+
+static const unsigned char ecjp_utf8_byte_2_high[16] = {
+    // ________ 0_______: ASCII
+    ECJP_UTF8_TOO_SHORT, ECJP_UTF8_TOO_SHORT, ECJP_UTF8_TOO_SHORT, ECJP_UTF8_TOO_SHORT,
+    ECJP_UTF8_TOO_SHORT, ECJP_UTF8_TOO_SHORT, ECJP_UTF8_TOO_SHORT, ECJP_UTF8_TOO_SHORT,
+    // ________ 1000____
+    ECJP_UTF8_TOO_LONG | ECJP_UTF8_OVERLONG_2 | ECJP_UTF8_TWO_CONTS | ECJP_UTF8_OVERLONG_3 | ECJP_UTF8_TOO_LARGE_1000 | ECJP_UTF8_OVERLONG_4,
+    // ________ 1001____
+    ECJP_UTF8_TOO_LONG | ECJP_UTF8_OVERLONG_2 | ECJP_UTF8_TWO_CONTS | ECJP_UTF8_OVERLONG_3 | ECJP_UTF8_TOO_LARGE,
+    // ________ 101_____
+    ECJP_UTF8_TOO_LONG | ECJP_UTF8_OVERLONG_2 | ECJP_UTF8_TWO_CONTS | ECJP_UTF8_SURROGATE | ECJP_UTF8_TOO_LARGE,
+    ECJP_UTF8_TOO_LONG | ECJP_UTF8_OVERLONG_2 | ECJP_UTF8_TWO_CONTS | ECJP_UTF8_SURROGATE | ECJP_UTF8_TOO_LARGE,
+    // ________ 11______: lead
+    ECJP_UTF8_TOO_SHORT, ECJP_UTF8_TOO_SHORT, ECJP_UTF8_TOO_SHORT, ECJP_UTF8_TOO_SHORT
+};
+
+/*
+ * Function: ecjp_utf8_check_ssse3()
+        This function finds the errors of a vector of 16 bytes.
+        Parameters:
+        - input: The bytes to check.
+        - prev_input: The 16 bytes before them.
+        Returns:
+        - A vector with a byte not zero for each error.
+*/
+__attribute__((target("ssse3")))
+static inline __m128i ecjp_utf8_check_ssse3(__m128i input, __m128i prev_input)
+{
+    const __m128i low_nibble = _mm_set1_epi8(0x0F);
+    __m128i prev1, prev2, prev3, special, must23;
+
+    prev1 = _mm_alignr_epi8(input, prev_input, 16 - 1);
+    prev2 = _mm_alignr_epi8(input, prev_input, 16 - 2);
+    prev3 = _mm_alignr_epi8(input, prev_input, 16 - 3);
+    special = _mm_and_si128(_mm_and_si128(
+        _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)ecjp_utf8_byte_1_high), _mm_and_si128(_mm_srli_epi16(prev1, 4), low_nibble)),
+        _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)ecjp_utf8_byte_1_low), _mm_and_si128(prev1, low_nibble))),
+        _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)ecjp_utf8_byte_2_high), _mm_and_si128(_mm_srli_epi16(input, 4), low_nibble)));
+    // the second and third bytes after a 3 or 4 byte lead must be continuations (TWO_CONTS)
+    must23 = _mm_or_si128(_mm_subs_epu8(prev2, _mm_set1_epi8((char)(0xE0 - 0x80))),
+                          _mm_subs_epu8(prev3, _mm_set1_epi8((char)(0xF0 - 0x80))));
+    return _mm_xor_si128(_mm_and_si128(must23, _mm_set1_epi8((char)0x80)), special);
+}
+
+/*
+ * Function: ecjp_utf8_ssse3()
+        SSSE3 kernel: validates a block as four vectors of 16 bytes. See ecjp_utf8_scalar().
+*/
+__attribute__((target("ssse3")))
+static ecjp_bool_t ecjp_utf8_ssse3(const unsigned char *block, const unsigned char *tail)
+{
+    unsigned char prev[16];
+    __m128i v[ECJP_BLOCK_SIZE / 16], high, error, last;
+    int i;
+
+    high = _mm_setzero_si128();
+    for (i = 0; i < ECJP_BLOCK_SIZE / 16; i++) {
+        v[i] = _mm_loadu_si128((const __m128i *)(block + 16 * i));
+        high = _mm_or_si128(high, v[i]);
+    }
+    if (_mm_movemask_epi8(high) == 0) {
+        return (ecjp_utf8_incomplete(tail) == ECJP_UTF8_TAIL) ? ECJP_BOOL_TRUE : ECJP_BOOL_FALSE;
+    }
+    memset(prev, 0, sizeof(prev) - ECJP_UTF8_TAIL);
+    memcpy(&prev[sizeof(prev) - ECJP_UTF8_TAIL], tail, ECJP_UTF8_TAIL);
+    last = _mm_loadu_si128((const __m128i *)prev);
+    error = _mm_setzero_si128();
+    for (i = 0; i < ECJP_BLOCK_SIZE / 16; i++) {
+        error = _mm_or_si128(error, ecjp_utf8_check_ssse3(v[i], last));
+        last = v[i];
+    }
+    return (_mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xFFFF) ? ECJP_BOOL_TRUE : ECJP_BOOL_FALSE;
+}
+
+/*
+ * Function: ecjp_utf8_check_avx2()
+        This function finds the errors of a vector of 32 bytes. See ecjp_utf8_check_ssse3().
+*/
+__attribute__((target("avx2")))
+static inline __m256i ecjp_utf8_check_avx2(__m256i input, __m256i prev_input)
+{
+    const __m256i low_nibble = _mm256_set1_epi8(0x0F);
+    __m256i shifted, prev1, prev2, prev3, special, must23;
+
+    shifted = _mm256_permute2x128_si256(prev_input, input, 0x21);
+    prev1 = _mm256_alignr_epi8(input, shifted, 16 - 1);
+    prev2 = _mm256_alignr_epi8(input, shifted, 16 - 2);
+    prev3 = _mm256_alignr_epi8(input, shifted, 16 - 3);
+    special = _mm256_and_si256(_mm256_and_si256(
+        _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)ecjp_utf8_byte_1_high)),
+                            _mm256_and_si256(_mm256_srli_epi16(prev1, 4), low_nibble)),
+        _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)ecjp_utf8_byte_1_low)),
+                            _mm256_and_si256(prev1, low_nibble))),
+        _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)ecjp_utf8_byte_2_high)),
+                            _mm256_and_si256(_mm256_srli_epi16(input, 4), low_nibble)));
+    must23 = _mm256_or_si256(_mm256_subs_epu8(prev2, _mm256_set1_epi8((char)(0xE0 - 0x80))),
+                             _mm256_subs_epu8(prev3, _mm256_set1_epi8((char)(0xF0 - 0x80))));
+    return _mm256_xor_si256(_mm256_and_si256(must23, _mm256_set1_epi8((char)0x80)), special);
+}
+
+/*
+ * Function: ecjp_utf8_avx2()
+        AVX2 kernel: validates a block as two vectors of 32 bytes. See ecjp_utf8_scalar().
+*/
+__attribute__((target("avx2")))
+static ecjp_bool_t ecjp_utf8_avx2(const unsigned char *block, const unsigned char *tail)
+{
+    unsigned char prev[32];
+    __m256i v0, v1, error;
+
+    v0 = _mm256_loadu_si256((const __m256i *)block);
+    v1 = _mm256_loadu_si256((const __m256i *)(block + 32));
+    if (_mm256_movemask_epi8(_mm256_or_si256(v0, v1)) == 0) {
+        return (ecjp_utf8_incomplete(tail) == ECJP_UTF8_TAIL) ? ECJP_BOOL_TRUE : ECJP_BOOL_FALSE;
+    }
+    memset(prev, 0, sizeof(prev) - ECJP_UTF8_TAIL);
+    memcpy(&prev[sizeof(prev) - ECJP_UTF8_TAIL], tail, ECJP_UTF8_TAIL);
+    error = _mm256_or_si256(ecjp_utf8_check_avx2(v0, _mm256_loadu_si256((const __m256i *)prev)),
+                            ecjp_utf8_check_avx2(v1, v0));
+    return _mm256_testz_si256(error, error) ? ECJP_BOOL_TRUE : ECJP_BOOL_FALSE;
+}
+
+#endif // ECJP_HAVE_X86_SIMD
+
+// SSE2 has no byte shuffle: the SSE2 level uses the SSSE3 kernel when the CPU has it (see ecjp_stage1_init())
+static const ecjp_utf8_fn_t ecjp_utf8_kernel[ECJP_SIMD_MAX_LEVEL] = {
+    ecjp_utf8_scalar,
+#ifdef ECJP_HAVE_X86_SIMD
+    ecjp_utf8_scalar,
+    ecjp_utf8_avx2,
+    ecjp_utf8_avx2
+#else
+    NULL,
+    NULL,
+    NULL
+#endif
+};
+
+// ECJP_SIMD_MAX_LEVEL until the first detection
+static ecjp_simd_level_t ecjp_simd_level = ECJP_SIMD_MAX_LEVEL;
+
+/*
+ * Function: ecjp_simd_supported()
+        This function checks if the running CPU supports a kernel level.
+        Parameters:
+        - level: The level to check.
+        Returns:
+        - ECJP_BOOL_TRUE if the kernel can be used.
+        - ECJP_BOOL_FALSE otherwise.
+*/
+static ecjp_bool_t ecjp_simd_supported(ecjp_simd_level_t level)
+{
+    switch (level) {
+        case ECJP_SIMD_SCALAR:
+            return ECJP_BOOL_TRUE;
+#ifdef ECJP_HAVE_X86_SIMD
+        case ECJP_SIMD_SSE2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2") ? ECJP_BOOL_TRUE : ECJP_BOOL_FALSE;
+        case ECJP_SIMD_AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") ? ECJP_BOOL_TRUE : ECJP_BOOL_FALSE;
+        case ECJP_SIMD_AVX512:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx512bw") ? ECJP_BOOL_TRUE : ECJP_BOOL_FALSE;
+#endif
+        default:
+            return ECJP_BOOL_FALSE;
+    }
+}
+
+/*
+ * Function: ecjp_stage1_init()
+        This function prepares the pre-scan of an input string using the selected kernel.
+        Parameters:
+        - s: Pointer to the stage 1 data.
+        - input: The input string.
+        - len: The length of the input string, negative if the input is NUL-terminated.
+        - utf8: ECJP_BOOL_TRUE to validate the input as UTF-8 while it's classified.
+*/
+static void ecjp_stage1_init(ecjp_stage1_t *s, const char *input, int len, ecjp_bool_t utf8)
+{
+    ecjp_simd_level_t level = ecjp_get_simd_level();
+
+    memset(s, 0, sizeof(ecjp_stage1_t));
+    s->input = input;
+    s->len = len;
+    if (len < 0) {
+        // the end is found one block at a time, the input is never read past its '\0'
+        s->len = INT_MAX;
+        s->open_end = ECJP_BOOL_TRUE;
+    }
+    s->block = -1;
+    s->classify = ecjp_classify_kernel[level];
+    s->prefix_xor = ecjp_prefix_xor_scalar;
+#ifdef ECJP_HAVE_X86_SIMD
+    if (level != ECJP_SIMD_SCALAR && __builtin_cpu_supports("pclmul")) {
+        s->prefix_xor = ecjp_prefix_xor_clmul;
+    }
+#endif
+    s->utf8 = (utf8 == ECJP_BOOL_TRUE) ? ecjp_utf8_kernel[level] : NULL;
+#ifdef ECJP_HAVE_X86_SIMD
+    if ((s->utf8 != NULL) && (level == ECJP_SIMD_SSE2) && __builtin_cpu_supports("ssse3")) {
+        s->utf8 = ecjp_utf8_ssse3;
+    }
+#endif
+    s->utf8_err_pos = -1;
+}
+
+/*
+ * Function: ecjp_stage1_utf8_block()
+        This function validates a block as UTF-8 and records the position of the first error.
+        Parameters:
+        - s: Pointer to the stage 1 data.
+        - src: Pointer to the block (padded with '\0' after the end of the input).
+        - start: The position of the block in the input.
+*/
+static void ecjp_stage1_utf8_block(ecjp_stage1_t *s, const unsigned char *src, int start)
+{
+    if (s->utf8_err_pos < 0) {
+        if (s->utf8(src, s->utf8_tail) == ECJP_BOOL_FALSE) {
+            s->utf8_err_pos = start + ecjp_utf8_block_error(src, s->utf8_tail);
+        }
+        memcpy(s->utf8_tail, &src[ECJP_BLOCK_SIZE - ECJP_UTF8_TAIL], ECJP_UTF8_TAIL);
+    }
+}
+
+/*
+ * Function: ecjp_stage1_utf8_error()
+        This function validates the blocks not classified yet and the end of the input:
+        it's called when the input is checked. The state machines don't need the masks any
+        more, so the blocks left are only validated.
+        Parameters:
+        - s: Pointer to the stage 1 data.
+        Returns:
+        - The position of the first invalid UTF-8 sequence, -1 if the input is valid or not validated.
+*/
+static int ecjp_stage1_utf8_error(ecjp_stage1_t *s)
+{
+    unsigned char tail[ECJP_BLOCK_SIZE];
+    int start, lead;
+
+    if (s->utf8 == NULL) {
+        return -1;
+    }
+    for (start = (s->block + 1) * ECJP_BLOCK_SIZE; (start < s->len) && (s->utf8_err_pos < 0); start += ECJP_BLOCK_SIZE) {
+        if (start + ECJP_BLOCK_SIZE <= s->len) {
+            ecjp_stage1_utf8_block(s, (const unsigned char *)&s->input[start], start);
+        } else {
+            memset(tail, 0, sizeof(tail));
+            memcpy(tail, &s->input[start], s->len - start);
+            ecjp_stage1_utf8_block(s, tail, start);
+        }
+        s->block = start / ECJP_BLOCK_SIZE;
+    }
+    // a sequence cut by the end of the input (the padding of the last block finds it otherwise)
+    if ((s->utf8_err_pos < 0) && (s->len % ECJP_BLOCK_SIZE == 0)) {
+        lead = ecjp_utf8_incomplete(s->utf8_tail);
+        if (lead < ECJP_UTF8_TAIL) {
+            s->utf8_err_pos = s->len - ECJP_UTF8_TAIL + lead;
+        }
+    }
+    return s->utf8_err_pos;
+}
+
+/*
+ * Function: ecjp_stage1_next_block()
+        This function classifies the next block of the input and updates the masks and the carries.
+        Parameters:
+        - s: Pointer to the stage 1 data.
+*/
+static void ecjp_stage1_next_block(ecjp_stage1_t *s)
+{
+    const uint64_t even_bits = 0x5555555555555555ULL;
+    unsigned char tail[ECJP_BLOCK_SIZE];
+    const unsigned char *src;
+    ecjp_block_masks_t m;
+    uint64_t backslash, follows_escape, odd_starts, sequences, escaped, quote, in_string;
+    int start, len;
+
+    s->block++;
+    start = s->block * ECJP_BLOCK_SIZE;
+    if (s->open_end == ECJP_BOOL_TRUE) {
+        len = (int)strnlen(&s->input[start], ECJP_BLOCK_SIZE);
+        if (len < ECJP_BLOCK_SIZE) {
+            s->len = start + len;
+            s->open_end = ECJP_BOOL_FALSE;
+        }
+    }
+    if (start + ECJP_BLOCK_SIZE <= s->len) {
+        src = (const unsigned char *)&s->input[start];
+    } else {
+        // last block: pad with '\0', it's a control character so it stops every run
+        memset(tail, 0, sizeof(tail));
+        memcpy(tail, &s->input[start], s->len - start);
+        src = tail;
+    }
+    s->classify(src, &m);
+    if (s->utf8 != NULL) {
+        ecjp_stage1_utf8_block(s, src, start);
+    }
+
+    // a run of backslashes escapes the next character when its length is odd
+    backslash = m.backslash & ~s->prev_escaped;
+    follows_escape = (backslash << 1) | s->prev_escaped;
+    odd_starts = backslash & ~even_bits & ~follows_escape;
+    sequences = odd_starts + backslash;
+    s->prev_escaped = (sequences < odd_starts) ? 1 : 0;
+    escaped = (even_bits ^ (sequences << 1)) & follows_escape;
+
+    quote = m.quote & ~escaped;
+    in_string = s->prefix_xor(quote) ^ s->prev_in_string;
+    s->prev_in_string = (in_string >> 63) ? ~(uint64_t)0 : 0;
+
+    s->in_string = in_string;
+    s->whitespace = m.whitespace & ~in_string;
+    s->plain = in_string & ~(m.quote | m.backslash | m.ctrl);
+    s->structural = m.structural & ~in_string;
+}
+
+/*
+ * Function: ecjp_stage1_skip()
+        This function finds the end of a run of whitespace outside strings or of plain characters inside strings.
+        Parameters:
+        - s: Pointer to the stage 1 data.
+        - pos: The position where the run starts.
+        - plain: ECJP_BOOL_TRUE to skip plain string characters, ECJP_BOOL_FALSE to skip whitespace.
+        Returns:
+        - The position of the first character not in the run (the input length at the end of the input).
+*/
+static int ecjp_stage1_skip(ecjp_stage1_t *s, int pos, ecjp_bool_t plain)
+{
+    uint64_t stop;
+    int off, n;
+
+    while (pos < s->len) {
+        while (s->block < (pos / ECJP_BLOCK_SIZE)) {
+            ecjp_stage1_next_block(s);
+        }
+        off = pos % ECJP_BLOCK_SIZE;
+        stop = ~((plain ? s->plain : s->whitespace) >> off);
+        if (stop != 0) {
+            n = ecjp_ctz64(stop);
+            if (n < ECJP_BLOCK_SIZE - off) {
+                return pos + n;
+            }
+        }
+        pos += ECJP_BLOCK_SIZE - off;
+    }
+    return s->len;
+}
+
+/*
+ * Function: ecjp_skip_whitespace()
+        This function returns the position of the first character that is not a whitespace, starting from pos.
+*/
+static inline int ecjp_skip_whitespace(ecjp_stage1_t *s, int pos)
+{
+    // short runs are resolved without touching the masks
+    if ((pos >= s->len) || (ecjp_is_whitespace(s->input[pos]) == ECJP_BOOL_FALSE)) {
+        return pos;
+    }
+    return ecjp_stage1_skip(s, pos, ECJP_BOOL_FALSE);
+}
+
+/*
+ * Function: ecjp_skip_plain()
+        This function returns the position of the first quote, backslash or control character inside a string,
+        starting from pos.
+*/
+static inline int ecjp_skip_plain(ecjp_stage1_t *s, int pos)
+{
+    char c;
+
+    if (pos >= s->len) {
+        return pos;
+    }
+    c = s->input[pos];
+    if ((c == '"') || (c == '\\') || (ecjp_is_ctrl(c) == ECJP_BOOL_TRUE)) {
+        return pos;
+    }
+    return ecjp_stage1_skip(s, pos, ECJP_BOOL_TRUE);
+}
+
+#ifdef DEBUG_VERBOSE
+/* 
+ * Function: ecjp_print_check_summary()
+        This function prints a summary of the parsing process for debugging purposes.
+        Parameters:
+        - p: Pointer to the parser data structure.
+*/
+void ecjp_print_check_summary(ecjp_parser_data_t *p)
+{
+    ecjp_flags_t flags = p->flags;
+    ecjp_print("Parsing summary:\n");
+    ecjp_printf("  Total characters processed: %d\n", p->index);
+    ecjp_printf("  Final parser status: %d\n", p->status);
+    ecjp_printf("  Total objects: %d\n", p->num_objects);
+    ecjp_printf("  Total arrays: %d\n", p->num_arrays);
+    ecjp_printf("  Final open brackets count: %d\n", p->open_brackets);
+    ecjp_printf("  Final open square brackets count: %d\n", p->open_square_brackets);
+    ecjp_print("Flags status:\n");
+    ecjp_printf("  in_string: %d\n", flags.in_string);
+    ecjp_printf("  in_key: %d\n", flags.in_key);
+    ecjp_printf("  in_value: %d\n", flags.in_value);
+    ecjp_printf("  in_number: %d\n", flags.in_number);
+    ecjp_printf("  trailing_comma: %d\n", flags.trailing_comma);
+    ecjp_print("Stack:\n");
+    ecjp_printf("  Stack top index: %d\n", p->parse_stack.top);
+    return;
+};
+#endif
+
+
+/* Public function definitions */
+
+/*
+    Function: ecjp_dummy()
+        A simple dummy function to test library linkage.
+        Returns:
+        - ECJP_NO_ERROR on success.
+*/
+ecjp_return_code_t ecjp_dummy(void)
+{
+    ecjp_printf("%s: Hello ecjp library!\n",__FUNCTION__);
+    return ECJP_NO_ERROR;
+};
+
+/*
+    Function: ecjp_get_version()
+        This function retrieves the version of the eCjp library.
+        Parameters:
+        - major: Pointer to an integer to store the major version number.
+        - minor: Pointer to an integer to store the minor version number.
+        - patch: Pointer to an integer to store the patch version number.
+        Returns:
+        - ECJP_NO_ERROR on success.
+*/
+ecjp_return_code_t ecjp_get_version(int *major, int *minor, int *patch)
+{
+    if (major != NULL) {
+        *major = ECJP_VERSION_MAJOR;
+    }
+    if (minor != NULL) {
+        *minor = ECJP_VERSION_MINOR;
+    }
+    if (patch != NULL) {
+        *patch = ECJP_VERSION_PATCH;
+    }
+    return ECJP_NO_ERROR;
+};
+
+/*
+    Function: ecjp_get_version_string()
+        This function retrieves the version of the eCjp library as a string.
+        Parameters:
+        - version_string: Pointer to a character array to store the version string.
+        - max_length: Maximum length of the version string buffer.
+        Returns:
+        - ECJP_NO_ERROR on success.
+        - ECJP_NULL_POINTER if version_string is NULL or max_length is 0.
+*/
+ecjp_return_code_t ecjp_get_version_string(char *version_string, int max_length)
+{
+    if (version_string == NULL || max_length == 0) {
+        return ECJP_NULL_POINTER;
+    }
+    snprintf(version_string, max_length, "%d.%d.%d", ECJP_VERSION_MAJOR, ECJP_VERSION_MINOR, ECJP_VERSION_PATCH);
+    return ECJP_NO_ERROR;
+};
+
+/*
+    Function: ecjp_show_error_n()
+        This function displays the input string with an indicator pointing to the error position.
+        Parameters:
+        - input: The JSON-like input string, it doesn't need to be NUL-terminated.
+        - len: The length of the input string.
+        - err_pos: The position of the error in the input string.
+        Returns:
+        - ECJP_NO_ERROR on success.
+        - ECJP_NULL_POINTER if input is NULL.
+*/
+ecjp_return_code_t ecjp_show_error_n(const char *input, size_t len, int err_pos)
+{
+    int row, i, j, k, err_row, err_column, remain;
+    char line[ECJP_MAX_PRINT_COLUMNS + 1];
+
+    if (input == NULL) {
+        ecjp_printf("%s - %d: NULL pointer input\n",__FUNCTION__,__LINE__);
+        return ECJP_NULL_POINTER;
+    }
+
+    row = len / ECJP_MAX_PRINT_COLUMNS;
+    err_row = err_pos / ECJP_MAX_PRINT_COLUMNS;
+    err_column = err_pos % ECJP_MAX_PRINT_COLUMNS;
+
+    ecjp_printf("%s - %d: Error at position %d (row %d, column %d):\n", __FUNCTION__,__LINE__,err_pos, err_row + 1, err_column + 1);
+
+    // the input is printed one row at a time, without copying it
+    for (i = 0; i <= row; i++) {
+        remain = (int)len - (i * ECJP_MAX_PRINT_COLUMNS);
+        remain = (remain > ECJP_MAX_PRINT_COLUMNS) ? ECJP_MAX_PRINT_COLUMNS : remain;
+        for (k = 0; k < remain; k++) {
+            j = (i * ECJP_MAX_PRINT_COLUMNS) + k;
+            // Replace newline (and NUL) with space to maintain character positions
+            line[k] = (input[j] != '\n' && input[j] != '\r' && input[j] != '\0') ? input[j] : ' ';
+        }
+        line[(remain > 0) ? remain : 0] = '\0';
+        ecjp_printf("%s\n", line);
+        (void)line; // not printed when the traces are disabled
+        if(i == err_row) {
+            for (j = 0; j < err_column; j++) {
+                ecjp_print("-");
+            }
+            ecjp_print("^\n");
+        }
+    }
+    return ECJP_NO_ERROR;
+};
+
+/*
+    Function: ecjp_show_error()
+        This function calls ecjp_show_error_n() on a NUL-terminated input string.
+        Parameters:
+        - input: The JSON-like input string.
+        - err_pos: The position of the error in the input string.
+        Returns:
+        - ECJP_NO_ERROR on success.
+        - ECJP_NULL_POINTER if input is NULL.
+*/
+ecjp_return_code_t ecjp_show_error(const char *input, int err_pos)
+{
+    return ecjp_show_error_n(input, (input != NULL) ? strlen(input) : 0, err_pos);
+}
+
+/*
+    Function: ecjp_get_simd_level()
+        This function returns the kernel used by the structural pre-scan of the input.
+        At the first call the best kernel supported by the running CPU is selected.
+        Returns:
+        - ECJP_SIMD_SCALAR, ECJP_SIMD_SSE2, ECJP_SIMD_AVX2 or ECJP_SIMD_AVX512.
+*/
+ecjp_simd_level_t ecjp_get_simd_level(void)
+{
+    ecjp_simd_level_t level;
+
+#ifdef ECJP_HAVE_X86_SIMD
+    level = __atomic_load_n(&ecjp_simd_level, __ATOMIC_RELAXED);
+    if (level == ECJP_SIMD_MAX_LEVEL) {
+        level = ECJP_SIMD_AVX512;
+        while (level > ECJP_SIMD_SCALAR && ecjp_simd_supported(level) == ECJP_BOOL_FALSE) {
+            level--;
+        }
+        __atomic_store_n(&ecjp_simd_level, level, __ATOMIC_RELAXED);
+    }
+#else
+    level = ECJP_SIMD_SCALAR;
+#endif
+    return level;
+}
+
+/*
+    Function: ecjp_set_simd_level()
+        This function forces the kernel used by the structural pre-scan of the input.
+        It's useful to compare the kernels or to disable the vector instructions.
+        Parameters:
+        - level: The kernel to use.
+        Returns:
+        - ECJP_NO_ERROR on success.
+        - ECJP_GENERIC_ERROR if the kernel is not supported by the running CPU or by the build.
+*/
+ecjp_return_code_t ecjp_set_simd_level(ecjp_simd_level_t level)
+{
+    if (level >= ECJP_SIMD_MAX_LEVEL || ecjp_simd_supported(level) == ECJP_BOOL_FALSE) {
+        ecjp_printf("%s - %d: Kernel level %d not supported\n", __FUNCTION__,__LINE__, level);
+        return ECJP_GENERIC_ERROR;
+    }
+#ifdef ECJP_HAVE_X86_SIMD
+    __atomic_store_n(&ecjp_simd_level, level, __ATOMIC_RELAXED);
+#else
+    ecjp_simd_level = level;
+#endif
+    return ECJP_NO_ERROR;
+}
+
+/*
+    Function: ecjp_set_allocator()
+        This function sets the allocator used for all the memory of the library (lists, indexes,
+        tapes and values). The memory must be released with the same allocator that allocated it:
+        the allocator must be changed only when no list, index or tape is allocated and no parsing
+        is running.
+        Parameters:
+        - allocator: The allocator (copied), NULL to restore malloc(), realloc() and free().
+          ecjp_pool_allocator and ecjp_thread_cache_allocator are provided by the library.
+        Returns:
+        - ECJP_NO_ERROR on success.
+        - ECJP_GENERIC_ERROR if a function of the allocator is missing.
+*/
+ecjp_return_code_t ecjp_set_allocator(const ecjp_allocator_t *allocator)
+{
+    if (allocator == NULL) {
+        allocator = &ecjp_std_allocator;
+    }
+    if (allocator->malloc_fn == NULL || allocator->realloc_fn == NULL || allocator->free_fn == NULL) {
+        ecjp_printf("%s - %d: Incomplete allocator\n", __FUNCTION__,__LINE__);
+        return ECJP_GENERIC_ERROR;
+    }
+    ecjp_allocator = *allocator;
+    return ECJP_NO_ERROR;
+}
+
+/*
+    Function: ecjp_get_allocator()
+        This function returns the allocator used by the library.
+        Parameters:
+        - allocator: Pointer to the structure where the allocator is copied.
+        Returns:
+        - ECJP_NO_ERROR on success.
+        - ECJP_NULL_POINTER if allocator is NULL.
+*/
+ecjp_return_code_t ecjp_get_allocator(ecjp_allocator_t *allocator)
+{
+    if (allocator == NULL) {
+        return ECJP_NULL_POINTER;
+    }
+    *allocator = ecjp_allocator;
+    return ECJP_NO_ERROR;
+}
+
+/*
+    Function: ecjp_init_ctx()
+        This function initializes a parse context. The scratch memory is allocated by the
+        first call that needs it, with the size needed by the input; the counters start from zero
+        and the UTF-8 validation is disabled.
+        Parameters:
+        - ctx: Pointer to the context.
+        Returns:
+        - ECJP_NO_ERROR on success.
+        - ECJP_NULL_POINTER if ctx is NULL.
+*/
+ecjp_return_code_t ecjp_init_ctx(ecjp_ctx_t *ctx)
+{
+    if (ctx == NULL) {
+        ecjp_printf("%s - %d: NULL pointer ctx\n",__FUNCTION__,__LINE__);
+        return ECJP_NULL_POINTER;
+    }
+    ctx->scratch = NULL;
+    ctx->scratch_size = 0;
+    ctx->utf8_validation = ECJP_BOOL_FALSE;
+    memset(&ctx->stats, 0, sizeof(ecjp_stats_t));
+    return ECJP_NO_ERROR;
+}
+
+/*
+    Function: ecjp_free_ctx()
+        This function frees the scratch memory of a parse context, the context can be used again.
+        Parameters:
+        - ctx: Pointer to the context.
+        Returns:
+        - ECJP_NO_ERROR on success.
+        - ECJP_NULL_POINTER if ctx is NULL.
+*/
+ecjp_return_code_t ecjp_free_ctx(ecjp_ctx_t *ctx)
+{
+    if (ctx == NULL) {
+        ecjp_printf("%s - %d: NULL pointer ctx\n",__FUNCTION__,__LINE__);
+        return ECJP_NULL_POINTER;
+    }
+    ecjp_free(ctx->scratch);
+    ctx->scratch = NULL;
+    ctx->scratch_size = 0;
+    return ECJP_NO_ERROR;
+}
+
+/*
+    Function: ecjp_get_stats()
+        This function copies the counters of a context, or the ones of the calling thread that count
+        the calls without a context. The counters grow until ecjp_reset_stats().
+        Parameters:
+        - ctx: Pointer to the context, NULL for the counters of the thread.
+        - stats: Pointer to store the counters.
+        Returns:
+        - ECJP_NO_ERROR on success.
+        - ECJP_NULL_POINTER if stats is NULL.
+        - ECJP_GENERIC_ERROR if the library is built without ECJP_STATS (the counters are zero).
+*/
+ecjp_return_code_t ecjp_get_stats(const ecjp_ctx_t *ctx, ecjp_stats_t *stats)
+{
+    if (stats == NULL) {
+        ecjp_printf("%s - %d: NULL pointer stats\n",__FUNCTION__,__LINE__);
+        return ECJP_NULL_POINTER;
+    }
+#ifdef ECJP_STATS
+    *stats = (ctx != NULL) ? ctx->stats : ecjp_thread_stats;
+    return ECJP_NO_ERROR;
+#else
+    (void)ctx;
+    memset(stats, 0, sizeof(ecjp_stats_t));
+    return ECJP_GENERIC_ERROR;
+#endif
+}
+
+/*
+    Function: ecjp_reset_stats()
+        This function sets to zero the counters of a context, or the ones of the calling thread.
+        Parameters:
+        - ctx: Pointer to the context, NULL for the counters of the thread.
+        Returns:
+        - ECJP_NO_ERROR on success.
+        - ECJP_GENERIC_ERROR if the library is built without ECJP_STATS.
+*/
+ecjp_return_code_t ecjp_reset_stats(ecjp_ctx_t *ctx)
+{
+    if (ctx != NULL) {
+        memset(&ctx->stats, 0, sizeof(ecjp_stats_t));
+    }
+#ifdef ECJP_STATS
+    else {
+        memset(&ecjp_thread_stats, 0, sizeof(ecjp_stats_t));
+        memset(ecjp_rescan.buffers, 0, sizeof(ecjp_rescan.buffers));
+    }
+    return ECJP_NO_ERROR;
+#else
+    return ECJP_GENERIC_ERROR;
+#endif
+}
+
+/*
+    Function: ecjp_set_rescan_callback()
+        This function sets the quadratic access detector of the calling thread: the bytes and the
+        list elements read again by the lookup functions are summed for each buffer, and the
+        callback is called once for a buffer when they exceed ratio times its size.
+        The buffers already looked up are forgotten, as with ecjp_reset_stats(NULL).
+        Parameters:
+        - callback: The function to call, NULL to stop the detector.
+        - ratio: The number of times a buffer can be read again before the callback, at least 1.
+        - user_data: Pointer passed to the callback.
+        Returns:
+        - ECJP_NO_ERROR on success.
+        - ECJP_GENERIC_ERROR if ratio is 0 or the library is built without ECJP_STATS.
+*/
+ecjp_return_code_t ecjp_set_rescan_callback(ecjp_rescan_cb_t callback, unsigned int ratio, void *user_data)
+{
+#ifdef ECJP_STATS
+    if ((callback != NULL) && (ratio == 0)) {
+        ecjp_printf("%s - %d: Ratio must be at least 1\n",__FUNCTION__,__LINE__);
+        return ECJP_GENERIC_ERROR;
+    }
+    memset(&ecjp_rescan, 0, sizeof(ecjp_rescan_detector_t));
+    ecjp_rescan.callback = callback;
+    ecjp_rescan.ratio = ratio;
+    ecjp_rescan.user_data = user_data;
+    return ECJP_NO_ERROR;
+#else
+    (void)callback;
+    (void)ratio;
+    (void)user_data;
+    return ECJP_GENERIC_ERROR;
+#endif
+}
+
+/*
+ * Function: ecjp_ctx_reserve()
+        This function grows the scratch memory of a context to at least size bytes.
+        The content of the scratch memory is not kept.
+        Parameters:
+        - ctx: Pointer to the context.
+        - size: The number of bytes needed.
+        Returns:
+        - 0 on success.
+        - -1 on memory allocation failure.
+*/
+static inline int ecjp_ctx_reserve(ecjp_ctx_t *ctx, size_t size)
+{
+    char *grown;
+
+    if (ctx->scratch_size >= size) {
+        return 0;
+    }
+    grown = (char *)ecjp_malloc(size);
+    if (grown == NULL) {
+        ecjp_printf("%s - %d: Memory allocation failed for %zu bytes of scratch memory\n", __FUNCTION__,__LINE__, size);
+        return -1;
+    }
+    ecjp_free(ctx->scratch);
+    ctx->scratch = grown;
+    ctx->scratch_size = size;
+    return 0;
+}
+
+/*
+ * Static pool allocator
+ * Buddy allocator on a static buffer of ECJP_POOL_SIZE bytes, for the targets without a heap.
+ * The blocks have a size power of 2 (ECJP_POOL_MIN_ORDER at least) and start with a header
+ * with their order; a freed block is merged with its buddy when the buddy is free too, so the
+ * pool returns to a single block when all the memory is released. It isn't thread-safe.
+*/
+#define ECJP_POOL_MIN_ORDER         4           // 16 bytes
+#define ECJP_POOL_MAX_ORDERS        32
+
+typedef char ecjp_pool_size_check_t[(((ECJP_POOL_SIZE) & ((ECJP_POOL_SIZE) - 1)) == 0 && (ECJP_POOL_SIZE) >= 64) ? 1 : -1];
+
+typedef struct ecjp_pool_header {
+    uint32_t            order;
+    uint32_t            is_free;
+} ecjp_pool_header_t;
+
+typedef struct ecjp_pool_block {
+    ecjp_pool_header_t      header;
+    struct ecjp_pool_block  *next;          // only in the free blocks
+} ecjp_pool_block_t;
+
+static uint64_t ecjp_pool_data[(ECJP_POOL_SIZE) / sizeof(uint64_t)];
+static ecjp_pool_block_t *ecjp_pool_free_list[ECJP_POOL_MAX_ORDERS];
+static unsigned int ecjp_pool_max_order = 0;
+
+/*
+ * Function: ecjp_pool_push()
+        This function marks a block as free and adds it to the free list of its order.
+*/
+static void ecjp_pool_push(ecjp_pool_block_t *b, unsigned int order)
+{
+    b->header.order = order;
+    b->header.is_free = 1;
+    b->next = ecjp_pool_free_list[order];
+    ecjp_pool_free_list[order] = b;
+}
+
+/*
+ * Function: ecjp_pool_remove()
+        This function removes a free block from the free list of its order.
+*/
+static void ecjp_pool_remove(ecjp_pool_block_t *b)
+{
+    ecjp_pool_block_t **link = &ecjp_pool_free_list[b->header.order];
+
+    while (*link != NULL && *link != b) {
+        link = &(*link)->next;
+    }
+    if (*link != NULL) {
+        *link = b->next;
+    }
+    b->header.is_free = 0;
+}
+
+static void *ecjp_pool_malloc(size_t size, void *user_data)
+{
+    ecjp_pool_block_t *b;
+    unsigned int order, o;
+
+    (void)user_data;
+    if (ecjp_pool_max_order == 0) {
+        // the whole pool is the first free block
+        while (((size_t)1 << ecjp_pool_max_order) < (ECJP_POOL_SIZE)) {
+            ecjp_pool_max_order++;
+        }
+        ecjp_pool_push((ecjp_pool_block_t *)ecjp_pool_data, ecjp_pool_max_order);
+    }
+    if (size > (ECJP_POOL_SIZE) - sizeof(ecjp_pool_header_t)) {
+        return NULL;
+    }
+    order = ECJP_POOL_MIN_ORDER;
+    while (((size_t)1 << order) < size + sizeof(ecjp_pool_header_t)) {
+        order++;
+    }
+    o = order;
+    while (o <= ecjp_pool_max_order && ecjp_pool_free_list[o] == NULL) {
+        o++;
+    }
+    if (o > ecjp_pool_max_order) {
+        ecjp_printf("%s - %d: Pool exhausted (%zu bytes requested)\n", __FUNCTION__,__LINE__, size);
+        return NULL;
+    }
+    b = ecjp_pool_free_list[o];
+    ecjp_pool_remove(b);
+    // split the block, the upper halves are free
+    while (o > order) {
+        o--;
+        ecjp_pool_push((ecjp_pool_block_t *)((char *)b + ((size_t)1 << o)), o);
+    }
+    b->header.order = order;
+    b->header.is_free = 0;
+    return (char *)b + sizeof(ecjp_pool_header_t);
+}
+
+static void ecjp_pool_free(void *ptr, void *user_data)
+{
+    ecjp_pool_block_t *b = (ecjp_pool_block_t *)((char *)ptr - sizeof(ecjp_pool_header_t));
+    ecjp_pool_block_t *buddy;
+    unsigned int order = b->header.order;
+    size_t offset;
+
+    (void)user_data;
+    while (order < ecjp_pool_max_order) {
+        offset = (size_t)((char *)b - (char *)ecjp_pool_data);
+        buddy = (ecjp_pool_block_t *)((char *)ecjp_pool_data + (offset ^ ((size_t)1 << order)));
+        if (!buddy->header.is_free || buddy->header.order != order) {
+            break;
+        }
+        ecjp_pool_remove(buddy);
+        if (buddy < b) {
+            b = buddy;
+        }
+        order++;
+    }
+    ecjp_pool_push(b, order);
+}
+
+static void *ecjp_pool_realloc(void *ptr, size_t size, void *user_data)
+{
+    ecjp_pool_header_t *h = (ecjp_pool_header_t *)((char *)ptr - sizeof(ecjp_pool_header_t));
+    size_t capacity = ((size_t)1 << h->order) - sizeof(ecjp_pool_header_t);
+    void *grown;
+
+    if (size <= capacity) {
+        return ptr;
+    }
+    grown = ecjp_pool_malloc(size, user_data);
+    if (grown != NULL) {
+        memcpy(grown, ptr, capacity);
+        ecjp_pool_free(ptr, user_data);
+    }
+    return grown;
+}
+
+const ecjp_allocator_t ecjp_pool_allocator = {
+    ecjp_pool_malloc,
+    ecjp_pool_realloc,
+    ecjp_pool_free,
+    NULL
+};
+
+#ifdef ECJP_RUN_ON_PC
+/*
+ * Thread cache allocator
+ * The small blocks (ECJP_THREAD_CACHE_CLASSES sizes, from 32 bytes doubling) freed by a thread
+ * are kept in a free list of the thread, up to ECJP_THREAD_CACHE_DEPTH for each size, and they
+ * are reused by the next allocations of the same thread without calling malloc(). The larger
+ * blocks are allocated with malloc(). The cache of a thread is released when the thread exits.
+*/
+#define ECJP_THREAD_CACHE_MIN_SIZE  32
+#define ECJP_THREAD_CACHE_MAX_SIZE  ((size_t)ECJP_THREAD_CACHE_MIN_SIZE << (ECJP_THREAD_CACHE_CLASSES - 1))
+
+typedef union ecjp_cache_header {
+    size_t              size;           // usable size of the block
+    union ecjp_cache_header *next;      // next block in the cache (only in the cached blocks)
+    long double         align;
+} ecjp_cache_header_t;
+
+typedef struct ecjp_thread_cache {
+    ecjp_cache_header_t *list[ECJP_THREAD_CACHE_CLASSES];
+    int                 count[ECJP_THREAD_CACHE_CLASSES];
+    ecjp_bool_t         registered;
+} ecjp_thread_cache_t;
+
+static __thread ecjp_thread_cache_t ecjp_thread_cache;
+static pthread_key_t ecjp_thread_cache_key;
+static pthread_once_t ecjp_thread_cache_once = PTHREAD_ONCE_INIT;
+
+/*
+ * Function: ecjp_thread_cache_release()
+        This function frees the blocks in the cache of a thread, it's called when the thread exits.
+*/
+static void ecjp_thread_cache_release(void *data)
+{
+    ecjp_thread_cache_t *cache = (ecjp_thread_cache_t *)data;
+    ecjp_cache_header_t *h;
+    int c;
+
+    for (c = 0; c < ECJP_THREAD_CACHE_CLASSES; c++) {
+        while ((h = cache->list[c]) != NULL) {
+            cache->list[c] = h->next;
+            free(h);
+        }
+        cache->count[c] = 0;
+    }
+}
+
+static void ecjp_thread_cache_create_key(void)
+{
+    pthread_key_create(&ecjp_thread_cache_key, ecjp_thread_cache_release);
+}
+
+static void *ecjp_thread_cache_malloc(size_t size, void *user_data)
+{
+    ecjp_thread_cache_t *cache = &ecjp_thread_cache;
+    ecjp_cache_header_t *h;
+    size_t class_size = ECJP_THREAD_CACHE_MIN_SIZE;
+    int c = 0;
+
+    (void)user_data;
+    if (size > ECJP_THREAD_CACHE_MAX_SIZE) {
+        if (size > (size_t)-1 - sizeof(ecjp_cache_header_t)) {
+            return NULL;
+        }
+        h = (ecjp_cache_header_t *)malloc(sizeof(ecjp_cache_header_t) + size);
+        if (h == NULL) {
+            return NULL;
+        }
+        h->size = size;
+        return h + 1;
+    }
+    while (class_size < size) {
+        class_size <<= 1;
+        c++;
+    }
+    h = cache->list[c];
+    if (h != NULL) {
+        cache->list[c] = h->next;
+        cache->count[c]--;
+    } else {
+        h = (ecjp_cache_header_t *)malloc(sizeof(ecjp_cache_header_t) + class_size);
+        if (h == NULL) {
+            return NULL;
+        }
+    }
+    h->size = class_size;
+    return h + 1;
+}
+
+static void ecjp_thread_cache_free(void *ptr, void *user_data)
+{
+    ecjp_thread_cache_t *cache = &ecjp_thread_cache;
+    ecjp_cache_header_t *h = (ecjp_cache_header_t *)ptr - 1;
+    size_t class_size = ECJP_THREAD_CACHE_MIN_SIZE;
+    int c = 0;
+
+    (void)user_data;
+    if (h->size > ECJP_THREAD_CACHE_MAX_SIZE) {
+        free(h);
+        return;
+    }
+    while (class_size < h->size) {
+        class_size <<= 1;
+        c++;
+    }
+    if (cache->count[c] >= ECJP_THREAD_CACHE_DEPTH) {
+        free(h);
+        return;
+    }
+    if (!cache->registered) {
+        // the destructor of the key releases the cache when the thread exits
+        pthread_once(&ecjp_thread_cache_once, ecjp_thread_cache_create_key);
+        pthread_setspecific(ecjp_thread_cache_key, cache);
+        cache->registered = ECJP_BOOL_TRUE;
+    }
+    h->next = cache->list[c];
+    cache->list[c] = h;
+    cache->count[c]++;
+}
+
+static void *ecjp_thread_cache_realloc(void *ptr, size_t size, void *user_data)
+{
+    ecjp_cache_header_t *h = (ecjp_cache_header_t *)ptr - 1;
+    void *grown;
+
+    if (size <= h->size) {
+        return ptr;
+    }
+    if (h->size > ECJP_THREAD_CACHE_MAX_SIZE) {
+        // large block: realloc() can grow it in place
+        if (size > (size_t)-1 - sizeof(ecjp_cache_header_t)) {
+            return NULL;
+        }
+        h = (ecjp_cache_header_t *)realloc(h, sizeof(ecjp_cache_header_t) + size);
+        if (h == NULL) {
+            return NULL;
+        }
+        h->size = size;
+        return h + 1;
+    }
+    grown = ecjp_thread_cache_malloc(size, user_data);
+    if (grown != NULL) {
+        memcpy(grown, ptr, h->size);
+        ecjp_thread_cache_free(ptr, user_data);
+    }
+    return grown;
+}
+
+const ecjp_allocator_t ecjp_thread_cache_allocator = {
+    ecjp_thread_cache_malloc,
+    ecjp_thread_cache_realloc,
+    ecjp_thread_cache_free,
+    NULL
+};
+#endif // ECJP_RUN_ON_PC
+
+/*
+ * Number decoding
+ * A number is checked and decoded in the same walk over its characters: the first
+ * ECJP_NUMBER_MAX_MANTISSA_DIGITS significant digits are accumulated in a 64-bit mantissa
+ * and the position of the decimal point and the exponent give the power of 10 of its last
+ * digit. An integer that fits 64 bits is returned as it is; the double nearest to the number
+ * is computed with the fast path of Clinger (exact when the mantissa and the power of 10 are
+ * both exact doubles), then with the algorithm of Eisel-Lemire, and for the rare cases left
+ * with a slow path on the decimal digits. The conversion doesn't depend on the locale.
+*/
+#define ECJP_NUMBER_MAX_MANTISSA_DIGITS 19          // 10^19 - 1 fits 64 bits
+#define ECJP_NUMBER_MAX_EXPONENT        100000      // larger exponents don't change the result
+#define ECJP_DOUBLE_MANTISSA_BITS       52
+#define ECJP_DOUBLE_EXPONENT_BIAS       1023
+#define ECJP_DOUBLE_INFINITE_POWER      0x7FF
+
+#if !defined(ECJP_RUN_ON_MCU)
+#define ECJP_HAVE_EISEL_LEMIRE          1
+#endif
+
+// mantissa and power of 10 of a number, filled by ecjp_scan_number()
+typedef struct ecjp_number_parts {
+    uint64_t            mantissa;       // first significant digits
+    int                 exponent;       // power of 10 of the last digit in mantissa
+    int                 start;          // position of the first character
+    int                 end;            // position of the first character after the number
+    ecjp_bool_t         negative;
+    ecjp_bool_t         integer;        // no fraction and no exponent
+    ecjp_bool_t         truncated;      // digits not in mantissa
+} ecjp_number_parts_t;
+
+// decimal digits of a number for the slow path, with the position of the decimal point
+typedef struct ecjp_decimal {
+    unsigned char       digit[ECJP_NUMBER_MAX_DIGITS];
+    int                 num_digits;
+    int                 decimal_point;
+    ecjp_bool_t         truncated;      // non-zero digits after digit[]
+} ecjp_decimal_t;
+
+// powers of 10 that are exact doubles
+static const double ecjp_exact_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/*
+ * Function: ecjp_scan_number()
+        This function checks a number: optional minus sign, integer part without leading zeros,
+        optional fraction and optional exponent. The same walk decodes the mantissa and the
+        power of 10 of the number.
+        Parameters:
+        - input: The input string.
+        - len: The length of the input string.
+        - pos: Pointer to the position of the first character of the number; on return, the position
+          of the first character after the number, or of the wrong character if the number is not valid.
+        - parts: Pointer to the structure to store the mantissa and the power of 10, NULL if they
+          are not needed.
+        Returns:
+        - ECJP_BOOL_TRUE if the number is valid.
+        - ECJP_BOOL_FALSE otherwise.
+*/
+static ecjp_bool_t ecjp_scan_number(const char *input, int len, int *pos, ecjp_number_parts_t *parts)
+{
+    int i = *pos;
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    int exp_value = 0;
+    ecjp_bool_t negative = ECJP_BOOL_FALSE;
+    ecjp_bool_t exp_negative = ECJP_BOOL_FALSE;
+    ecjp_bool_t truncated = ECJP_BOOL_FALSE;
+    ecjp_bool_t integer = ECJP_BOOL_TRUE;
+
+    if (input[i] == '-') {
+        negative = ECJP_BOOL_TRUE;
+        i++;
+    }
+    if ((i >= len) || (input[i] < '0') || (input[i] > '9')) {
+        *pos = i;
+        return ECJP_BOOL_FALSE;
+    }
+    if (input[i] == '0') {
+        i++;
+    } else {
+        while ((i < len) && (input[i] >= '0') && (input[i] <= '9')) {
+            if (digits < ECJP_NUMBER_MAX_MANTISSA_DIGITS) {
+                mantissa = mantissa * 10 + (uint64_t)(input[i] - '0');
+                digits++;
+            } else {
+                // the digit is dropped, its position is kept
+                truncated = ECJP_BOOL_TRUE;
+                exponent++;
+            }
+            i++;
+        }
+    }
+    if ((i < len) && (input[i] == '.')) {
+        integer = ECJP_BOOL_FALSE;
+        i++;
+        if ((i >= len) || (input[i] < '0') || (input[i] > '9')) {
+            *pos = i;
+            return ECJP_BOOL_FALSE;
+        }
+        while ((i < len) && (input[i] >= '0') && (input[i] <= '9')) {
+            if (digits < ECJP_NUMBER_MAX_MANTISSA_DIGITS) {
+                // the leading zeros of a fraction are not significant
+                if ((digits > 0) || (input[i] != '0')) {
+                    mantissa = mantissa * 10 + (uint64_t)(input[i] - '0');
+                    digits++;
+                }
+                exponent--;
+            } else {
+                truncated = ECJP_BOOL_TRUE;
+            }
+            i++;
+        }
+    }
+    if ((i < len) && ((input[i] == 'e') || (input[i] == 'E'))) {
+        integer = ECJP_BOOL_FALSE;
+        i++;
+        if ((i < len) && ((input[i] == '+') || (input[i] == '-'))) {
+            exp_negative = (input[i] == '-') ? ECJP_BOOL_TRUE : ECJP_BOOL_FALSE;
+            i++;
+        }
+        if ((i >= len) || (input[i] < '0') || (input[i] > '9')) {
+            *pos = i;
+            return ECJP_BOOL_FALSE;
+        }
+        while ((i < len) && (input[i] >= '0') && (input[i] <= '9')) {
+            if (exp_value < ECJP_NUMBER_MAX_EXPONENT) {
+                exp_value = exp_value * 10 + (input[i] - '0');
+            }
+            i++;
+        }
+    }
+    if (parts != NULL) {
+        parts->mantissa = mantissa;
+        parts->exponent = exp_negative ? (exponent - exp_value) : (exponent + exp_value);
+        parts->start = *pos;
+        parts->end = i;
+        parts->negative = negative;
+        parts->integer = integer;
+        parts->truncated = truncated;
+    }
+    *pos = i;
+    return ECJP_BOOL_TRUE;
+}
+
+/*
+ * Function: ecjp_make_double()
+        This function builds a double from its sign, biased exponent and mantissa without the implicit bit.
+*/
+static inline double ecjp_make_double(ecjp_bool_t negative, int power2, uint64_t mantissa)
+{
+    uint64_t bits;
+    double d;
+
+    bits = mantissa | ((uint64_t)power2 << ECJP_DOUBLE_MANTISSA_BITS);
+    if (negative) {
+        bits |= (uint64_t)1 << 63;
+    }
+    memcpy(&d, &bits, sizeof(double));
+    return d;
+}
+
+/*
+ * Function: ecjp_decimal_trim()
+        This function removes the trailing zeros of a decimal.
+*/
+static void ecjp_decimal_trim(ecjp_decimal_t *d)
+{
+    while ((d->num_digits > 0) && (d->digit[d->num_digits - 1] == 0)) {
+        d->num_digits--;
+    }
+    if (d->num_digits == 0) {
+        d->decimal_point = 0;
+    }
+}
+
+/*
+ * Function: ecjp_decimal_shift_right()
+        This function divides a decimal by 2^shift (shift <= 60).
+*/
+static void ecjp_decimal_shift_right(ecjp_decimal_t *d, unsigned int shift)
+{
+    uint64_t n = 0;
+    uint64_t mask = ((uint64_t)1 << shift) - 1;
+    int r = 0;
+    int w = 0;
+
+    // read the digits needed by the first output digit
+    while ((n >> shift) == 0) {
+        if (r >= d->num_digits) {
+            if (n == 0) {
+                d->num_digits = 0;
+                d->decimal_point = 0;
+                return;
+            }
+            while ((n >> shift) == 0) {
+                n *= 10;
+                r++;
+            }
+            break;
+        }
+        n = n * 10 + d->digit[r];
+        r++;
+    }
+    d->decimal_point -= r - 1;
+    // read a digit, write a digit
+    for (; r < d->num_digits; r++) {
+        d->digit[w++] = (unsigned char)(n >> shift);
+        n = (n & mask) * 10 + d->digit[r];
+    }
+    // write the digits left in n
+    while (n > 0) {
+        if (w < ECJP_NUMBER_MAX_DIGITS) {
+            d->digit[w++] = (unsigned char)(n >> shift);
+        } else if ((n >> shift) > 0) {
+            d->truncated = ECJP_BOOL_TRUE;
+        }
+        n = (n & mask) * 10;
+    }
+    d->num_digits = w;
+    ecjp_decimal_trim(d);
+}
+
+/*
+ * Function: ecjp_decimal_shift_left()
+        This function multiplies a decimal by 2^shift (shift <= 60).
+*/
+static void ecjp_decimal_shift_left(ecjp_decimal_t *d, unsigned int shift)
+{
+    uint64_t n = 0;
+    uint64_t quo;
+    int added = 0;
+    int r, w;
+
+    // the number of new digits is the number of digits of the last carry
+    for (r = d->num_digits - 1; r >= 0; r--) {
+        n = (n + ((uint64_t)d->digit[r] << shift)) / 10;
+    }
+    for (; n > 0; n /= 10) {
+        added++;
+    }
+    w = d->num_digits + added;
+    for (r = d->num_digits - 1; r >= 0; r--) {
+        n += (uint64_t)d->digit[r] << shift;
+        quo = n / 10;
+        w--;
+        if (w < ECJP_NUMBER_MAX_DIGITS) {
+            d->digit[w] = (unsigned char)(n - 10 * quo);
+        } else if (n - 10 * quo != 0) {
+            d->truncated = ECJP_BOOL_TRUE;
+        }
+        n = quo;
+    }
+    while (n > 0) {
+        quo = n / 10;
+        w--;
+        if (w < ECJP_NUMBER_MAX_DIGITS) {
+            d->digit[w] = (unsigned char)(n - 10 * quo);
+        } else if (n - 10 * quo != 0) {
+            d->truncated = ECJP_BOOL_TRUE;
+        }
+        n = quo;
+    }
+    d->num_digits += added;
+    if (d->num_digits > ECJP_NUMBER_MAX_DIGITS) {
+        d->num_digits = ECJP_NUMBER_MAX_DIGITS;
+    }
+    d->decimal_point += added;
+    ecjp_decimal_trim(d);
+}
+
+/*
+ * Function: ecjp_decimal_shift()
+        This function multiplies (shift > 0) or divides (shift < 0) a decimal by 2^|shift|.
+*/
+static void ecjp_decimal_shift(ecjp_decimal_t *d, int shift)
+{
+    if (d->num_digits == 0) {
+        return;
+    }
+    for (; shift > 60; shift -= 60) {
+        ecjp_decimal_shift_left(d, 60);
+    }
+    for (; shift < -60; shift += 60) {
+        ecjp_decimal_shift_right(d, 60);
+    }
+    if (shift > 0) {
+        ecjp_decimal_shift_left(d, (unsigned int)shift);
+    } else if (shift < 0) {
+        ecjp_decimal_shift_right(d, (unsigned int)-shift);
+    }
+}
+
+/*
+ * Function: ecjp_decimal_rounded_integer()
+        This function returns the integer part of a decimal, rounded to the nearest (ties to even).
+*/
+static uint64_t ecjp_decimal_rounded_integer(const ecjp_decimal_t *d)
+{
+    uint64_t n = 0;
+    ecjp_bool_t round_up;
+    int i;
+
+    if (d->decimal_point > 20) {
+        return UINT64_MAX;
+    }
+    for (i = 0; (i < d->decimal_point) && (i < d->num_digits); i++) {
+        n = n * 10 + d->digit[i];
+    }
+    for (; i < d->decimal_point; i++) {
+        n *= 10;
+    }
+    round_up = ECJP_BOOL_FALSE;
+    if ((d->decimal_point >= 0) && (d->decimal_point < d->num_digits)) {
+        if ((d->digit[d->decimal_point] == 5) && (d->decimal_point + 1 == d->num_digits)) {
+            // exactly halfway, unless digits were dropped
+            round_up = (d->truncated || ((d->decimal_point > 0) && (d->digit[d->decimal_point - 1] % 2 == 1))) ? ECJP_BOOL_TRUE : ECJP_BOOL_FALSE;
+        } else {
+            round_up = (d->digit[d->decimal_point] >= 5) ? ECJP_BOOL_TRUE : ECJP_BOOL_FALSE;
+        }
+    }
+    return round_up ? (n + 1) : n;
+}
+
+/*
+ * Function: ecjp_decimal_to_double()
+        This function computes the double nearest to the digits of a number, scaling them by powers
+        of 2 until the 53 bits of the mantissa are the integer part. It's the slow path of the conversion.
+        Parameters:
+        - input: The input string.
+        - parts: Pointer to the parts of the number found by ecjp_scan_number().
+        Returns:
+        - The double nearest to the number (infinity if it's too large).
+*/
+static double ecjp_decimal_to_double(const char *input, const ecjp_number_parts_t *parts)
+{
+    // number of bits to shift to move the decimal point by 1 to 8 digits
+    static const int power2_of_digits[] = { 1, 3, 6, 9, 13, 16, 19, 23, 26 };
+    ecjp_decimal_t d;
+    uint64_t mantissa;
+    int power2, shift, exp_value, significant, i;
+    ecjp_bool_t exp_negative;
+    ecjp_bool_t seen_point = ECJP_BOOL_FALSE;
+
+    // load the digits again, without the leading zeros
+    d.num_digits = 0;
+    d.decimal_point = 0;
+    d.truncated = ECJP_BOOL_FALSE;
+    significant = 0;
+    i = parts->negative ? (parts->start + 1) : parts->start;
+    for (; i < parts->end; i++) {
+        if (input[i] == '.') {
+            d.decimal_point = significant;
+            seen_point = ECJP_BOOL_TRUE;
+        } else if ((input[i] == 'e') || (input[i] == 'E')) {
+            break;
+        } else if ((input[i] == '0') && (significant == 0)) {
+            d.decimal_point--;
+        } else {
+            // the digits that don't fit are counted for the position of the decimal point
+            if (d.num_digits < ECJP_NUMBER_MAX_DIGITS) {
+                d.digit[d.num_digits++] = (unsigned char)(input[i] - '0');
+            } else if (input[i] != '0') {
+                d.truncated = ECJP_BOOL_TRUE;
+            }
+            significant++;
+        }
+    }
+    if (!seen_point) {
+        d.decimal_point = significant;
+    }
+    if (i < parts->end) {
+        i++;
+        exp_negative = (input[i] == '-') ? ECJP_BOOL_TRUE : ECJP_BOOL_FALSE;
+        if ((input[i] == '+') || (input[i] == '-')) {
+            i++;
+        }
+        for (exp_value = 0; i < parts->end; i++) {
+            if (exp_value < ECJP_NUMBER_MAX_EXPONENT) {
+                exp_value = exp_value * 10 + (input[i] - '0');
+            }
+        }
+        d.decimal_point += exp_negative ? -exp_value : exp_value;
+    }
+
+    if (d.num_digits == 0) {
+        return ecjp_make_double(parts->negative, 0, 0);
+    }
+    if (d.decimal_point > 310) {
+        return ecjp_make_double(parts->negative, ECJP_DOUBLE_INFINITE_POWER, 0);
+    }
+    if (d.decimal_point < -330) {
+        return ecjp_make_double(parts->negative, 0, 0);
+    }
+    // scale to [0.5, 1)
+    power2 = 0;
+    while (d.decimal_point > 0) {
+        shift = (d.decimal_point >= 9) ? 27 : power2_of_digits[d.decimal_point];
+        ecjp_decimal_shift(&d, -shift);
+        power2 += shift;
+    }
+    while ((d.decimal_point < 0) || ((d.decimal_point == 0) && (d.digit[0] < 5))) {
+        shift = (-d.decimal_point >= 9) ? 27 : power2_of_digits[-d.decimal_point];
+        ecjp_decimal_shift(&d, shift);
+        power2 -= shift;
+    }
+    power2--;
+    // a denormal has the minimum exponent and less bits
+    if (power2 < 1 - ECJP_DOUBLE_EXPONENT_BIAS) {
+        shift = 1 - ECJP_DOUBLE_EXPONENT_BIAS - power2;
+        ecjp_decimal_shift(&d, -shift);
+        power2 += shift;
+    }
+    if (power2 + ECJP_DOUBLE_EXPONENT_BIAS >= ECJP_DOUBLE_INFINITE_POWER) {
+        return ecjp_make_double(parts->negative, ECJP_DOUBLE_INFINITE_POWER, 0);
+    }
+    ecjp_decimal_shift(&d, 1 + ECJP_DOUBLE_MANTISSA_BITS);
+    mantissa = ecjp_decimal_rounded_integer(&d);
+    // the rounding can add a bit
+    if (mantissa == ((uint64_t)2 << ECJP_DOUBLE_MANTISSA_BITS)) {
+        mantissa >>= 1;
+        power2++;
+        if (power2 + ECJP_DOUBLE_EXPONENT_BIAS >= ECJP_DOUBLE_INFINITE_POWER) {
+            return ecjp_make_double(parts->negative, ECJP_DOUBLE_INFINITE_POWER, 0);
+        }
+    }
+    if ((mantissa & ((uint64_t)1 << ECJP_DOUBLE_MANTISSA_BITS)) == 0) {
+        return ecjp_make_double(parts->negative, 0, mantissa);
+    }
+    return ecjp_make_double(parts->negative, power2 + ECJP_DOUBLE_EXPONENT_BIAS,
+                            mantissa & (((uint64_t)1 << ECJP_DOUBLE_MANTISSA_BITS) - 1));
+}
+
+#ifdef ECJP_HAVE_EISEL_LEMIRE
+#define ECJP_POW5_MIN_EXPONENT          -342
+#define ECJP_POW5_MAX_EXPONENT          308
+
+// 128 bits of 5^q, normalized with the most significant bit set, for q in [-342, 308]
+static const uint64_t ecjp_pow5_128[2 * (ECJP_POW5_MAX_EXPONENT - ECJP_POW5_MIN_EXPONENT + 1)] = {
+    0xeef453d6923bd65aULL, 0x113faa2906a13b3fULL, // 5^-342
+    0x9558b4661b6565f8ULL, 0x4ac7ca59a424c507ULL, // 5^-341
+    0xbaaee17fa23ebf76ULL, 0x5d79bcf00d2df649ULL, // 5^-340
+    0xe95a99df8ace6f53ULL, 0xf4d82c2c107973dcULL, // 5^-339
+    0x91d8a02bb6c10594ULL, 0x79071b9b8a4be869ULL, // 5^-338
+    0xb64ec836a47146f9ULL, 0x9748e2826cdee284ULL, // 5^-337
+    0xe3e27a444d8d98b7ULL, 0xfd1b1b2308169b25ULL, // 5^-336
+    0x8e6d8c6ab0787f72ULL, 0xfe30f0f5e50e20f7ULL, // 5^-335
+    0xb208ef855c969f4fULL, 0xbdbd2d335e51a935ULL, // 5^-334
+    0xde8b2b66b3bc4723ULL, 0xad2c788035e61382ULL, // 5^-333
+    0x8b16fb203055ac76ULL, 0x4c3bcb5021afcc31ULL, // 5^-332
+    0xaddcb9e83c6b1793ULL, 0xdf4abe242a1bbf3dULL, // 5^-331
+    0xd953e8624b85dd78ULL, 0xd71d6dad34a2af0dULL, // 5^-330
+    0x87d4713d6f33aa6bULL, 0x8672648c40e5ad68ULL, // 5^-329
+    0xa9c98d8ccb009506ULL, 0x680efdaf511f18c2ULL, // 5^-328
+    0xd43bf0effdc0ba48ULL, 0x0212bd1b2566def2ULL, // 5^-327
+    0x84a57695fe98746dULL, 0x014bb630f7604b57ULL, // 5^-326
+    0xa5ced43b7e3e9188ULL, 0x419ea3bd35385e2dULL, // 5^-325
+    0xcf42894a5dce35eaULL, 0x52064cac828675b9ULL, // 5^-324
+    0x818995ce7aa0e1b2ULL, 0x7343efebd1940993ULL, // 5^-323
+    0xa1ebfb4219491a1fULL, 0x1014ebe6c5f90bf8ULL, // 5^-322
+    0xca66fa129f9b60a6ULL, 0xd41a26e077774ef6ULL, // 5^-321
+    0xfd00b897478238d0ULL, 0x8920b098955522b4ULL, // 5^-320
+    0x9e20735e8cb16382ULL, 0x55b46e5f5d5535b0ULL, // 5^-319
+    0xc5a890362fddbc62ULL, 0xeb2189f734aa831dULL, // 5^-318
+    0xf712b443bbd52b7bULL, 0xa5e9ec7501d523e4ULL, // 5^-317
+    0x9a6bb0aa55653b2dULL, 0x47b233c92125366eULL, // 5^-316
+    0xc1069cd4eabe89f8ULL, 0x999ec0bb696e840aULL, // 5^-315
+    0xf148440a256e2c76ULL, 0xc00670ea43ca250dULL, // 5^-314
+    0x96cd2a865764dbcaULL, 0x380406926a5e5728ULL, // 5^-313
+    0xbc807527ed3e12bcULL, 0xc605083704f5ecf2ULL, // 5^-312
+    0xeba09271e88d976bULL, 0xf7864a44c633682eULL, // 5^-311
+    0x93445b8731587ea3ULL, 0x7ab3ee6afbe0211dULL, // 5^-310
+    0xb8157268fdae9e4cULL, 0x5960ea05bad82964ULL, // 5^-309
+    0xe61acf033d1a45dfULL, 0x6fb92487298e33bdULL, // 5^-308
+    0x8fd0c16206306babULL, 0xa5d3b6d479f8e056ULL, // 5^-307
+    0xb3c4f1ba87bc8696ULL, 0x8f48a4899877186cULL, // 5^-306
+    0xe0b62e2929aba83cULL, 0x331acdabfe94de87ULL, // 5^-305
+    0x8c71dcd9ba0b4925ULL, 0x9ff0c08b7f1d0b14ULL, // 5^-304
+    0xaf8e5410288e1b6fULL, 0x07ecf0ae5ee44dd9ULL, // 5^-303
+    0xdb71e91432b1a24aULL, 0xc9e82cd9f69d6150ULL, // 5^-302
+    0x892731ac9faf056eULL, 0xbe311c083a225cd2ULL, // 5^-301
+    0xab70fe17c79ac6caULL, 0x6dbd630a48aaf406ULL, // 5^-300
+    0xd64d3d9db981787dULL, 0x092cbbccdad5b108ULL, // 5^-299
+    0x85f0468293f0eb4eULL, 0x25bbf56008c58ea5ULL, // 5^-298
+    0xa76c582338ed2621ULL, 0xaf2af2b80af6f24eULL, // 5^-297
+    0xd1476e2c07286faaULL, 0x1af5af660db4aee1ULL, // 5^-296
+    0x82cca4db847945caULL, 0x50d98d9fc890ed4dULL, // 5^-295
+    0xa37fce126597973cULL, 0xe50ff107bab528a0ULL, // 5^-294
+    0xcc5fc196fefd7d0cULL, 0x1e53ed49a96272c8ULL, // 5^-293
+    0xff77b1fcbebcdc4fULL, 0x25e8e89c13bb0f7aULL, // 5^-292
+    0x9faacf3df73609b1ULL, 0x77b191618c54e9acULL, // 5^-291
+    0xc795830d75038c1dULL, 0xd59df5b9ef6a2417ULL, // 5^-290
+    0xf97ae3d0d2446f25ULL, 0x4b0573286b44ad1dULL, // 5^-289
+    0x9becce62836ac577ULL, 0x4ee367f9430aec32ULL, // 5^-288
+    0xc2e801fb244576d5ULL, 0x229c41f793cda73fULL, // 5^-287
+    0xf3a20279ed56d48aULL, 0x6b43527578c1110fULL, // 5^-286
+    0x9845418c345644d6ULL, 0x830a13896b78aaa9ULL, // 5^-285
+    0xbe5691ef416bd60cULL, 0x23cc986bc656d553ULL, // 5^-284
+    0xedec366b11c6cb8fULL, 0x2cbfbe86b7ec8aa8ULL, // 5^-283
+    0x94b3a202eb1c3f39ULL, 0x7bf7d71432f3d6a9ULL, // 5^-282
+    0xb9e08a83a5e34f07ULL, 0xdaf5ccd93fb0cc53ULL, // 5^-281
+    0xe858ad248f5c22c9ULL, 0xd1b3400f8f9cff68ULL, // 5^-280
+    0x91376c36d99995beULL, 0x23100809b9c21fa1ULL, // 5^-279
+    0xb58547448ffffb2dULL, 0xabd40a0c2832a78aULL, // 5^-278
+    0xe2e69915b3fff9f9ULL, 0x16c90c8f323f516cULL, // 5^-277
+    0x8dd01fad907ffc3bULL, 0xae3da7d97f6792e3ULL, // 5^-276
+    0xb1442798f49ffb4aULL, 0x99cd11cfdf41779cULL, // 5^-275
+    0xdd95317f31c7fa1dULL, 0x40405643d711d583ULL, // 5^-274
+    0x8a7d3eef7f1cfc52ULL, 0x482835ea666b2572ULL, // 5^-273
+    0xad1c8eab5ee43b66ULL, 0xda3243650005eecfULL, // 5^-272
+    0xd863b256369d4a40ULL, 0x90bed43e40076a82ULL, // 5^-271
+    0x873e4f75e2224e68ULL, 0x5a7744a6e804a291ULL, // 5^-270
+    0xa90de3535aaae202ULL, 0x711515d0a205cb36ULL, // 5^-269
+    0xd3515c2831559a83ULL, 0x0d5a5b44ca873e03ULL, // 5^-268
+    0x8412d9991ed58091ULL, 0xe858790afe9486c2ULL, // 5^-267
+    0xa5178fff668ae0b6ULL, 0x626e974dbe39a872ULL, // 5^-266
+    0xce5d73ff402d98e3ULL, 0xfb0a3d212dc8128fULL, // 5^-265
+    0x80fa687f881c7f8eULL, 0x7ce66634bc9d0b99ULL, // 5^-264
+    0xa139029f6a239f72ULL, 0x1c1fffc1ebc44e80ULL, // 5^-263
+    0xc987434744ac874eULL, 0xa327ffb266b56220ULL, // 5^-262
+    0xfbe9141915d7a922ULL, 0x4bf1ff9f0062baa8ULL, // 5^-261
+    0x9d71ac8fada6c9b5ULL, 0x6f773fc3603db4a9ULL, // 5^-260
+    0xc4ce17b399107c22ULL, 0xcb550fb4384d21d3ULL, // 5^-259
+    0xf6019da07f549b2bULL, 0x7e2a53a146606a48ULL, // 5^-258
+    0x99c102844f94e0fbULL, 0x2eda7444cbfc426dULL, // 5^-257
+    0xc0314325637a1939ULL, 0xfa911155fefb5308ULL, // 5^-256
+    0xf03d93eebc589f88ULL, 0x793555ab7eba27caULL, // 5^-255
+    0x96267c7535b763b5ULL, 0x4bc1558b2f3458deULL, // 5^-254
+    0xbbb01b9283253ca2ULL, 0x9eb1aaedfb016f16ULL, // 5^-253
+    0xea9c227723ee8bcbULL, 0x465e15a979c1cadcULL, // 5^-252
+    0x92a1958a7675175fULL, 0x0bfacd89ec191ec9ULL, // 5^-251
+    0xb749faed14125d36ULL, 0xcef980ec671f667bULL, // 5^-250
+    0xe51c79a85916f484ULL, 0x82b7e12780e7401aULL, // 5^-249
+    0x8f31cc0937ae58d2ULL, 0xd1b2ecb8b0908810ULL, // 5^-248
+    0xb2fe3f0b8599ef07ULL, 0x861fa7e6dcb4aa15ULL, // 5^-247
+    0xdfbdcece67006ac9ULL, 0x67a791e093e1d49aULL, // 5^-246
+    0x8bd6a141006042bdULL, 0xe0c8bb2c5c6d24e0ULL, // 5^-245
+    0xaecc49914078536dULL, 0x58fae9f773886e18ULL, // 5^-244
+    0xda7f5bf590966848ULL, 0xaf39a475506a899eULL, // 5^-243
+    0x888f99797a5e012dULL, 0x6d8406c952429603ULL, // 5^-242
+    0xaab37fd7d8f58178ULL, 0xc8e5087ba6d33b83ULL, // 5^-241
+    0xd5605fcdcf32e1d6ULL, 0xfb1e4a9a90880a64ULL, // 5^-240
+    0x855c3be0a17fcd26ULL, 0x5cf2eea09a55067fULL, // 5^-239
+    0xa6b34ad8c9dfc06fULL, 0xf42faa48c0ea481eULL, // 5^-238
+    0xd0601d8efc57b08bULL, 0xf13b94daf124da26ULL, // 5^-237
+    0x823c12795db6ce57ULL, 0x76c53d08d6b70858ULL, // 5^-236
+    0xa2cb1717b52481edULL, 0x54768c4b0c64ca6eULL, // 5^-235
+    0xcb7ddcdda26da268ULL, 0xa9942f5dcf7dfd09ULL, // 5^-234
+    0xfe5d54150b090b02ULL, 0xd3f93b35435d7c4cULL, // 5^-233
+    0x9efa548d26e5a6e1ULL, 0xc47bc5014a1a6dafULL, // 5^-232
+    0xc6b8e9b0709f109aULL, 0x359ab6419ca1091bULL, // 5^-231
+    0xf867241c8cc6d4c0ULL, 0xc30163d203c94b62ULL, // 5^-230
+    0x9b407691d7fc44f8ULL, 0x79e0de63425dcf1dULL, // 5^-229
+    0xc21094364dfb5636ULL, 0x985915fc12f542e4ULL, // 5^-228
+    0xf294b943e17a2bc4ULL, 0x3e6f5b7b17b2939dULL, // 5^-227
+    0x979cf3ca6cec5b5aULL, 0xa705992ceecf9c42ULL, // 5^-226
+    0xbd8430bd08277231ULL, 0x50c6ff782a838353ULL, // 5^-225
+    0xece53cec4a314ebdULL, 0xa4f8bf5635246428ULL, // 5^-224
+    0x940f4613ae5ed136ULL, 0x871b7795e136be99ULL, // 5^-223
+    0xb913179899f68584ULL, 0x28e2557b59846e3fULL, // 5^-222
+    0xe757dd7ec07426e5ULL, 0x331aeada2fe589cfULL, // 5^-221
+    0x9096ea6f3848984fULL, 0x3ff0d2c85def7621ULL, // 5^-220
+    0xb4bca50b065abe63ULL, 0x0fed077a756b53a9ULL, // 5^-219
+    0xe1ebce4dc7f16dfbULL, 0xd3e8495912c62894ULL, // 5^-218
+    0x8d3360f09cf6e4bdULL, 0x64712dd7abbbd95cULL, // 5^-217
+    0xb080392cc4349decULL, 0xbd8d794d96aacfb3ULL, // 5^-216
+    0xdca04777f541c567ULL, 0xecf0d7a0fc5583a0ULL, // 5^-215
+    0x89e42caaf9491b60ULL, 0xf41686c49db57244ULL, // 5^-214
+    0xac5d37d5b79b6239ULL, 0x311c2875c522ced5ULL, // 5^-213
+    0xd77485cb25823ac7ULL, 0x7d633293366b828bULL, // 5^-212
+    0x86a8d39ef77164bcULL, 0xae5dff9c02033197ULL, // 5^-211
+    0xa8530886b54dbdebULL, 0xd9f57f830283fdfcULL, // 5^-210
+    0xd267caa862a12d66ULL, 0xd072df63c324fd7bULL, // 5^-209
+    0x8380dea93da4bc60ULL, 0x4247cb9e59f71e6dULL, // 5^-208
+    0xa46116538d0deb78ULL, 0x52d9be85f074e608ULL, // 5^-207
+    0xcd795be870516656ULL, 0x67902e276c921f8bULL, // 5^-206
+    0x806bd9714632dff6ULL, 0x00ba1cd8a3db53b6ULL, // 5^-205
+    0xa086cfcd97bf97f3ULL, 0x80e8a40eccd228a4ULL, // 5^-204
+    0xc8a883c0fdaf7df0ULL, 0x6122cd128006b2cdULL, // 5^-203
+    0xfad2a4b13d1b5d6cULL, 0x796b805720085f81ULL, // 5^-202
+    0x9cc3a6eec6311a63ULL, 0xcbe3303674053bb0ULL, // 5^-201
+    0xc3f490aa77bd60fcULL, 0xbedbfc4411068a9cULL, // 5^-200
+    0xf4f1b4d515acb93bULL, 0xee92fb5515482d44ULL, // 5^-199
+    0x991711052d8bf3c5ULL, 0x751bdd152d4d1c4aULL, // 5^-198
+    0xbf5cd54678eef0b6ULL, 0xd262d45a78a0635dULL, // 5^-197
+    0xef340a98172aace4ULL, 0x86fb897116c87c34ULL, // 5^-196
+    0x9580869f0e7aac0eULL, 0xd45d35e6ae3d4da0ULL, // 5^-195
+    0xbae0a846d2195712ULL, 0x8974836059cca109ULL, // 5^-194
+    0xe998d258869facd7ULL, 0x2bd1a438703fc94bULL, // 5^-193
+    0x91ff83775423cc06ULL, 0x7b6306a34627ddcfULL, // 5^-192
+    0xb67f6455292cbf08ULL, 0x1a3bc84c17b1d542ULL, // 5^-191
+    0xe41f3d6a7377eecaULL, 0x20caba5f1d9e4a93ULL, // 5^-190
+    0x8e938662882af53eULL, 0x547eb47b7282ee9cULL, // 5^-189
+    0xb23867fb2a35b28dULL, 0xe99e619a4f23aa43ULL, // 5^-188
+    0xdec681f9f4c31f31ULL, 0x6405fa00e2ec94d4ULL, // 5^-187
+    0x8b3c113c38f9f37eULL, 0xde83bc408dd3dd04ULL, // 5^-186
+    0xae0b158b4738705eULL, 0x9624ab50b148d445ULL, // 5^-185
+    0xd98ddaee19068c76ULL, 0x3badd624dd9b0957ULL, // 5^-184
+    0x87f8a8d4cfa417c9ULL, 0xe54ca5d70a80e5d6ULL, // 5^-183
+    0xa9f6d30a038d1dbcULL, 0x5e9fcf4ccd211f4cULL, // 5^-182
+    0xd47487cc8470652bULL, 0x7647c3200069671fULL, // 5^-181
+    0x84c8d4dfd2c63f3bULL, 0x29ecd9f40041e073ULL, // 5^-180
+    0xa5fb0a17c777cf09ULL, 0xf468107100525890ULL, // 5^-179
+    0xcf79cc9db955c2ccULL, 0x7182148d4066eeb4ULL, // 5^-178
+    0x81ac1fe293d599bfULL, 0xc6f14cd848405530ULL, // 5^-177
+    0xa21727db38cb002fULL, 0xb8ada00e5a506a7cULL, // 5^-176
+    0xca9cf1d206fdc03bULL, 0xa6d90811f0e4851cULL, // 5^-175
+    0xfd442e4688bd304aULL, 0x908f4a166d1da663ULL, // 5^-174
+    0x9e4a9cec15763e2eULL, 0x9a598e4e043287feULL, // 5^-173
+    0xc5dd44271ad3cdbaULL, 0x40eff1e1853f29fdULL, // 5^-172
+    0xf7549530e188c128ULL, 0xd12bee59e68ef47cULL, // 5^-171
+    0x9a94dd3e8cf578b9ULL, 0x82bb74f8301958ceULL, // 5^-170
+    0xc13a148e3032d6e7ULL, 0xe36a52363c1faf01ULL, // 5^-169
+    0xf18899b1bc3f8ca1ULL, 0xdc44e6c3cb279ac1ULL, // 5^-168
+    0x96f5600f15a7b7e5ULL, 0x29ab103a5ef8c0b9ULL, // 5^-167
+    0xbcb2b812db11a5deULL, 0x7415d448f6b6f0e7ULL, // 5^-166
+    0xebdf661791d60f56ULL, 0x111b495b3464ad21ULL, // 5^-165
+    0x936b9fcebb25c995ULL, 0xcab10dd900beec34ULL, // 5^-164
+    0xb84687c269ef3bfbULL, 0x3d5d514f40eea742ULL, // 5^-163
+    0xe65829b3046b0afaULL, 0x0cb4a5a3112a5112ULL, // 5^-162
+    0x8ff71a0fe2c2e6dcULL, 0x47f0e785eaba72abULL, // 5^-161
+    0xb3f4e093db73a093ULL, 0x59ed216765690f56ULL, // 5^-160
+    0xe0f218b8d25088b8ULL, 0x306869c13ec3532cULL, // 5^-159
+    0x8c974f7383725573ULL, 0x1e414218c73a13fbULL, // 5^-158
+    0xafbd2350644eeacfULL, 0xe5d1929ef90898faULL, // 5^-157
+    0xdbac6c247d62a583ULL, 0xdf45f746b74abf39ULL, // 5^-156
+    0x894bc396ce5da772ULL, 0x6b8bba8c328eb783ULL, // 5^-155
+    0xab9eb47c81f5114fULL, 0x066ea92f3f326564ULL, // 5^-154
+    0xd686619ba27255a2ULL, 0xc80a537b0efefebdULL, // 5^-153
+    0x8613fd0145877585ULL, 0xbd06742ce95f5f36ULL, // 5^-152
+    0xa798fc4196e952e7ULL, 0x2c48113823b73704ULL, // 5^-151
+    0xd17f3b51fca3a7a0ULL, 0xf75a15862ca504c5ULL, // 5^-150
+    0x82ef85133de648c4ULL, 0x9a984d73dbe722fbULL, // 5^-149
+    0xa3ab66580d5fdaf5ULL, 0xc13e60d0d2e0ebbaULL, // 5^-148
+    0xcc963fee10b7d1b3ULL, 0x318df905079926a8ULL, // 5^-147
+    0xffbbcfe994e5c61fULL, 0xfdf17746497f7052ULL, // 5^-146
+    0x9fd561f1fd0f9bd3ULL, 0xfeb6ea8bedefa633ULL, // 5^-145
+    0xc7caba6e7c5382c8ULL, 0xfe64a52ee96b8fc0ULL, // 5^-144
+    0xf9bd690a1b68637bULL, 0x3dfdce7aa3c673b0ULL, // 5^-143
+    0x9c1661a651213e2dULL, 0x06bea10ca65c084eULL, // 5^-142
+    0xc31bfa0fe5698db8ULL, 0x486e494fcff30a62ULL, // 5^-141
+    0xf3e2f893dec3f126ULL, 0x5a89dba3c3efccfaULL, // 5^-140
+    0x986ddb5c6b3a76b7ULL, 0xf89629465a75e01cULL, // 5^-139
+    0xbe89523386091465ULL, 0xf6bbb397f1135823ULL, // 5^-138
+    0xee2ba6c0678b597fULL, 0x746aa07ded582e2cULL, // 5^-137
+    0x94db483840b717efULL, 0xa8c2a44eb4571cdcULL, // 5^-136
+    0xba121a4650e4ddebULL, 0x92f34d62616ce413ULL, // 5^-135
+    0xe896a0d7e51e1566ULL, 0x77b020baf9c81d17ULL, // 5^-134
+    0x915e2486ef32cd60ULL, 0x0ace1474dc1d122eULL, // 5^-133
+    0xb5b5ada8aaff80b8ULL, 0x0d819992132456baULL, // 5^-132
+    0xe3231912d5bf60e6ULL, 0x10e1fff697ed6c69ULL, // 5^-131
+    0x8df5efabc5979c8fULL, 0xca8d3ffa1ef463c1ULL, // 5^-130
+    0xb1736b96b6fd83b3ULL, 0xbd308ff8a6b17cb2ULL, // 5^-129
+    0xddd0467c64bce4a0ULL, 0xac7cb3f6d05ddbdeULL, // 5^-128
+    0x8aa22c0dbef60ee4ULL, 0x6bcdf07a423aa96bULL, // 5^-127
+    0xad4ab7112eb3929dULL, 0x86c16c98d2c953c6ULL, // 5^-126
+    0xd89d64d57a607744ULL, 0xe871c7bf077ba8b7ULL, // 5^-125
+    0x87625f056c7c4a8bULL, 0x11471cd764ad4972ULL, // 5^-124
+    0xa93af6c6c79b5d2dULL, 0xd598e40d3dd89bcfULL, // 5^-123
+    0xd389b47879823479ULL, 0x4aff1d108d4ec2c3ULL, // 5^-122
+    0x843610cb4bf160cbULL, 0xcedf722a585139baULL, // 5^-121
+    0xa54394fe1eedb8feULL, 0xc2974eb4ee658828ULL, // 5^-120
+    0xce947a3da6a9273eULL, 0x733d226229feea32ULL, // 5^-119
+    0x811ccc668829b887ULL, 0x0806357d5a3f525fULL, // 5^-118
+    0xa163ff802a3426a8ULL, 0xca07c2dcb0cf26f7ULL, // 5^-117
+    0xc9bcff6034c13052ULL, 0xfc89b393dd02f0b5ULL, // 5^-116
+    0xfc2c3f3841f17c67ULL, 0xbbac2078d443ace2ULL, // 5^-115
+    0x9d9ba7832936edc0ULL, 0xd54b944b84aa4c0dULL, // 5^-114
+    0xc5029163f384a931ULL, 0x0a9e795e65d4df11ULL, // 5^-113
+    0xf64335bcf065d37dULL, 0x4d4617b5ff4a16d5ULL, // 5^-112
+    0x99ea0196163fa42eULL, 0x504bced1bf8e4e45ULL, // 5^-111
+    0xc06481fb9bcf8d39ULL, 0xe45ec2862f71e1d6ULL, // 5^-110
+    0xf07da27a82c37088ULL, 0x5d767327bb4e5a4cULL, // 5^-109
+    0x964e858c91ba2655ULL, 0x3a6a07f8d510f86fULL, // 5^-108
+    0xbbe226efb628afeaULL, 0x890489f70a55368bULL, // 5^-107
+    0xeadab0aba3b2dbe5ULL, 0x2b45ac74ccea842eULL, // 5^-106
+    0x92c8ae6b464fc96fULL, 0x3b0b8bc90012929dULL, // 5^-105
+    0xb77ada0617e3bbcbULL, 0x09ce6ebb40173744ULL, // 5^-104
+    0xe55990879ddcaabdULL, 0xcc420a6a101d0515ULL, // 5^-103
+    0x8f57fa54c2a9eab6ULL, 0x9fa946824a12232dULL, // 5^-102
+    0xb32df8e9f3546564ULL, 0x47939822dc96abf9ULL, // 5^-101
+    0xdff9772470297ebdULL, 0x59787e2b93bc56f7ULL, // 5^-100
+    0x8bfbea76c619ef36ULL, 0x57eb4edb3c55b65aULL, // 5^-99
+    0xaefae51477a06b03ULL, 0xede622920b6b23f1ULL, // 5^-98
+    0xdab99e59958885c4ULL, 0xe95fab368e45ecedULL, // 5^-97
+    0x88b402f7fd75539bULL, 0x11dbcb0218ebb414ULL, // 5^-96
+    0xaae103b5fcd2a881ULL, 0xd652bdc29f26a119ULL, // 5^-95
+    0xd59944a37c0752a2ULL, 0x4be76d3346f0495fULL, // 5^-94
+    0x857fcae62d8493a5ULL, 0x6f70a4400c562ddbULL, // 5^-93
+    0xa6dfbd9fb8e5b88eULL, 0xcb4ccd500f6bb952ULL, // 5^-92
+    0xd097ad07a71f26b2ULL, 0x7e2000a41346a7a7ULL, // 5^-91
+    0x825ecc24c873782fULL, 0x8ed400668c0c28c8ULL, // 5^-90
+    0xa2f67f2dfa90563bULL, 0x728900802f0f32faULL, // 5^-89
+    0xcbb41ef979346bcaULL, 0x4f2b40a03ad2ffb9ULL, // 5^-88
+    0xfea126b7d78186bcULL, 0xe2f610c84987bfa8ULL, // 5^-87
+    0x9f24b832e6b0f436ULL, 0x0dd9ca7d2df4d7c9ULL, // 5^-86
+    0xc6ede63fa05d3143ULL, 0x91503d1c79720dbbULL, // 5^-85
+    0xf8a95fcf88747d94ULL, 0x75a44c6397ce912aULL, // 5^-84
+    0x9b69dbe1b548ce7cULL, 0xc986afbe3ee11abaULL, // 5^-83
+    0xc24452da229b021bULL, 0xfbe85badce996168ULL, // 5^-82
+    0xf2d56790ab41c2a2ULL, 0xfae27299423fb9c3ULL, // 5^-81
+    0x97c560ba6b0919a5ULL, 0xdccd879fc967d41aULL, // 5^-80
+    0xbdb6b8e905cb600fULL, 0x5400e987bbc1c920ULL, // 5^-79
+    0xed246723473e3813ULL, 0x290123e9aab23b68ULL, // 5^-78
+    0x9436c0760c86e30bULL, 0xf9a0b6720aaf6521ULL, // 5^-77
+    0xb94470938fa89bceULL, 0xf808e40e8d5b3e69ULL, // 5^-76
+    0xe7958cb87392c2c2ULL, 0xb60b1d1230b20e04ULL, // 5^-75
+    0x90bd77f3483bb9b9ULL, 0xb1c6f22b5e6f48c2ULL, // 5^-74
+    0xb4ecd5f01a4aa828ULL, 0x1e38aeb6360b1af3ULL, // 5^-73
+    0xe2280b6c20dd5232ULL, 0x25c6da63c38de1b0ULL, // 5^-72
+    0x8d590723948a535fULL, 0x579c487e5a38ad0eULL, // 5^-71
+    0xb0af48ec79ace837ULL, 0x2d835a9df0c6d851ULL, // 5^-70
+    0xdcdb1b2798182244ULL, 0xf8e431456cf88e65ULL, // 5^-69
+    0x8a08f0f8bf0f156bULL, 0x1b8e9ecb641b58ffULL, // 5^-68
+    0xac8b2d36eed2dac5ULL, 0xe272467e3d222f3fULL, // 5^-67
+    0xd7adf884aa879177ULL, 0x5b0ed81dcc6abb0fULL, // 5^-66
+    0x86ccbb52ea94baeaULL, 0x98e947129fc2b4e9ULL, // 5^-65
+    0xa87fea27a539e9a5ULL, 0x3f2398d747b36224ULL, // 5^-64
+    0xd29fe4b18e88640eULL, 0x8eec7f0d19a03aadULL, // 5^-63
+    0x83a3eeeef9153e89ULL, 0x1953cf68300424acULL, // 5^-62
+    0xa48ceaaab75a8e2bULL, 0x5fa8c3423c052dd7ULL, // 5^-61
+    0xcdb02555653131b6ULL, 0x3792f412cb06794dULL, // 5^-60
+    0x808e17555f3ebf11ULL, 0xe2bbd88bbee40bd0ULL, // 5^-59
+    0xa0b19d2ab70e6ed6ULL, 0x5b6aceaeae9d0ec4ULL, // 5^-58
+    0xc8de047564d20a8bULL, 0xf245825a5a445275ULL, // 5^-57
+    0xfb158592be068d2eULL, 0xeed6e2f0f0d56712ULL, // 5^-56
+    0x9ced737bb6c4183dULL, 0x55464dd69685606bULL, // 5^-55
+    0xc428d05aa4751e4cULL, 0xaa97e14c3c26b886ULL, // 5^-54
+    0xf53304714d9265dfULL, 0xd53dd99f4b3066a8ULL, // 5^-53
+    0x993fe2c6d07b7fabULL, 0xe546a8038efe4029ULL, // 5^-52
+    0xbf8fdb78849a5f96ULL, 0xde98520472bdd033ULL, // 5^-51
+    0xef73d256a5c0f77cULL, 0x963e66858f6d4440ULL, // 5^-50
+    0x95a8637627989aadULL, 0xdde7001379a44aa8ULL, // 5^-49
+    0xbb127c53b17ec159ULL, 0x5560c018580d5d52ULL, // 5^-48
+    0xe9d71b689dde71afULL, 0xaab8f01e6e10b4a6ULL, // 5^-47
+    0x9226712162ab070dULL, 0xcab3961304ca70e8ULL, // 5^-46
+    0xb6b00d69bb55c8d1ULL, 0x3d607b97c5fd0d22ULL, // 5^-45
+    0xe45c10c42a2b3b05ULL, 0x8cb89a7db77c506aULL, // 5^-44
+    0x8eb98a7a9a5b04e3ULL, 0x77f3608e92adb242ULL, // 5^-43
+    0xb267ed1940f1c61cULL, 0x55f038b237591ed3ULL, // 5^-42
+    0xdf01e85f912e37a3ULL, 0x6b6c46dec52f6688ULL, // 5^-41
+    0x8b61313bbabce2c6ULL, 0x2323ac4b3b3da015ULL, // 5^-40
+    0xae397d8aa96c1b77ULL, 0xabec975e0a0d081aULL, // 5^-39
+    0xd9c7dced53c72255ULL, 0x96e7bd358c904a21ULL, // 5^-38
+    0x881cea14545c7575ULL, 0x7e50d64177da2e54ULL, // 5^-37
+    0xaa242499697392d2ULL, 0xdde50bd1d5d0b9e9ULL, // 5^-36
+    0xd4ad2dbfc3d07787ULL, 0x955e4ec64b44e864ULL, // 5^-35
+    0x84ec3c97da624ab4ULL, 0xbd5af13bef0b113eULL, // 5^-34
+    0xa6274bbdd0fadd61ULL, 0xecb1ad8aeacdd58eULL, // 5^-33
+    0xcfb11ead453994baULL, 0x67de18eda5814af2ULL, // 5^-32
+    0x81ceb32c4b43fcf4ULL, 0x80eacf948770ced7ULL, // 5^-31
+    0xa2425ff75e14fc31ULL, 0xa1258379a94d028dULL, // 5^-30
+    0xcad2f7f5359a3b3eULL, 0x096ee45813a04330ULL, // 5^-29
+    0xfd87b5f28300ca0dULL, 0x8bca9d6e188853fcULL, // 5^-28
+    0x9e74d1b791e07e48ULL, 0x775ea264cf55347eULL, // 5^-27
+    0xc612062576589ddaULL, 0x95364afe032a819eULL, // 5^-26
+    0xf79687aed3eec551ULL, 0x3a83ddbd83f52205ULL, // 5^-25
+    0x9abe14cd44753b52ULL, 0xc4926a9672793543ULL, // 5^-24
+    0xc16d9a0095928a27ULL, 0x75b7053c0f178294ULL, // 5^-23
+    0xf1c90080baf72cb1ULL, 0x5324c68b12dd6339ULL, // 5^-22
+    0x971da05074da7beeULL, 0xd3f6fc16ebca5e04ULL, // 5^-21
+    0xbce5086492111aeaULL, 0x88f4bb1ca6bcf585ULL, // 5^-20
+    0xec1e4a7db69561a5ULL, 0x2b31e9e3d06c32e6ULL, // 5^-19
+    0x9392ee8e921d5d07ULL, 0x3aff322e62439fd0ULL, // 5^-18
+    0xb877aa3236a4b449ULL, 0x09befeb9fad487c3ULL, // 5^-17
+    0xe69594bec44de15bULL, 0x4c2ebe687989a9b4ULL, // 5^-16
+    0x901d7cf73ab0acd9ULL, 0x0f9d37014bf60a11ULL, // 5^-15
+    0xb424dc35095cd80fULL, 0x538484c19ef38c95ULL, // 5^-14
+    0xe12e13424bb40e13ULL, 0x2865a5f206b06fbaULL, // 5^-13
+    0x8cbccc096f5088cbULL, 0xf93f87b7442e45d4ULL, // 5^-12
+    0xafebff0bcb24aafeULL, 0xf78f69a51539d749ULL, // 5^-11
+    0xdbe6fecebdedd5beULL, 0xb573440e5a884d1cULL, // 5^-10
+    0x89705f4136b4a597ULL, 0x31680a88f8953031ULL, // 5^-9
+    0xabcc77118461cefcULL, 0xfdc20d2b36ba7c3eULL, // 5^-8
+    0xd6bf94d5e57a42bcULL, 0x3d32907604691b4dULL, // 5^-7
+    0x8637bd05af6c69b5ULL, 0xa63f9a49c2c1b110ULL, // 5^-6
+    0xa7c5ac471b478423ULL, 0x0fcf80dc33721d54ULL, // 5^-5
+    0xd1b71758e219652bULL, 0xd3c36113404ea4a9ULL, // 5^-4
+    0x83126e978d4fdf3bULL, 0x645a1cac083126eaULL, // 5^-3
+    0xa3d70a3d70a3d70aULL, 0x3d70a3d70a3d70a4ULL, // 5^-2
+    0xccccccccccccccccULL, 0xcccccccccccccccdULL, // 5^-1
+    0x8000000000000000ULL, 0x0000000000000000ULL, // 5^0
+    0xa000000000000000ULL, 0x0000000000000000ULL, // 5^1
+    0xc800000000000000ULL, 0x0000000000000000ULL, // 5^2
+    0xfa00000000000000ULL, 0x0000000000000000ULL, // 5^3
+    0x9c40000000000000ULL, 0x0000000000000000ULL, // 5^4
+    0xc350000000000000ULL, 0x0000000000000000ULL, // 5^5
+    0xf424000000000000ULL, 0x0000000000000000ULL, // 5^6
+    0x9896800000000000ULL, 0x0000000000000000ULL, // 5^7
+    0xbebc200000000000ULL, 0x0000000000000000ULL, // 5^8
+    0xee6b280000000000ULL, 0x0000000000000000ULL, // 5^9
+    0x9502f90000000000ULL, 0x0000000000000000ULL, // 5^10
+    0xba43b74000000000ULL, 0x0000000000000000ULL, // 5^11
+    0xe8d4a51000000000ULL, 0x0000000000000000ULL, // 5^12
+    0x9184e72a00000000ULL, 0x0000000000000000ULL, // 5^13
+    0xb5e620f480000000ULL, 0x0000000000000000ULL, // 5^14
+    0xe35fa931a0000000ULL, 0x0000000000000000ULL, // 5^15
+    0x8e1bc9bf04000000ULL, 0x0000000000000000ULL, // 5^16
+    0xb1a2bc2ec5000000ULL, 0x0000000000000000ULL, // 5^17
+    0xde0b6b3a76400000ULL, 0x0000000000000000ULL, // 5^18
+    0x8ac7230489e80000ULL, 0x0000000000000000ULL, // 5^19
+    0xad78ebc5ac620000ULL, 0x0000000000000000ULL, // 5^20
+    0xd8d726b7177a8000ULL, 0x0000000000000000ULL, // 5^21
+    0x878678326eac9000ULL, 0x0000000000000000ULL, // 5^22
+    0xa968163f0a57b400ULL, 0x0000000000000000ULL, // 5^23
+    0xd3c21bcecceda100ULL, 0x0000000000000000ULL, // 5^24
+    0x84595161401484a0ULL, 0x0000000000000000ULL, // 5^25
+    0xa56fa5b99019a5c8ULL, 0x0000000000000000ULL, // 5^26
+    0xcecb8f27f4200f3aULL, 0x0000000000000000ULL, // 5^27
+    0x813f3978f8940984ULL, 0x4000000000000000ULL, // 5^28
+    0xa18f07d736b90be5ULL, 0x5000000000000000ULL, // 5^29
+    0xc9f2c9cd04674edeULL, 0xa400000000000000ULL, // 5^30
+    0xfc6f7c4045812296ULL, 0x4d00000000000000ULL, // 5^31
+    0x9dc5ada82b70b59dULL, 0xf020000000000000ULL, // 5^32
+    0xc5371912364ce305ULL, 0x6c28000000000000ULL, // 5^33
+    0xf684df56c3e01bc6ULL, 0xc732000000000000ULL, // 5^34
+    0x9a130b963a6c115cULL, 0x3c7f400000000000ULL, // 5^35
+    0xc097ce7bc90715b3ULL, 0x4b9f100000000000ULL, // 5^36
+    0xf0bdc21abb48db20ULL, 0x1e86d40000000000ULL, // 5^37
+    0x96769950b50d88f4ULL, 0x1314448000000000ULL, // 5^38
+    0xbc143fa4e250eb31ULL, 0x17d955a000000000ULL, // 5^39
+    0xeb194f8e1ae525fdULL, 0x5dcfab0800000000ULL, // 5^40
+    0x92efd1b8d0cf37beULL, 0x5aa1cae500000000ULL, // 5^41
+    0xb7abc627050305adULL, 0xf14a3d9e40000000ULL, // 5^42
+    0xe596b7b0c643c719ULL, 0x6d9ccd05d0000000ULL, // 5^43
+    0x8f7e32ce7bea5c6fULL, 0xe4820023a2000000ULL, // 5^44
+    0xb35dbf821ae4f38bULL, 0xdda2802c8a800000ULL, // 5^45
+    0xe0352f62a19e306eULL, 0xd50b2037ad200000ULL, // 5^46
+    0x8c213d9da502de45ULL, 0x4526f422cc340000ULL, // 5^47
+    0xaf298d050e4395d6ULL, 0x9670b12b7f410000ULL, // 5^48
+    0xdaf3f04651d47b4cULL, 0x3c0cdd765f114000ULL, // 5^49
+    0x88d8762bf324cd0fULL, 0xa5880a69fb6ac800ULL, // 5^50
+    0xab0e93b6efee0053ULL, 0x8eea0d047a457a00ULL, // 5^51
+    0xd5d238a4abe98068ULL, 0x72a4904598d6d880ULL, // 5^52
+    0x85a36366eb71f041ULL, 0x47a6da2b7f864750ULL, // 5^53
+    0xa70c3c40a64e6c51ULL, 0x999090b65f67d924ULL, // 5^54
+    0xd0cf4b50cfe20765ULL, 0xfff4b4e3f741cf6dULL, // 5^55
+    0x82818f1281ed449fULL, 0xbff8f10e7a8921a4ULL, // 5^56
+    0xa321f2d7226895c7ULL, 0xaff72d52192b6a0dULL, // 5^57
+    0xcbea6f8ceb02bb39ULL, 0x9bf4f8a69f764490ULL, // 5^58
+    0xfee50b7025c36a08ULL, 0x02f236d04753d5b4ULL, // 5^59
+    0x9f4f2726179a2245ULL, 0x01d762422c946590ULL, // 5^60
+    0xc722f0ef9d80aad6ULL, 0x424d3ad2b7b97ef5ULL, // 5^61
+    0xf8ebad2b84e0d58bULL, 0xd2e0898765a7deb2ULL, // 5^62
+    0x9b934c3b330c8577ULL, 0x63cc55f49f88eb2fULL, // 5^63
+    0xc2781f49ffcfa6d5ULL, 0x3cbf6b71c76b25fbULL, // 5^64
+    0xf316271c7fc3908aULL, 0x8bef464e3945ef7aULL, // 5^65
+    0x97edd871cfda3a56ULL, 0x97758bf0e3cbb5acULL, // 5^66
+    0xbde94e8e43d0c8ecULL, 0x3d52eeed1cbea317ULL, // 5^67
+    0xed63a231d4c4fb27ULL, 0x4ca7aaa863ee4bddULL, // 5^68
+    0x945e455f24fb1cf8ULL, 0x8fe8caa93e74ef6aULL, // 5^69
+    0xb975d6b6ee39e436ULL, 0xb3e2fd538e122b44ULL, // 5^70
+    0xe7d34c64a9c85d44ULL, 0x60dbbca87196b616ULL, // 5^71
+    0x90e40fbeea1d3a4aULL, 0xbc8955e946fe31cdULL, // 5^72
+    0xb51d13aea4a488ddULL, 0x6babab6398bdbe41ULL, // 5^73
+    0xe264589a4dcdab14ULL, 0xc696963c7eed2dd1ULL, // 5^74
+    0x8d7eb76070a08aecULL, 0xfc1e1de5cf543ca2ULL, // 5^75
+    0xb0de65388cc8ada8ULL, 0x3b25a55f43294bcbULL, // 5^76
+    0xdd15fe86affad912ULL, 0x49ef0eb713f39ebeULL, // 5^77
+    0x8a2dbf142dfcc7abULL, 0x6e3569326c784337ULL, // 5^78
+    0xacb92ed9397bf996ULL, 0x49c2c37f07965404ULL, // 5^79
+    0xd7e77a8f87daf7fbULL, 0xdc33745ec97be906ULL, // 5^80
+    0x86f0ac99b4e8dafdULL, 0x69a028bb3ded71a3ULL, // 5^81
+    0xa8acd7c0222311bcULL, 0xc40832ea0d68ce0cULL, // 5^82
+    0xd2d80db02aabd62bULL, 0xf50a3fa490c30190ULL, // 5^83
+    0x83c7088e1aab65dbULL, 0x792667c6da79e0faULL, // 5^84
+    0xa4b8cab1a1563f52ULL, 0x577001b891185938ULL, // 5^85
+    0xcde6fd5e09abcf26ULL, 0xed4c0226b55e6f86ULL, // 5^86
+    0x80b05e5ac60b6178ULL, 0x544f8158315b05b4ULL, // 5^87
+    0xa0dc75f1778e39d6ULL, 0x696361ae3db1c721ULL, // 5^88
+    0xc913936dd571c84cULL, 0x03bc3a19cd1e38e9ULL, // 5^89
+    0xfb5878494ace3a5fULL, 0x04ab48a04065c723ULL, // 5^90
+    0x9d174b2dcec0e47bULL, 0x62eb0d64283f9c76ULL, // 5^91
+    0xc45d1df942711d9aULL, 0x3ba5d0bd324f8394ULL, // 5^92
+    0xf5746577930d6500ULL, 0xca8f44ec7ee36479ULL, // 5^93
+    0x9968bf6abbe85f20ULL, 0x7e998b13cf4e1ecbULL, // 5^94
+    0xbfc2ef456ae276e8ULL, 0x9e3fedd8c321a67eULL, // 5^95
+    0xefb3ab16c59b14a2ULL, 0xc5cfe94ef3ea101eULL, // 5^96
+    0x95d04aee3b80ece5ULL, 0xbba1f1d158724a12ULL, // 5^97
+    0xbb445da9ca61281fULL, 0x2a8a6e45ae8edc97ULL, // 5^98
+    0xea1575143cf97226ULL, 0xf52d09d71a3293bdULL, // 5^99
+    0x924d692ca61be758ULL, 0x593c2626705f9c56ULL, // 5^100
+    0xb6e0c377cfa2e12eULL, 0x6f8b2fb00c77836cULL, // 5^101
+    0xe498f455c38b997aULL, 0x0b6dfb9c0f956447ULL, // 5^102
+    0x8edf98b59a373fecULL, 0x4724bd4189bd5eacULL, // 5^103
+    0xb2977ee300c50fe7ULL, 0x58edec91ec2cb657ULL, // 5^104
+    0xdf3d5e9bc0f653e1ULL, 0x2f2967b66737e3edULL, // 5^105
+    0x8b865b215899f46cULL, 0xbd79e0d20082ee74ULL, // 5^106
+    0xae67f1e9aec07187ULL, 0xecd8590680a3aa11ULL, // 5^107
+    0xda01ee641a708de9ULL, 0xe80e6f4820cc9495ULL, // 5^108
+    0x884134fe908658b2ULL, 0x3109058d147fdcddULL, // 5^109
+    0xaa51823e34a7eedeULL, 0xbd4b46f0599fd415ULL, // 5^110
+    0xd4e5e2cdc1d1ea96ULL, 0x6c9e18ac7007c91aULL, // 5^111
+    0x850fadc09923329eULL, 0x03e2cf6bc604ddb0ULL, // 5^112
+    0xa6539930bf6bff45ULL, 0x84db8346b786151cULL, // 5^113
+    0xcfe87f7cef46ff16ULL, 0xe612641865679a63ULL, // 5^114
+    0x81f14fae158c5f6eULL, 0x4fcb7e8f3f60c07eULL, // 5^115
+    0xa26da3999aef7749ULL, 0xe3be5e330f38f09dULL, // 5^116
+    0xcb090c8001ab551cULL, 0x5cadf5bfd3072cc5ULL, // 5^117
+    0xfdcb4fa002162a63ULL, 0x73d9732fc7c8f7f6ULL, // 5^118
+    0x9e9f11c4014dda7eULL, 0x2867e7fddcdd9afaULL, // 5^119
+    0xc646d63501a1511dULL, 0xb281e1fd541501b8ULL, // 5^120
+    0xf7d88bc24209a565ULL, 0x1f225a7ca91a4226ULL, // 5^121
+    0x9ae757596946075fULL, 0x3375788de9b06958ULL, // 5^122
+    0xc1a12d2fc3978937ULL, 0x0052d6b1641c83aeULL, // 5^123
+    0xf209787bb47d6b84ULL, 0xc0678c5dbd23a49aULL, // 5^124
+    0x9745eb4d50ce6332ULL, 0xf840b7ba963646e0ULL, // 5^125
+    0xbd176620a501fbffULL, 0xb650e5a93bc3d898ULL, // 5^126
+    0xec5d3fa8ce427affULL, 0xa3e51f138ab4cebeULL, // 5^127
+    0x93ba47c980e98cdfULL, 0xc66f336c36b10137ULL, // 5^128
+    0xb8a8d9bbe123f017ULL, 0xb80b0047445d4184ULL, // 5^129
+    0xe6d3102ad96cec1dULL, 0xa60dc059157491e5ULL, // 5^130
+    0x9043ea1ac7e41392ULL, 0x87c89837ad68db2fULL, // 5^131
+    0xb454e4a179dd1877ULL, 0x29babe4598c311fbULL, // 5^132
+    0xe16a1dc9d8545e94ULL, 0xf4296dd6fef3d67aULL, // 5^133
+    0x8ce2529e2734bb1dULL, 0x1899e4a65f58660cULL, // 5^134
+    0xb01ae745b101e9e4ULL, 0x5ec05dcff72e7f8fULL, // 5^135
+    0xdc21a1171d42645dULL, 0x76707543f4fa1f73ULL, // 5^136
+    0x899504ae72497ebaULL, 0x6a06494a791c53a8ULL, // 5^137
+    0xabfa45da0edbde69ULL, 0x0487db9d17636892ULL, // 5^138
+    0xd6f8d7509292d603ULL, 0x45a9d2845d3c42b6ULL, // 5^139
+    0x865b86925b9bc5c2ULL, 0x0b8a2392ba45a9b2ULL, // 5^140
+    0xa7f26836f282b732ULL, 0x8e6cac7768d7141eULL, // 5^141
+    0xd1ef0244af2364ffULL, 0x3207d795430cd926ULL, // 5^142
+    0x8335616aed761f1fULL, 0x7f44e6bd49e807b8ULL, // 5^143
+    0xa402b9c5a8d3a6e7ULL, 0x5f16206c9c6209a6ULL, // 5^144
+    0xcd036837130890a1ULL, 0x36dba887c37a8c0fULL, // 5^145
+    0x802221226be55a64ULL, 0xc2494954da2c9789ULL, // 5^146
+    0xa02aa96b06deb0fdULL, 0xf2db9baa10b7bd6cULL, // 5^147
+    0xc83553c5c8965d3dULL, 0x6f92829494e5acc7ULL, // 5^148
+    0xfa42a8b73abbf48cULL, 0xcb772339ba1f17f9ULL, // 5^149
+    0x9c69a97284b578d7ULL, 0xff2a760414536efbULL, // 5^150
+    0xc38413cf25e2d70dULL, 0xfef5138519684abaULL, // 5^151
+    0xf46518c2ef5b8cd1ULL, 0x7eb258665fc25d69ULL, // 5^152
+    0x98bf2f79d5993802ULL, 0xef2f773ffbd97a61ULL, // 5^153
+    0xbeeefb584aff8603ULL, 0xaafb550ffacfd8faULL, // 5^154
+    0xeeaaba2e5dbf6784ULL, 0x95ba2a53f983cf38ULL, // 5^155
+    0x952ab45cfa97a0b2ULL, 0xdd945a747bf26183ULL, // 5^156
+    0xba756174393d88dfULL, 0x94f971119aeef9e4ULL, // 5^157
+    0xe912b9d1478ceb17ULL, 0x7a37cd5601aab85dULL, // 5^158
+    0x91abb422ccb812eeULL, 0xac62e055c10ab33aULL, // 5^159
+    0xb616a12b7fe617aaULL, 0x577b986b314d6009ULL, // 5^160
+    0xe39c49765fdf9d94ULL, 0xed5a7e85fda0b80bULL, // 5^161
+    0x8e41ade9fbebc27dULL, 0x14588f13be847307ULL, // 5^162
+    0xb1d219647ae6b31cULL, 0x596eb2d8ae258fc8ULL, // 5^163
+    0xde469fbd99a05fe3ULL, 0x6fca5f8ed9aef3bbULL, // 5^164
+    0x8aec23d680043beeULL, 0x25de7bb9480d5854ULL, // 5^165
+    0xada72ccc20054ae9ULL, 0xaf561aa79a10ae6aULL, // 5^166
+    0xd910f7ff28069da4ULL, 0x1b2ba1518094da04ULL, // 5^167
+    0x87aa9aff79042286ULL, 0x90fb44d2f05d0842ULL, // 5^168
+    0xa99541bf57452b28ULL, 0x353a1607ac744a53ULL, // 5^169
+    0xd3fa922f2d1675f2ULL, 0x42889b8997915ce8ULL, // 5^170
+    0x847c9b5d7c2e09b7ULL, 0x69956135febada11ULL, // 5^171
+    0xa59bc234db398c25ULL, 0x43fab9837e699095ULL, // 5^172
+    0xcf02b2c21207ef2eULL, 0x94f967e45e03f4bbULL, // 5^173
+    0x8161afb94b44f57dULL, 0x1d1be0eebac278f5ULL, // 5^174
+    0xa1ba1ba79e1632dcULL, 0x6462d92a69731732ULL, // 5^175
+    0xca28a291859bbf93ULL, 0x7d7b8f7503cfdcfeULL, // 5^176
+    0xfcb2cb35e702af78ULL, 0x5cda735244c3d43eULL, // 5^177
+    0x9defbf01b061adabULL, 0x3a0888136afa64a7ULL, // 5^178
+    0xc56baec21c7a1916ULL, 0x088aaa1845b8fdd0ULL, // 5^179
+    0xf6c69a72a3989f5bULL, 0x8aad549e57273d45ULL, // 5^180
+    0x9a3c2087a63f6399ULL, 0x36ac54e2f678864bULL, // 5^181
+    0xc0cb28a98fcf3c7fULL, 0x84576a1bb416a7ddULL, // 5^182
+    0xf0fdf2d3f3c30b9fULL, 0x656d44a2a11c51d5ULL, // 5^183
+    0x969eb7c47859e743ULL, 0x9f644ae5a4b1b325ULL, // 5^184
+    0xbc4665b596706114ULL, 0x873d5d9f0dde1feeULL, // 5^185
+    0xeb57ff22fc0c7959ULL, 0xa90cb506d155a7eaULL, // 5^186
+    0x9316ff75dd87cbd8ULL, 0x09a7f12442d588f2ULL, // 5^187
+    0xb7dcbf5354e9beceULL, 0x0c11ed6d538aeb2fULL, // 5^188
+    0xe5d3ef282a242e81ULL, 0x8f1668c8a86da5faULL, // 5^189
+    0x8fa475791a569d10ULL, 0xf96e017d694487bcULL, // 5^190
+    0xb38d92d760ec4455ULL, 0x37c981dcc395a9acULL, // 5^191
+    0xe070f78d3927556aULL, 0x85bbe253f47b1417ULL, // 5^192
+    0x8c469ab843b89562ULL, 0x93956d7478ccec8eULL, // 5^193
+    0xaf58416654a6babbULL, 0x387ac8d1970027b2ULL, // 5^194
+    0xdb2e51bfe9d0696aULL, 0x06997b05fcc0319eULL, // 5^195
+    0x88fcf317f22241e2ULL, 0x441fece3bdf81f03ULL, // 5^196
+    0xab3c2fddeeaad25aULL, 0xd527e81cad7626c3ULL, // 5^197
+    0xd60b3bd56a5586f1ULL, 0x8a71e223d8d3b074ULL, // 5^198
+    0x85c7056562757456ULL, 0xf6872d5667844e49ULL, // 5^199
+    0xa738c6bebb12d16cULL, 0xb428f8ac016561dbULL, // 5^200
+    0xd106f86e69d785c7ULL, 0xe13336d701beba52ULL, // 5^201
+    0x82a45b450226b39cULL, 0xecc0024661173473ULL, // 5^202
+    0xa34d721642b06084ULL, 0x27f002d7f95d0190ULL, // 5^203
+    0xcc20ce9bd35c78a5ULL, 0x31ec038df7b441f4ULL, // 5^204
+    0xff290242c83396ceULL, 0x7e67047175a15271ULL, // 5^205
+    0x9f79a169bd203e41ULL, 0x0f0062c6e984d386ULL, // 5^206
+    0xc75809c42c684dd1ULL, 0x52c07b78a3e60868ULL, // 5^207
+    0xf92e0c3537826145ULL, 0xa7709a56ccdf8a82ULL, // 5^208
+    0x9bbcc7a142b17ccbULL, 0x88a66076400bb691ULL, // 5^209
+    0xc2abf989935ddbfeULL, 0x6acff893d00ea435ULL, // 5^210
+    0xf356f7ebf83552feULL, 0x0583f6b8c4124d43ULL, // 5^211
+    0x98165af37b2153deULL, 0xc3727a337a8b704aULL, // 5^212
+    0xbe1bf1b059e9a8d6ULL, 0x744f18c0592e4c5cULL, // 5^213
+    0xeda2ee1c7064130cULL, 0x1162def06f79df73ULL, // 5^214
+    0x9485d4d1c63e8be7ULL, 0x8addcb5645ac2ba8ULL, // 5^215
+    0xb9a74a0637ce2ee1ULL, 0x6d953e2bd7173692ULL, // 5^216
+    0xe8111c87c5c1ba99ULL, 0xc8fa8db6ccdd0437ULL, // 5^217
+    0x910ab1d4db9914a0ULL, 0x1d9c9892400a22a2ULL, // 5^218
+    0xb54d5e4a127f59c8ULL, 0x2503beb6d00cab4bULL, // 5^219
+    0xe2a0b5dc971f303aULL, 0x2e44ae64840fd61dULL, // 5^220
+    0x8da471a9de737e24ULL, 0x5ceaecfed289e5d2ULL, // 5^221
+    0xb10d8e1456105dadULL, 0x7425a83e872c5f47ULL, // 5^222
+    0xdd50f1996b947518ULL, 0xd12f124e28f77719ULL, // 5^223
+    0x8a5296ffe33cc92fULL, 0x82bd6b70d99aaa6fULL, // 5^224
+    0xace73cbfdc0bfb7bULL, 0x636cc64d1001550bULL, // 5^225
+    0xd8210befd30efa5aULL, 0x3c47f7e05401aa4eULL, // 5^226
+    0x8714a775e3e95c78ULL, 0x65acfaec34810a71ULL, // 5^227
+    0xa8d9d1535ce3b396ULL, 0x7f1839a741a14d0dULL, // 5^228
+    0xd31045a8341ca07cULL, 0x1ede48111209a050ULL, // 5^229
+    0x83ea2b892091e44dULL, 0x934aed0aab460432ULL, // 5^230
+    0xa4e4b66b68b65d60ULL, 0xf81da84d5617853fULL, // 5^231
+    0xce1de40642e3f4b9ULL, 0x36251260ab9d668eULL, // 5^232
+    0x80d2ae83e9ce78f3ULL, 0xc1d72b7c6b426019ULL, // 5^233
+    0xa1075a24e4421730ULL, 0xb24cf65b8612f81fULL, // 5^234
+    0xc94930ae1d529cfcULL, 0xdee033f26797b627ULL, // 5^235
+    0xfb9b7cd9a4a7443cULL, 0x169840ef017da3b1ULL, // 5^236
+    0x9d412e0806e88aa5ULL, 0x8e1f289560ee864eULL, // 5^237
+    0xc491798a08a2ad4eULL, 0xf1a6f2bab92a27e2ULL, // 5^238
+    0xf5b5d7ec8acb58a2ULL, 0xae10af696774b1dbULL, // 5^239
+    0x9991a6f3d6bf1765ULL, 0xacca6da1e0a8ef29ULL, // 5^240
+    0xbff610b0cc6edd3fULL, 0x17fd090a58d32af3ULL, // 5^241
+    0xeff394dcff8a948eULL, 0xddfc4b4cef07f5b0ULL, // 5^242
+    0x95f83d0a1fb69cd9ULL, 0x4abdaf101564f98eULL, // 5^243
+    0xbb764c4ca7a4440fULL, 0x9d6d1ad41abe37f1ULL, // 5^244
+    0xea53df5fd18d5513ULL, 0x84c86189216dc5edULL, // 5^245
+    0x92746b9be2f8552cULL, 0x32fd3cf5b4e49bb4ULL, // 5^246
+    0xb7118682dbb66a77ULL, 0x3fbc8c33221dc2a1ULL, // 5^247
+    0xe4d5e82392a40515ULL, 0x0fabaf3feaa5334aULL, // 5^248
+    0x8f05b1163ba6832dULL, 0x29cb4d87f2a7400eULL, // 5^249
+    0xb2c71d5bca9023f8ULL, 0x743e20e9ef511012ULL, // 5^250
+    0xdf78e4b2bd342cf6ULL, 0x914da9246b255416ULL, // 5^251
+    0x8bab8eefb6409c1aULL, 0x1ad089b6c2f7548eULL, // 5^252
+    0xae9672aba3d0c320ULL, 0xa184ac2473b529b1ULL, // 5^253
+    0xda3c0f568cc4f3e8ULL, 0xc9e5d72d90a2741eULL, // 5^254
+    0x8865899617fb1871ULL, 0x7e2fa67c7a658892ULL, // 5^255
+    0xaa7eebfb9df9de8dULL, 0xddbb901b98feeab7ULL, // 5^256
+    0xd51ea6fa85785631ULL, 0x552a74227f3ea565ULL, // 5^257
+    0x8533285c936b35deULL, 0xd53a88958f87275fULL, // 5^258
+    0xa67ff273b8460356ULL, 0x8a892abaf368f137ULL, // 5^259
+    0xd01fef10a657842cULL, 0x2d2b7569b0432d85ULL, // 5^260
+    0x8213f56a67f6b29bULL, 0x9c3b29620e29fc73ULL, // 5^261
+    0xa298f2c501f45f42ULL, 0x8349f3ba91b47b8fULL, // 5^262
+    0xcb3f2f7642717713ULL, 0x241c70a936219a73ULL, // 5^263
+    0xfe0efb53d30dd4d7ULL, 0xed238cd383aa0110ULL, // 5^264
+    0x9ec95d1463e8a506ULL, 0xf4363804324a40aaULL, // 5^265
+    0xc67bb4597ce2ce48ULL, 0xb143c6053edcd0d5ULL, // 5^266
+    0xf81aa16fdc1b81daULL, 0xdd94b7868e94050aULL, // 5^267
+    0x9b10a4e5e9913128ULL, 0xca7cf2b4191c8326ULL, // 5^268
+    0xc1d4ce1f63f57d72ULL, 0xfd1c2f611f63a3f0ULL, // 5^269
+    0xf24a01a73cf2dccfULL, 0xbc633b39673c8cecULL, // 5^270
+    0x976e41088617ca01ULL, 0xd5be0503e085d813ULL, // 5^271
+    0xbd49d14aa79dbc82ULL, 0x4b2d8644d8a74e18ULL, // 5^272
+    0xec9c459d51852ba2ULL, 0xddf8e7d60ed1219eULL, // 5^273
+    0x93e1ab8252f33b45ULL, 0xcabb90e5c942b503ULL, // 5^274
+    0xb8da1662e7b00a17ULL, 0x3d6a751f3b936243ULL, // 5^275
+    0xe7109bfba19c0c9dULL, 0x0cc512670a783ad4ULL, // 5^276
+    0x906a617d450187e2ULL, 0x27fb2b80668b24c5ULL, // 5^277
+    0xb484f9dc9641e9daULL, 0xb1f9f660802dedf6ULL, // 5^278
+    0xe1a63853bbd26451ULL, 0x5e7873f8a0396973ULL, // 5^279
+    0x8d07e33455637eb2ULL, 0xdb0b487b6423e1e8ULL, // 5^280
+    0xb049dc016abc5e5fULL, 0x91ce1a9a3d2cda62ULL, // 5^281
+    0xdc5c5301c56b75f7ULL, 0x7641a140cc7810fbULL, // 5^282
+    0x89b9b3e11b6329baULL, 0xa9e904c87fcb0a9dULL, // 5^283
+    0xac2820d9623bf429ULL, 0x546345fa9fbdcd44ULL, // 5^284
+    0xd732290fbacaf133ULL, 0xa97c177947ad4095ULL, // 5^285
+    0x867f59a9d4bed6c0ULL, 0x49ed8eabcccc485dULL, // 5^286
+    0xa81f301449ee8c70ULL, 0x5c68f256bfff5a74ULL, // 5^287
+    0xd226fc195c6a2f8cULL, 0x73832eec6fff3111ULL, // 5^288
+    0x83585d8fd9c25db7ULL, 0xc831fd53c5ff7eabULL, // 5^289
+    0xa42e74f3d032f525ULL, 0xba3e7ca8b77f5e55ULL, // 5^290
+    0xcd3a1230c43fb26fULL, 0x28ce1bd2e55f35ebULL, // 5^291
+    0x80444b5e7aa7cf85ULL, 0x7980d163cf5b81b3ULL, // 5^292
+    0xa0555e361951c366ULL, 0xd7e105bcc332621fULL, // 5^293
+    0xc86ab5c39fa63440ULL, 0x8dd9472bf3fefaa7ULL, // 5^294
+    0xfa856334878fc150ULL, 0xb14f98f6f0feb951ULL, // 5^295
+    0x9c935e00d4b9d8d2ULL, 0x6ed1bf9a569f33d3ULL, // 5^296
+    0xc3b8358109e84f07ULL, 0x0a862f80ec4700c8ULL, // 5^297
+    0xf4a642e14c6262c8ULL, 0xcd27bb612758c0faULL, // 5^298
+    0x98e7e9cccfbd7dbdULL, 0x8038d51cb897789cULL, // 5^299
+    0xbf21e44003acdd2cULL, 0xe0470a63e6bd56c3ULL, // 5^300
+    0xeeea5d5004981478ULL, 0x1858ccfce06cac74ULL, // 5^301
+    0x95527a5202df0ccbULL, 0x0f37801e0c43ebc8ULL, // 5^302
+    0xbaa718e68396cffdULL, 0xd30560258f54e6baULL, // 5^303
+    0xe950df20247c83fdULL, 0x47c6b82ef32a2069ULL, // 5^304
+    0x91d28b7416cdd27eULL, 0x4cdc331d57fa5441ULL, // 5^305
+    0xb6472e511c81471dULL, 0xe0133fe4adf8e952ULL, // 5^306
+    0xe3d8f9e563a198e5ULL, 0x58180fddd97723a6ULL, // 5^307
+    0x8e679c2f5e44ff8fULL, 0x570f09eaa7ea7648ULL, // 5^308
+
+};
+
+/*
+ * Function: ecjp_mul_128()
+        This function returns the 128-bit product of two 64-bit numbers: the low half is returned,
+        the high half is stored in high.
+*/
+static inline uint64_t ecjp_mul_128(uint64_t a, uint64_t b, uint64_t *high)
+{
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 r = (unsigned __int128)a * b;
+
+    *high = (uint64_t)(r >> 64);
+    return (uint64_t)r;
+#else
+    uint64_t a0 = a & 0xFFFFFFFFU, a1 = a >> 32;
+    uint64_t b0 = b & 0xFFFFFFFFU, b1 = b >> 32;
+    uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    uint64_t middle = p10 + (p00 >> 32) + (p01 & 0xFFFFFFFFU);
+
+    *high = p11 + (middle >> 32) + (p01 >> 32);
+    return (middle << 32) | (p00 & 0xFFFFFFFFU);
+#endif
+}
+
+/*
+ * Function: ecjp_leading_zeros()
+        This function returns the number of leading zero bits of a number different from 0.
+*/
+static inline int ecjp_leading_zeros(uint64_t n)
+{
+#ifdef __GNUC__
+    return __builtin_clzll(n);
+#else
+    int count = 0;
+
+    while ((n & ((uint64_t)1 << 63)) == 0) {
+        n <<= 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+/*
+ * Function: ecjp_eisel_lemire()
+        This function computes the double nearest to mantissa * 10^exponent with the algorithm of
+        Eisel-Lemire: the mantissa is multiplied by the 128 bits of 5^exponent and the bits of the
+        result give the mantissa of the double, unless they are too close to a halfway point.
+        Parameters:
+        - exponent: The power of 10.
+        - mantissa: The decimal mantissa, different from 0.
+        - negative: ECJP_BOOL_TRUE for a negative number.
+        - value: Pointer to store the double.
+        Returns:
+        - 0 on success.
+        - -1 if the result is not certain and the slow path is needed.
+*/
+static int ecjp_eisel_lemire(int exponent, uint64_t mantissa, ecjp_bool_t negative, double *value)
+{
+    const uint64_t *pow5;
+    uint64_t low, high, second_high, result;
+    int lz, upper_bit, shift, power2;
+
+    if (exponent < ECJP_POW5_MIN_EXPONENT) {
+        *value = ecjp_make_double(negative, 0, 0);
+        return 0;
+    }
+    if (exponent > ECJP_POW5_MAX_EXPONENT) {
+        *value = ecjp_make_double(negative, ECJP_DOUBLE_INFINITE_POWER, 0);
+        return 0;
+    }
+    lz = ecjp_leading_zeros(mantissa);
+    mantissa <<= lz;
+    pow5 = &ecjp_pow5_128[2 * (exponent - ECJP_POW5_MIN_EXPONENT)];
+    low = ecjp_mul_128(mantissa, pow5[0], &high);
+    // the low bits of the first product are not enough: add the second half of 5^exponent
+    if ((high & 0x1FF) == 0x1FF) {
+        ecjp_mul_128(mantissa, pow5[1], &second_high);
+        low += second_high;
+        if (second_high > low) {
+            high++;
+        }
+        // 5^exponent doesn't fit 128 bits and the result can still be wrong
+        if ((low == UINT64_MAX) && ((exponent < -27) || (exponent > 55))) {
+            return -1;
+        }
+    }
+    upper_bit = (int)(high >> 63);
+    shift = upper_bit + 64 - ECJP_DOUBLE_MANTISSA_BITS - 3;
+    result = high >> shift;
+    // floor(log2(10^exponent)) + 63 + bias
+    power2 = (int)((((int64_t)(152170 + 65536) * exponent) >> 16) + 63) + upper_bit - lz + ECJP_DOUBLE_EXPONENT_BIAS;
+    if (power2 <= 0) {
+        // denormal
+        if (-power2 + 1 >= 64) {
+            *value = ecjp_make_double(negative, 0, 0);
+            return 0;
+        }
+        result >>= -power2 + 1;
+        result += result & 1;
+        result >>= 1;
+        power2 = (result < ((uint64_t)1 << ECJP_DOUBLE_MANTISSA_BITS)) ? 0 : 1;
+        *value = ecjp_make_double(negative, power2, result & (((uint64_t)1 << ECJP_DOUBLE_MANTISSA_BITS) - 1));
+        return 0;
+    }
+    // exactly halfway between two doubles: round to even
+    if ((low <= 1) && (exponent >= -4) && (exponent <= 23) && ((result & 3) == 1) && ((result << shift) == high)) {
+        result &= ~(uint64_t)1;
+    }
+    result += result & 1;
+    result >>= 1;
+    if (result >= ((uint64_t)2 << ECJP_DOUBLE_MANTISSA_BITS)) {
+        result = (uint64_t)1 << ECJP_DOUBLE_MANTISSA_BITS;
+        power2++;
+    }
+    result &= ~((uint64_t)1 << ECJP_DOUBLE_MANTISSA_BITS);
+    if (power2 >= ECJP_DOUBLE_INFINITE_POWER) {
+        power2 = ECJP_DOUBLE_INFINITE_POWER;
+        result = 0;
+    }
+    *value = ecjp_make_double(negative, power2, result);
+    return 0;
+}
+#endif // ECJP_HAVE_EISEL_LEMIRE
+
+/*
+ * Function: ecjp_number_to_double()
+        This function computes the double nearest to a number found by ecjp_scan_number().
+        Parameters:
+        - input: The input string.
+        - parts: Pointer to the parts of the number.
+        Returns:
+        - The double nearest to the number (infinity if it's too large).
+*/
+static double ecjp_number_to_double(const char *input, const ecjp_number_parts_t *parts)
+{
+    double value;
+#ifdef ECJP_HAVE_EISEL_LEMIRE
+    double value_up;
+#endif
+
+    if (parts->mantissa == 0) {
+        // no significant digits (a truncated mantissa starts with a non-zero digit)
+        return ecjp_make_double(parts->negative, 0, 0);
+    }
+#if defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD == 0)
+    // the mantissa and the power of 10 are exact doubles, a single operation rounds the result
+    if (!parts->truncated && (parts->exponent >= -22) && (parts->exponent <= 22) &&
+        (parts->mantissa <= ((uint64_t)1 << (ECJP_DOUBLE_MANTISSA_BITS + 1)))) {
+        value = (double)parts->mantissa;
+        if (parts->exponent < 0) {
+            value /= ecjp_exact_pow10[-parts->exponent];
+        } else {
+            value *= ecjp_exact_pow10[parts->exponent];
+        }
+        return parts->negative ? -value : value;
+    }
+#endif
+#ifdef ECJP_HAVE_EISEL_LEMIRE
+    if (ecjp_eisel_lemire(parts->exponent, parts->mantissa, parts->negative, &value) == 0) {
+        // the number is between mantissa and mantissa + 1: the result is certain if both give it
+        if (!parts->truncated) {
+            return value;
+        }
+        if ((ecjp_eisel_lemire(parts->exponent, parts->mantissa + 1, parts->negative, &value_up) == 0) && (value == value_up)) {
+            return value;
+        }
+    }
+#endif
+    return ecjp_decimal_to_double(input, parts);
+}
+
+/*
+ * Function: ecjp_decode_number()
+        This function stores a number found by ecjp_scan_number() in the number structure.
+*/
+static void ecjp_decode_number(const char *input, const ecjp_number_parts_t *parts, ecjp_number_t *number)
+{
+    // integers that fit 64 bits, the minimum is -2^63
+    if (parts->integer && !parts->truncated &&
+        (parts->mantissa <= (parts->negative ? ((uint64_t)INT64_MAX + 1) : (uint64_t)INT64_MAX))) {
+        number->kind = ECJP_NUMBER_INTEGER;
+        if (parts->negative) {
+            number->integer = (parts->mantissa == (uint64_t)INT64_MAX + 1) ? INT64_MIN : -(int64_t)parts->mantissa;
+        } else {
+            number->integer = (int64_t)parts->mantissa;
+        }
+        number->real = ((parts->mantissa == 0) && parts->negative) ? ecjp_make_double(ECJP_BOOL_TRUE, 0, 0) : (double)number->integer;
+        return;
+    }
+    number->kind = ECJP_NUMBER_REAL;
+    number->real = ecjp_number_to_double(input, parts);
+    number->integer = 0;
+}
+
+/*
+    Function: ecjp_read_number()
+        This function checks and decodes a JSON number in a single walk over its characters,
+        without copying it and without the C library: the result doesn't depend on the locale.
+        Parameters:
+        - input: The characters of the number (e.g. the view of a value); they don't need to be NUL-terminated.
+        - len: The number of characters.
+        - number: Pointer to the structure to store the number: an integer without fraction and
+          exponent that fits 64 bits is stored in integer (kind ECJP_NUMBER_INTEGER); every number
+          is stored in real, rounded to the nearest double (infinity if it's too large).
+        Returns:
+        - ECJP_NO_ERROR on success.
+        - ECJP_NULL_POINTER if any input pointer is NULL.
+        - ECJP_EMPTY_STRING if len is 0.
+        - ECJP_SYNTAX_ERROR if the characters are not exactly one JSON number.
+*/
+ecjp_return_code_t ecjp_read_number(const char *input, size_t len, ecjp_number_t *number)
+{
+    ecjp_number_parts_t parts;
+    int pos = 0;
+
+    if (input == NULL || number == NULL) {
+        return ECJP_NULL_POINTER;
+    }
+    if (len == 0) {
+        return ECJP_EMPTY_STRING;
+    }
+    if ((len > INT_MAX) || (ecjp_scan_number(input, (int)len, &pos, &parts) == ECJP_BOOL_FALSE) || ((size_t)pos != len)) {
+        ecjp_printf("%s - %d: Number not valid at position %d\n",__FUNCTION__,__LINE__,pos);
+        return ECJP_SYNTAX_ERROR;
+    }
+    ecjp_decode_number(input, &parts, number);
+    return ECJP_NO_ERROR;
+}
+
+/*
+ * String decoding
+ * The characters of a string are copied in runs: a kernel finds the first quote, backslash
+ * or control character and copies the characters before it, many bytes at a time (the
+ * kernel is selected with the SIMD level, see ecjp_set_simd_level()). Only the escape
+ * sequences are decoded one at a time, \uXXXX (and the surrogate pairs) as UTF-8.
+*/
+
+#define ECJP_STRING_WINDOW              256     // characters checked at a time in a NUL-terminated input
+
+// copies the plain characters of a string (not quote, backslash or control) and returns their number
+typedef size_t (*ecjp_copy_plain_fn_t)(const char *src, size_t len, char *dst);
+
+/*
+ * Function: ecjp_is_plain_char()
+        This function checks if a character of a string is copied by the kernels: not a quote,
+        a backslash, a character less than 0x20 or DEL.
+*/
+static inline ecjp_bool_t ecjp_is_plain_char(char c)
+{
+    if ((c == '"') || (c == '\\') || ((unsigned char)c < 0x20) || (c == 0x7F)) {
+        return ECJP_BOOL_FALSE;
+    }
+    return ECJP_BOOL_TRUE;
+}
+
+/*
+ * Function: ecjp_copy_plain_swar()
+        Portable kernel: checks 8 characters at a time in a 64 bit word. A byte is flagged when
+        it's a quote, a backslash, less than 0x20 or DEL; the flags can be wrong only after the
+        first flagged byte, so the lowest one is exact.
+        Parameters:
+        - src: The characters of the string.
+        - len: The number of characters that can be read (and written to dst).
+        - dst: Pointer to the destination, NULL to count the characters only.
+        Returns:
+        - The number of plain characters at the start of src.
+*/
+static size_t ecjp_copy_plain_swar(const char *src, size_t len, char *dst)
+{
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t high = 0x8080808080808080ULL;
+    uint64_t v, q, b, d, flags;
+    size_t n = 0;
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    while (n + 8 <= len) {
+        memcpy(&v, &src[n], 8);
+        q = v ^ (ones * '"');
+        b = v ^ (ones * '\\');
+        d = v ^ (ones * 0x7F);
+        flags = (((q - ones) & ~q) | ((b - ones) & ~b) | ((d - ones) & ~d) | ((v - ones * 0x20) & ~v)) & high;
+        if (dst != NULL) {
+            memcpy(&dst[n], &v, 8);
+        }
+        if (flags != 0) {
+            return n + (ecjp_ctz64(flags) >> 3);
+        }
+        n += 8;
+    }
+#endif
+    while ((n < len) && ecjp_is_plain_char(src[n])) {
+        if (dst != NULL) {
+            dst[n] = src[n];
+        }
+        n++;
+    }
+    return n;
+}
+
+#ifdef ECJP_HAVE_X86_SIMD
+
+/*
+ * Function: ecjp_copy_plain_sse2()
+        SSE2 kernel: checks and copies 16 characters at a time. See ecjp_copy_plain_swar().
+*/
+__attribute__((target("sse2")))
+static size_t ecjp_copy_plain_sse2(const char *src, size_t len, char *dst)
+{
+    __m128i v, stop;
+    unsigned int mask;
+    size_t n = 0;
+
+    while (n + 16 <= len) {
+        v = _mm_loadu_si128((const __m128i *)&src[n]);
+        // unsigned v <= 0x1F, quote, backslash and DEL
+        stop = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))),
+                            _mm_or_si128(_mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8(0x1F)), _mm_set1_epi8(0x1F)),
+                                         _mm_cmpeq_epi8(v, _mm_set1_epi8(0x7F))));
+        if (dst != NULL) {
+            _mm_storeu_si128((__m128i *)&dst[n], v);
+        }
+        mask = (unsigned int)_mm_movemask_epi8(stop);
+        if (mask != 0) {
+            return n + ecjp_ctz64(mask);
+        }
+        n += 16;
+    }
+    return n + ecjp_copy_plain_swar(&src[n], len - n, (dst != NULL) ? &dst[n] : NULL);
+}
+
+/*
+ * Function: ecjp_copy_plain_avx2()
+        AVX2 kernel: checks and copies 32 characters at a time. See ecjp_copy_plain_swar().
+*/
+__attribute__((target("avx2")))
+static size_t ecjp_copy_plain_avx2(const char *src, size_t len, char *dst)
+{
+    __m256i v, stop;
+    unsigned int mask;
+    size_t n = 0;
+
+    while (n + 32 <= len) {
+        v = _mm256_loadu_si256((const __m256i *)&src[n]);
+        stop = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))),
+                               _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(v, _mm256_set1_epi8(0x1F)), _mm256_set1_epi8(0x1F)),
+                                               _mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x7F))));
+        if (dst != NULL) {
+            _mm256_storeu_si256((__m256i *)&dst[n], v);
+        }
+        mask = (unsigned int)_mm256_movemask_epi8(stop);
+        if (mask != 0) {
+            return n + ecjp_ctz64(mask);
+        }
+        n += 32;
+    }
+    return n + ecjp_copy_plain_sse2(&src[n], len - n, (dst != NULL) ? &dst[n] : NULL);
+}
+
+#endif // ECJP_HAVE_X86_SIMD
+
+// the AVX-512 level uses the AVX2 kernel: strings are short compared to the blocks of stage 1
+static const ecjp_copy_plain_fn_t ecjp_copy_plain_kernel[ECJP_SIMD_MAX_LEVEL] = {
+    ecjp_copy_plain_swar,
+#ifdef ECJP_HAVE_X86_SIMD
+    ecjp_copy_plain_sse2,
+    ecjp_copy_plain_avx2,
+    ecjp_copy_plain_avx2
+#else
+    NULL,
+    NULL,
+    NULL
+#endif
+};
+
+/*
+ * Function: ecjp_read_hex4()
+        This function decodes the 4 hex digits of a \uXXXX escape sequence.
+        Returns:
+        - The code unit, or -1 if a character is not a hex digit.
+*/
+static long ecjp_read_hex4(const char *src)
+{
+    long value = 0;
+    int i;
+    char c;
+
+    for (i = 0; i < 4; i++) {
+        c = src[i];
+        if ((c >= '0') && (c <= '9')) {
+            value = (value << 4) | (c - '0');
+        } else if ((c >= 'a') && (c <= 'f')) {
+            value = (value << 4) | (c - 'a' + 10);
+        } else if ((c >= 'A') && (c <= 'F')) {
+            value = (value << 4) | (c - 'A' + 10);
+        } else {
+            return -1;
+        }
+    }
+    return value;
+}
+
+/*
+ * Function: ecjp_decode_escape()
+        This function decodes an escape sequence as UTF-8. A surrogate pair is decoded as a
+        single code point; a surrogate without its pair is replaced by U+FFFD.
+        Parameters:
+        - src: Pointer to the backslash.
+        - len: The number of characters that can be read from src.
+        - out: Pointer to the buffer for the UTF-8 bytes (4 bytes at least).
+        - n_out: Pointer to store the number of UTF-8 bytes.
+        Returns:
+        - The number of characters of the escape sequence, 0 if the sequence is not valid.
+*/
+static size_t ecjp_decode_escape(const char *src, size_t len, char *out, int *n_out)
+{
+    unsigned long cp;
+    long low;
+    size_t used;
+
+    if (len < 2) {
+        return 0;
+    }
+    *n_out = 1;
+    switch (src[1]) {
+        case '"':
+        case '\\':
+        case '/':
+            out[0] = src[1];
+            return 2;
+        case 'b':
+            out[0] = '\b';
+            return 2;
+        case 'f':
+            out[0] = '\f';
+            return 2;
+        case 'n':
+            out[0] = '\n';
+            return 2;
+        case 'r':
+            out[0] = '\r';
+            return 2;
+        case 't':
+            out[0] = '\t';
+            return 2;
+        case 'u':
+            break;
+        default:
+            return 0;
+    }
+    if ((len < 6) || (ecjp_read_hex4(&src[2]) < 0)) {
+        return 0;
+    }
+    cp = (unsigned long)ecjp_read_hex4(&src[2]);
+    used = 6;
+    if ((cp >= 0xD800) && (cp <= 0xDBFF)) {
+        // high surrogate: the low one must follow
+        low = ((len >= 12) && (src[6] == '\\') && (src[7] == 'u')) ? ecjp_read_hex4(&src[8]) : -1;
+        if ((low >= 0xDC00) && (low <= 0xDFFF)) {
+            cp = 0x10000 + ((cp - 0xD800) << 10) + ((unsigned long)low - 0xDC00);
+            used = 12;
+        } else {
+            cp = 0xFFFD;
+        }
+    } else if ((cp >= 0xDC00) && (cp <= 0xDFFF)) {
+        cp = 0xFFFD;
+    }
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+    } else if (cp < 0x800) {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        *n_out = 2;
+    } else if (cp < 0x10000) {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        *n_out = 3;
+    } else {
+        out[0] = (char)(0xF0 | (cp >> 18));
+        out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+        out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[3] = (char)(0x80 | (cp & 0x3F));
+        *n_out = 4;
+    }
+    return used;
+}
+
+/*
+ * Function: ecjp_internal_read_string()
+        This function decodes the characters of a string, from the first character after the
+        opening quote to the closing quote (or to len).
+        Parameters:
+        - input: The first character of the string after the opening quote.
+        - len: The number of characters that can be read, SIZE_MAX if the input is NUL-terminated.
+        - need_quote: ECJP_BOOL_TRUE if the string must end with a quote before len.
+        - buffer: The buffer for the decoded string, NULL if only a string without escapes is expected.
+        - buffer_size: The size of the buffer.
+        - string: Pointer to the structure to store the decoded string.
+        Returns:
+        - See ecjp_read_string().
+*/
+static ecjp_return_code_t ecjp_internal_read_string(const char *input, size_t len, ecjp_bool_t need_quote,
+                                                    char *buffer, size_t buffer_size, ecjp_string_t *string)
+{
+    ecjp_copy_plain_fn_t copy_plain = ecjp_copy_plain_kernel[ecjp_get_simd_level()];
+    char utf8[4];
+    char *dst = buffer;
+    size_t room = (buffer_size > 0) ? (buffer_size - 1) : 0;     // the NUL terminator is always added
+    size_t i = 0;
+    size_t w = 0;
+    size_t n, max;
+    int n_out;
+
+    string->ptr = NULL;
+    string->len = 0;
+    string->raw_len = 0;
+    string->escaped = ECJP_BOOL_FALSE;
+    if ((buffer == NULL) || (buffer_size == 0)) {
+        // no room for the NUL terminator: the characters are only counted
+        dst = NULL;
+        room = 0;
+    }
+    while (1) {
+        // a NUL-terminated input is read by windows that end before the '\0'
+        max = (len == SIZE_MAX) ? strnlen(&input[i], ECJP_STRING_WINDOW) : (len - i);
+        // run of plain characters: copied while they fit in the buffer, then only counted
+        if (dst != NULL) {
+            n = copy_plain(&input[i], (max < (room - w)) ? max : (room - w), &dst[w]);
+        } else {
+            n = copy_plain(&input[i], max, NULL);
+        }
+        i += n;
+        w += n;
+        if ((i >= len) || (input[i] == '"')) {
+            break;
+        }
+        if (input[i] == '\\') {
+            n = ecjp_decode_escape(&input[i], len - i, utf8, &n_out);
+            if (n == 0) {
+                ecjp_printf("%s - %d: Escape sequence not valid at position %zu\n",__FUNCTION__,__LINE__,i);
+                return ECJP_SYNTAX_ERROR;
+            }
+            if ((dst != NULL) && (w + n_out <= room)) {
+                memcpy(&dst[w], utf8, n_out);
+            } else {
+                dst = NULL;
+            }
+            string->escaped = ECJP_BOOL_TRUE;
+            i += n;
+            w += n_out;
+        } else if (ecjp_is_ctrl(input[i]) == ECJP_BOOL_TRUE) {
+            ecjp_printf("%s - %d: Control character at position %zu\n",__FUNCTION__,__LINE__,i);
+            return ECJP_SYNTAX_ERROR;
+        } else {
+            // tab, newline and carriage return stop the kernels, or the buffer is full
+            if ((dst != NULL) && (w < room)) {
+                dst[w] = input[i];
+            } else {
+                dst = NULL;
+            }
+            i++;
+            w++;
+        }
+    }
+    if (need_quote && (i >= len)) {
+        ecjp_printf("%s - %d: Closing quote not found\n",__FUNCTION__,__LINE__);
+        return ECJP_SYNTAX_ERROR;
+    }
+    string->len = w;
+    string->raw_len = i;
+    if ((buffer == NULL) && !string->escaped) {
+        // zero-copy: the input is the decoded string
+        string->ptr = input;
+        return ECJP_NO_ERROR;
+    }
+    if ((buffer == NULL) || (dst == NULL) || (w > room)) {
+        return ECJP_NO_SPACE_IN_BUFFER_VALUE;
+    }
+    buffer[w] = '\0';
+    string->ptr = buffer;
+    return ECJP_NO_ERROR;
+}
+
+/*
+    Function: ecjp_read_string()
+        This function decodes a JSON string into UTF-8: all the escape sequences are decoded,
+        \uXXXX as UTF-8 and a surrogate pair as a single code point (a surrogate without its pair
+        is replaced by U+FFFD). The runs of characters without escapes are copied many bytes at a time.
+        Parameters:
+        - input: The first character of the string after the opening quote (e.g. the view of a string value);
+          it doesn't need to be NUL-terminated.
+        - len: The number of characters that can be read: the string ends at the first quote that is not
+          escaped, or after len characters.
+        - buffer: The buffer for the decoded string, NUL-terminated; NULL to decode only the strings
+          without escapes, which are returned without copying them.
+        - buffer_size: The size of the buffer.
+        - string: Pointer to the structure to store the decoded string: ptr and len of the decoded
+          characters (in buffer, or in the input if buffer is NULL), raw_len the characters read from
+          the input and escaped ECJP_BOOL_FALSE if the input is already the decoded string.
+        Returns:
+        - ECJP_NO_ERROR on success.
+        - ECJP_NULL_POINTER if any input pointer is NULL.
+        - ECJP_SYNTAX_ERROR if an escape sequence is not valid or a control character is found.
+        - ECJP_NO_SPACE_IN_BUFFER_VALUE if the decoded string doesn't fit in the buffer (or buffer is NULL
+          and the string has escapes): string->len is the length needed, without the NUL terminator.
+*/
+ecjp_return_code_t ecjp_read_string(const char *input, size_t len, char *buffer, size_t buffer_size, ecjp_string_t *string)
+{
+    if (input == NULL || string == NULL) {
+        return ECJP_NULL_POINTER;
+    }
+    return ecjp_internal_read_string(input, len, ECJP_BOOL_FALSE, buffer, buffer_size, string);
+}
+
+/*
+ * Tape of a whole document
+ * The input is parsed once and every key, value, object and array is appended to a flat
+ * array of entries. The entry of an object or array is completed when its closing bracket
+ * is found: the position of its closing bracket gives its length and the number of entries
+ * loaded so far the index of the entry after its content.
+*/
+
+/*
+ * Function: ecjp_tape_add()
+        This function appends an entry to the tape, in O(1) amortized time.
+        The capacity of the tape is doubled when it's full.
+        Parameters:
+        - tape: Pointer to the tape.
+        - pos: The position of the first character of the entry in the input string.
+        - length: The number of characters of the entry.
+        - type: The type of the entry.
+        Returns:
+        - 0 on success.
+        - -1 on memory allocation failure.
+*/
+static int ecjp_tape_add(ecjp_tape_t *tape, int pos, int length, ecjp_value_type_t type)
+{
+    ecjp_tape_entry_t *grown;
+    ecjp_tape_entry_t *e;
+    int capacity;
+
+    if (tape->count == tape->capacity) {
+        capacity = (tape->capacity == 0) ? ECJP_LIST_MIN_CAPACITY : (tape->capacity * 2);
+        grown = (ecjp_tape_entry_t *)ecjp_realloc(tape->entry, capacity * sizeof(ecjp_tape_entry_t));
+        if (!grown)
+            return -1;
+        tape->entry = grown;
+        tape->capacity = capacity;
+    }
+    e = &tape->entry[tape->count];
+    e->pos = (unsigned int)pos;
+    e->length = (unsigned int)length;
+    e->next = tape->count + 1;
+    e->type = (unsigned char)type;
+    tape->count++;
+    ECJP_STATS_ADD(nodes_allocated, 1);
+    return 0;
+}
+
+/*
+ * Function: ecjp_tape_scan_string()
+        This function checks a string, from its opening quote to its closing quote.
+        Parameters:
+        - s: Pointer to the stage 1 data of the input.
+        - pos: Pointer to the position of the opening quote; on return, the position of the
+          closing quote, or of the wrong character if the string is not valid.
+        Returns:
+        - ECJP_BOOL_TRUE if the string is valid.
+        - ECJP_BOOL_FALSE otherwise.
+*/
+static ecjp_bool_t ecjp_tape_scan_string(ecjp_stage1_t *s, int *pos)
+{
+    int i = *pos + 1;
+    int k;
+
+    while (1) {
+        // jump over the characters that don't need a check
+        i = ecjp_skip_plain(s, i);
+        if (i >= s->len) {
+            break;
+        }
+        if (s->input[i] == '"') {
+            *pos = i;
+            return ECJP_BOOL_TRUE;
+        }
+        if (s->input[i] != '\\') {
+            // control character
+            break;
+        }
+        i++;
+        if (i >= s->len) {
+            break;
+        }
+        switch (s->input[i]) {
+            case '"':
+            case '\\':
+            case '/':
+            case 'b':
+            case 'f':
+            case 'n':
+            case 'r':
+            case 't':
+                i++;
+                break;
+
+            case 'u':
+                for (k = 1; k <= 4; k++) {
+                    if ((i + k >= s->len) || (ecjp_is_excode(s->input[i + k]) == ECJP_BOOL_FALSE)) {
+                        *pos = i + k;
+                        return ECJP_BOOL_FALSE;
+                    }
+                }
+                i += 5;
+                break;
+
+            default:
+                *pos = i;
+                return ECJP_BOOL_FALSE;
+        }
+    }
+    *pos = i;
+    return ECJP_BOOL_FALSE;
+}
+
+/*
+    Function: ecjp_internal_load_tape()
+        This function checks the syntax of a JSON-like input string and loads the tape of the whole document
+        in a single pass.
+        Parameters:
+        - input: The JSON-like input string.
+        - len: The length of the input string; a '\0' found before len is a syntax error.
+        - tape: Pointer to the tape to load, initialized with ecjp_init_tape().
+        - res: Pointer to a structure to store the result of the check, including any error position.
+        - utf8: ECJP_BOOL_TRUE to validate the input as UTF-8 (see ecjp_ctx_t).
+        Returns:
+        - ECJP_NO_ERROR if the input string is valid and the tape is loaded.
+        - ECJP_NULL_POINTER if any input pointer is NULL.
+        - ECJP_EMPTY_STRING if the input string is empty.
+        - ECJP_SYNTAX_ERROR if there is a syntax error in the input string.
+        - ECJP_BRACKETS_MISSING if the input ends before all objects and arrays are closed.
+        - ECJP_GENERIC_ERROR on memory allocation failure.
+*/
+static ecjp_return_code_t ecjp_internal_load_tape(const char *input, size_t len, ecjp_tape_t *tape, ecjp_check_result_t *res, ecjp_bool_t utf8)
+{
+    int stack[ECJP_MAX_PARSE_STACK_DEPTH];
+    int top = -1;
+    int pos, end, num_keys;
+    ecjp_parse_tape_status_t status;
+    ecjp_tape_entry_t *container;
+    ecjp_stage1_t stage1;
+    char c;
+
+    if (input == NULL || tape == NULL || res == NULL) {
+        ecjp_printf("%s - %d: NULL pointer input/tape/res",__FUNCTION__,__LINE__);
+        return ECJP_NULL_POINTER;
+    }
+    res->err_pos = -1;
+    res->num_keys = 0;
+    res->struct_type = ECJP_ST_NULL;
+    tape->count = 0;
+    if (len == 0) {
+        ecjp_printf("%s - %d: Empty input string\n", __FUNCTION__,__LINE__);
+        return ECJP_EMPTY_STRING;
+    }
+
+    ecjp_stage1_init(&stage1, input, (int)len, utf8);
+    ECJP_STATS_ADD(bytes_scanned, len);
+    num_keys = 0;
+    status = ECJP_PT_START;
+    pos = ecjp_skip_whitespace(&stage1, 0);
+    while ((pos < (int)len) && (status != ECJP_PT_ERROR)) {
+        c = input[pos];
+#ifdef DEBUG_VERBOSE
+        ecjp_printf("%s - %d: Index %d, Status %d, Char '%c'\n", __FUNCTION__,__LINE__, pos, status, c);
+#endif
+        switch (status) {
+            case ECJP_PT_WAIT_KEY_OR_END:
+            case ECJP_PT_WAIT_KEY:
+                if (c == '"') {
+                    end = pos;
+                    if (ecjp_tape_scan_string(&stage1, &end) == ECJP_BOOL_FALSE) {
+                        pos = end;
+                        status = ECJP_PT_ERROR;
+                        break;
+                    }
+                    if (ecjp_tape_add(tape, pos + 1, end - pos - 1, ECJP_TYPE_KEY) != 0) {
+                        return ECJP_GENERIC_ERROR;
+                    }
+                    num_keys++;
+                    pos = end + 1;
+                    status = ECJP_PT_WAIT_COLON;
+                } else if ((c == '}') && (status == ECJP_PT_WAIT_KEY_OR_END)) {
+                    // empty object, closed below
+                    status = ECJP_PT_WAIT_COMMA_OR_END;
+                    continue;
+                } else {
+                    ecjp_printf("%s - %d: Character %c unexpected, key expected\n", __FUNCTION__,__LINE__,c);
+                    status = ECJP_PT_ERROR;
+                }
+                break;
+
+            case ECJP_PT_WAIT_COLON:
+                if (c == ':') {
+                    pos++;
+                    status = ECJP_PT_WAIT_VALUE;
+                } else {
+                    ecjp_printf("%s - %d: Character %c unexpected, colon expected\n", __FUNCTION__,__LINE__,c);
+                    status = ECJP_PT_ERROR;
+                }
+                break;
+
+            case ECJP_PT_START:
+            case ECJP_PT_WAIT_VALUE_OR_END:
+            case ECJP_PT_WAIT_VALUE:
+                if ((status == ECJP_PT_START) && (c != '{') && (c != '[')) {
+                    ecjp_printf("%s - %d: Input must start with '{' or '['\n", __FUNCTION__,__LINE__);
+                    status = ECJP_PT_ERROR;
+                    break;
+                }
+                switch (c) {
+                    case '{':
+                    case '[':
+                        if (top >= ECJP_MAX_PARSE_STACK_DEPTH - 1) {
+                            ecjp_printf("%s - %d: Parse stack overflow\n", __FUNCTION__,__LINE__);
+                            status = ECJP_PT_ERROR;
+                            break;
+                        }
+                        if (ecjp_tape_add(tape, pos, 0, (c == '{') ? ECJP_TYPE_OBJECT : ECJP_TYPE_ARRAY) != 0) {
+                            return ECJP_GENERIC_ERROR;
+                        }
+                        if (top < 0) {
+                            res->struct_type = (c == '{') ? ECJP_ST_OBJ : ECJP_ST_ARRAY;
+                        }
+                        stack[++top] = tape->count - 1;
+                        ECJP_STATS_DEPTH(top + 1);
+                        pos++;
+                        status = (c == '{') ? ECJP_PT_WAIT_KEY_OR_END : ECJP_PT_WAIT_VALUE_OR_END;
+                        break;
+
+                    case ']':
+                        if (status != ECJP_PT_WAIT_VALUE_OR_END) {
+                            ecjp_printf("%s - %d: Value expected before closing square bracket\n", __FUNCTION__,__LINE__);
+                            status = ECJP_PT_ERROR;
+                            break;
+                        }
+                        // empty array, closed below
+                        status = ECJP_PT_WAIT_COMMA_OR_END;
+                        continue;
+
+                    case '"':
+                        end = pos;
+                        if (ecjp_tape_scan_string(&stage1, &end) == ECJP_BOOL_FALSE) {
+                            pos = end;
+                            status = ECJP_PT_ERROR;
+                            break;
+                        }
+                        if (ecjp_tape_add(tape, pos + 1, end - pos - 1, ECJP_TYPE_STRING) != 0) {
+                            return ECJP_GENERIC_ERROR;
+                        }
+                        pos = end + 1;
+                        status = ECJP_PT_WAIT_COMMA_OR_END;
+                        break;
+
+                    case 't':
+                    case 'f':
+                    case 'n':
+                        end = (c == 'f') ? 5 : 4;
+                        if (!ecjp_has_chars(&input[pos], input + len, end) ||
+                            (strncmp(&input[pos], (c == 't') ? "true" : ((c == 'f') ? "false" : "null"), end) != 0)) {
+                            ecjp_printf("%s - %d: Character %c unexpected\n", __FUNCTION__,__LINE__,c);
+                            status = ECJP_PT_ERROR;
+                            break;
+                        }
+                        if (ecjp_tape_add(tape, pos, end, (c == 'n') ? ECJP_TYPE_NULL : ECJP_TYPE_BOOL) != 0) {
+                            return ECJP_GENERIC_ERROR;
+                        }
+                        pos += end;
+                        status = ECJP_PT_WAIT_COMMA_OR_END;
+                        break;
+
+                    default:
+                        end = pos;
+                        if (((c != '-') && ((c < '0') || (c > '9'))) || (ecjp_scan_number(input, (int)len, &end, NULL) == ECJP_BOOL_FALSE)) {
+                            ecjp_printf("%s - %d: Character %c unexpected, value expected\n", __FUNCTION__,__LINE__,c);
+                            pos = end;
+                            status = ECJP_PT_ERROR;
+                            break;
+                        }
+                        if (ecjp_tape_add(tape, pos, end - pos, ECJP_TYPE_NUMBER) != 0) {
+                            return ECJP_GENERIC_ERROR;
+                        }
+                        pos = end;
+                        status = ECJP_PT_WAIT_COMMA_OR_END;
+                        break;
+                }
+                break;
+
+            case ECJP_PT_WAIT_COMMA_OR_END:
+                container = &tape->entry[stack[top]];
+                if (c == ',') {
+                    pos++;
+                    status = (container->type == ECJP_TYPE_OBJECT) ? ECJP_PT_WAIT_KEY : ECJP_PT_WAIT_VALUE;
+                } else if (((c == '}') && (container->type == ECJP_TYPE_OBJECT)) ||
+                           ((c == ']') && (container->type == ECJP_TYPE_ARRAY))) {
+                    // complete the container: its content ends with the last entry loaded
+                    container->length = (unsigned int)pos - container->pos + 1;
+                    container->next = tape->count;
+                    top--;
+                    pos++;
+                    status = (top < 0) ? ECJP_PT_END : ECJP_PT_WAIT_COMMA_OR_END;
+                } else {
+                    ecjp_printf("%s - %d: Character %c unexpected, comma or closing bracket expected\n", __FUNCTION__,__LINE__,c);
+                    status = ECJP_PT_ERROR;
+                }
+                break;
+
+            case ECJP_PT_END:
+            default:
+                ecjp_printf("%s - %d: Character %c unexpected after the end of the structure\n", __FUNCTION__,__LINE__,c);
+                status = ECJP_PT_ERROR;
+                break;
+        }
+        if (status != ECJP_PT_ERROR) {
+            pos = ecjp_skip_whitespace(&stage1, pos);
+        }
+    }
+
+    res->num_keys = (ECJP_TYPE_POS_KEY)num_keys;
+    res->memory_used = tape->capacity * (int)sizeof(ecjp_tape_entry_t);
+    if (status == ECJP_PT_ERROR) {
+        res->err_pos = pos;
+        return ECJP_SYNTAX_ERROR;
+    }
+    if (status == ECJP_PT_START) {
+        ecjp_printf("%s - %d: Empty input string\n", __FUNCTION__,__LINE__);
+        return ECJP_EMPTY_STRING;
+    }
+    if (status != ECJP_PT_END) {
+        ecjp_printf("%s - %d: Mismatched brackets at end of input\n", __FUNCTION__,__LINE__);
+        res->err_pos = (int)len;
+        return ECJP_BRACKETS_MISSING;
+    }
+    if (ecjp_stage1_utf8_error(&stage1) >= 0) {
+        res->err_pos = stage1.utf8_err_pos;
+        ecjp_printf("%s - %d: Invalid UTF-8 sequence at position %d\n", __FUNCTION__,__LINE__, res->err_pos);
+        return ECJP_SYNTAX_ERROR;
+    }
+    return ECJP_NO_ERROR;
+}
+
+/*
+    Function: ecjp_init_tape()
+        This function initializes an empty tape.
+        Parameters:
+        - tape: Pointer to the tape.
+        Returns:
+        - ECJP_NO_ERROR on success.
+        - ECJP_NULL_POINTER if tape is NULL.
+*/
+ecjp_return_code_t ecjp_init_tape(ecjp_tape_t *tape)
+{
+    if (tape == NULL) {
+        return ECJP_NULL_POINTER;
+    }
+    memset(tape, 0, sizeof(ecjp_tape_t));
+    return ECJP_NO_ERROR;
+}
+
+/*
+    Function: ecjp_free_tape()
+        This function frees the memory allocated for a tape and leaves it empty.
+        Parameters:
+        - tape: Pointer to the tape.
+        Returns:
+        - ECJP_NO_ERROR on success.
+*/
+ecjp_return_code_t ecjp_free_tape(ecjp_tape_t *tape)
+{
+    if (tape == NULL) {
+        return ECJP_NO_ERROR;
+    }
+    ecjp_free(tape->entry);
+    tape->entry = NULL;
+    tape->capacity = 0;
+    tape->count = 0;
+    return ECJP_NO_ERROR;
+}
+
+/*
+    Function: ecjp_load_tape()
+        This function checks the syntax of a NUL-terminated JSON-like input string and loads the tape
+        of the whole document. The memory of the tape is reused if it's loaded again.
+        See ecjp_internal_load_tape().
+*/
+ecjp_return_code_t ecjp_load_tape(const char *input, ecjp_tape_t *tape, ecjp_check_result_t *res)
+{
+    return ecjp_internal_load_tape(input, (input != NULL) ? strlen(input) : 0, tape, res, ECJP_BOOL_FALSE);
+}
+
+/*
+    Function: ecjp_load_tape_n()
+        Same as ecjp_load_tape(), the input string is delimited by its length (len)
+        and doesn't need to be NUL-terminated.
+*/
+ecjp_return_code_t ecjp_load_tape_n(const char *input, size_t len, ecjp_tape_t *tape, ecjp_check_result_t *res)
+{
+    return ecjp_internal_load_tape(input, len, tape, res, ECJP_BOOL_FALSE);
+}
+
+/*
+    Function: ecjp_load_tape_ctx()
+        Same as ecjp_load_tape_n(), the input is validated as UTF-8 if the utf8_validation
+        field of the context is set.
+        The call counts in the counters of the context (see ecjp_get_stats()).
+        Returns also:
+        - ECJP_NULL_POINTER if ctx is NULL.
+*/
+ecjp_return_code_t ecjp_load_tape_ctx(ecjp_ctx_t *ctx, const char *input, size_t len, ecjp_tape_t *tape, ecjp_check_result_t *res)
+{
+    ecjp_return_code_t ret;
+#ifdef ECJP_STATS
+    ecjp_stats_t *stats_prev = ecjp_stats_cur;
+#endif
+
+    if (ctx == NULL) {
+        ecjp_printf("%s - %d: NULL pointer ctx\n",__FUNCTION__,__LINE__);
+        return ECJP_NULL_POINTER;
+    }
+    ECJP_STATS_USE(&ctx->stats);
+    ret = ecjp_internal_load_tape(input, len, tape, res, ctx->utf8_validation);
+    ECJP_STATS_USE(stats_prev);
+    return ret;
+}
+
+/*
+    Function: ecjp_tape_find_key()
+        This function finds a key by name among the keys of an object of the tape.
+        The values of the object are skipped with their next index, so only the keys of the object
+        are compared (not the keys of the nested objects).
+        The whole name must match and it's compared with the characters of the key in the input string
+        (escape sequences are not decoded); if the name is duplicated, the first key is found.
+        Parameters:
+        - tape: Pointer to the tape loaded by ecjp_load_tape().
+        - input: The JSON-like input string used to load the tape.
+        - object: The index of the entry of the object.
+        - key: The name of the key to search for.
+        - entry: Pointer to store the index of the entry of the value of the key.
+        Returns:
+        - ECJP_NO_ERROR if the key is found.
+        - ECJP_NULL_POINTER if any input pointer is NULL.
+        - ECJP_INDEX_OUT_OF_BOUNDS if object is not the index of an object.
+        - ECJP_NO_MORE_KEY if the object has no key with this name.
+*/
+ecjp_return_code_t ecjp_tape_find_key(const ecjp_tape_t *tape, const char *input, int object, const char *key, int *entry)
+{
+    const ecjp_tape_entry_t *e;
+    size_t len;
+    int i;
+
+    if (tape == NULL || input == NULL || key == NULL || entry == NULL) {
+        return ECJP_NULL_POINTER;
+    }
+    if ((object < 0) || (object >= tape->count) || (tape->entry[object].type != ECJP_TYPE_OBJECT)) {
+        return ECJP_INDEX_OUT_OF_BOUNDS;
+    }
+    len = strlen(key);
+    for (i = object + 1; i < tape->entry[object].next; i = tape->entry[i + 1].next) {
+        e = &tape->entry[i];
+        if ((e->length == len) && (memcmp(&input[e->pos], key, len) == 0)) {
+            *entry = i + 1;
+            return ECJP_NO_ERROR;
+        }
+    }
+    return ECJP_NO_MORE_KEY;
+}
+
+/*
+    Function: ecjp_tape_get_element()
+        This function finds an element of an array of the tape.
+        The elements before it are skipped with their next index, without visiting their content.
+        Parameters:
+        - tape: Pointer to the tape loaded by ecjp_load_tape().
+        - array: The index of the entry of the array.
+        - index: The index of the element in the array.
+        - entry: Pointer to store the index of the entry of the element.
+        Returns:
+        - ECJP_NO_ERROR if the element is found.
+        - ECJP_NULL_POINTER if any input pointer is NULL.
+        - ECJP_INDEX_OUT_OF_BOUNDS if array is not the index of an array or the array has no element at index.
+*/
+ecjp_return_code_t ecjp_tape_get_element(const ecjp_tape_t *tape, int array, int index, int *entry)
+{
+    int i;
+
+    if (tape == NULL || entry == NULL) {
+        return ECJP_NULL_POINTER;
+    }
+    if ((array < 0) || (array >= tape->count) || (tape->entry[array].type != ECJP_TYPE_ARRAY) || (index < 0)) {
+        return ECJP_INDEX_OUT_OF_BOUNDS;
+    }
+    for (i = array + 1; i < tape->entry[array].next; i = tape->entry[i].next) {
+        if (index == 0) {
+            *entry = i;
+            return ECJP_NO_ERROR;
+        }
+        index--;
+    }
+    return ECJP_INDEX_OUT_OF_BOUNDS;
+}
+
+/*
+    Function: ecjp_tape_view()
+        This function returns the characters of an entry of the tape, without copying them.
+        Parameters:
+        - tape: Pointer to the tape loaded by ecjp_load_tape().
+        - input: The JSON-like input string used to load the tape.
+        - entry: The index of the entry.
+        - view: Pointer to the view to store the position, length and type of the entry.
+        Returns:
+        - ECJP_NO_ERROR on success.
+        - ECJP_NULL_POINTER if any input pointer is NULL.
+        - ECJP_INDEX_OUT_OF_BOUNDS if the tape has no entry at index entry.
+*/
+ecjp_return_code_t ecjp_tape_view(const ecjp_tape_t *tape, const char *input, int entry, ecjp_value_view_t *view)
+{
+    if (tape == NULL || input == NULL || view == NULL) {
+        return ECJP_NULL_POINTER;
+    }
+    if ((entry < 0) || (entry >= tape->count)) {
+        return ECJP_INDEX_OUT_OF_BOUNDS;
+    }
+    view->ptr = &input[tape->entry[entry].pos];
+    view->len = tape->entry[entry].length;
+    view->type = (ecjp_value_type_t)tape->entry[entry].type;
+    return ECJP_NO_ERROR;
+}
+
+
+/*
+ * Subtree extents
+ * The end of a value is found on the masks of stage 1: a string ends at the first character
+ * outside strings after its opening quote, an object or an array at the structural bracket
+ * that brings the depth back to zero. Quotes, brackets and escape sequences inside strings
+ * are resolved by the masks, so a subtree is skipped a block at a time.
+*/
+
+#ifndef ECJP_TOKEN_LIST
+/*
+ * Function: ecjp_skip_string()
+        This function finds the closing quote of a string on the in-string mask of stage 1.
+        The content is not checked.
+        Parameters:
+        - s: Pointer to the stage 1 data of the input.
+        - pos: The position of the opening quote.
+        Returns:
+        - The position of the closing quote, -1 if the input ends before it.
+*/
+static int ecjp_skip_string(ecjp_stage1_t *s, int pos)
+{
+    uint64_t outside;
+    int off;
+
+    pos++;
+    while (pos < s->len) {
+        while (s->block < (pos / ECJP_BLOCK_SIZE)) {
+            ecjp_stage1_next_block(s);
+        }
+        off = pos % ECJP_BLOCK_SIZE;
+        outside = (~s->in_string) >> off;
+        if (outside != 0) {
+            pos += ecjp_ctz64(outside);
+            return (pos < s->len) ? pos : -1;
+        }
+        pos += ECJP_BLOCK_SIZE - off;
+    }
+    return -1;
+}
+#endif // ECJP_TOKEN_LIST
+
+/*
+ * Function: ecjp_skip_container()
+        This function finds the end of an object or an array counting the depth of its brackets
+        on the structural mask of stage 1 (brackets inside strings are not structural).
+        The content is not checked.
+        Parameters:
+        - s: Pointer to the stage 1 data of the input.
+        - pos: The position of the opening bracket, or of a character outside strings inside the container.
+        - depth: 0 if pos is the opening bracket, 1 if pos is inside the container.
+        - stack: Pointer to a parse stack that checks the kind of each closing bracket, NULL to count the depth only.
+        Returns:
+        - The position of the closing bracket, -1 if the input ends before it (or a bracket doesn't match).
+*/
+static int ecjp_skip_container(ecjp_stage1_t *s, int pos, int depth, ecjp_parse_stack_item_t *stack)
+{
+    uint64_t structural;
+    int off, p;
+    char c;
+
+    while (pos < s->len) {
+        while (s->block < (pos / ECJP_BLOCK_SIZE)) {
+            ecjp_stage1_next_block(s);
+        }
+        off = pos % ECJP_BLOCK_SIZE;
+        structural = s->structural >> off;
+        while (structural != 0) {
+            p = pos + ecjp_ctz64(structural);
+            structural &= structural - 1;
+            c = s->input[p];
+            if ((c == '{') || (c == '[')) {
+                if ((stack != NULL) && (ecjp_push_parse_stack(stack, c) == ECJP_BOOL_FALSE)) {
+                    return -1;
+                }
+                depth++;
+            } else if ((c == '}') || (c == ']')) {
+                if ((stack != NULL) && (ecjp_pop_parse_stack(stack, (c == '}') ? '{' : '[') == ECJP_BOOL_FALSE)) {
+                    return -1;
+                }
+                if (--depth == 0) {
+                    return p;
+                }
+            }
+        }
+        pos += ECJP_BLOCK_SIZE - off;
+    }
+    return -1;
+}
+
+/*
+ * Function: ecjp_skip_value()
+        This function finds the characters of the value that starts at pos.
+        Parameters:
+        - s: Pointer to the stage 1 data of the input.
+        - pos: The position of the first character of the value.
+        - view: Pointer to the view to store the position, length and type of the value.
+        Returns:
+        - The position of the first character after the value, -1 if the value is not valid.
+*/
+static int ecjp_skip_value(ecjp_stage1_t *s, int pos, ecjp_value_view_t *view)
+{
+    const char *input = s->input;
+    int end = pos;
+    char c;
+
+    if (pos >= s->len) {
+        return -1;
+    }
+    c = input[pos];
+    switch (c) {
+        case '"':
+            if (ecjp_tape_scan_string(s, &end) == ECJP_BOOL_FALSE) {
+                return -1;
+            }
+            view->ptr = &input[pos + 1];
+            view->len = end - pos - 1;
+            view->type = ECJP_TYPE_STRING;
+            return end + 1;
+
+        case '{':
+        case '[':
+            end = ecjp_skip_container(s, pos, 0, NULL);
+            if ((end < 0) || (input[end] != ((c == '{') ? '}' : ']'))) {
+                return -1;
+            }
+            view->ptr = &input[pos];
+            view->len = end - pos + 1;
+            view->type = (c == '{') ? ECJP_TYPE_OBJECT : ECJP_TYPE_ARRAY;
+            return end + 1;
+
+        case 't':
+        case 'f':
+        case 'n':
+            end = (c == 'f') ? 5 : 4;
+            if (!ecjp_has_chars(&input[pos], input + s->len, end) ||
+                (strncmp(&input[pos], (c == 't') ? "true" : ((c == 'f') ? "false" : "null"), end) != 0)) {
+                return -1;
+            }
+            view->ptr = &input[pos];
+            view->len = end;
+            view->type = (c == 'n') ? ECJP_TYPE_NULL : ECJP_TYPE_BOOL;
+            return pos + end;
+
+        default:
+            if (((c != '-') && ((c < '0') || (c > '9'))) || (ecjp_scan_number(input, s->len, &end, NULL) == ECJP_BOOL_FALSE)) {
+                return -1;
+            }
+            view->ptr = &input[pos];
+            view->len = end - pos;
+            view->type = ECJP_TYPE_NUMBER;
+            return end;
+    }
+}
+
+
+/*
+ * Path queries
+ * A value is found with its path from the root of the document, in a single forward pass over
+ * the input: the keys and the elements that are not on the path are skipped without loading
+ * them. An object or an array is skipped counting the depth of its brackets on the structural
+ * mask of stage 1, so the characters inside its strings are never visited one at a time.
+ * Only the characters walked to reach the value are checked.
+*/
+
+typedef struct ecjp_path_token {
+    const char          *ptr;           // characters of the token in the path
+    size_t              len;
+    int                 index;          // the token as an array index, -1 if it's not an index
+    ecjp_bool_t         pointer;        // JSON Pointer token: ~0 and ~1 are escape sequences
+    ecjp_bool_t         escaped;        // the token has escape sequences
+    ecjp_bool_t         array_only;     // [n] of the dotted syntax: only an array element
+} ecjp_path_token_t;
+
+/*
+ * Function: ecjp_path_index()
+        This function reads a token as an array index: digits without leading zeros.
+        Returns:
+        - The index, -1 if the token is not an index or doesn't fit an int.
+*/
+static int ecjp_path_index(const char *ptr, size_t len)
+{
+    long index = 0;
+    size_t i;
+
+    if ((len == 0) || ((len > 1) && (ptr[0] == '0'))) {
+        return -1;
+    }
+    for (i = 0; i < len; i++) {
+        if ((ptr[i] < '0') || (ptr[i] > '9')) {
+            return -1;
+        }
+        index = index * 10 + (ptr[i] - '0');
+        if (index > INT_MAX) {
+            return -1;
+        }
+    }
+    return (int)index;
+}
+
+/*
+ * Function: ecjp_path_next()
+        This function reads the next token of a path: a JSON Pointer (RFC 6901) when the path
+        starts with '/', the dotted syntax otherwise (keys separated by '.', array indexes in brackets).
+        Parameters:
+        - path: The path.
+        - pos: Pointer to the position of the next token in the path; on return, the position after it.
+        - tok: Pointer to the token to fill.
+        Returns:
+        - 1 if a token is read.
+        - 0 at the end of the path.
+        - -1 if the path is not valid.
+*/
+static int ecjp_path_next(const char *path, size_t *pos, ecjp_path_token_t *tok)
+{
+    size_t i = *pos;
+    size_t n;
+
+    if (path[i] == '\0') {
+        return 0;
+    }
+    memset(tok, 0, sizeof(ecjp_path_token_t));
+    if (path[0] == '/') {
+        // JSON Pointer: '/' then the token, '~' only in ~0 and ~1
+        tok->pointer = ECJP_BOOL_TRUE;
+        i++;
+        for (n = i; (path[n] != '\0') && (path[n] != '/'); n++) {
+            if (path[n] == '~') {
+                if ((path[n + 1] != '0') && (path[n + 1] != '1')) {
+                    return -1;
+                }
+                tok->escaped = ECJP_BOOL_TRUE;
+                n++;
+            }
+        }
+    } else if (path[i] == '[') {
+        // dotted syntax: array index
+        tok->array_only = ECJP_BOOL_TRUE;
+        i++;
+        for (n = i; (path[n] != '\0') && (path[n] != ']'); n++) {
+        }
+        if ((path[n] != ']') || (ecjp_path_index(&path[i], n - i) < 0)) {
+            return -1;
+        }
+    } else {
+        // dotted syntax: key, after a '.' if it's not the first token
+        if ((i > 0) && (path[i++] != '.')) {
+            return -1;
+        }
+        for (n = i; (path[n] != '\0') && (path[n] != '.') && (path[n] != '['); n++) {
+        }
+        if (n == i) {
+            return -1;
+        }
+    }
+    tok->ptr = &path[i];
+    tok->len = n - i;
+    tok->index = tok->escaped ? -1 : ecjp_path_index(tok->ptr, tok->len);
+    *pos = tok->array_only ? (n + 1) : n;
+    return 1;
+}
+
+/*
+ * Function: ecjp_path_match_key()
+        This function compares a key of the input, with its escape sequences, with a token of the path.
+        Parameters:
+        - key: The first character of the key after the opening quote.
+        - key_len: The number of characters of the key.
+        - tok: Pointer to the token.
+        Returns:
+        - ECJP_BOOL_TRUE if the key is the token.
+        - ECJP_BOOL_FALSE otherwise.
+*/
+static ecjp_bool_t ecjp_path_match_key(const char *key, size_t key_len, const ecjp_path_token_t *tok)
+{
+    char utf8[4];
+    size_t i = 0;
+    size_t j = 0;
+    size_t used;
+    int k, n_out;
+    char c;
+
+    if ((tok->escaped == ECJP_BOOL_FALSE) && (memchr(key, '\\', key_len) == NULL)) {
+        return ((key_len == tok->len) && (memcmp(key, tok->ptr, key_len) == 0)) ? ECJP_BOOL_TRUE : ECJP_BOOL_FALSE;
+    }
+    while (i < key_len) {
+        if (key[i] == '\\') {
+            used = ecjp_decode_escape(&key[i], key_len - i, utf8, &n_out);
+            if (used == 0) {
+                return ECJP_BOOL_FALSE;
+            }
+            i += used;
+        } else {
+            utf8[0] = key[i++];
+            n_out = 1;
+        }
+        for (k = 0; k < n_out; k++) {
+            if (j >= tok->len) {
+                return ECJP_BOOL_FALSE;
+            }
+            c = tok->ptr[j++];
+            if ((c == '~') && (tok->pointer == ECJP_BOOL_TRUE)) {
+                c = (tok->ptr[j++] == '0') ? '~' : '/';
+            }
+            if (c != utf8[k]) {
+                return ECJP_BOOL_FALSE;
+            }
+        }
+    }
+    return (j == tok->len) ? ECJP_BOOL_TRUE : ECJP_BOOL_FALSE;
+}
+
+/*
+ * Function: ecjp_query_member()
+        This function finds the value of a key of an object, skipping the values of the other keys.
+        Parameters:
+        - s: Pointer to the stage 1 data of the input.
+        - pos: Pointer to the position of the opening bracket; on return, the position of the value.
+        - tok: Pointer to the token of the path.
+        Returns:
+        - ECJP_NO_ERROR if the key is found.
+        - ECJP_NO_MORE_KEY if the object has no key with this name.
+        - ECJP_SYNTAX_ERROR if the object is not valid.
+*/
+static ecjp_return_code_t ecjp_query_member(ecjp_stage1_t *s, int *pos, const ecjp_path_token_t *tok)
+{
+    ecjp_value_view_t skipped;
+    ecjp_bool_t found;
+    int p, end;
+
+    p = ecjp_skip_whitespace(s, *pos + 1);
+    if ((p < s->len) && (s->input[p] == '}')) {
+        return ECJP_NO_MORE_KEY;
+    }
+    while (p < s->len) {
+        end = p;
+        if ((s->input[p] != '"') || (ecjp_tape_scan_string(s, &end) == ECJP_BOOL_FALSE)) {
+            break;
+        }
+        found = ecjp_path_match_key(&s->input[p + 1], end - p - 1, tok);
+        p = ecjp_skip_whitespace(s, end + 1);
+        if ((p >= s->len) || (s->input[p] != ':')) {
+            break;
+        }
+        p = ecjp_skip_whitespace(s, p + 1);
+        if (p >= s->len) {
+            // the input ends before the value
+            break;
+        }
+        if (found == ECJP_BOOL_TRUE) {
+            *pos = p;
+            return ECJP_NO_ERROR;
+        }
+        p = ecjp_skip_value(s, p, &skipped);
+        if (p < 0) {
+            break;
+        }
+        p = ecjp_skip_whitespace(s, p);
+        if ((p < s->len) && (s->input[p] == '}')) {
+            return ECJP_NO_MORE_KEY;
+        }
+        if ((p >= s->len) || (s->input[p] != ',')) {
+            break;
+        }
+        p = ecjp_skip_whitespace(s, p + 1);
+    }
+    *pos = p;
+    return ECJP_SYNTAX_ERROR;
+}
+
+/*
+ * Function: ecjp_query_element()
+        This function finds an element of an array, skipping the elements before it.
+        Parameters:
+        - s: Pointer to the stage 1 data of the input.
+        - pos: Pointer to the position of the opening bracket; on return, the position of the element.
+        - index: The index of the element, -1 if the token of the path is not an index.
+        Returns:
+        - ECJP_NO_ERROR if the element is found.
+        - ECJP_INDEX_OUT_OF_BOUNDS if the array has no element at index.
+        - ECJP_SYNTAX_ERROR if the array is not valid.
+*/
+static ecjp_return_code_t ecjp_query_element(ecjp_stage1_t *s, int *pos, int index)
+{
+    ecjp_value_view_t skipped;
+    int p;
+
+    p = ecjp_skip_whitespace(s, *pos + 1);
+    if (p >= s->len) {
+        *pos = p;
+        return ECJP_SYNTAX_ERROR;
+    }
+    if ((index < 0) || (s->input[p] == ']')) {
+        return ECJP_INDEX_OUT_OF_BOUNDS;
+    }
+    while (p < s->len) {
+        if (index == 0) {
+            *pos = p;
+            return ECJP_NO_ERROR;
+        }
+        p = ecjp_skip_value(s, p, &skipped);
+        if (p < 0) {
+            break;
+        }
+        p = ecjp_skip_whitespace(s, p);
+        if ((p < s->len) && (s->input[p] == ']')) {
+            return ECJP_INDEX_OUT_OF_BOUNDS;
+        }
+        if ((p >= s->len) || (s->input[p] != ',')) {
+            break;
+        }
+        p = ecjp_skip_whitespace(s, p + 1);
+        index--;
+    }
+    *pos = p;
+    return ECJP_SYNTAX_ERROR;
+}
+
+/*
+    Function: ecjp_query()
+        This function finds a value of a JSON-like input string with its path from the root of the document,
+        without loading the document: the keys and the elements that are not on the path are skipped in the
+        same pass. The value is not copied: the view points to its characters inside the input string (see
+        ecjp_read_key_view()).
+        The path is a JSON Pointer (RFC 6901) like "/db/tables/3/name", or a dotted path like "db.tables[3].name"
+        (the keys of a dotted path can't have '.' and '['); an empty path is the whole document.
+        Only the characters walked to reach the value are checked: check the input with ecjp_check_syntax()
+        first if it is not trusted.
+        Parameters:
+        - input: The JSON-like input string.
+        - len: The length of the input string.
+        - path: The path of the value (NUL-terminated).
+        - view: Pointer to the view to store the position, length and type of the value.
+        Returns:
+        - ECJP_NO_ERROR if the value is found.
+        - ECJP_NULL_POINTER if any input pointer is NULL.
+        - ECJP_EMPTY_STRING if the input string is empty.
+        - ECJP_SYNTAX_ERROR if the path or the characters walked in the input string are not valid.
+        - ECJP_NO_MORE_KEY if an object has no key with a name of the path (or the path has an index in brackets
+          for it), or the path goes on after a string, number, bool or null value.
+        - ECJP_INDEX_OUT_OF_BOUNDS if an array has no element with an index of the path.
+*/
+ecjp_return_code_t ecjp_query(const char *input, size_t len, const char *path, ecjp_value_view_t *view)
+{
+    ecjp_return_code_t ret = ECJP_NO_ERROR;
+    ecjp_path_token_t tok;
+    ecjp_stage1_t stage1;
+    size_t path_pos = 0;
+    int pos, next;
+
+    if (input == NULL || path == NULL || view == NULL) {
+        ecjp_printf("%s - %d: NULL pointer input/path/view",__FUNCTION__,__LINE__);
+        return ECJP_NULL_POINTER;
+    }
+    view->ptr = NULL;
+    view->len = 0;
+    view->type = ECJP_TYPE_UNDEFINED;
+    if ((len == 0) || (len > INT_MAX)) {
+        ecjp_printf("%s - %d: Empty input string\n", __FUNCTION__,__LINE__);
+        return ECJP_EMPTY_STRING;
+    }
+
+    // the whole path is checked before the input
+    while ((next = ecjp_path_next(path, &path_pos, &tok)) > 0) {
+    }
+    if (next < 0) {
+        ecjp_printf("%s - %d: Path %s not valid\n", __FUNCTION__,__LINE__, path);
+        return ECJP_SYNTAX_ERROR;
+    }
+    path_pos = 0;
+
+    // the input is not checked as a whole
+    ecjp_stage1_init(&stage1, input, (int)len, ECJP_BOOL_FALSE);
+    pos = ecjp_skip_whitespace(&stage1, 0);
+    if (pos >= (int)len) {
+        return ECJP_EMPTY_STRING;
+    }
+    while ((ret == ECJP_NO_ERROR) && (ecjp_path_next(path, &path_pos, &tok) > 0)) {
+        if (pos >= (int)len) {
+            ret = ECJP_SYNTAX_ERROR;
+        } else if ((input[pos] == '{') && (tok.array_only == ECJP_BOOL_FALSE)) {
+            ret = ecjp_query_member(&stage1, &pos, &tok);
+        } else if (input[pos] == '[') {
+            ret = ecjp_query_element(&stage1, &pos, tok.index);
+        } else {
+            ret = ECJP_NO_MORE_KEY;
+        }
+    }
+    // the input is walked again from its start for each query
+    ECJP_STATS_RESCAN(__FUNCTION__, bytes_rescanned, input, len, pos);
+    if (ret != ECJP_NO_ERROR) {
+        ecjp_printf("%s - %d: Path %s not found, error %d at position %d\n", __FUNCTION__,__LINE__, path, ret, pos);
+        return ret;
+    }
+    next = ecjp_skip_value(&stage1, pos, view);
+    if (next >= 0) {
+        // the value must end before a separator
+        next = ecjp_skip_whitespace(&stage1, next);
+    }
+    if ((next < 0) || ((next < (int)len) && (input[next] != ',') && (input[next] != '}') && (input[next] != ']'))) {
+        ecjp_printf("%s - %d: Value at position %d not valid\n", __FUNCTION__,__LINE__, pos);
+        view->ptr = NULL;
+        view->len = 0;
+        view->type = ECJP_TYPE_UNDEFINED;
+        return ECJP_SYNTAX_ERROR;
+    }
+    return ECJP_NO_ERROR;
+}
+
+/*
+ * Function: ecjp_projection_child()
+        This function finds the child of a node of a projection for a key of an object or for an
+        element of an array.
+        Parameters:
+        - proj: Pointer to the projection.
+        - node: The index of the node.
+        - key: The first character of the key after the opening quote, NULL for an array element.
+        - key_len: The number of characters of the key.
+        - index: The index of the array element.
+        Returns:
+        - The index of the child, -1 if the key or the element is not on a path.
+*/
+static int ecjp_projection_child(const ecjp_projection_t *proj, int node, const char *key, size_t key_len, int index)
+{
+    const ecjp_projection_node_t *child;
+    ecjp_path_token_t tok;
+    int i;
+
+    memset(&tok, 0, sizeof(ecjp_path_token_t));
+    for (i = proj->node[node].first_child; i >= 0; i = child->next_sibling) {
+        child = &proj->node[i];
+        if (key == NULL) {
+            if (child->index == index) {
+                return i;
+            }
+        } else if (child->array_only == ECJP_BOOL_FALSE) {
+            tok.ptr = &proj->names[child->key_pos];
+            tok.len = child->key_len;
+            if (ecjp_path_match_key(key, key_len, &tok) == ECJP_BOOL_TRUE) {
+                return i;
+            }
+        }
+    }
+    return -1;
+}
+
+static int ecjp_project_value(const ecjp_projection_t *proj, int node, ecjp_stage1_t *s, int pos, ecjp_value_view_t views[], int *remaining);
+
+/*
+ * Function: ecjp_project_container()
+        This function walks the keys or the elements of a container: the values on a path are projected,
+        the others are skipped. The rest of the container is skipped when all the paths below the node
+        are found.
+        Parameters:
+        - proj: Pointer to the projection.
+        - node: The index of the node of the container.
+        - s: Pointer to the stage 1 data of the input.
+        - pos: The position of the opening bracket.
+        - views: The views of the paths.
+        - remaining: Pointer to the number of nodes where a path ends that are not found yet.
+        Returns:
+        - The position of the closing bracket.
+        - -1 if the container is not valid.
+        - -2 if all the paths are found (the walk stops).
+*/
+static int ecjp_project_container(const ecjp_projection_t *proj, int node, ecjp_stage1_t *s, int pos, ecjp_value_view_t views[], int *remaining)
+{
+    ecjp_value_view_t skipped;
+    const char *input = s->input;
+    char close = (input[pos] == '{') ? '}' : ']';
+    int below = *remaining;
+    int index = 0;
+    int p, end, child;
+
+    p = ecjp_skip_whitespace(s, pos + 1);
+    if ((p < s->len) && (input[p] == close)) {
+        return p;
+    }
+    while (p < s->len) {
+        if (close == '}') {
+            end = p;
+            if ((input[p] != '"') || (ecjp_tape_scan_string(s, &end) == ECJP_BOOL_FALSE)) {
+                break;
+            }
+            child = ecjp_projection_child(proj, node, &input[p + 1], end - p - 1, 0);
+            p = ecjp_skip_whitespace(s, end + 1);
+            if ((p >= s->len) || (input[p] != ':')) {
+                break;
+            }
+            p = ecjp_skip_whitespace(s, p + 1);
+        } else {
+            child = ecjp_projection_child(proj, node, NULL, 0, index++);
+        }
+        if (child >= 0) {
+            p = ecjp_project_value(proj, child, s, p, views, remaining);
+            if (p < 0) {
+                return p;
+            }
+        } else if ((p = ecjp_skip_value(s, p, &skipped)) < 0) {
+            break;
+        }
+        p = ecjp_skip_whitespace(s, p);
+        if ((p < s->len) && (input[p] == close)) {
+            return p;
+        }
+        if ((p >= s->len) || (input[p] != ',')) {
+            break;
+        }
+        if (below - *remaining == proj->node[node].num_below) {
+            // nothing more to find here
+            return ecjp_skip_container(s, p, 1, NULL);
+        }
+        p = ecjp_skip_whitespace(s, p + 1);
+    }
+    return -1;
+}
+
+/*
+ * Function: ecjp_project_value()
+        This function projects the value of a node: its view is stored for the paths that end at
+        the node, and its content is walked for the paths that go on.
+        Parameters:
+        - See ecjp_project_container(); pos is the position of the first character of the value.
+        Returns:
+        - The position of the first character after the value.
+        - -1 if the value is not valid.
+        - -2 if all the paths are found (the walk stops).
+*/
+static int ecjp_project_value(const ecjp_projection_t *proj, int node, ecjp_stage1_t *s, int pos, ecjp_value_view_t views[], int *remaining)
+{
+    const ecjp_projection_node_t *n = &proj->node[node];
+    ecjp_value_view_t view;
+    int end, i;
+    char c;
+
+    if (pos >= s->len) {
+        return -1;
+    }
+    c = s->input[pos];
+    if ((n->first_child >= 0) && ((c == '{') || (c == '['))) {
+        end = ecjp_project_container(proj, node, s, pos, views, remaining);
+        if (end < 0) {
+            return end;
+        }
+        view.ptr = &s->input[pos];
+        view.len = end - pos + 1;
+        view.type = (c == '{') ? ECJP_TYPE_OBJECT : ECJP_TYPE_ARRAY;
+        end++;
+    } else {
+        end = ecjp_skip_value(s, pos, &view);
+        if (end < 0) {
+            return -1;
+        }
+    }
+    // with duplicate keys the first value is kept
+    if ((n->path >= 0) && (views[n->path].ptr == NULL)) {
+        for (i = n->path; i >= 0; i = proj->next_path[i]) {
+            views[i] = view;
+        }
+        if (--(*remaining) == 0) {
+            return -2;
+        }
+    }
+    return end;
+}
+
+/*
+    Function: ecjp_projection_compile()
+        This function compiles a set of paths (see ecjp_query()) in a projection, that finds all their values
+        in a single pass with ecjp_project(). The projection is compiled once and used for many inputs.
+        Parameters:
+        - proj: Pointer to the projection to compile; it's freed with ecjp_free_projection().
+        - paths: The paths, JSON Pointers or dotted paths (also mixed).
+        - num_paths: The number of paths.
+        Returns:
+        - ECJP_NO_ERROR on success.
+        - ECJP_NULL_POINTER if any input pointer is NULL.
+        - ECJP_EMPTY_STRING if there are no paths.
+        - ECJP_SYNTAX_ERROR if a path is not valid or has more than ECJP_MAX_PARSE_STACK_DEPTH steps.
+        - ECJP_GENERIC_ERROR on memory allocation failure.
+*/
+ecjp_return_code_t ecjp_projection_compile(ecjp_projection_t *proj, const char *const paths[], int num_paths)
+{
+    ecjp_projection_node_t *n;
+    ecjp_path_token_t tok;
+    size_t path_pos, names_len;
+    int i, node, child, depth, next, max_nodes;
+    size_t k;
+
+    if (proj == NULL || paths == NULL) {
+        ecjp_printf("%s - %d: NULL pointer proj/paths",__FUNCTION__,__LINE__);
+        return ECJP_NULL_POINTER;
+    }
+    memset(proj, 0, sizeof(ecjp_projection_t));
+    if (num_paths <= 0) {
+        return ECJP_EMPTY_STRING;
+    }
+    // check the paths and size the tree
+    max_nodes = 1;
+    names_len = 1;
+    for (i = 0; i < num_paths; i++) {
+        if (paths[i] == NULL) {
+            return ECJP_NULL_POINTER;
+        }
+        path_pos = 0;
+        depth = 0;
+        while ((next = ecjp_path_next(paths[i], &path_pos, &tok)) > 0) {
+            depth++;
+        }
+        if ((next < 0) || (depth > ECJP_MAX_PARSE_STACK_DEPTH)) {
+            ecjp_printf("%s - %d: Path %s not valid\n", __FUNCTION__,__LINE__, paths[i]);
+            return ECJP_SYNTAX_ERROR;
+        }
+        max_nodes += depth;
+        names_len += path_pos;
+    }
+    proj->node = (ecjp_projection_node_t *)ecjp_malloc(max_nodes * sizeof(ecjp_projection_node_t));
+    proj->next_path = (int *)ecjp_malloc(num_paths * sizeof(int));
+    proj->names = (char *)ecjp_malloc(names_len);
+    if ((proj->node == NULL) || (proj->next_path == NULL) || (proj->names == NULL)) {
+        ecjp_free_projection(proj);
+        return ECJP_GENERIC_ERROR;
+    }
+    proj->num_paths = num_paths;
+    memset(&proj->node[0], 0, sizeof(ecjp_projection_node_t));
+    proj->node[0].parent = -1;
+    proj->node[0].first_child = -1;
+    proj->node[0].next_sibling = -1;
+    proj->node[0].path = -1;
+    proj->node[0].index = -1;
+    proj->num_nodes = 1;
+    names_len = 0;
+
+    for (i = 0; i < num_paths; i++) {
+        path_pos = 0;
+        node = 0;
+        while (ecjp_path_next(paths[i], &path_pos, &tok) > 0) {
+            // the step is stored decoded, after the names already stored
+            n = &proj->node[proj->num_nodes];
+            n->key_pos = (unsigned int)names_len;
+            for (k = 0; k < tok.len; k++) {
+                if ((tok.pointer == ECJP_BOOL_TRUE) && (tok.ptr[k] == '~')) {
+                    proj->names[names_len++] = (tok.ptr[++k] == '0') ? '~' : '/';
+                } else {
+                    proj->names[names_len++] = tok.ptr[k];
+                }
+            }
+            n->key_len = (unsigned int)names_len - n->key_pos;
+            for (child = proj->node[node].first_child; child >= 0; child = proj->node[child].next_sibling) {
+                if ((proj->node[child].key_len == n->key_len) &&
+                    (memcmp(&proj->names[proj->node[child].key_pos], &proj->names[n->key_pos], n->key_len) == 0)) {
+                    break;
+                }
+            }
+            if (child >= 0) {
+                // shared step: "[3]" and ".3" are the same node, that matches also the key "3"
+                names_len = n->key_pos;
+                if (tok.array_only == ECJP_BOOL_FALSE) {
+                    proj->node[child].array_only = ECJP_BOOL_FALSE;
+                }
+            } else {
+                child = proj->num_nodes++;
+                n->parent = node;
+                n->first_child = -1;
+                n->next_sibling = proj->node[node].first_child;
+                n->path = -1;
+                n->num_below = 0;
+                n->index = tok.index;
+                n->array_only = tok.array_only;
+                proj->node[node].first_child = child;
+            }
+            node = child;
+        }
+        // the paths that end at the same node are chained
+        proj->next_path[i] = proj->node[node].path;
+        proj->node[node].path = i;
+    }
+    for (node = 0; node < proj->num_nodes; node++) {
+        if (proj->node[node].path >= 0) {
+            proj->num_targets++;
+            for (child = proj->node[node].parent; child >= 0; child = proj->node[child].parent) {
+                proj->node[child].num_below++;
+            }
+        }
+    }
+    return ECJP_NO_ERROR;
+}
+
+/*
+    Function: ecjp_free_projection()
+        This function frees the memory allocated for a projection.
+        Parameters:
+        - proj: Pointer to the projection.
+        Returns:
+        - ECJP_NO_ERROR on success.
+*/
+ecjp_return_code_t ecjp_free_projection(ecjp_projection_t *proj)
+{
+    if (proj == NULL) {
+        return ECJP_NO_ERROR;
+    }
+    if (proj->node != NULL) {
+        ecjp_free(proj->node);
+    }
+    if (proj->next_path != NULL) {
+        ecjp_free(proj->next_path);
+    }
+    if (proj->names != NULL) {
+        ecjp_free(proj->names);
+    }
+    memset(proj, 0, sizeof(ecjp_projection_t));
+    return ECJP_NO_ERROR;
+}
+
+/*
+    Function: ecjp_project()
+        This function finds the values of all the paths of a projection in a single pass over the input string,
+        that stops as soon as all of them are found. The keys and the elements that are not on a path are skipped
+        as in ecjp_query(), and a container is skipped as a whole when all the paths below it are found.
+        The values are not copied: the views point to their characters inside the input string. With duplicate
+        keys the first value found for each path is kept.
+        Parameters:
+        - proj: Pointer to the projection compiled by ecjp_projection_compile().
+        - input: The JSON-like input string.
+        - len: The length of the input string.
+        - views: The views to store the values, one for each path in the order of the paths; the view of a path
+          not found has a NULL position.
+        Returns:
+        - ECJP_NO_ERROR if all the values are found.
+        - ECJP_NULL_POINTER if any input pointer is NULL.
+        - ECJP_EMPTY_STRING if the input string is empty.
+        - ECJP_SYNTAX_ERROR if the characters walked in the input string are not valid.
+        - ECJP_NO_MORE_KEY if some values are not found (the views of the others are stored).
+*/
+ecjp_return_code_t ecjp_project(const ecjp_projection_t *proj, const char *input, size_t len, ecjp_value_view_t views[])
+{
+    ecjp_stage1_t stage1;
+    int remaining, pos, i;
+
+    if (proj == NULL || input == NULL || views == NULL || proj->node == NULL) {
+        ecjp_printf("%s - %d: NULL pointer proj/input/views",__FUNCTION__,__LINE__);
+        return ECJP_NULL_POINTER;
+    }
+    for (i = 0; i < proj->num_paths; i++) {
+        views[i].ptr = NULL;
+        views[i].len = 0;
+        views[i].type = ECJP_TYPE_UNDEFINED;
+    }
+    if ((len == 0) || (len > INT_MAX)) {
+        ecjp_printf("%s - %d: Empty input string\n", __FUNCTION__,__LINE__);
+        return ECJP_EMPTY_STRING;
+    }
+
+    // the input is not checked as a whole
+    ecjp_stage1_init(&stage1, input, (int)len, ECJP_BOOL_FALSE);
+    pos = ecjp_skip_whitespace(&stage1, 0);
+    if (pos >= (int)len) {
+        return ECJP_EMPTY_STRING;
+    }
+    remaining = proj->num_targets;
+    pos = ecjp_project_value(proj, 0, &stage1, pos, views, &remaining);
+    ECJP_STATS_RESCAN(__FUNCTION__, bytes_rescanned, input, len, (pos >= 0) ? pos : 0);
+    if (pos == -1) {
+        ecjp_printf("%s - %d: Input not valid\n", __FUNCTION__,__LINE__);
+        for (i = 0; i < proj->num_paths; i++) {
+            views[i].ptr = NULL;
+            views[i].len = 0;
+            views[i].type = ECJP_TYPE_UNDEFINED;
+        }
+        return ECJP_SYNTAX_ERROR;
+    }
+    return (remaining == 0) ? ECJP_NO_ERROR : ECJP_NO_MORE_KEY;
+}
+
+
+/*
+ * Streaming parser
+ * The same grammar of the tape is checked one chunk at a time. A token that straddles two chunks
+ * (string, escape sequence, number or literal) is not buffered: the stream keeps only the status
+ * needed to go on with the next character, and the position where the token started.
+ * In each chunk the runs of whitespace and of plain string characters are skipped with the stage 1
+ * masks; the carries of the masks are set from the status of the stream at the start of the chunk.
+*/
+
+/*
+ * Function: ecjp_stream_add()
+        This function appends an entry to the tape of the stream, if the stream has a tape.
+        See ecjp_tape_add().
+*/
+static int ecjp_stream_add(ecjp_stream_t *stream, int pos, int length, ecjp_value_type_t type)
+{
+    if (stream->tape == NULL) {
+        return 0;
+    }
+    return ecjp_tape_add(stream->tape, pos, length, type);
+}
+
+/*
+ * Function: ecjp_stream_number_step()
+        This function updates the status of a number with its next character.
+        Parameters:
+        - step: Pointer to the status of the number (ecjp_stream_number_status_t).
+        - c: The next character.
+        Returns:
+        - ECJP_BOOL_TRUE if the character is part of the number.
+        - ECJP_BOOL_FALSE if the character is not part of the number (the status is not changed).
+*/
+static ecjp_bool_t ecjp_stream_number_step(unsigned char *step, char c)
+{
+    ecjp_bool_t digit = ((c >= '0') && (c <= '9')) ? ECJP_BOOL_TRUE : ECJP_BOOL_FALSE;
+
+    switch (*step) {
+        case ECJP_SN_MINUS:
+            if (digit) {
+                *step = (c == '0') ? ECJP_SN_ZERO : ECJP_SN_INT;
+                return ECJP_BOOL_TRUE;
+            }
+            break;
+
+        case ECJP_SN_INT:
+            if (digit) {
+                return ECJP_BOOL_TRUE;
+            }
+            // fall through
+        case ECJP_SN_ZERO:
+            if (c == '.') {
+                *step = ECJP_SN_DOT;
+                return ECJP_BOOL_TRUE;
+            }
+            // fall through
+        case ECJP_SN_FRAC:
+            if ((*step == ECJP_SN_FRAC) && digit) {
+                return ECJP_BOOL_TRUE;
+            }
+            if ((c == 'e') || (c == 'E')) {
+                *step = ECJP_SN_EXP;
+                return ECJP_BOOL_TRUE;
+            }
+            break;
+
+        case ECJP_SN_DOT:
+            if (digit) {
+                *step = ECJP_SN_FRAC;
+                return ECJP_BOOL_TRUE;
+            }
+            break;
+
+        case ECJP_SN_EXP:
+            if ((c == '+') || (c == '-')) {
+                *step = ECJP_SN_EXP_SIGN;
+                return ECJP_BOOL_TRUE;
+            }
+            // fall through
+        case ECJP_SN_EXP_SIGN:
+        case ECJP_SN_EXP_INT:
+            if (digit) {
+                *step = ECJP_SN_EXP_INT;
+                return ECJP_BOOL_TRUE;
+            }
+            break;
+
+        default:
+            break;
+    }
+    return ECJP_BOOL_FALSE;
+}
+
+/*
+ * Function: ecjp_stream_value()
+        This function handles the first character of a value, or a closing square bracket
+        when the value is optional.
+        Parameters:
+        - stream: Pointer to the stream.
+        - c: The character.
+        - pos: The position of the character from the start of the stream.
+        Returns:
+        - ECJP_NO_ERROR if the character is accepted.
+        - ECJP_SYNTAX_ERROR if the character is not expected.
+        - ECJP_GENERIC_ERROR on memory allocation failure.
+*/
+static ecjp_return_code_t ecjp_stream_value(ecjp_stream_t *stream, char c, int pos)
+{
+    if ((stream->status == ECJP_PT_START) && (c != '{') && (c != '[')) {
+        ecjp_printf("%s - %d: Input must start with '{' or '['\n", __FUNCTION__,__LINE__);
+        return ECJP_SYNTAX_ERROR;
+    }
+    switch (c) {
+        case '{':
+        case '[':
+            if (stream->top >= ECJP_MAX_PARSE_STACK_DEPTH - 1) {
+                ecjp_printf("%s - %d: Parse stack overflow\n", __FUNCTION__,__LINE__);
+                return ECJP_SYNTAX_ERROR;
+            }
+            if (ecjp_stream_add(stream, pos, 0, (c == '{') ? ECJP_TYPE_OBJECT : ECJP_TYPE_ARRAY) != 0) {
+                return ECJP_GENERIC_ERROR;
+            }
+            if (stream->top < 0) {
+                stream->struct_type = (c == '{') ? ECJP_ST_OBJ : ECJP_ST_ARRAY;
+            }
+            stream->top++;
+            ECJP_STATS_DEPTH(stream->top + 1);
+            stream->container[stream->top] = c;
+            stream->entry[stream->top] = (stream->tape != NULL) ? (stream->tape->count - 1) : -1;
+            stream->status = (c == '{') ? ECJP_PT_WAIT_KEY_OR_END : ECJP_PT_WAIT_VALUE_OR_END;
+            break;
+
+        case '"':
+            stream->token = ECJP_SK_STRING;
+            stream->is_key = ECJP_BOOL_FALSE;
+            stream->token_start = pos;
+            break;
+
+        case 't':
+        case 'f':
+        case 'n':
+            stream->token = ECJP_SK_LITERAL;
+            stream->literal = (c == 't') ? "true" : ((c == 'f') ? "false" : "null");
+            stream->step = 1;
+            stream->token_start = pos;
+            break;
+
+        default:
+            if ((c != '-') && ((c < '0') || (c > '9'))) {
+                ecjp_printf("%s - %d: Character %c unexpected, value expected\n", __FUNCTION__,__LINE__,c);
+                return ECJP_SYNTAX_ERROR;
+            }
+            stream->token = ECJP_SK_NUMBER;
+            stream->step = ECJP_SN_MINUS;
+            if (c != '-') {
+                ecjp_stream_number_step(&stream->step, c);
+            }
+            stream->token_start = pos;
+            break;
+    }
+    return ECJP_NO_ERROR;
+}
+
+/*
+ * Function: ecjp_stream_structure()
+        This function handles a character outside the tokens: brackets, colons and commas.
+        Parameters:
+        - stream: Pointer to the stream.
+        - c: The character (not a whitespace).
+        - pos: The position of the character from the start of the stream.
+        Returns:
+        - ECJP_NO_ERROR if the character is accepted.
+        - ECJP_SYNTAX_ERROR if the character is not expected.
+        - ECJP_GENERIC_ERROR on memory allocation failure.
+*/
+static ecjp_return_code_t ecjp_stream_structure(ecjp_stream_t *stream, char c, int pos)
+{
+    ecjp_tape_entry_t *container;
+    char open;
+
+    switch (stream->status) {
+        case ECJP_PT_WAIT_KEY_OR_END:
+        case ECJP_PT_WAIT_KEY:
+            if (c == '"') {
+                stream->token = ECJP_SK_STRING;
+                stream->is_key = ECJP_BOOL_TRUE;
+                stream->token_start = pos;
+                return ECJP_NO_ERROR;
+            }
+            if ((c == '}') && (stream->status == ECJP_PT_WAIT_KEY_OR_END)) {
+                // empty object, closed below
+                stream->status = ECJP_PT_WAIT_COMMA_OR_END;
+                return ecjp_stream_structure(stream, c, pos);
+            }
+            ecjp_printf("%s - %d: Character %c unexpected, key expected\n", __FUNCTION__,__LINE__,c);
+            return ECJP_SYNTAX_ERROR;
+
+        case ECJP_PT_WAIT_COLON:
+            if (c != ':') {
+                ecjp_printf("%s - %d: Character %c unexpected, colon expected\n", __FUNCTION__,__LINE__,c);
+                return ECJP_SYNTAX_ERROR;
+            }
+            stream->status = ECJP_PT_WAIT_VALUE;
+            return ECJP_NO_ERROR;
+
+        case ECJP_PT_WAIT_VALUE_OR_END:
+            if (c == ']') {
+                // empty array, closed below
+                stream->status = ECJP_PT_WAIT_COMMA_OR_END;
+                return ecjp_stream_structure(stream, c, pos);
+            }
+            // fall through
+        case ECJP_PT_WAIT_VALUE:
+            if (c == ']') {
+                ecjp_printf("%s - %d: Value expected before closing square bracket\n", __FUNCTION__,__LINE__);
+                return ECJP_SYNTAX_ERROR;
+            }
+            // fall through
+        case ECJP_PT_START:
+            return ecjp_stream_value(stream, c, pos);
+
+        case ECJP_PT_WAIT_COMMA_OR_END:
+            open = stream->container[stream->top];
+            if (c == ',') {
+                stream->status = (open == '{') ? ECJP_PT_WAIT_KEY : ECJP_PT_WAIT_VALUE;
+                return ECJP_NO_ERROR;
+            }
+            if (((c == '}') && (open == '{')) || ((c == ']') && (open == '['))) {
+                if (stream->tape != NULL) {
+                    // complete the container: its content ends with the last entry loaded
+                    container = &stream->tape->entry[stream->entry[stream->top]];
+                    container->length = (unsigned int)pos - container->pos + 1;
+                    container->next = stream->tape->count;
+                }
+                stream->top--;
+                stream->status = (stream->top < 0) ? ECJP_PT_END : ECJP_PT_WAIT_COMMA_OR_END;
+                return ECJP_NO_ERROR;
+            }
+            ecjp_printf("%s - %d: Character %c unexpected, comma or closing bracket expected\n", __FUNCTION__,__LINE__,c);
+            return ECJP_SYNTAX_ERROR;
+
+        case ECJP_PT_END:
+        default:
+            ecjp_printf("%s - %d: Character %c unexpected after the end of the structure\n", __FUNCTION__,__LINE__,c);
+            return ECJP_SYNTAX_ERROR;
+    }
+}
+
+/*
+ * Function: ecjp_stream_scan()
+        This function parses the characters of a chunk, see ecjp_stream_feed().
+        Parameters:
+        - stream: Pointer to the stream.
+        - chunk: The characters of the chunk.
+        - n: The number of characters of the chunk.
+        - stop_at_end: ECJP_BOOL_TRUE to stop after the closing bracket of the document, so the
+          characters after it are not parsed (stream->pos is the length of the document).
+        Returns:
+        - ECJP_NO_ERROR if the document is valid so far.
+        - ECJP_SYNTAX_ERROR if there is a syntax error in the document.
+        - ECJP_GENERIC_ERROR on memory allocation failure.
+*/
+static ecjp_return_code_t ecjp_stream_scan(ecjp_stream_t *stream, const char *chunk, int n, ecjp_bool_t stop_at_end)
+{
+    ecjp_stage1_t stage1;
+    ecjp_return_code_t ret = ECJP_NO_ERROR;
+    int i;
+    char c;
+
+    // a UTF-8 sequence can be split between two chunks: the stream doesn't validate it
+    ecjp_stage1_init(&stage1, chunk, n, ECJP_BOOL_FALSE);
+    if ((stream->token == ECJP_SK_STRING) || (stream->token == ECJP_SK_ESCAPE) || (stream->token == ECJP_SK_UNICODE)) {
+        // the chunk starts inside a string
+        stage1.prev_in_string = ~(uint64_t)0;
+    }
+    if (stream->token == ECJP_SK_ESCAPE) {
+        stage1.prev_escaped = 1;
+    }
+    i = 0;
+    while ((i < n) && (ret == ECJP_NO_ERROR) && ((stop_at_end == ECJP_BOOL_FALSE) || (stream->status != ECJP_PT_END))) {
+        c = chunk[i];
+#ifdef DEBUG_VERBOSE
+        ecjp_printf("%s - %d: Index %d, Status %d, Token %d, Char '%c'\n", __FUNCTION__,__LINE__, stream->pos + i, stream->status, stream->token, c);
+#endif
+        switch (stream->token) {
+            case ECJP_SK_NONE:
+                if (ecjp_is_whitespace(c) == ECJP_BOOL_TRUE) {
+                    i = ecjp_skip_whitespace(&stage1, i);
+                    continue;
+                }
+                ret = ecjp_stream_structure(stream, c, stream->pos + i);
+                break;
+
+            case ECJP_SK_STRING:
+                // jump over the characters that don't need a check
+                i = ecjp_skip_plain(&stage1, i);
+                if (i >= n) {
+                    continue;
+                }
+                c = chunk[i];
+                if (c == '"') {
+                    if (stream->is_key == ECJP_BOOL_TRUE) {
+                        stream->num_keys++;
+                    }
+                    if (ecjp_stream_add(stream, stream->token_start + 1, stream->pos + i - stream->token_start - 1,
+                                        stream->is_key ? ECJP_TYPE_KEY : ECJP_TYPE_STRING) != 0) {
+                        ret = ECJP_GENERIC_ERROR;
+                        break;
+                    }
+                    stream->token = ECJP_SK_NONE;
+                    stream->status = stream->is_key ? ECJP_PT_WAIT_COLON : ECJP_PT_WAIT_COMMA_OR_END;
+                } else if (c == '\\') {
+                    stream->token = ECJP_SK_ESCAPE;
+                } else {
+                    ecjp_printf("%s - %d: Control character in string\n", __FUNCTION__,__LINE__);
+                    ret = ECJP_SYNTAX_ERROR;
+                }
+                break;
+
+            case ECJP_SK_ESCAPE:
+                if (c == 'u') {
+                    stream->token = ECJP_SK_UNICODE;
+                    stream->step = 0;
+                } else if ((c == '"') || (c == '\\') || (c == '/') || (c == 'b') || (c == 'f') || (c == 'n') || (c == 'r') || (c == 't')) {
+                    stream->token = ECJP_SK_STRING;
+                } else {
+                    ecjp_printf("%s - %d: Invalid escape sequence \\%c\n", __FUNCTION__,__LINE__,c);
+                    ret = ECJP_SYNTAX_ERROR;
+                }
+                break;
+
+            case ECJP_SK_UNICODE:
+                if (ecjp_is_excode(c) == ECJP_BOOL_FALSE) {
+                    ecjp_printf("%s - %d: Invalid unicode escape sequence\n", __FUNCTION__,__LINE__);
+                    ret = ECJP_SYNTAX_ERROR;
+                    break;
+                }
+                stream->step++;
+                if (stream->step == 4) {
+                    stream->token = ECJP_SK_STRING;
+                }
+                break;
+
+            case ECJP_SK_LITERAL:
+                if (c != stream->literal[stream->step]) {
+                    ecjp_printf("%s - %d: Character %c unexpected in %s\n", __FUNCTION__,__LINE__,c,stream->literal);
+                    // the error is the literal, as in ecjp_load_tape()
+                    stream->err_pos = stream->token_start;
+                    ret = ECJP_SYNTAX_ERROR;
+                    break;
+                }
+                stream->step++;
+                if (stream->literal[stream->step] == '\0') {
+                    if (ecjp_stream_add(stream, stream->token_start, stream->step, (stream->literal[0] == 'n') ? ECJP_TYPE_NULL : ECJP_TYPE_BOOL) != 0) {
+                        ret = ECJP_GENERIC_ERROR;
+                        break;
+                    }
+                    stream->token = ECJP_SK_NONE;
+                    stream->status = ECJP_PT_WAIT_COMMA_OR_END;
+                }
+                break;
+
+            case ECJP_SK_NUMBER:
+                if (ecjp_stream_number_step(&stream->step, c) == ECJP_BOOL_TRUE) {
+                    break;
+                }
+                if ((stream->step != ECJP_SN_ZERO) && (stream->step != ECJP_SN_INT) &&
+                    (stream->step != ECJP_SN_FRAC) && (stream->step != ECJP_SN_EXP_INT)) {
+                    ecjp_printf("%s - %d: Character %c unexpected in number\n", __FUNCTION__,__LINE__,c);
+                    ret = ECJP_SYNTAX_ERROR;
+                    break;
+                }
+                if (ecjp_stream_add(stream, stream->token_start, stream->pos + i - stream->token_start, ECJP_TYPE_NUMBER) != 0) {
+                    ret = ECJP_GENERIC_ERROR;
+                    break;
+                }
+                // the character after the number is checked again outside the token
+                stream->token = ECJP_SK_NONE;
+                stream->status = ECJP_PT_WAIT_COMMA_OR_END;
+                continue;
+
+            default:
+                ret = ECJP_GENERIC_ERROR;
+                break;
+        }
+        if (ret == ECJP_NO_ERROR) {
+            i++;
+        }
+    }
+
+    if (ret != ECJP_NO_ERROR) {
+        stream->error = ret;
+        if (stream->err_pos < 0) {
+            stream->err_pos = stream->pos + i;
+        }
+    }
+    stream->pos += i;
+    return ret;
+}
+
+/*
+    Function: ecjp_stream_init()
+        This function initializes a stream to parse a document received in chunks.
+        Parameters:
+        - stream: Pointer to the stream.
+        - tape: Pointer to a tape initialized with ecjp_init_tape(), loaded while the chunks are parsed;
+          NULL to check the syntax only.
+        Returns:
+        - ECJP_NO_ERROR on success.
+        - ECJP_NULL_POINTER if stream is NULL.
+*/
+ecjp_return_code_t ecjp_stream_init(ecjp_stream_t *stream, ecjp_tape_t *tape)
+{
+    if (stream == NULL) {
+        return ECJP_NULL_POINTER;
+    }
+    // the stacks are written before they are read, only the status is cleared
+    stream->status = ECJP_PT_START;
+    stream->token = ECJP_SK_NONE;
+    stream->step = 0;
+    stream->is_key = ECJP_BOOL_FALSE;
+    stream->literal = NULL;
+    stream->token_start = 0;
+    stream->pos = 0;
+    stream->top = -1;
+    stream->num_keys = 0;
+    stream->struct_type = ECJP_ST_NULL;
+    stream->error = ECJP_NO_ERROR;
+    stream->err_pos = -1;
+    stream->tape = tape;
+    if (tape != NULL) {
+        tape->count = 0;
+    }
+    return ECJP_NO_ERROR;
+}
+
+/*
+    Function: ecjp_stream_feed()
+        This function parses the next chunk of a document. The chunk can end anywhere, also in the middle
+        of a token: the token goes on with the next chunk. The chunk is not needed after the call.
+        After an error, the next calls return the same error.
+        Parameters:
+        - stream: Pointer to the stream initialized with ecjp_stream_init().
+        - chunk: The characters of the chunk (not NUL-terminated).
+        - len: The number of characters of the chunk.
+        Returns:
+        - ECJP_NO_ERROR if the document is valid so far.
+        - ECJP_NULL_POINTER if any input pointer is NULL.
+        - ECJP_SYNTAX_ERROR if there is a syntax error in the document.
+        - ECJP_GENERIC_ERROR on memory allocation failure.
+*/
+ecjp_return_code_t ecjp_stream_feed(ecjp_stream_t *stream, const char *chunk, size_t len)
+{
+    if (stream == NULL || (chunk == NULL && len > 0)) {
+        ecjp_printf("%s - %d: NULL pointer stream/chunk",__FUNCTION__,__LINE__);
+        return ECJP_NULL_POINTER;
+    }
+    if (stream->error != ECJP_NO_ERROR) {
+        return stream->error;
+    }
+    ECJP_STATS_ADD(bytes_scanned, len);
+    return ecjp_stream_scan(stream, chunk, (int)len, ECJP_BOOL_FALSE);
+}
+
+/*
+    Function: ecjp_stream_finish()
+        This function ends a stream: the document must be complete after the last chunk.
+        Parameters:
+        - stream: Pointer to the stream.
+        - res: Pointer to a structure to store the result of the check, including any error position
+          (from the start of the stream).
+        Returns:
+        - ECJP_NO_ERROR if the document is valid and complete.
+        - ECJP_NULL_POINTER if any input pointer is NULL.
+        - ECJP_EMPTY_STRING if no character (but whitespaces) was received.
+        - ECJP_SYNTAX_ERROR if there is a syntax error in the document, or it ends inside a string or a literal.
+        - ECJP_BRACKETS_MISSING if the document ends before all objects and arrays are closed.
+        - ECJP_GENERIC_ERROR on memory allocation failure.
+*/
+ecjp_return_code_t ecjp_stream_finish(ecjp_stream_t *stream, ecjp_check_result_t *res)
+{
+    ecjp_return_code_t ret;
+
+    if (stream == NULL || res == NULL) {
+        ecjp_printf("%s - %d: NULL pointer stream/res",__FUNCTION__,__LINE__);
+        return ECJP_NULL_POINTER;
+    }
+    ret = stream->error;
+    if (ret == ECJP_NO_ERROR) {
+        switch (stream->token) {
+            case ECJP_SK_STRING:
+            case ECJP_SK_ESCAPE:
+            case ECJP_SK_UNICODE:
+                ecjp_printf("%s - %d: Unterminated string at end of input\n", __FUNCTION__,__LINE__);
+                stream->err_pos = stream->pos;
+                ret = ECJP_SYNTAX_ERROR;
+                break;
+
+            case ECJP_SK_LITERAL:
+                ecjp_printf("%s - %d: Truncated %s at end of input\n", __FUNCTION__,__LINE__,stream->literal);
+                stream->err_pos = stream->token_start;
+                ret = ECJP_SYNTAX_ERROR;
+                break;
+
+            case ECJP_SK_NUMBER:
+                if ((stream->step != ECJP_SN_ZERO) && (stream->step != ECJP_SN_INT) &&
+                    (stream->step != ECJP_SN_FRAC) && (stream->step != ECJP_SN_EXP_INT)) {
+                    ecjp_printf("%s - %d: Truncated number at end of input\n", __FUNCTION__,__LINE__);
+                    stream->err_pos = stream->pos;
+                    ret = ECJP_SYNTAX_ERROR;
+                    break;
+                }
+                // a number is always inside a container not closed
+                // fall through
+            default:
+                if (stream->status == ECJP_PT_START) {
+                    ecjp_printf("%s - %d: Empty input string\n", __FUNCTION__,__LINE__);
+                    ret = ECJP_EMPTY_STRING;
+                } else if (stream->status != ECJP_PT_END) {
+                    ecjp_printf("%s - %d: Mismatched brackets at end of input\n", __FUNCTION__,__LINE__);
+                    stream->err_pos = stream->pos;
+                    ret = ECJP_BRACKETS_MISSING;
+                }
+                break;
+        }
+        stream->error = ret;
+    }
+    res->err_pos = stream->err_pos;
+    res->num_keys = (ECJP_TYPE_POS_KEY)stream->num_keys;
+    res->struct_type = stream->struct_type;
+    res->memory_used = (int)sizeof(ecjp_stream_t);
+    if (stream->tape != NULL) {
+        res->memory_used += stream->tape->capacity * (int)sizeof(ecjp_tape_entry_t);
+    }
+    return ret;
+}
+
+/*
+ * Multi-document input
+ * The documents follow one another in the input string, separated by whitespaces (e.g. NDJSON,
+ * one document per line, or concatenated documents). Each document is parsed with a stream that
+ * stops after its closing bracket, so the next characters are left to the next document.
+ * When a document is not valid, the parsing goes on from the first line, starting from the line of
+ * the error, that begins a new document (see ecjp_document_resume()): the rest of a broken document,
+ * also on many lines, is not taken for other documents.
+*/
+
+/*
+    Function: ecjp_document_resume()
+        This function finds where the parsing goes on after a document not valid: the first line,
+        starting from the line of the error, that begins with '{' or '[' (after the whitespaces)
+        in its first column or after all the brackets of the document are closed. The brackets
+        in the strings are skipped, a string ends at the end of its line.
+        Parameters:
+        - input: The input string.
+        - len: The length of the input string.
+        - start: The position of the document not valid.
+        - err_pos: The position of the error from the start of the input string.
+        Returns:
+        - The position of the next document, len if there is none.
+*/
+static int ecjp_document_resume(const char *input, size_t len, int start, int err_pos)
+{
+    ecjp_bool_t in_string = ECJP_BOOL_FALSE;
+    int depth = 0;
+    int pos, first;
+
+    if ((err_pos < start) || (err_pos >= (int)len)) {
+        return (int)len;
+    }
+    for (pos = start; pos < (int)len; pos++) {
+        if ((pos > start) && (input[pos - 1] == '\n')) {
+            in_string = ECJP_BOOL_FALSE;
+            first = pos;
+            while ((first < (int)len) && ((input[first] == ' ') || (input[first] == '\t') || (input[first] == '\r'))) {
+                first++;
+            }
+            // on the line of the error, only an error at the opener starts a new document
+            if ((first < (int)len) && (first >= err_pos) && ((input[first] == '{') || (input[first] == '[')) &&
+                ((first == pos) || (depth <= 0))) {
+                return first;
+            }
+        }
+        if (in_string == ECJP_BOOL_TRUE) {
+            if (input[pos] == '\\') {
+                pos++;
+            } else if (input[pos] == '"') {
+                in_string = ECJP_BOOL_FALSE;
+            }
+            continue;
+        }
+        switch (input[pos]) {
+            case '"':
+                in_string = ECJP_BOOL_TRUE;
+                break;
+            case '{':
+            case '[':
+                depth++;
+                break;
+            case '}':
+            case ']':
+                depth--;
+                break;
+            default:
+                break;
+        }
+    }
+    return (int)len;
+}
+
+/*
+    Function: ecjp_internal_check_documents()
+        This function checks all the documents of a multi-document input string.
+        Parameters:
+        - input: The input string.
+        - len: The length of the input string.
+        - callback: The function called for each document, NULL to count the documents only.
+        - user_data: Pointer passed to the callback.
+        - num_documents: Pointer to store the number of documents found (can be NULL).
+        Returns:
+        - ECJP_NO_ERROR if all the documents are valid.
+        - ECJP_NULL_POINTER if input is NULL.
+        - ECJP_EMPTY_STRING if the input string has no document.
+        - the error of the first document not valid otherwise.
+*/
+static ecjp_return_code_t ecjp_internal_check_documents(const char *input, size_t len, ecjp_document_cb_t callback, void *user_data, int *num_documents)
+{
+    ecjp_stream_t stream;
+    ecjp_check_result_t res;
+    ecjp_document_t doc;
+    ecjp_return_code_t ret = ECJP_NO_ERROR;
+    int next;
+    int pos = 0;
+    int count = 0;
+
+    if (num_documents != NULL) {
+        *num_documents = 0;
+    }
+    if (input == NULL) {
+        ecjp_printf("%s - %d: NULL pointer input",__FUNCTION__,__LINE__);
+        return ECJP_NULL_POINTER;
+    }
+    ECJP_STATS_ADD(bytes_scanned, len);
+
+    while (1) {
+        while ((pos < (int)len) && (ecjp_is_whitespace(input[pos]) == ECJP_BOOL_TRUE)) {
+            pos++;
+        }
+        if (pos >= (int)len) {
+            break;
+        }
+        ecjp_stream_init(&stream, NULL);
+        ecjp_stream_scan(&stream, &input[pos], (int)len - pos, ECJP_BOOL_TRUE);
+        doc.error = ecjp_stream_finish(&stream, &res);
+        doc.start = pos;
+        doc.err_pos = (res.err_pos >= 0) ? (pos + res.err_pos) : -1;
+        if (doc.error == ECJP_NO_ERROR) {
+            doc.length = stream.pos;
+            next = pos + doc.length;
+        } else {
+            // the document ends before the next one, without the trailing whitespaces, and contains the error
+            next = ecjp_document_resume(input, len, pos, doc.err_pos);
+            doc.length = next - pos;
+            while ((doc.length > 0) && (ecjp_is_whitespace(input[pos + doc.length - 1]) == ECJP_BOOL_TRUE)) {
+                doc.length--;
+            }
+            if ((doc.err_pos >= 0) && (doc.err_pos < next) && (doc.length <= doc.err_pos - pos)) {
+                doc.length = doc.err_pos - pos + 1;
+            }
+            if (ret == ECJP_NO_ERROR) {
+                ret = doc.error;
+            }
+        }
+        doc.num_keys = res.num_keys;
+        doc.struct_type = res.struct_type;
+#ifdef DEBUG_VERBOSE
+        ecjp_printf("%s - %d: Document %d at %d, length %d, error %d\n", __FUNCTION__,__LINE__, count, doc.start, doc.length, doc.error);
+#endif
+        count++;
+        pos = next;
+        if ((callback != NULL) && (callback(input, &doc, user_data) == ECJP_BOOL_FALSE)) {
+            break;
+        }
+    }
+
+    if (num_documents != NULL) {
+        *num_documents = count;
+    }
+    if (count == 0) {
+        ecjp_printf("%s - %d: Empty input string\n", __FUNCTION__,__LINE__);
+        return ECJP_EMPTY_STRING;
+    }
+    return ret;
+}
+
+/*
+    Function: ecjp_check_documents()
+        This function checks all the documents of a NUL-terminated multi-document input string.
+        See ecjp_internal_check_documents().
+*/
+ecjp_return_code_t ecjp_check_documents(const char *input, ecjp_document_cb_t callback, void *user_data, int *num_documents)
+{
+    return ecjp_internal_check_documents(input, (input != NULL) ? strlen(input) : 0, callback, user_data, num_documents);
+}
+
+/*
+    Function: ecjp_check_documents_n()
+        Same as ecjp_check_documents(), the input string is delimited by its length (len)
+        and doesn't need to be NUL-terminated.
+*/
+ecjp_return_code_t ecjp_check_documents_n(const char *input, size_t len, ecjp_document_cb_t callback, void *user_data, int *num_documents)
+{
+    return ecjp_internal_check_documents(input, len, callback, user_data, num_documents);
+}
+
+/*
+ * Table-driven syntax check
+ * The syntax-only check runs a DFA instead of the nested switch of ecjp_check_and_load(): each
+ * character is mapped to a class by a 256-entry table, and the state table gives for each state
+ * and class the action to run and the next state, packed in one byte ((action << 4) | state,
+ * 0 is a syntax error). The nesting of the brackets is kept on a stack of openers.
+ * The DFA accepts exactly the inputs accepted by the switch, with the same error positions: the
+ * loaders keep the switch, since the lists are built in each branch.
+ * With GCC and Clang the actions are dispatched with computed gotos (each action jumps directly
+ * to the next one), unless ECJP_NO_COMPUTED_GOTO is defined (see --disable-computed-goto).
+ * The actions that open or close a token also send the events of ecjp_sax_parse(), so the
+ * callbacks run in the same pass as the check.
+*/
+
+#if defined(__GNUC__) && !defined(ECJP_NO_COMPUTED_GOTO)
+#define ECJP_DFA_COMPUTED_GOTO      1
+#endif
+
+// character classes
+enum {
+    ECJP_CC_OTHER = 0,
+    ECJP_CC_WS,             // ' ', '\t', '\n', '\r'
+    ECJP_CC_CTRL,           // control characters (see ecjp_is_ctrl()), '\0' included
+    ECJP_CC_LBRACE,
+    ECJP_CC_RBRACE,
+    ECJP_CC_LBRACKET,
+    ECJP_CC_RBRACKET,
+    ECJP_CC_QUOTE,
+    ECJP_CC_BACKSLASH,
+    ECJP_CC_COLON,
+    ECJP_CC_COMMA,
+    ECJP_CC_ZERO,
+    ECJP_CC_DIGIT,          // '1' - '9'
+    ECJP_CC_MINUS,
+    ECJP_CC_PLUS,
+    ECJP_CC_DOT,
+    ECJP_CC_EXP,            // 'e', 'E'
+    ECJP_CC_LITERAL,        // first character of true, false and null
+    ECJP_CC_NUM
+};
+
+// states (at most 16)
+enum {
+    ECJP_DS_START = 0,
+    ECJP_DS_OBJ,            // in an object, before a key
+    ECJP_DS_OBJ_T,          // in an object, after a comma
+    ECJP_DS_ARR,            // in an array, before a value
+    ECJP_DS_ARR_T,          // in an array, after a comma
+    ECJP_DS_KEY,
+    ECJP_DS_COLON,
+    ECJP_DS_VALUE,
+    ECJP_DS_STRING,
+    ECJP_DS_NUMBER,
+    ECJP_DS_NUMBER_Z,       // number starting with '0': only '.' can follow
+    ECJP_DS_COMMA,          // after a value
+    ECJP_DS_COMMA_T,        // after a value closing an array opened after a comma
+    ECJP_DS_END,
+    ECJP_DS_NUM
+};
+
+// actions (at most 16)
+enum {
+    ECJP_DA_ERROR = 0,      // syntax error at the character
+    ECJP_DA_MOVE,           // go to the next state
+    ECJP_DA_SKIP_WS,        // skip the run of whitespace
+    ECJP_DA_SKIP_PLAIN,     // skip the run of plain characters inside a string
+    ECJP_DA_ESCAPE,         // check the escape sequence
+    ECJP_DA_OPEN,           // opening quote of a key or a string
+    ECJP_DA_CLOSE,          // closing quote of a key or a string
+    ECJP_DA_PUSH,           // push the opener (the first one sets the type of the structure)
+    ECJP_DA_POP,            // pop the opener, END if it's the root
+    ECJP_DA_POP_KEEP,       // pop the opener, never END
+    ECJP_DA_COMMA,          // go to ARR_T or OBJ_T by the opener on top of the stack
+    ECJP_DA_LITERAL,        // skip true, false or null
+    ECJP_DA_NUMBER,         // start a number (NUMBER or NUMBER_Z)
+    ECJP_DA_NUMBER_END,     // whitespace after a number
+    ECJP_DA_NUM
+};
+
+#define ECJP_DFA(action, state)     (unsigned char)((ECJP_DA_##action << 4) | ECJP_DS_##state)
+
+static const unsigned char ecjp_dfa_class[256] = {
+    // 0x00
+    ECJP_CC_CTRL, ECJP_CC_CTRL, ECJP_CC_CTRL, ECJP_CC_CTRL, ECJP_CC_CTRL, ECJP_CC_CTRL, ECJP_CC_CTRL, ECJP_CC_CTRL,
+    ECJP_CC_CTRL, ECJP_CC_WS, ECJP_CC_WS, ECJP_CC_CTRL, ECJP_CC_CTRL, ECJP_CC_WS, ECJP_CC_CTRL, ECJP_CC_CTRL,
+    // 0x10
+    ECJP_CC_CTRL, ECJP_CC_CTRL, ECJP_CC_CTRL, ECJP_CC_CTRL, ECJP_CC_CTRL, ECJP_CC_CTRL, ECJP_CC_CTRL, ECJP_CC_CTRL,
+    ECJP_CC_CTRL, ECJP_CC_CTRL, ECJP_CC_CTRL, ECJP_CC_CTRL, ECJP_CC_CTRL, ECJP_CC_CTRL, ECJP_CC_CTRL, ECJP_CC_CTRL,
+    // 0x20: ' ' to '/'
+    ECJP_CC_WS, ECJP_CC_OTHER, ECJP_CC_QUOTE, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER,
+    ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_PLUS, ECJP_CC_COMMA, ECJP_CC_MINUS, ECJP_CC_DOT, ECJP_CC_OTHER,
+    // 0x30: '0' to '?'
+    ECJP_CC_ZERO, ECJP_CC_DIGIT, ECJP_CC_DIGIT, ECJP_CC_DIGIT, ECJP_CC_DIGIT, ECJP_CC_DIGIT, ECJP_CC_DIGIT, ECJP_CC_DIGIT,
+    ECJP_CC_DIGIT, ECJP_CC_DIGIT, ECJP_CC_COLON, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER,
+    // 0x40: '@' to 'O'
+    ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_EXP, ECJP_CC_OTHER, ECJP_CC_OTHER,
+    ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER,
+    // 0x50: 'P' to '_'
+    ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER,
+    ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_LBRACKET, ECJP_CC_BACKSLASH, ECJP_CC_RBRACKET, ECJP_CC_OTHER, ECJP_CC_OTHER,
+    // 0x60: '`' to 'o'
+    ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_EXP, ECJP_CC_LITERAL, ECJP_CC_OTHER,
+    ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_LITERAL, ECJP_CC_OTHER,
+    // 0x70: 'p' to 0x7F
+    ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_LITERAL, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER,
+    ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_OTHER, ECJP_CC_LBRACE, ECJP_CC_OTHER, ECJP_CC_RBRACE, ECJP_CC_OTHER, ECJP_CC_CTRL
+    // 0x80 - 0xFF: ECJP_CC_OTHER
+};
+
+// the classes not listed are a syntax error
+static const unsigned char ecjp_dfa_table[ECJP_DS_NUM][ECJP_CC_NUM] = {
+    [ECJP_DS_START] = {
+        [ECJP_CC_WS] = ECJP_DFA(SKIP_WS, START),
+        [ECJP_CC_LBRACE] = ECJP_DFA(PUSH, OBJ),
+        [ECJP_CC_LBRACKET] = ECJP_DFA(PUSH, ARR),
+    },
+    [ECJP_DS_OBJ] = {
+        [ECJP_CC_WS] = ECJP_DFA(SKIP_WS, OBJ),
+        [ECJP_CC_LBRACE] = ECJP_DFA(PUSH, OBJ),
+        [ECJP_CC_RBRACE] = ECJP_DFA(POP, COMMA),
+        [ECJP_CC_COMMA] = ECJP_DFA(MOVE, OBJ_T),
+        [ECJP_CC_QUOTE] = ECJP_DFA(OPEN, KEY),
+    },
+    [ECJP_DS_OBJ_T] = {
+        [ECJP_CC_WS] = ECJP_DFA(SKIP_WS, OBJ_T),
+        [ECJP_CC_LBRACE] = ECJP_DFA(PUSH, OBJ_T),
+        [ECJP_CC_QUOTE] = ECJP_DFA(OPEN, KEY),
+    },
+    [ECJP_DS_ARR] = {
+        [ECJP_CC_WS] = ECJP_DFA(SKIP_WS, ARR),
+        [ECJP_CC_LBRACE] = ECJP_DFA(PUSH, OBJ),
+        [ECJP_CC_RBRACE] = ECJP_DFA(POP_KEEP, COMMA),
+        [ECJP_CC_LBRACKET] = ECJP_DFA(PUSH, ARR),
+        [ECJP_CC_RBRACKET] = ECJP_DFA(POP_KEEP, COMMA),
+        [ECJP_CC_QUOTE] = ECJP_DFA(OPEN, STRING),
+        [ECJP_CC_ZERO] = ECJP_DFA(NUMBER, NUMBER),
+        [ECJP_CC_DIGIT] = ECJP_DFA(NUMBER, NUMBER),
+        [ECJP_CC_MINUS] = ECJP_DFA(NUMBER, NUMBER),
+        [ECJP_CC_LITERAL] = ECJP_DFA(LITERAL, COMMA),
+    },
+    [ECJP_DS_ARR_T] = {
+        [ECJP_CC_WS] = ECJP_DFA(SKIP_WS, ARR_T),
+        [ECJP_CC_LBRACE] = ECJP_DFA(PUSH, OBJ),
+        [ECJP_CC_RBRACE] = ECJP_DFA(POP_KEEP, COMMA_T),
+        [ECJP_CC_LBRACKET] = ECJP_DFA(PUSH, ARR),
+        [ECJP_CC_RBRACKET] = ECJP_DFA(POP_KEEP, COMMA_T),
+        [ECJP_CC_QUOTE] = ECJP_DFA(OPEN, STRING),
+        [ECJP_CC_ZERO] = ECJP_DFA(NUMBER, NUMBER),
+        [ECJP_CC_DIGIT] = ECJP_DFA(NUMBER, NUMBER),
+        [ECJP_CC_MINUS] = ECJP_DFA(NUMBER, NUMBER),
+        [ECJP_CC_LITERAL] = ECJP_DFA(LITERAL, COMMA),
+    },
+    [ECJP_DS_KEY] = {
+        [ECJP_CC_OTHER] = ECJP_DFA(SKIP_PLAIN, KEY),
+        [ECJP_CC_WS] = ECJP_DFA(SKIP_PLAIN, KEY),
+        [ECJP_CC_LBRACE] = ECJP_DFA(SKIP_PLAIN, KEY),
+        [ECJP_CC_RBRACE] = ECJP_DFA(SKIP_PLAIN, KEY),
+        [ECJP_CC_LBRACKET] = ECJP_DFA(SKIP_PLAIN, KEY),
+        [ECJP_CC_RBRACKET] = ECJP_DFA(SKIP_PLAIN, KEY),
+        [ECJP_CC_QUOTE] = ECJP_DFA(CLOSE, COLON),
+        [ECJP_CC_BACKSLASH] = ECJP_DFA(ESCAPE, KEY),
+        [ECJP_CC_COLON] = ECJP_DFA(SKIP_PLAIN, KEY),
+        [ECJP_CC_COMMA] = ECJP_DFA(SKIP_PLAIN, KEY),
+        [ECJP_CC_ZERO] = ECJP_DFA(SKIP_PLAIN, KEY),
+        [ECJP_CC_DIGIT] = ECJP_DFA(SKIP_PLAIN, KEY),
+        [ECJP_CC_MINUS] = ECJP_DFA(SKIP_PLAIN, KEY),
+        [ECJP_CC_PLUS] = ECJP_DFA(SKIP_PLAIN, KEY),
+        [ECJP_CC_DOT] = ECJP_DFA(SKIP_PLAIN, KEY),
+        [ECJP_CC_EXP] = ECJP_DFA(SKIP_PLAIN, KEY),
+        [ECJP_CC_LITERAL] = ECJP_DFA(SKIP_PLAIN, KEY),
+    },
+    [ECJP_DS_COLON] = {
+        [ECJP_CC_WS] = ECJP_DFA(SKIP_WS, COLON),
+        [ECJP_CC_COLON] = ECJP_DFA(MOVE, VALUE),
+    },
+    [ECJP_DS_VALUE] = {
+        [ECJP_CC_WS] = ECJP_DFA(SKIP_WS, VALUE),
+        [ECJP_CC_LBRACE] = ECJP_DFA(PUSH, OBJ),
+        [ECJP_CC_LBRACKET] = ECJP_DFA(PUSH, ARR),
+        [ECJP_CC_QUOTE] = ECJP_DFA(OPEN, STRING),
+        [ECJP_CC_ZERO] = ECJP_DFA(NUMBER, NUMBER),
+        [ECJP_CC_DIGIT] = ECJP_DFA(NUMBER, NUMBER),
+        [ECJP_CC_MINUS] = ECJP_DFA(NUMBER, NUMBER),
+        [ECJP_CC_LITERAL] = ECJP_DFA(LITERAL, COMMA),
+    },
+    [ECJP_DS_STRING] = {
+        [ECJP_CC_OTHER] = ECJP_DFA(SKIP_PLAIN, STRING),
+        [ECJP_CC_WS] = ECJP_DFA(SKIP_PLAIN, STRING),
+        [ECJP_CC_LBRACE] = ECJP_DFA(SKIP_PLAIN, STRING),
+        [ECJP_CC_RBRACE] = ECJP_DFA(SKIP_PLAIN, STRING),
+        [ECJP_CC_LBRACKET] = ECJP_DFA(SKIP_PLAIN, STRING),
+        [ECJP_CC_RBRACKET] = ECJP_DFA(SKIP_PLAIN, STRING),
+        [ECJP_CC_QUOTE] = ECJP_DFA(CLOSE, COMMA),
+        [ECJP_CC_BACKSLASH] = ECJP_DFA(ESCAPE, STRING),
+        [ECJP_CC_COLON] = ECJP_DFA(SKIP_PLAIN, STRING),
+        [ECJP_CC_COMMA] = ECJP_DFA(SKIP_PLAIN, STRING),
+        [ECJP_CC_ZERO] = ECJP_DFA(SKIP_PLAIN, STRING),
+        [ECJP_CC_DIGIT] = ECJP_DFA(SKIP_PLAIN, STRING),
+        [ECJP_CC_MINUS] = ECJP_DFA(SKIP_PLAIN, STRING),
+        [ECJP_CC_PLUS] = ECJP_DFA(SKIP_PLAIN, STRING),
+        [ECJP_CC_DOT] = ECJP_DFA(SKIP_PLAIN, STRING),
+        [ECJP_CC_EXP] = ECJP_DFA(SKIP_PLAIN, STRING),
+        [ECJP_CC_LITERAL] = ECJP_DFA(SKIP_PLAIN, STRING),
+    },
+    [ECJP_DS_NUMBER] = {
+        [ECJP_CC_WS] = ECJP_DFA(NUMBER_END, COMMA),
+        [ECJP_CC_RBRACE] = ECJP_DFA(POP, COMMA),
+        [ECJP_CC_RBRACKET] = ECJP_DFA(POP, COMMA),
+        [ECJP_CC_COMMA] = ECJP_DFA(COMMA, OBJ_T),
+        [ECJP_CC_ZERO] = ECJP_DFA(MOVE, NUMBER),
+        [ECJP_CC_DIGIT] = ECJP_DFA(MOVE, NUMBER),
+        [ECJP_CC_MINUS] = ECJP_DFA(MOVE, NUMBER),
+        [ECJP_CC_PLUS] = ECJP_DFA(MOVE, NUMBER),
+        [ECJP_CC_DOT] = ECJP_DFA(MOVE, NUMBER),
+        [ECJP_CC_EXP] = ECJP_DFA(MOVE, NUMBER),
+    },
+    [ECJP_DS_NUMBER_Z] = {
+        [ECJP_CC_WS] = ECJP_DFA(NUMBER_END, COMMA),
+        [ECJP_CC_RBRACE] = ECJP_DFA(POP, COMMA),
+        [ECJP_CC_RBRACKET] = ECJP_DFA(POP, COMMA),
+        [ECJP_CC_COMMA] = ECJP_DFA(COMMA, OBJ_T),
+        [ECJP_CC_DOT] = ECJP_DFA(MOVE, NUMBER),
+    },
+    [ECJP_DS_COMMA] = {
+        [ECJP_CC_WS] = ECJP_DFA(SKIP_WS, COMMA),
+        [ECJP_CC_RBRACE] = ECJP_DFA(POP, COMMA),
+        [ECJP_CC_RBRACKET] = ECJP_DFA(POP, COMMA),
+        [ECJP_CC_COMMA] = ECJP_DFA(COMMA, OBJ_T),
+    },
+    [ECJP_DS_COMMA_T] = {
+        [ECJP_CC_WS] = ECJP_DFA(SKIP_WS, COMMA_T),
+    },
+    [ECJP_DS_END] = {
+        [ECJP_CC_WS] = ECJP_DFA(SKIP_WS, END),
+    },
+};
+
+#ifdef ECJP_STATS
+// status of the loaders in each state, for the counters of the transitions (see ecjp_get_stats())
+static const unsigned char ecjp_dfa_status[ECJP_DS_NUM] = {
+    [ECJP_DS_START] = ECJP_PS_START,
+    [ECJP_DS_OBJ] = ECJP_PS_IN_OBJECT,
+    [ECJP_DS_OBJ_T] = ECJP_PS_IN_OBJECT,
+    [ECJP_DS_ARR] = ECJP_PS_IN_ARRAY,
+    [ECJP_DS_ARR_T] = ECJP_PS_IN_ARRAY,
+    [ECJP_DS_KEY] = ECJP_PS_IN_KEY,
+    [ECJP_DS_COLON] = ECJP_PS_WAIT_COLON,
+    [ECJP_DS_VALUE] = ECJP_PS_WAIT_VALUE,
+    [ECJP_DS_STRING] = ECJP_PS_IN_VALUE,
+    [ECJP_DS_NUMBER] = ECJP_PS_IN_VALUE,
+    [ECJP_DS_NUMBER_Z] = ECJP_PS_IN_VALUE,
+    [ECJP_DS_COMMA] = ECJP_PS_WAIT_COMMA,
+    [ECJP_DS_COMMA_T] = ECJP_PS_WAIT_COMMA,
+    [ECJP_DS_END] = ECJP_PS_END,
+};
+    #define ECJP_DFA_STATS_STATUS()     ECJP_STATS_STATUS(stats_status, ecjp_dfa_status[state])
+#else
+    #define ECJP_DFA_STATS_STATUS()
+#endif
+
+#ifdef ECJP_DFA_COMPUTED_GOTO
+    #define ECJP_DFA_ACTION(action)     ecjp_dfa_##action:
+    // the next action is reached from the end of each action, without the loop
+    #define ECJP_DFA_DISPATCH()         do { \
+                                            ECJP_DFA_STATS_STATUS(); \
+                                            if (pos >= end) { \
+                                                goto ecjp_dfa_stop; \
+                                            } \
+                                            entry = ecjp_dfa_table[state][ecjp_dfa_class[(unsigned char)input[pos]]]; \
+                                            goto *ecjp_dfa_action[entry >> 4]; \
+                                        } while (0)
+#else
+    #define ECJP_DFA_ACTION(action)     case ECJP_DA_##action:
+    #define ECJP_DFA_DISPATCH()         continue
+#endif
+
+// calls a callback of the SAX handler, a callback that returns ECJP_BOOL_FALSE stops the parsing
+#define ECJP_SAX_EVENT(callback, start, length)     do { \
+                                                        if ((handler->callback != NULL) && \
+                                                            (handler->callback(input, (start), (length), user_data) == ECJP_BOOL_FALSE)) { \
+                                                            return ECJP_STOPPED; \
+                                                        } \
+                                                    } while (0)
+
+/*
+    Function: ecjp_internal_check_syntax()
+        This function checks the syntax of a JSON-like input string with the DFA, without loading anything.
+        With a handler, the events of the keys, values and structures are sent while the input is checked.
+        Parameters:
+        - input: The JSON-like input string to be checked.
+        - len: The length of the input string; a '\0' found before len is a syntax error.
+        - res: Pointer to a structure to store the result of the check, including any error position.
+        - handler: Pointer to the SAX handler, NULL to check the syntax only.
+        - user_data: Pointer passed to the callbacks of the handler.
+        - utf8: ECJP_BOOL_TRUE to validate the input as UTF-8 (see ecjp_ctx_t).
+        Returns:
+        - ECJP_NO_ERROR if the input string is valid.
+        - ECJP_STOPPED if a callback stopped the parsing.
+        - ECJP_NULL_POINTER if any input pointer is NULL.
+        - ECJP_EMPTY_STRING if the input string is empty.
+        - ECJP_SYNTAX_ERROR if there is a syntax error in the input string.
+        - ECJP_GENERIC_ERROR if the structures are nested deeper than ECJP_MAX_PARSE_STACK_DEPTH.
+*/
+static ecjp_return_code_t ecjp_internal_check_syntax(const char *input, size_t len, ecjp_check_result_t *res, const ecjp_sax_handler_t *handler, void *user_data, ecjp_bool_t utf8)
+{
+#ifdef ECJP_DFA_COMPUTED_GOTO
+    static const void *const ecjp_dfa_action[ECJP_DA_NUM] = {
+        &&ecjp_dfa_ERROR, &&ecjp_dfa_MOVE, &&ecjp_dfa_SKIP_WS, &&ecjp_dfa_SKIP_PLAIN, &&ecjp_dfa_ESCAPE, &&ecjp_dfa_OPEN,
+        &&ecjp_dfa_CLOSE, &&ecjp_dfa_PUSH, &&ecjp_dfa_POP, &&ecjp_dfa_POP_KEEP, &&ecjp_dfa_COMMA, &&ecjp_dfa_LITERAL,
+        &&ecjp_dfa_NUMBER, &&ecjp_dfa_NUMBER_END
+    };
+#endif
+    char stack[ECJP_MAX_PARSE_STACK_DEPTH];
+    ecjp_stage1_t stage1;
+    const char *literal;
+    int end = (int)len;
+    int pos = 0;
+    int top = -1;
+    int n;
+    int token = 0;          // first character of the current key, string or number
+    unsigned int state = ECJP_DS_START;
+    unsigned int entry;
+    char c;
+#ifdef ECJP_STATS
+    int stats_status = -1;
+#endif
+
+    if ((input == NULL) || (res == NULL)) {
+        ecjp_printf("%s - %d: NULL pointer input/res\n",__FUNCTION__,__LINE__);
+        return ECJP_NULL_POINTER;
+    }
+    if (len == 0) {
+        ecjp_printf("%s - %d: Empty string input\n",__FUNCTION__,__LINE__);
+        return ECJP_EMPTY_STRING;
+    }
+    ecjp_stage1_init(&stage1, input, end, utf8);
+    ECJP_STATS_ADD(bytes_scanned, len);
+
+#ifdef ECJP_DFA_COMPUTED_GOTO
+    ECJP_DFA_DISPATCH();
+    {
+#else
+    while (pos < end) {
+        ECJP_DFA_STATS_STATUS();
+        entry = ecjp_dfa_table[state][ecjp_dfa_class[(unsigned char)input[pos]]];
+        switch (entry >> 4) {
+#endif
+            ECJP_DFA_ACTION(MOVE)
+                state = entry & 0x0F;
+                pos++;
+                ECJP_DFA_DISPATCH();
+
+            ECJP_DFA_ACTION(SKIP_WS)
+                pos = ecjp_skip_whitespace(&stage1, pos);
+                ECJP_DFA_DISPATCH();
+
+            ECJP_DFA_ACTION(SKIP_PLAIN)
+                pos = ecjp_skip_plain(&stage1, pos + 1);
+                ECJP_DFA_DISPATCH();
+
+            ECJP_DFA_ACTION(ESCAPE)
+                pos++;
+                c = (pos < end) ? input[pos] : '\0';
+                if ((c == '"') || (c == '\\') || (c == '/') || (c == 'b') || (c == 'f') || (c == 'r') || (c == 'n') || (c == 't')) {
+                    pos++;
+                    ECJP_DFA_DISPATCH();
+                }
+                if ((c != 'u') || (pos + 4 >= end) ||
+                    !ecjp_is_excode(input[pos + 1]) || !ecjp_is_excode(input[pos + 2]) ||
+                    !ecjp_is_excode(input[pos + 3]) || !ecjp_is_excode(input[pos + 4])) {
+                    res->err_pos = pos;
+                    ecjp_printf("%s - %d: Invalid escape sequence\n", __FUNCTION__,__LINE__);
+                    return ECJP_SYNTAX_ERROR;
+                }
+                pos += 5;
+                ECJP_DFA_DISPATCH();
+
+            ECJP_DFA_ACTION(OPEN)
+                token = pos + 1;
+                state = entry & 0x0F;
+                pos++;
+                ECJP_DFA_DISPATCH();
+
+            ECJP_DFA_ACTION(CLOSE)
+                if (handler != NULL) {
+                    if (state == ECJP_DS_KEY) {
+                        ECJP_SAX_EVENT(key, token, pos - token);
+                    } else {
+                        ECJP_SAX_EVENT(string, token, pos - token);
+                    }
+                }
+                state = entry & 0x0F;
+                pos++;
+                ECJP_DFA_DISPATCH();
+
+            ECJP_DFA_ACTION(PUSH)
+                if (top >= ECJP_MAX_PARSE_STACK_DEPTH - 1) {
+                    res->err_pos = pos;
+                    ecjp_printf("%s - %d: Parse stack overflow\n", __FUNCTION__,__LINE__);
+                    return ECJP_GENERIC_ERROR;
+                }
+                if (state == ECJP_DS_START) {
+                    // the root structure (a structure after the root doesn't change it, as in the loaders)
+                    res->struct_type = (input[pos] == '{') ? ECJP_ST_OBJ : ECJP_ST_ARRAY;
+                }
+                stack[++top] = input[pos];
+                ECJP_STATS_DEPTH(top + 1);
+                if (handler != NULL) {
+                    if (input[pos] == '{') {
+                        ECJP_SAX_EVENT(start_object, pos, 1);
+                    } else {
+                        ECJP_SAX_EVENT(start_array, pos, 1);
+                    }
+                }
+                state = entry & 0x0F;
+                pos++;
+                ECJP_DFA_DISPATCH();
+
+            ECJP_DFA_ACTION(POP)
+            ECJP_DFA_ACTION(POP_KEEP)
+                if ((top < 0) || (stack[top] != ((input[pos] == '}') ? '{' : '['))) {
+                    res->err_pos = pos;
+                    ecjp_printf("%s - %d: Unexpected closing bracket\n", __FUNCTION__,__LINE__);
+                    return ECJP_SYNTAX_ERROR;
+                }
+                top--;
+                if (handler != NULL) {
+                    if ((state == ECJP_DS_NUMBER) || (state == ECJP_DS_NUMBER_Z)) {
+                        ECJP_SAX_EVENT(number, token, pos - token);
+                    }
+                    if (input[pos] == '}') {
+                        ECJP_SAX_EVENT(end_object, pos, 1);
+                    } else {
+                        ECJP_SAX_EVENT(end_array, pos, 1);
+                    }
+                }
+                state = ((top < 0) && ((entry >> 4) == ECJP_DA_POP)) ? ECJP_DS_END : (entry & 0x0F);
+                pos++;
+                ECJP_DFA_DISPATCH();
+
+            ECJP_DFA_ACTION(COMMA)
+                if ((handler != NULL) && ((state == ECJP_DS_NUMBER) || (state == ECJP_DS_NUMBER_Z))) {
+                    ECJP_SAX_EVENT(number, token, pos - token);
+                }
+                state = ((top >= 0) && (stack[top] == '[')) ? ECJP_DS_ARR_T : ECJP_DS_OBJ_T;
+                pos++;
+                ECJP_DFA_DISPATCH();
+
+            ECJP_DFA_ACTION(LITERAL)
+                literal = (input[pos] == 't') ? "true" : ((input[pos] == 'f') ? "false" : "null");
+                n = (input[pos] == 'f') ? 5 : 4;
+                if ((end - pos < n) || (memcmp(&input[pos], literal, n) != 0)) {
+                    res->err_pos = pos;
+                    ecjp_printf("%s - %d: Invalid character in value\n", __FUNCTION__,__LINE__);
+                    return ECJP_SYNTAX_ERROR;
+                }
+                if (handler != NULL) {
+                    if (input[pos] == 'n') {
+                        ECJP_SAX_EVENT(null, pos, n);
+                    } else {
+                        ECJP_SAX_EVENT(boolean, pos, n);
+                    }
+                }
+                state = entry & 0x0F;
+                pos += n;
+                ECJP_DFA_DISPATCH();
+
+            ECJP_DFA_ACTION(NUMBER)
+                state = (input[pos] == '0') ? ECJP_DS_NUMBER_Z : ECJP_DS_NUMBER;
+                token = pos;
+                pos++;
+                ECJP_DFA_DISPATCH();
+
+            ECJP_DFA_ACTION(NUMBER_END)
+                if (handler != NULL) {
+                    ECJP_SAX_EVENT(number, token, pos - token);
+                }
+                state = ECJP_DS_COMMA;
+                pos++;
+                ECJP_DFA_DISPATCH();
+
+            ECJP_DFA_ACTION(ERROR)
+#ifndef ECJP_DFA_COMPUTED_GOTO
+            default:
+#endif
+                res->err_pos = pos;
+                ecjp_printf("%s - %d: Unexpected character in status %u\n", __FUNCTION__,__LINE__, state);
+                return ECJP_SYNTAX_ERROR;
+        }
+#ifdef ECJP_DFA_COMPUTED_GOTO
+ecjp_dfa_stop:
+#else
+    }
+    ECJP_DFA_STATS_STATUS();
+#endif
+
+    if (state != ECJP_DS_END) {
+        ecjp_printf("%s - %d: Incomplete JSON structure\n", __FUNCTION__,__LINE__);
+        return ECJP_SYNTAX_ERROR;
+    }
+    if (ecjp_stage1_utf8_error(&stage1) >= 0) {
+        res->err_pos = stage1.utf8_err_pos;
+        ecjp_printf("%s - %d: Invalid UTF-8 sequence at position %d\n", __FUNCTION__,__LINE__, res->err_pos);
+        return ECJP_SYNTAX_ERROR;
+    }
+    return ECJP_NO_ERROR;
+}
+
+/*
+    Function: ecjp_sax_parse()
+        This function checks the syntax of a JSON-like input string and calls the callbacks of the handler
+        for each structure, key and value, in the same pass: nothing is allocated or copied. Each callback
+        receives the position and the length of the characters of the event in the input string (see
+        ecjp_sax_handler_t); the callbacks left NULL are not called.
+        The events are sent while the input is checked: an input with a syntax error can send some events
+        before the error is found.
+        Parameters:
+        - input: The JSON-like input string to be parsed.
+        - len: The length of the input string; a '\0' found before len is a syntax error.
+        - handler: Pointer to the handler with the callbacks.
+        - user_data: Pointer passed to the callbacks.
+        Returns:
+        - ECJP_NO_ERROR if the input string is valid.
+        - ECJP_STOPPED if a callback returned ECJP_BOOL_FALSE to stop the parsing (the rest of the input
+          is not checked).
+        - ECJP_NULL_POINTER if any input pointer is NULL.
+        - ECJP_EMPTY_STRING if the input string is empty.
+        - ECJP_SYNTAX_ERROR if there is a syntax error in the input string.
+        - ECJP_GENERIC_ERROR if the structures are nested deeper than ECJP_MAX_PARSE_STACK_DEPTH.
+*/
+ecjp_return_code_t ecjp_sax_parse(const char *input, size_t len, const ecjp_sax_handler_t *handler, void *user_data)
+{
+    ecjp_check_result_t res;
+
+    if (handler == NULL) {
+        ecjp_printf("%s - %d: NULL pointer handler\n",__FUNCTION__,__LINE__);
+        return ECJP_NULL_POINTER;
+    }
+    memset(&res, 0, sizeof(ecjp_check_result_t));
+    res.err_pos = -1;
+    return ecjp_internal_check_syntax(input, len, &res, handler, user_data, ECJP_BOOL_FALSE);
+}
+
+#undef ECJP_DFA_ACTION
+#undef ECJP_DFA_DISPATCH
+#undef ECJP_SAX_EVENT
+
+
+#ifdef ECJP_TOKEN_LIST
+
+/******* ALTERNATIVE IMPLEMENTATION *********/
+/* 
+In this implementation, we parse the input string and extract item tokens (values) instead of keys.
+We store these item tokens in a linked list passed as a parameter.
+This implementation is useful when the focus is on the values rather than the keys but use much more memory.
+*/
+
+/*
+ * The values of an item list loaded by ecjp_check_and_load_2_arena() are stored in an arena:
+ * a chain of blocks where the values are allocated one after the other, the newest block first.
+ * The values are not freed one by one, the whole chain is freed with the list.
+*/
+typedef struct ecjp_arena_block {
+    struct ecjp_arena_block *next;
+    size_t                  size;
+    size_t                  used;
+    char                    data[];
+} ecjp_arena_block_t;
+
+/*
+ * The elements of an item list are stored in a contiguous vector: the next pointers link
+ * the elements in order, so the list can be walked as before or accessed by index.
+ * The head of the list is the first element of the vector.
+*/
+typedef struct ecjp_item_vector {
+    int                 count;
+    int                 capacity;
+    ecjp_arena_block_t  *arena;     // NULL if each value is allocated with ecjp_malloc()
+    ecjp_item_elem_t    elem[];
+} ecjp_item_vector_t;
+
+/* Internal API functions */
+
+/*
+ *  Function: ecjp_store_tmp_item()
+    This function store a character in the temporary buffer for building an item token value.
+    Parameters:
+    - buffer: The temporary buffer to store the character, NULL if the values are not loaded.
+    - p_buffer: Pointer to the current position in the buffer.
+    - c: The character to be stored.
+    Returns:
+    - ECJP_NO_ERROR if the character is stored successfully.
+    - ECJP_NO_SPACE_IN_BUFFER_VALUE if the buffer exceeds maximum length.
+*/
+ecjp_return_code_t ecjp_store_tmp_item(char *buffer, int *p_buffer, char c)
+{
+    if (buffer == NULL) {
+        return ECJP_NO_ERROR;
+    }
+    if(*p_buffer >= (ECJP_MAX_ITEM_LEN - 1)) {
+        ecjp_printf("%s - %d: Item length exceeds maximum limit (p_buffer = %d, limit = %d)\n", __FUNCTION__,__LINE__, *p_buffer, ECJP_MAX_ITEM_LEN);
+        return ECJP_NO_SPACE_IN_BUFFER_VALUE;
+    }
+    buffer[*p_buffer] = c;
+    (*p_buffer)++;
+#ifdef DEBUG_VERBOSE    
+    ecjp_printf("%s - %d: Stored char '%c' in tmp buffer at position %d\n", __FUNCTION__,__LINE__, c, *p_buffer - 1);
+#endif
+    return ECJP_NO_ERROR;
+}
+
+/*
+ *  Function: ecjp_store_tmp_items()
+    This function store a run of characters in the temporary buffer for building an item token value.
+    The characters that exceed the buffer are dropped, as with ecjp_store_tmp_item().
+    Parameters:
+    - buffer: The temporary buffer to store the characters, NULL if the values are not loaded.
+    - p_buffer: Pointer to the current position in the buffer.
+    - src: The characters to be stored.
+    - n: The number of characters to be stored.
+    Returns:
+    - ECJP_NO_ERROR if all the characters are stored successfully.
+    - ECJP_NO_SPACE_IN_BUFFER_VALUE if the buffer exceeds maximum length.
+*/
+ecjp_return_code_t ecjp_store_tmp_items(char *buffer, int *p_buffer, const char *src, int n)
+{
+    int room = (ECJP_MAX_ITEM_LEN - 1) - *p_buffer;
+
+    if (buffer == NULL) {
+        return ECJP_NO_ERROR;
+    }
+    if (room < 0) {
+        room = 0;
+    }
+    if (n > room) {
+        ecjp_printf("%s - %d: Item length exceeds maximum limit (p_buffer = %d, limit = %d)\n", __FUNCTION__,__LINE__, *p_buffer, ECJP_MAX_ITEM_LEN);
+        memcpy(&buffer[*p_buffer], src, room);
+        *p_buffer += room;
+        return ECJP_NO_SPACE_IN_BUFFER_VALUE;
+    }
+    memcpy(&buffer[*p_buffer], src, n);
+    *p_buffer += n;
+    return ECJP_NO_ERROR;
+}
+
+/*
+ *  Function: ecjp_arena_add_block()
+    This function adds a new block to an arena, the new block becomes the newest one.
+    Parameters:
+    - arena: Pointer to the newest block of the arena (NULL for an empty arena).
+    - size: The number of bytes of the block.
+    Returns:
+    - 0 on success.
+    - -1 on memory allocation failure.
+*/
+static int ecjp_arena_add_block(ecjp_arena_block_t **arena, size_t size)
+{
+    ecjp_arena_block_t *b;
+
+    b = (ecjp_arena_block_t *)ecjp_malloc(sizeof(ecjp_arena_block_t) + size);
+    if (b == NULL) {
+        return -1;
+    }
+    b->next = *arena;
+    b->size = size;
+    b->used = 0;
+    *arena = b;
+    return 0;
+}
+
+/*
+ *  Function: ecjp_arena_alloc()
+    This function allocates n bytes from an arena, in O(1) time.
+    When the newest block has no room, a new block is added with twice its size (at least n bytes),
+    so the number of blocks grows with the logarithm of the bytes allocated.
+    Parameters:
+    - arena: Pointer to the newest block of the arena (NULL for an empty arena), updated when a block is added.
+    - n: The number of bytes.
+    Returns:
+    - Pointer to the bytes allocated.
+    - NULL if there is a memory allocation error.
+*/
+static void *ecjp_arena_alloc(ecjp_arena_block_t **arena, size_t n)
+{
+    size_t size;
+    void *ptr;
+
+    if ((*arena == NULL) || ((*arena)->size - (*arena)->used < n)) {
+        size = (*arena == NULL) ? ECJP_ARENA_BLOCK_SIZE : ((*arena)->size * 2);
+        if (ecjp_arena_add_block(arena, (n > size) ? n : size) != 0) {
+            return NULL;
+        }
+    }
+    ptr = &(*arena)->data[(*arena)->used];
+    (*arena)->used += n;
+    return ptr;
+}
+
+/*
+ *  Function: ecjp_free_arena()
+    This function frees all the blocks of an arena.
+    Parameters:
+    - arena: Pointer to the newest block of the arena, set to NULL.
+*/
+static void ecjp_free_arena(ecjp_arena_block_t **arena)
+{
+    ecjp_arena_block_t *b;
+
+    while (*arena != NULL) {
+        b = *arena;
+        *arena = b->next;
+        ecjp_free(b);
+    }
+}
+
+/*
+ *  Function: ecjp_arena_footprint()
+    This function returns the number of bytes allocated for the blocks of an arena.
+*/
+static int ecjp_arena_footprint(const ecjp_arena_block_t *arena)
+{
+    int bytes = 0;
+
+    for (; arena != NULL; arena = arena->next) {
+        bytes += (int)(sizeof(ecjp_arena_block_t) + arena->size);
+    }
+    return bytes;
+}
+
+/*
+ *  Function: ecjp_load_item()
+    This function load an item token from the temporary buffer.
+    Parameters:
+    - token: Pointer to the item token structure to be loaded.
+    - tmp_buffer: The temporary buffer containing the item value.
+    - p_buffer: The size of the item value in the buffer.
+    - arena: Pointer to the arena where the value is allocated, NULL to allocate it with ecjp_malloc().
+    Returns:
+    - The length of the loaded item token value.
+    - 0 if there is a memory allocation error.
+*/
+int ecjp_load_item(ecjp_item_token_t *token, char *tmp_buffer, int p_buffer, ecjp_arena_block_t **arena)
+{
+    int len = (p_buffer + 1);
+
+    // allocate memory for token value, copy tmp_buffer to token value
+    // in tmp_buffer there are no more than ECJP_MAX_ITEM_LEN characters
+    token->value = (arena != NULL) ? ecjp_arena_alloc(arena, len) : ecjp_malloc(len);
+    if (token->value == NULL) {
+        ecjp_printf("%s - %d: Memory allocation error for item token value\n", __FUNCTION__,__LINE__);
+        token->value_size = 0;
+        return 0;
+    }   
+    // null terminate the string
+    tmp_buffer[p_buffer] = '\0';
+    token->value_size = len;
+    strncpy(token->value, tmp_buffer, len);
+
+    ecjp_printf("%s - %d: Loaded item token of type %s, size %u, value: %s\n", __FUNCTION__,__LINE__, ecjp_type[token->type], token->value_size, (char *)token->value);
+    return len;
+}
+
+/*
+ *  Function: ecjp_reset_tmp_buffer()
+    This function reset the temporary buffer for building an item token value.
+    Parameters:
+    - tmp_buffer: The temporary buffer to be reset.
+    - p_buffer: Pointer to the current position in the buffer to be reset.
+*/
+void ecjp_reset_tmp_buffer(char *tmp_buffer, int *p_buffer)
+{
+    // the value is terminated by ecjp_load_item(), the buffer doesn't need to be cleared
+    (void)tmp_buffer;
+    *p_buffer = 0;
+    return;
+}
+
+/*
+ *  Function: ecjp_init_item_token()
+    This function initialize an item token structure.
+    Parameters:
+    - token: Pointer to the item token structure to be initialized.
+*/
+void ecjp_init_item_token(ecjp_item_token_t *token)
+{
+    token->type = ECJP_TYPE_UNDEFINED;
+    token->value = NULL;
+    token->value_size = 0;
+    return;
+}
+
+/*
+ *  Function: ecjp_free_item_token()
+    This function free the memory allocated for an item token structure.
+    Parameters:
+    - token: Pointer to the item token structure to be freed.
+*/
+void ecjp_free_item_token(ecjp_item_token_t *token)
+{
+    if (token->value != NULL) {
+        ecjp_free(token->value);
+        token->value = NULL;
+    }
+    token->value_size = 0;
     token->type = ECJP_TYPE_UNDEFINED;
     return;
 }
 
+/*
+ * Function: ecjp_item_vector_of()
+        This function returns the vector that stores the elements of an item list.
+        Parameters:
+        - head: Pointer to the head of the item list (first element of the vector).
+*/
+static inline ecjp_item_vector_t *ecjp_item_vector_of(ecjp_item_elem_t *head)
+{
+    return (ecjp_item_vector_t *)((char *)head - offsetof(ecjp_item_vector_t, elem));
+}
+
 /*
  * Function: ecjp_add_node_item_end()
-        This function adds a new item token node to the end of the linked list.
+        This function appends a new item token to the vector of the list, in O(1) amortized time.
+        The capacity of the vector is doubled when it's full.
         Parameters:
-        - head: Pointer to the head of the linked list.
+        - head: Pointer to the head of the linked list, updated if the vector is moved.
         - data: Pointer to the item token data to add.
         Returns:
         - 0 on success.
@@ -490,27 +6668,74 @@ void ecjp_free_item_token(ecjp_item_token_t *token)
 */
 int ecjp_add_node_item_end(ecjp_item_elem_t **head, ecjp_item_token_t *data)
 {
-    ecjp_item_elem_t  *new_node;
-    ecjp_item_elem_t  *current;
-    
-    new_node = (ecjp_item_elem_t *)malloc(sizeof(ecjp_item_elem_t));
-    if (!new_node)  
-        return -1;
+    ecjp_item_vector_t  *v;
+    ecjp_item_vector_t  *grown;
+    ecjp_item_elem_t    *new_node;
+    int i, capacity;
+
+    v = (*head == NULL) ? NULL : ecjp_item_vector_of(*head);
+    if ((v == NULL) || (v->count == v->capacity)) {
+        capacity = (v == NULL) ? ECJP_LIST_MIN_CAPACITY : (v->capacity * 2);
+        grown = (ecjp_item_vector_t *)ecjp_realloc(v, sizeof(ecjp_item_vector_t) + (capacity * sizeof(ecjp_item_elem_t)));
+        if (!grown)
+            return -1;
+        if (v == NULL) {
+            grown->count = 0;
+            grown->arena = NULL;
+        }
+        grown->capacity = capacity;
+        // the array can be moved by realloc(): link again the elements
+        for (i = 1; i < grown->count; i++) {
+            grown->elem[i - 1].next = &grown->elem[i];
+        }
+        v = grown;
+        *head = &v->elem[0];
+    }
+    new_node = &v->elem[v->count];
     new_node->item.type = data->type;
     new_node->item.value = data->value;
     new_node->item.value_size = data->value_size;
     new_node->next = NULL;
-    if (*head == NULL)
-    {
-        *head = new_node;
+    if (v->count > 0) {
+        v->elem[v->count - 1].next = new_node;
     }
-    else
-    {
-        current = *head;
-        while (current->next != NULL)
-            current = current->next;
-        current->next = new_node;
+    v->count++;
+    ECJP_STATS_ADD(nodes_allocated, 1);
+    return 0;
+}
+
+/*
+ * Function: ecjp_load_and_add_item()
+        This function loads an item token from the temporary buffer and appends it to the list.
+        If the token can't be added, its value is released.
+        Parameters:
+        - item_list: Pointer to the head of the list.
+        - token: Pointer to the item token to load.
+        - tmp_buffer: The temporary buffer containing the item value.
+        - p_buffer: The size of the item value in the buffer.
+        - arena: Pointer to the arena where the value is allocated, NULL to allocate it with ecjp_malloc().
+        - res: Pointer to the result of the check, where the memory used is updated.
+        Returns:
+        - 0 on success.
+        - -1 on memory allocation failure.
+*/
+static int ecjp_load_and_add_item(ecjp_item_elem_t **item_list, ecjp_item_token_t *token, char *tmp_buffer, int p_buffer,
+                                  ecjp_arena_block_t **arena, ecjp_check_result_t *res)
+{
+    int len;
+
+    len = ecjp_load_item(token, tmp_buffer, p_buffer, arena);
+    if (len == 0) {
+        return -1;
+    }
+    if (ecjp_add_node_item_end(item_list, token) != 0) {
+        if (arena == NULL) {
+            ecjp_free_item_token(token);
+        }
+        token->value = NULL;
+        return -1;
     }
+    res->memory_used += len;
     return 0;
 }
 
@@ -520,54 +6745,97 @@ int ecjp_add_node_item_end(ecjp_item_elem_t **head, ecjp_item_token_t *data)
  *  Function: ecjp_free_item_list()
     This function free the memory allocated for a list of item elements.
     Parameters:
-    - item_list: Pointer to the list of item elements to be freed.
+    - item_list: Pointer to the list of item elements to be freed (head of the list returned by the library).
     Returns:
     - ECJP_NO_ERROR if the list is freed successfully.
 */
 ecjp_return_code_t ecjp_free_item_list(ecjp_item_elem_t **item_list)
 {
-    ecjp_item_elem_t *current;
-    ecjp_item_elem_t *next;
+    ecjp_item_vector_t *v;
+    int i;
 
     if(item_list == NULL || *item_list == NULL)
         return ECJP_NO_ERROR;
         
-    current = *item_list;
-
-    while (current != NULL) {
-        free(current->item.value);
-        next = current->next;
-        free(current);
-        current = next;
+    v = ecjp_item_vector_of(*item_list);
+    if (v->arena != NULL) {
+        // the values are in the blocks of the arena
+        ecjp_free_arena(&v->arena);
+    } else {
+        for (i = 0; i < v->count; i++) {
+            ecjp_free(v->elem[i].item.value);
+        }
     }
+    ecjp_free(v);
     *item_list = NULL;
 
     return ECJP_NO_ERROR;
 }
 
+/*
+ * Function: ecjp_get_item_count()
+    This function returns the number of items stored in an item list.
+    Parameters:
+    - item_list: Head of the item list.
+    Returns:
+    - The number of items, 0 if the list is empty.
+*/
+int ecjp_get_item_count(ecjp_item_elem_t *item_list)
+{
+    if (item_list == NULL)
+        return 0;
+    return ecjp_item_vector_of(item_list)->count;
+}
+
+/*
+ * Function: ecjp_get_item_token()
+    This function returns the item at a given index of an item list, in constant time.
+    Parameters:
+    - item_list: Head of the item list.
+    - index: The index of the item.
+    Returns:
+    - Pointer to the item token, NULL if the index is out of bounds.
+*/
+ecjp_item_token_t *ecjp_get_item_token(ecjp_item_elem_t *item_list, int index)
+{
+    if ((index < 0) || (index >= ecjp_get_item_count(item_list)))
+        return NULL;
+    return &(ecjp_item_vector_of(item_list)->elem[index].item);
+}
+
 /* 
- * Function: ecjp_check_and_load_2()
+ * Function: ecjp_internal_check_and_load_2()
     This function checks the syntax of a JSON-like input string and loads item tokens (values)
     into a linked list if the syntax is valid.
+    The input is delimited by its length, so it can be a slice of a larger buffer not NUL-terminated.
     Parameters:
+    - ctx: Pointer to the context with the scratch memory where the values are built.
     - input: The JSON-like input string to be checked and loaded.
-    - item_list: Pointer to a list of item elements loaded with the item tokens found in the input string.
+    - len: The length of the input string; a '\0' found before len is a syntax error.
+    - item_list: Pointer to a list of item elements loaded with the item tokens found in the input string
+      (NULL to check the syntax only, the scratch memory is not used).
     - res: Pointer to a structure to store the result of the check, including any error position.
+    - arena: Pointer to the arena where the values are allocated, NULL to allocate each value with ecjp_malloc().
     Returns:
     - ECJP_NO_ERROR if the input string is valid.
     - ECJP_NULL_POINTER if any input pointer is NULL.
     - ECJP_EMPTY_STRING if the input string is empty.
     - ECJP_SYNTAX_ERROR if there is a syntax error in the input string.
+    - ECJP_GENERIC_ERROR on memory allocation failure.
 */
-ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **item_list, ecjp_check_result_t *res)
+static ecjp_return_code_t ecjp_internal_check_and_load_2(ecjp_ctx_t *ctx, const char *input, size_t len, ecjp_item_elem_t **item_list, ecjp_check_result_t *res, ecjp_arena_block_t **arena)
 {
     ecjp_parser_data_t parser_data;
     ecjp_parser_data_t *p;
     ecjp_item_token_t token;
-    char tmp_buffer[ECJP_MAX_ITEM_LEN];
+    char *tmp_buffer = NULL;
     int p_buffer = 0;
+    ecjp_stage1_t stage1;
+    int run_end;
+#ifdef ECJP_STATS
+    int stats_status = -1;
+#endif
 
-    memset(tmp_buffer, 0, ECJP_MAX_ITEM_LEN);
     memset(&token, 0, sizeof(ecjp_item_token_t));
     memset(&parser_data, 0, sizeof(ecjp_parser_data_t));
     p =  &parser_data;
@@ -577,22 +6845,38 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
         ecjp_printf("%s - %d: NULL pointer input/res\n",__FUNCTION__,__LINE__);
         return ECJP_NULL_POINTER;
     }
-    if (strlen(input) == 0) {
+    if (len == 0) {
         ecjp_printf("%s - %d: Empty string input\n",__FUNCTION__,__LINE__);
         return ECJP_EMPTY_STRING;
     }
 #ifdef DEBUG_VERBOSE
-    ecjp_printf("%s - %d:\nInput string: %s\n",__FUNCTION__,__LINE__,input);
+    ecjp_printf("%s - %d:\nInput string: %.*s\n",__FUNCTION__,__LINE__,(int)len,input);
 #endif
+    if (item_list != NULL) {
+        // a value is never longer than the input: the scratch memory is sized on it
+        if (ecjp_ctx_reserve(ctx, (len < ECJP_MAX_ITEM_LEN) ? (len + 1) : ECJP_MAX_ITEM_LEN) != 0) {
+            return ECJP_GENERIC_ERROR;
+        }
+        tmp_buffer = ctx->scratch;
+    }
+    ecjp_stage1_init(&stage1, input, len, ctx->utf8_validation);
+    ECJP_STATS_ADD(bytes_scanned, len);
 
     p->index = 0;
     p->flags.all = 0;
     p->status = ECJP_PS_START;
-    while (input[p->index] != '\0') {
+    while (p->index < (int)len) {
         // walk through the string
 #ifdef DEBUG_VERBOSE        
         ecjp_printf("%s - %d: Index %d, Status %d, Char '%c'\n", __FUNCTION__,__LINE__, p->index, p->status, input[p->index]);
 #endif
+        ECJP_STATS_STATUS(stats_status, p->status);
+        if (input[p->index] == '\0') {
+            // the length is given by the caller: a NUL inside the input is not valid
+            res->err_pos = p->index;
+            ecjp_printf("%s - %d: Unexpected NUL character in input\n", __FUNCTION__,__LINE__);
+            return ECJP_SYNTAX_ERROR;
+        }
         switch (p->status)
         {
             case ECJP_PS_START:
@@ -602,7 +6886,7 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
                     case '\r':
                     case '\t':
                         // skip whitespace
-                        p->index++;
+                        p->index = ecjp_skip_whitespace(&stage1, p->index);
                         continue;
 
                     case '{':
@@ -642,7 +6926,7 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
                     case '\r':
                     case '\t':
                         // skip whitespace
-                        p->index++;
+                        p->index = ecjp_skip_whitespace(&stage1, p->index);
                         continue;
 
                     case '{':
@@ -721,7 +7005,7 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
                     case '\r':
                     case '\t':
                         // skip whitespace
-                        p->index++;
+                        p->index = ecjp_skip_whitespace(&stage1, p->index);
                         continue;
 
                     case '{':
@@ -803,7 +7087,9 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
                         break;
 
                     default:
-                        if (strncmp(&input[p->index], "true", 4) == 0 || strncmp(&input[p->index], "false", 5) == 0 || strncmp(&input[p->index], "null", 4) == 0) {
+                        if ((ecjp_has_chars(&input[p->index], input + len, 4) && strncmp(&input[p->index], "true", 4) == 0) ||
+                            (ecjp_has_chars(&input[p->index], input + len, 5) && strncmp(&input[p->index], "false", 5) == 0) ||
+                            (ecjp_has_chars(&input[p->index], input + len, 4) && strncmp(&input[p->index], "null", 4) == 0)) {
                             // valid value
                             p->status = ECJP_PS_WAIT_COMMA;
                             if (strncmp(&input[p->index], "true", 4) == 0) {
@@ -840,9 +7126,8 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
                             if (p_buffer == 0) {
                                 token.type = ECJP_TYPE_NUMBER;
                             }
-                            if (input[p->index] == '0') {
-                                p->flags.start_zero = 1;
-                            }
+                            // reset also the flag left by a number closed by a bracket
+                            p->flags.start_zero = (input[p->index] == '0') ? 1 : 0;
                             p->status = ECJP_PS_IN_VALUE;
                             if (p->flags.trailing_comma) {
                                 p->flags.trailing_comma = 0;
@@ -863,7 +7148,7 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
                     case '\\':
                         // skip escaped character
                         p->index++;
-                        switch(input[p->index]) {
+                        switch ((p->index < (int)len) ? input[p->index] : '\0') {
                             case '"':
                             case '\\':
                             case '/':
@@ -876,7 +7161,8 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
                                 continue;
 
                             case 'u':
-                                if(ecjp_is_excode(input[p->index+1]) &&
+                                if((p->index + 4 < (int)len) &&
+                                   ecjp_is_excode(input[p->index+1]) &&
                                    ecjp_is_excode(input[p->index+2]) &&
                                    ecjp_is_excode(input[p->index+3]) &&
                                    ecjp_is_excode(input[p->index+4])) {
@@ -912,7 +7198,11 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
                             ecjp_printf("%s - %d: Invalid control character in key\n", __FUNCTION__,__LINE__);
                             return ECJP_SYNTAX_ERROR;
                         } else {
-                            ecjp_store_tmp_item(tmp_buffer, &p_buffer, input[p->index]);
+                            // copy the whole run of plain characters
+                            run_end = ecjp_skip_plain(&stage1, p->index + 1);
+                            ecjp_store_tmp_items(tmp_buffer, &p_buffer, &input[p->index], run_end - p->index);
+                            p->index = run_end;
+                            continue;
                         }
                         break;
                 }
@@ -925,7 +7215,7 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
                     case '\r':
                     case '\t':
                         // skip whitespace
-                        p->index++;
+                        p->index = ecjp_skip_whitespace(&stage1, p->index);
                         continue;
 
                     case ':':
@@ -948,7 +7238,7 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
                     case '\r':
                     case '\t':
                         // skip whitespace
-                        p->index++;
+                        p->index = ecjp_skip_whitespace(&stage1, p->index);
                         continue;
 
                     case '{':
@@ -980,7 +7270,9 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
                         break;
 
                     default:
-                        if (strncmp(&input[p->index], "true", 4) == 0 || strncmp(&input[p->index], "false", 5) == 0 || strncmp(&input[p->index], "null", 4) == 0) {
+                        if ((ecjp_has_chars(&input[p->index], input + len, 4) && strncmp(&input[p->index], "true", 4) == 0) ||
+                            (ecjp_has_chars(&input[p->index], input + len, 5) && strncmp(&input[p->index], "false", 5) == 0) ||
+                            (ecjp_has_chars(&input[p->index], input + len, 4) && strncmp(&input[p->index], "null", 4) == 0)) {
                             // valid value
                             p->status = ECJP_PS_WAIT_COMMA;
                             if (strncmp(&input[p->index], "true", 4) == 0) {
@@ -1002,9 +7294,8 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
                         if ((input[p->index] >= '0' && input[p->index] <= '9') || input[p->index] == '-') {
                             // valid value start
                             p->flags.in_number = 1;
-                            if (input[p->index] == '0') {
-                                p->flags.start_zero = 1;
-                            }
+                            // reset also the flag left by a number closed by a bracket
+                            p->flags.start_zero = (input[p->index] == '0') ? 1 : 0;
                             p->status = ECJP_PS_IN_VALUE;
                             ecjp_store_tmp_item(tmp_buffer, &p_buffer, input[p->index]);
                         } else {
@@ -1035,7 +7326,7 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
                                 case '\\':
                                     // skip escaped character
                                     p->index++;
-                                    switch(input[p->index]) {
+                                    switch ((p->index < (int)len) ? input[p->index] : '\0') {
                                         case '"':
                                         case '\\':
                                         case '/':
@@ -1048,7 +7339,8 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
                                             continue;
 
                                         case 'u':
-                                            if(ecjp_is_excode(input[p->index+1]) &&
+                                            if((p->index + 4 < (int)len) &&
+                                               ecjp_is_excode(input[p->index+1]) &&
                                                ecjp_is_excode(input[p->index+2]) &&
                                                ecjp_is_excode(input[p->index+3]) &&
                                                ecjp_is_excode(input[p->index+4])) {
@@ -1077,8 +7369,11 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
                                         ecjp_printf("%s - %d: Invalid control character inside value\n", __FUNCTION__,__LINE__);
                                         return ECJP_SYNTAX_ERROR;
                                     }
-                                    ecjp_store_tmp_item(tmp_buffer, &p_buffer, input[p->index]);
-                                    break;
+                                    // copy the whole run of plain characters
+                                    run_end = ecjp_skip_plain(&stage1, p->index + 1);
+                                    ecjp_store_tmp_items(tmp_buffer, &p_buffer, &input[p->index], run_end - p->index);
+                                    p->index = run_end;
+                                    continue;
                             }
                         } else {
                             switch (input[p->index]) {
@@ -1093,7 +7388,7 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
                                     }
                                     else {
                                         // skip whitespace
-                                        p->index++;
+                                        p->index = ecjp_skip_whitespace(&stage1, p->index);
                                         continue;
                                     }
                                     break;
@@ -1117,9 +7412,8 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
                                     if (ecjp_get_level_parse_stack(&(p->parse_stack)) == 0) {
                                         if (item_list != NULL)
                                         {
-                                           res->memory_used += ecjp_load_item(&token, tmp_buffer, p_buffer);
                                             // Add item token to the list
-                                            if (ecjp_add_node_item_end(item_list, &token) != 0) {
+                                            if (ecjp_load_and_add_item(item_list, &token, tmp_buffer, p_buffer, arena, res) != 0) {
                                                 res->err_pos = p->index;
                                                 ecjp_printf("%s - %d: Failed to add item token to the list\n", __FUNCTION__,__LINE__);
                                                 return ECJP_GENERIC_ERROR;
@@ -1185,9 +7479,8 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
                                     if (ecjp_get_level_parse_stack(&(p->parse_stack)) == 0) {
                                         if (item_list != NULL)
                                         {
-                                            res->memory_used += ecjp_load_item(&token, tmp_buffer, p_buffer);
                                             // Add item token to the list
-                                            if (ecjp_add_node_item_end(item_list, &token) != 0) {
+                                            if (ecjp_load_and_add_item(item_list, &token, tmp_buffer, p_buffer, arena, res) != 0) {
                                                 res->err_pos = p->index;
                                                 ecjp_printf("%s - %d: Failed to add item token to the list\n", __FUNCTION__,__LINE__);
                                                 return ECJP_GENERIC_ERROR;
@@ -1228,9 +7521,8 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
                                     if (ecjp_get_level_parse_stack(&(p->parse_stack)) == 0) {
                                         if (item_list != NULL)
                                         {
-                                            res->memory_used += ecjp_load_item(&token, tmp_buffer, p_buffer);
                                             // Add item token to the list
-                                            if (ecjp_add_node_item_end(item_list, &token) != 0) {
+                                            if (ecjp_load_and_add_item(item_list, &token, tmp_buffer, p_buffer, arena, res) != 0) {
                                                 res->err_pos = p->index;
                                                 ecjp_printf("%s - %d: Failed to add item token to the list\n", __FUNCTION__,__LINE__);
                                                 return ECJP_GENERIC_ERROR;
@@ -1282,7 +7574,7 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
                     case '\r':
                     case '\t':
                         // skip whitespace
-                        p->index++;
+                        p->index = ecjp_skip_whitespace(&stage1, p->index);
                         continue;
                     
                     case '}':
@@ -1297,9 +7589,8 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
                         if (ecjp_get_level_parse_stack(&(p->parse_stack)) == 0) {
                             if (item_list != NULL)
                             {
-                                res->memory_used += ecjp_load_item(&token, tmp_buffer, p_buffer);
                                 // Add item token to the list
-                                if (ecjp_add_node_item_end(item_list, &token) != 0) {
+                                if (ecjp_load_and_add_item(item_list, &token, tmp_buffer, p_buffer, arena, res) != 0) {
                                     res->err_pos = p->index;
                                     ecjp_printf("%s - %d: Failed to add item token to the list\n", __FUNCTION__,__LINE__);
                                     return ECJP_GENERIC_ERROR;
@@ -1343,9 +7634,8 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
                         if (ecjp_get_level_parse_stack(&(p->parse_stack)) == 0) {
                             if (item_list != NULL)
                             {
-                                res->memory_used += ecjp_load_item(&token, tmp_buffer, p_buffer);
                                 // Add item token to the list
-                                if (ecjp_add_node_item_end(item_list, &token) != 0) {
+                                if (ecjp_load_and_add_item(item_list, &token, tmp_buffer, p_buffer, arena, res) != 0) {
                                     res->err_pos = p->index;
                                     ecjp_printf("%s - %d: Failed to add item token to the list\n", __FUNCTION__,__LINE__);
                                     return ECJP_GENERIC_ERROR;
@@ -1389,9 +7679,8 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
                         if (ecjp_get_level_parse_stack(&(p->parse_stack)) == 0) {
                             if (item_list != NULL)
                             {
-                                res->memory_used += ecjp_load_item(&token, tmp_buffer, p_buffer);
                                 // Add item token to the list
-                                if (ecjp_add_node_item_end(item_list, &token) != 0) {
+                                if (ecjp_load_and_add_item(item_list, &token, tmp_buffer, p_buffer, arena, res) != 0) {
                                     res->err_pos = p->index;
                                     ecjp_printf("%s - %d: Failed to add item token to the list\n", __FUNCTION__,__LINE__);
                                     return ECJP_GENERIC_ERROR;
@@ -1431,7 +7720,7 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
                     case '\r':
                     case '\t':
                         // skip whitespace
-                        p->index++;
+                        p->index = ecjp_skip_whitespace(&stage1, p->index);
                         continue;
 
                     default:
@@ -1447,6 +7736,7 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
 
         p->index++;
     }
+    ECJP_STATS_STATUS(stats_status, p->status);
 
     if (p->status != ECJP_PS_END) {
         ecjp_printf("%s - %d: Incomplete JSON structure\n", __FUNCTION__,__LINE__);
@@ -1457,6 +7747,11 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
         ecjp_printf("%s - %d: Mismatched brackets at end of input\n", __FUNCTION__,__LINE__);
         return ECJP_BRACKETS_MISSING;
     }
+    if (ecjp_stage1_utf8_error(&stage1) >= 0) {
+        res->err_pos = stage1.utf8_err_pos;
+        ecjp_printf("%s - %d: Invalid UTF-8 sequence at position %d\n", __FUNCTION__,__LINE__, res->err_pos);
+        return ECJP_SYNTAX_ERROR;
+    }
 
 #ifdef DEBUG_VERBOSE
     ecjp_print_check_summary(p);
@@ -1467,9 +7762,167 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
     return ECJP_NO_ERROR;
 };
 
+/*
+ * Function: ecjp_internal_check_and_load_2_ctx()
+    This function checks the context and the list, then loads the list with the scratch memory of
+    the context. See ecjp_check_and_load_2_ctx().
+*/
+static ecjp_return_code_t ecjp_internal_check_and_load_2_ctx(ecjp_ctx_t *ctx, const char *input, size_t len, ecjp_item_elem_t **item_list, ecjp_check_result_t *res)
+{
+    if (ctx == NULL) {
+        ecjp_printf("%s - %d: NULL pointer ctx\n",__FUNCTION__,__LINE__);
+        return ECJP_NULL_POINTER;
+    }
+    if ((item_list != NULL) && (*item_list != NULL) && (ecjp_item_vector_of(*item_list)->arena != NULL)) {
+        ecjp_printf("%s - %d: The list was loaded in an arena\n",__FUNCTION__,__LINE__);
+        return ECJP_GENERIC_ERROR;
+    }
+    return ecjp_internal_check_and_load_2(ctx, input, len, item_list, res, NULL);
+}
+
+/* 
+ * Function: ecjp_check_and_load_2_n()
+    This function checks the syntax of a JSON-like input string and loads item tokens (values)
+    into a linked list if the syntax is valid. Each value is allocated with ecjp_malloc().
+    The input is delimited by its length, so it can be a slice of a larger buffer not NUL-terminated.
+    See ecjp_internal_check_and_load_2().
+    Returns also:
+    - ECJP_GENERIC_ERROR if the list was loaded by ecjp_check_and_load_2_arena().
+*/
+ecjp_return_code_t ecjp_check_and_load_2_n(const char *input, size_t len, ecjp_item_elem_t **item_list, ecjp_check_result_t *res)
+{
+    ecjp_ctx_t ctx;
+    ecjp_return_code_t ret;
+
+    ecjp_init_ctx(&ctx);
+    // the temporary context doesn't keep the counters: they are the ones of the thread
+    ret = ecjp_internal_check_and_load_2_ctx(&ctx, input, len, item_list, res);
+    ecjp_free_ctx(&ctx);
+    return ret;
+}
+
+/*
+ * Function: ecjp_check_and_load_2_ctx()
+    Same as ecjp_check_and_load_2_n(), the values are built in the scratch memory of the context,
+    that is kept for the next calls: a loop over many inputs allocates it only once.
+    The input is validated as UTF-8 if the utf8_validation field of the context is set.
+    The call counts in the counters of the context (see ecjp_get_stats()).
+    Parameters:
+    - ctx: Pointer to the context (see ecjp_init_ctx()).
+    - input: The JSON-like input string to be checked and loaded.
+    - len: The length of the input string.
+    - item_list: Pointer to a list of item elements loaded with the item tokens found in the input string.
+    - res: Pointer to a structure to store the result of the check, including any error position.
+    Returns:
+    - See ecjp_check_and_load_2_n().
+    - ECJP_NULL_POINTER if ctx is NULL.
+*/
+ecjp_return_code_t ecjp_check_and_load_2_ctx(ecjp_ctx_t *ctx, const char *input, size_t len, ecjp_item_elem_t **item_list, ecjp_check_result_t *res)
+{
+    ecjp_return_code_t ret;
+#ifdef ECJP_STATS
+    ecjp_stats_t *stats_prev = ecjp_stats_cur;
+#endif
+
+    if (ctx == NULL) {
+        ecjp_printf("%s - %d: NULL pointer ctx\n",__FUNCTION__,__LINE__);
+        return ECJP_NULL_POINTER;
+    }
+    ECJP_STATS_USE(&ctx->stats);
+    ret = ecjp_internal_check_and_load_2_ctx(ctx, input, len, item_list, res);
+    ECJP_STATS_USE(stats_prev);
+    return ret;
+}
+
+/* 
+ * Function: ecjp_check_and_load_2_arena_n()
+    This function checks the syntax of a JSON-like input string and loads item tokens (values)
+    into a linked list, as ecjp_check_and_load_2_n(), but the values are allocated from an arena
+    owned by the list: ecjp_free_item_list() frees the arena with a few calls to free(), not one for each item.
+    res->memory_used is the number of bytes allocated for the list (vector of the elements and blocks of the arena).
+    Parameters:
+    - input: The JSON-like input string to be checked and loaded.
+    - len: The length of the input string; a '\0' found before len is a syntax error.
+    - item_list: Pointer to a list of item elements, empty or loaded by this function.
+    - res: Pointer to a structure to store the result of the check, including any error position.
+    Returns:
+    - ECJP_NO_ERROR if the input string is valid.
+    - ECJP_NULL_POINTER if any input pointer is NULL.
+    - ECJP_EMPTY_STRING if the input string is empty.
+    - ECJP_SYNTAX_ERROR if there is a syntax error in the input string.
+    - ECJP_GENERIC_ERROR on memory allocation failure, or if the list was not loaded by this function.
+*/
+ecjp_return_code_t ecjp_check_and_load_2_arena_n(const char *input, size_t len, ecjp_item_elem_t **item_list, ecjp_check_result_t *res)
+{
+    ecjp_arena_block_t *arena = NULL;
+    ecjp_item_vector_t *v;
+    ecjp_ctx_t ctx;
+    ecjp_return_code_t ret;
+    size_t size;
+
+    if ((item_list == NULL) || (res == NULL)) {
+        ecjp_printf("%s - %d: NULL pointer item_list/res\n",__FUNCTION__,__LINE__);
+        return ECJP_NULL_POINTER;
+    }
+    if (*item_list != NULL) {
+        // the new values are added to the arena of the list
+        arena = ecjp_item_vector_of(*item_list)->arena;
+        if (arena == NULL) {
+            ecjp_printf("%s - %d: The list was not loaded in an arena\n",__FUNCTION__,__LINE__);
+            return ECJP_GENERIC_ERROR;
+        }
+    }
+    // the values are copied from the input: a small input fits in the first block,
+    // with the terminators of ECJP_LIST_MIN_CAPACITY values
+    size = len + ECJP_LIST_MIN_CAPACITY;
+    if ((len > 0) && (ecjp_arena_add_block(&arena, (size < ECJP_ARENA_BLOCK_SIZE) ? size : ECJP_ARENA_BLOCK_SIZE) != 0)) {
+        return ECJP_GENERIC_ERROR;
+    }
+    ecjp_init_ctx(&ctx);
+    ret = ecjp_internal_check_and_load_2(&ctx, input, len, item_list, res, &arena);
+    ecjp_free_ctx(&ctx);
+    if (*item_list != NULL) {
+        v = ecjp_item_vector_of(*item_list);
+        v->arena = arena;
+        res->memory_used = (int)(sizeof(ecjp_item_vector_t) + (v->capacity * sizeof(ecjp_item_elem_t))) + ecjp_arena_footprint(arena);
+    } else {
+        ecjp_free_arena(&arena);
+        res->memory_used = 0;
+    }
+    return ret;
+}
+
+/*
+    Function: ecjp_check_and_load_2_arena()
+    This function calls ecjp_check_and_load_2_arena_n() on a NUL-terminated input string.
+*/
+ecjp_return_code_t ecjp_check_and_load_2_arena(const char *input, ecjp_item_elem_t **item_list, ecjp_check_result_t *res)
+{
+    return ecjp_check_and_load_2_arena_n(input, (input != NULL) ? strlen(input) : 0, item_list, res);
+}
+
+/*
+    Function: ecjp_check_and_load_2()
+    This function calls ecjp_check_and_load_2_n() on a NUL-terminated input string.
+    Parameters:
+    - input: The JSON-like input string to be checked and loaded.
+    - item_list: Pointer to a list of item elements loaded with the item tokens found in the input string.
+    - res: Pointer to a structure to store the result of the check, including any error position.
+    Returns:
+    - ECJP_NO_ERROR if the input string is valid.
+    - ECJP_NULL_POINTER if any input pointer is NULL.
+    - ECJP_EMPTY_STRING if the input string is empty.
+    - ECJP_SYNTAX_ERROR if there is a syntax error in the input string.
+*/
+ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **item_list, ecjp_check_result_t *res)
+{
+    return ecjp_check_and_load_2_n(input, (input != NULL) ? strlen(input) : 0, item_list, res);
+}
+
 /*
     Function: ecjp_check_syntax_2()
-    This function call ecjp_check_and_load_2() without pointer to store the items to perform only syntax checking.
+    This function performs only syntax checking, with the same results as ecjp_check_and_load_2() without pointer
+    to store the items (see ecjp_internal_check_syntax()).
     Parameters:
     - input: The JSON-like input string to be checked and loaded.
     - res: Pointer to a structure to store the result of the check, including any error position.
@@ -1481,7 +7934,41 @@ ecjp_return_code_t ecjp_check_and_load_2(const char *input, ecjp_item_elem_t **i
 */
 ecjp_return_code_t ecjp_check_syntax_2(const char *input, ecjp_check_result_t *res)
 {
-    return ecjp_check_and_load_2(input, NULL, res);
+    return ecjp_internal_check_syntax(input, (input != NULL) ? strlen(input) : 0, res, NULL, NULL, ECJP_BOOL_FALSE);
+}
+
+/*
+    Function: ecjp_check_syntax_2_n()
+    Same as ecjp_check_syntax_2(), the input string is delimited by its length (len).
+*/
+ecjp_return_code_t ecjp_check_syntax_2_n(const char *input, size_t len, ecjp_check_result_t *res)
+{
+    return ecjp_internal_check_syntax(input, len, res, NULL, NULL, ECJP_BOOL_FALSE);
+}
+
+/*
+    Function: ecjp_check_syntax_2_ctx()
+        Same as ecjp_check_syntax_2_n(), the input is validated as UTF-8 if the utf8_validation
+        field of the context is set.
+        The call counts in the counters of the context (see ecjp_get_stats()).
+        Returns also:
+        - ECJP_NULL_POINTER if ctx is NULL.
+*/
+ecjp_return_code_t ecjp_check_syntax_2_ctx(ecjp_ctx_t *ctx, const char *input, size_t len, ecjp_check_result_t *res)
+{
+    ecjp_return_code_t ret;
+#ifdef ECJP_STATS
+    ecjp_stats_t *stats_prev = ecjp_stats_cur;
+#endif
+
+    if (ctx == NULL) {
+        ecjp_printf("%s - %d: NULL pointer ctx\n",__FUNCTION__,__LINE__);
+        return ECJP_NULL_POINTER;
+    }
+    ECJP_STATS_USE(&ctx->stats);
+    ret = ecjp_internal_check_syntax(input, len, res, NULL, NULL, ctx->utf8_validation);
+    ECJP_STATS_USE(stats_prev);
+    return ret;
 }
 
 /*
@@ -1503,6 +7990,15 @@ ecjp_return_code_t ecjp_load_2(const char *input, ecjp_item_elem_t **item_list,
     return ecjp_check_and_load_2(input, item_list, res);
 }
 
+/*
+    Function: ecjp_load_2_n()
+    Same as ecjp_load_2(), the input string is delimited by its length (len).
+*/
+ecjp_return_code_t ecjp_load_2_n(const char *input, size_t len, ecjp_item_elem_t **item_list, ecjp_check_result_t *res)
+{
+    return ecjp_check_and_load_2_n(input, len, item_list, res);
+}
+
 /*
  * Function: ecjp_split_key_and_value()
  * --------------------
@@ -1577,7 +8073,7 @@ ecjp_return_code_t ecjp_split_key_and_value(ecjp_item_elem_t *item_list, char *k
  * Reads an element from the item list by its index and copies its value to the output structure.
  * Parameters:
  *      item_list: Pointer to the head of the ecjp_item_elem_t linked list.
- *      index: The index of the element to read.
+ *      index: The index of the element to read (the item is accessed in constant time).
  *      out: Pointer to an ecjp_outdata_t structure where the output will be stored.
  * Returns:
  *  ECJP_NO_ERROR on success
@@ -1586,30 +8082,24 @@ ecjp_return_code_t ecjp_split_key_and_value(ecjp_item_elem_t *item_list, char *k
 */
 ecjp_return_code_t ecjp_read_element(ecjp_item_elem_t *item_list, int index, ecjp_outdata_t *out)
 {
-    int current_index;
-    current_index = 0;
+    ecjp_item_token_t *item;
 
     if (item_list == NULL || out == NULL) {
         return ECJP_NULL_POINTER;
     }
 
-    while ((item_list != NULL) && (current_index <= index)) {
-        if (current_index == index) {
-            ecjp_printf("%s - %d: Find element of index %d: Type = %s, Value = %s\n", __FUNCTION__, __LINE__,index, ecjp_type[item_list->item.type], (char *)item_list->item.value);
-            if ((out->value != NULL) && (out->value_size >= item_list->item.value_size)) {
-                memset(out->value, 0, out->value_size);
-                out->type = item_list->item.type;
-                out->value_size = item_list->item.value_size;
-                memcpy(out->value, item_list->item.value, out->value_size);
-            }
-            break;
-        }
-        item_list = item_list->next;
-        current_index++;
-    }
-    if (item_list == NULL) {
+    item = ecjp_get_item_token(item_list, index);
+    if (item == NULL) {
         return ECJP_INDEX_OUT_OF_BOUNDS;
     }
+    ecjp_printf("%s - %d: Find element of index %d: Type = %s, Value = %s\n", __FUNCTION__, __LINE__,index, ecjp_type[item->type], (char *)item->value);
+    if ((out->value != NULL) && (out->value_size >= item->value_size)) {
+        memset(out->value, 0, out->value_size);
+        out->type = item->type;
+        out->value_size = item->value_size;
+        memcpy(out->value, item->value, out->value_size);
+        ECJP_STATS_ADD(bytes_copied, out->value_size);
+    }
 
     return ECJP_NO_ERROR;
 }
@@ -1648,8 +8138,7 @@ ecjp_return_code_t ecjp_read_key_2(ecjp_item_elem_t *item_list, const char *key,
     current_item = item_list;
     while (current_item != NULL) {
         split_res = ECJP_NO_ERROR;
-        memset(extracted_key, 0, ECJP_MAX_KEY_LEN);
-        memset(extracted_value, 0, ECJP_MAX_KEY_VALUE_LEN);
+        // ecjp_split_key_and_value() terminates the key and the value, the buffers are not cleared
 
         if (current_index < index) {
             current_item = current_item->next;
@@ -1657,6 +8146,7 @@ ecjp_return_code_t ecjp_read_key_2(ecjp_item_elem_t *item_list, const char *key,
             continue;
         }
         if (current_item->item.type == ECJP_TYPE_KEY_VALUE_PAIR) {
+            ECJP_STATS_ADD(bytes_rescanned, current_item->item.value_size);
             split_res = ecjp_split_key_and_value(current_item, extracted_key, extracted_value, ECJP_BOOL_FALSE);
             if (split_res != ECJP_NO_ERROR) {
                 ecjp_printf("%s - %d: Fail to split key and value pair (res = %d)\n", __FUNCTION__, __LINE__,split_res);
@@ -1674,15 +8164,19 @@ ecjp_return_code_t ecjp_read_key_2(ecjp_item_elem_t *item_list, const char *key,
                     out->type = current_item->item.type;
                     out->value_size = strlen(extracted_value) + 1;
                     memcpy(out->value, extracted_value, out->value_size);
+                    ECJP_STATS_ADD(bytes_copied, out->value_size);
                     out->last_pos = current_index;
                     out->error_code = ECJP_NO_ERROR;
                 }
+                // the list is walked again from its head for each key
+                ECJP_STATS_RESCAN(__FUNCTION__, nodes_revisited, item_list, ecjp_get_item_count(item_list), current_index + 1);
                 return ECJP_NO_ERROR;
             }
         }
         current_item = current_item->next;
         current_index++;
     }
+    ECJP_STATS_RESCAN(__FUNCTION__, nodes_revisited, item_list, ecjp_get_item_count(item_list), current_index);
 #ifdef DEBUG_VERBOSE
     ecjp_printf("%s - %d: Fail with error ECJP_INDEX_NOT_FOUND\n", __FUNCTION__, __LINE__);
 #endif
@@ -1691,13 +8185,36 @@ ecjp_return_code_t ecjp_read_key_2(ecjp_item_elem_t *item_list, const char *key,
 
 #else
 
+/*
+ * The elements of a key list are stored in a contiguous vector: the next pointers link
+ * the elements in order, so the list can be walked as before or accessed by index.
+ * The head of the list is the first element of the vector.
+*/
+typedef struct ecjp_key_vector {
+    int                 count;
+    int                 capacity;
+    ecjp_key_elem_t     elem[];
+} ecjp_key_vector_t;
+
 /* Internal function definitions */
 
+/*
+ * Function: ecjp_key_vector_of()
+        This function returns the vector that stores the elements of a key list.
+        Parameters:
+        - head: Pointer to the head of the key list (first element of the vector).
+*/
+static inline ecjp_key_vector_t *ecjp_key_vector_of(ecjp_key_elem_t *head)
+{
+    return (ecjp_key_vector_t *)((char *)head - offsetof(ecjp_key_vector_t, elem));
+}
+
 /*
  * Function: ecjp_add_node_end()
-        This function adds a new key token node to the end of the linked list.
+        This function appends a new key token to the vector of the list, in O(1) amortized time.
+        The capacity of the vector is doubled when it's full.
         Parameters:
-        - head: Pointer to the head of the linked list.
+        - head: Pointer to the head of the linked list, updated if the vector is moved.
         - data: Pointer to the key token data to add.
         Returns:
         - 0 on success.
@@ -1705,36 +8222,46 @@ ecjp_return_code_t ecjp_read_key_2(ecjp_item_elem_t *item_list, const char *key,
 */
 int ecjp_add_node_end(ecjp_key_elem_t **head, ecjp_key_token_t *data)
 {
-    ecjp_key_elem_t  *new_node;
-    ecjp_key_elem_t  *current;
-
-    new_node = (ecjp_key_elem_t *)malloc(sizeof(ecjp_key_elem_t));
-    if (!new_node)
-        return -1;
+    ecjp_key_vector_t  *v;
+    ecjp_key_vector_t  *grown;
+    ecjp_key_elem_t    *new_node;
+    int i, capacity;
+
+    v = (*head == NULL) ? NULL : ecjp_key_vector_of(*head);
+    if ((v == NULL) || (v->count == v->capacity)) {
+        capacity = (v == NULL) ? ECJP_LIST_MIN_CAPACITY : (v->capacity * 2);
+        grown = (ecjp_key_vector_t *)ecjp_realloc(v, sizeof(ecjp_key_vector_t) + (capacity * sizeof(ecjp_key_elem_t)));
+        if (!grown)
+            return -1;
+        if (v == NULL)
+            grown->count = 0;
+        grown->capacity = capacity;
+        // the array can be moved by realloc(): link again the elements
+        for (i = 1; i < grown->count; i++) {
+            grown->elem[i - 1].next = &grown->elem[i];
+        }
+        v = grown;
+        *head = &v->elem[0];
+    }
+    new_node = &v->elem[v->count];
     new_node->key.start_pos = data->start_pos;
     new_node->key.length = data->length;
     new_node->key.type = data->type;
     new_node->next = NULL;
-    if (*head == NULL)
-    {
-        *head = new_node;
-    }
-    else
-    {
-        current = *head;
-        while (current->next != NULL)
-            current = current->next;
-        current->next = new_node;
+    if (v->count > 0) {
+        v->elem[v->count - 1].next = new_node;
     }
+    v->count++;
+    ECJP_STATS_ADD(nodes_allocated, 1);
     return 0;
 }
 
 /*
  * Function: ecjp_internal_copy_array_element()
-        This function copies an array element from a buffer to an output structure if it matches the requested index.
+        This function copies an array element to an output structure if it matches the requested index.
         Parameters:
-        - buffer: The buffer containing the array element.
-        - p_buffer: The size of the buffer.
+        - buffer: The characters of the array element, not NUL-terminated.
+        - p_buffer: The length of the array element.
         - index: The index of the requested array element.
         - num_elements: The current number of elements processed.
         - out: Pointer to an output structure to store the array element's details.
@@ -1742,21 +8269,22 @@ int ecjp_add_node_end(ecjp_key_elem_t **head, ecjp_key_token_t *data)
         - ECJP_INDEX_NOT_FOUND if the requested index does not match the current element.
         - ECJP_NO_ERROR if the requested element is found and copied to out.
 */
-ecjp_return_code_t ecjp_internal_copy_array_element(char *buffer, unsigned int p_buffer, int index, int num_elements, ecjp_outdata_t *out)
+ecjp_return_code_t ecjp_internal_copy_array_element(const char *buffer, unsigned int p_buffer, int index, int num_elements, ecjp_outdata_t *out)
 {
     ecjp_return_code_t ret = ECJP_INDEX_NOT_FOUND;
 
     // check if this is the requested element
     if ((index != ECJP_ARRAY_NO_INDEX) && (num_elements - 1 == index)) {
         // found requested element
-        if (p_buffer >= ECJP_MAX_ARRAY_ELEM_LEN) {
-            ecjp_printf("%s - %d: Value buffer too small, truncated to %d bytes\n", __FUNCTION__,__LINE__,(ECJP_MAX_ARRAY_ELEM_LEN - 1));
+        if ((out->value_size > 0) && (p_buffer >= out->value_size)) {
+            ecjp_printf("%s - %d: Value buffer too small, truncated to %d bytes\n", __FUNCTION__,__LINE__,(out->value_size - 1));
         }
         // copy to out structure
         if ((out->value != NULL) && (out->value_size > 0)) {
             strncpy(out->value, buffer, (p_buffer < out->value_size) ? p_buffer : (out->value_size - 1));
             *(char *)(out->value + ((p_buffer < out->value_size) ? p_buffer : (out->value_size - 1))) = '\0'; // null terminate
             out->length = (p_buffer < out->value_size) ? p_buffer : (out->value_size - 1);
+            ECJP_STATS_ADD(bytes_copied, out->length);
             out->error_code = ECJP_NO_ERROR;
             ret = out->error_code;
         } else {
@@ -1767,6 +8295,56 @@ ecjp_return_code_t ecjp_internal_copy_array_element(char *buffer, unsigned int p
     return ret;
 }
 
+/*
+ * Function: ecjp_internal_end_array_element()
+        This function is called at the end of each element of an array: the element is appended to
+        the array index if used, else it's stored in the view if it matches the requested index.
+        Parameters:
+        - input: The JSON-like array string.
+        - end: Pointer past the last character of the input, NULL if the input is null terminated.
+        - elem_start: The position of the element in the input string.
+        - elem_len: The length of the element.
+        - elem_type: The type of the element.
+        - index: The index of the requested array element.
+        - num_elements: The current number of elements processed.
+        - array_index: Pointer to the array index to load, NULL if not used.
+        - view: Pointer to the view to store the requested element, used if array_index is NULL.
+        Returns:
+        - ECJP_INDEX_NOT_FOUND if the parsing of the array must go on.
+        - ECJP_NO_ERROR if the requested element is found and stored in the view.
+        - ECJP_GENERIC_ERROR on memory allocation failure.
+*/
+static ecjp_return_code_t ecjp_internal_end_array_element(const char input[], const char *end, int elem_start, unsigned int elem_len, ecjp_value_type_t elem_type, int index, int num_elements, ecjp_array_index_t *array_index, ecjp_value_view_t *view)
+{
+    ecjp_array_elem_token_t *grown;
+    int capacity;
+
+    if (array_index == NULL) {
+        if (num_elements - 1 != index) {
+            return ECJP_INDEX_NOT_FOUND;
+        }
+        view->ptr = &input[elem_start];
+        view->len = elem_len;
+        view->type = elem_type;
+        // the array is walked again from its start for each element
+        ECJP_STATS_RESCAN("ecjp_read_array_element", bytes_rescanned, input, ECJP_INPUT_SIZE(input, end), elem_start + elem_len);
+        return ECJP_NO_ERROR;
+    }
+    if (array_index->count == array_index->capacity) {
+        capacity = (array_index->capacity == 0) ? ECJP_LIST_MIN_CAPACITY : (array_index->capacity * 2);
+        grown = (ecjp_array_elem_token_t *)ecjp_realloc(array_index->elem, capacity * sizeof(ecjp_array_elem_token_t));
+        if (!grown)
+            return ECJP_GENERIC_ERROR;
+        array_index->elem = grown;
+        array_index->capacity = capacity;
+    }
+    array_index->elem[array_index->count].offset = (unsigned int)elem_start;
+    array_index->elem[array_index->count].length = elem_len;
+    array_index->elem[array_index->count].type = (unsigned char)elem_type;
+    array_index->count++;
+    return ECJP_INDEX_NOT_FOUND;
+}
+
 /*
     Function: ecjp_print_keys()
         This function prints all keys stored in the linked list along with their types.
@@ -1804,28 +8382,135 @@ ecjp_return_code_t  ecjp_print_keys(const char *input, ecjp_key_elem_t *key_list
     Function: ecjp_free_key_list()
         This function frees the memory allocated for the linked list of keys.
         Parameters:
-        - key_list: Pointer to a pointer to the linked list of keys.
+        - key_list: Pointer to a pointer to the linked list of keys (head of the list returned by the library).
+        Returns:
+        - ECJP_NO_ERROR on success.
+*/
+ecjp_return_code_t ecjp_free_key_list(ecjp_key_elem_t **key_list)
+{
+    if(key_list == NULL || *key_list == NULL)
+        return ECJP_NO_ERROR;
+        
+    ecjp_free(ecjp_key_vector_of(*key_list));
+    *key_list = NULL;
+
+    return ECJP_NO_ERROR;
+}
+
+/*
+    Function: ecjp_get_key_count()
+        This function returns the number of keys stored in a key list.
+        Parameters:
+        - key_list: Head of the key list.
+        Returns:
+        - The number of keys, 0 if the list is empty.
+*/
+int ecjp_get_key_count(ecjp_key_elem_t *key_list)
+{
+    if (key_list == NULL)
+        return 0;
+    return ecjp_key_vector_of(key_list)->count;
+}
+
+/*
+    Function: ecjp_get_key_token()
+        This function returns the key at a given index of a key list, in constant time.
+        Parameters:
+        - key_list: Head of the key list.
+        - index: The index of the key.
+        Returns:
+        - Pointer to the key token, NULL if the index is out of bounds.
+*/
+ecjp_key_token_t *ecjp_get_key_token(ecjp_key_elem_t *key_list, int index)
+{
+    if ((index < 0) || (index >= ecjp_get_key_count(key_list)))
+        return NULL;
+    return &(ecjp_key_vector_of(key_list)->elem[index].key);
+}
+
+/*
+    Function: ecjp_init_key_index()
+        This function initializes an empty key index.
+        Parameters:
+        - key_index: Pointer to the index.
+        - policy: The key kept by the index when a key name is duplicated:
+          ECJP_DUP_FIRST_WINS (first key in the input) or ECJP_DUP_LAST_WINS (last key in the input).
+        Returns:
+        - ECJP_NO_ERROR on success.
+        - ECJP_NULL_POINTER if key_index is NULL.
+*/
+ecjp_return_code_t ecjp_init_key_index(ecjp_key_index_t *key_index, ecjp_dup_policy_t policy)
+{
+    if (key_index == NULL) {
+        return ECJP_NULL_POINTER;
+    }
+    memset(key_index, 0, sizeof(ecjp_key_index_t));
+    key_index->policy = policy;
+    return ECJP_NO_ERROR;
+}
+
+/*
+    Function: ecjp_free_key_index()
+        This function frees the memory allocated for a key index and leaves it empty.
+        Parameters:
+        - key_index: Pointer to the index.
+        Returns:
+        - ECJP_NO_ERROR on success.
+*/
+ecjp_return_code_t ecjp_free_key_index(ecjp_key_index_t *key_index)
+{
+    if (key_index == NULL) {
+        return ECJP_NO_ERROR;
+    }
+    ecjp_free(key_index->slot);
+    key_index->slot = NULL;
+    key_index->capacity = 0;
+    key_index->count = 0;
+    return ECJP_NO_ERROR;
+}
+
+/*
+    Function: ecjp_find_key()
+        This function finds a key by name in a key index, in constant expected time.
+        Unlike ecjp_get_key(), the whole name must match: the key is compared with the characters
+        of the key in the input string (escape sequences are not decoded).
+        Parameters:
+        - key_index: Pointer to the index loaded by ecjp_check_and_load_indexed().
+        - input: The JSON-like input string used to load the index.
+        - key: The name of the key to search for.
+        - out: Pointer to an output structure to store the found key's details (type, position and length).
         Returns:
-        - ECJP_NO_ERROR on success.
+        - ECJP_NO_ERROR if the key is found.
+        - ECJP_NO_MORE_KEY if the key is not in the index.
+        - ECJP_NULL_POINTER if any input pointer is NULL.
 */
-ecjp_return_code_t ecjp_free_key_list(ecjp_key_elem_t **key_list)
+ecjp_return_code_t ecjp_find_key(const ecjp_key_index_t *key_index, const char *input, const char *key, ecjp_outdata_t *out)
 {
-    ecjp_key_elem_t *current;
-    ecjp_key_elem_t *next;
-
-    if(key_list == NULL || *key_list == NULL)
-        return ECJP_NO_ERROR;
-        
-    current = *key_list;
+    const ecjp_key_slot_t *slot;
+    unsigned int hash, mask, i;
+    size_t key_len;
 
-    while (current != NULL) {
-        next = current->next;
-        free(current);
-        current = next;
+    if (key_index == NULL || input == NULL || key == NULL || out == NULL) {
+        return ECJP_NULL_POINTER;
     }
-    *key_list = NULL;
-
-    return ECJP_NO_ERROR;
+    if (key_index->capacity == 0) {
+        return ECJP_NO_MORE_KEY;
+    }
+    key_len = strlen(key);
+    hash = ecjp_hash_update(ECJP_HASH_INIT, key, key_len);
+    mask = key_index->capacity - 1;
+    for (i = hash & mask; key_index->slot[i].key.type != ECJP_TYPE_UNDEFINED; i = (i + 1) & mask) {
+        slot = &key_index->slot[i];
+        if ((slot->hash == hash) && (slot->key.length == key_len) &&
+            (memcmp(&input[slot->key.start_pos], key, key_len) == 0)) {
+            out->error_code = ECJP_NO_ERROR;
+            out->type = slot->key.type;
+            out->last_pos = slot->key.start_pos;
+            out->length = slot->key.length;
+            return ECJP_NO_ERROR;
+        }
+    }
+    return ECJP_NO_MORE_KEY;
 }
 
 /*
@@ -1865,6 +8550,7 @@ ecjp_return_code_t ecjp_get_key(const char input[],char *key,ecjp_key_elem_t **k
         current = current->next;
     }
     if(current == NULL) {
+        ECJP_STATS_RESCAN(__FUNCTION__, nodes_revisited, *key_list, ecjp_get_key_count(*key_list), ecjp_get_key_count(*key_list));
         ret = ECJP_NO_MORE_KEY;
         return ret;
     }
@@ -1876,6 +8562,7 @@ ecjp_return_code_t ecjp_get_key(const char input[],char *key,ecjp_key_elem_t **k
         memset(buffer, 0, sizeof(buffer));
         len = (current->key.length < ECJP_MAX_KEY_LEN) ? current->key.length : (ECJP_MAX_KEY_LEN - 1);
         strncpy(buffer, &input[current->key.start_pos], len);
+        ECJP_STATS_ADD(bytes_rescanned, len);
         if(key != NULL)
         {
             // search for specific key, return NO_ERROR only if key is found, no need to copy again in out.value
@@ -1906,6 +8593,7 @@ ecjp_return_code_t ecjp_get_key(const char input[],char *key,ecjp_key_elem_t **k
                 }
                 memcpy(dst, buffer, len);
                 dst[len] = '\0'; // null terminate
+                ECJP_STATS_ADD(bytes_copied, len);
             } else {
                 out->error_code = ECJP_NO_SPACE_IN_BUFFER_VALUE;
             }
@@ -1914,6 +8602,9 @@ ecjp_return_code_t ecjp_get_key(const char input[],char *key,ecjp_key_elem_t **k
         }
         current = current->next;
     }
+    // the list is walked again from its head for each call, the elements are contiguous
+    ECJP_STATS_RESCAN(__FUNCTION__, nodes_revisited, *key_list, ecjp_get_key_count(*key_list),
+                                    (current != NULL) ? (current - *key_list + 1) : ecjp_get_key_count(*key_list));
     if (ret == ECJP_GENERIC_ERROR)
         ret = ECJP_NO_MORE_KEY;
 
@@ -1921,191 +8612,247 @@ ecjp_return_code_t ecjp_get_key(const char input[],char *key,ecjp_key_elem_t **k
 }
 
 /*
- Function: ecjp_read_key()
-    This function reads the value associated with a specific key from a JSON-like input string.
+ Function: ecjp_find_key_value()
+    This function returns the position after the colon that follows a key found with ecjp_get_key().
     Parameters:
     - input: The JSON-like input string.
+    - end: Pointer to the first character after the input string, NULL if the input is NUL-terminated.
     - in: Pointer to an input structure containing key details.
-    - out: Pointer to an output structure to store the key's value details.
     Returns:
-    - ECJP_NO_ERROR if the key's value is successfully read and stored in out.
+    - The position of the first character after the colon (end if the colon is not found).
+*/
+static const char *ecjp_find_key_value(const char input[],const char *end,const ecjp_indata_t *in)
+{
+    const char *ptr;
+
+    // set to input buffer start position
+    if ((end != NULL) && ((in->pos + in->length + 1) > (end - input))) {
+        ptr = end;
+    } else {
+        ptr = &input[in->pos + in->length + 1]; // skip key and quote
+    }
+    // find colon
+    while (ecjp_has_char(ptr, end) && *ptr != ':') {
+        ptr++;
+    }
+    if(ecjp_has_char(ptr, end) && *ptr == ':') {
+        ptr++; // skip colon
+    }
+    return ptr;
+}
+
+/*
+ Function: ecjp_internal_read_key_view()
+    This function finds the value associated with a specific key in a JSON-like input string.
+    The value is not copied: the view points to its characters inside the input string.
+    Parameters:
+    - input: The JSON-like input string.
+    - end: Pointer to the first character after the input string, NULL if the input is NUL-terminated.
+    - in: Pointer to an input structure containing key details.
+    - view: Pointer to the view to store the position, length and type of the value;
+      the position is NULL if the value is not found.
+    Returns:
+    - ECJP_NO_ERROR if the key's value is found.
     - ECJP_NULL_POINTER if any input pointer is NULL.
-    - ECJP_NO_SPACE_IN_BUFFER_VALUE if the output buffer is insufficient.
     - ECJP_EMPTY_STRING if the key has no associated value (should not happen in well-formed JSON).
+    - ECJP_GENERIC_ERROR if the value is not found.
 */
-ecjp_return_code_t ecjp_read_key(const char input[],ecjp_indata_t *in,ecjp_outdata_t *out)
+static ecjp_return_code_t ecjp_internal_read_key_view(const char input[],const char *end,ecjp_indata_t *in,ecjp_value_view_t *view)
 {
     ecjp_return_code_t ret = ECJP_NO_ERROR;
-    char *ptr;
-    char *ptr_value = NULL; // pointer to value start
-    unsigned int vsize;
-    unsigned short int open_brackets;
+    const char *ptr;
+    size_t vsize;
+    ecjp_stage1_t stage1;
+    int last;
 
-    if (in == NULL || out == NULL) {
-        ecjp_printf("%s - %d: NULL pointer in/out",__FUNCTION__,__LINE__);
-        ret = ECJP_NULL_POINTER;
-        return ret;
-    }
-    if (input == NULL) {
-        ecjp_printf("%s - %d: No input, NULL pointer",__FUNCTION__,__LINE__);
+    if (in == NULL || view == NULL || input == NULL) {
+        ecjp_printf("%s - %d: NULL pointer input/in/view",__FUNCTION__,__LINE__);
         ret = ECJP_NULL_POINTER;
         return ret;
     }
 
+    view->ptr = NULL;
+    view->len = 0;
+    view->type = ECJP_TYPE_UNDEFINED;
     if (in->type == ECJP_TYPE_UNDEFINED) {
         // skip research
-        out->type = ECJP_TYPE_UNDEFINED;
-        out->error_code = ECJP_EMPTY_STRING;
-        ret = out->error_code;
-        return ret;
-    }
-
-    if(out->value == NULL || out->value_size == 0) {
-        ecjp_printf("%s - %d: No buffer supplied for store value\n", __FUNCTION__,__LINE__);
-        out->error_code = ECJP_NO_SPACE_IN_BUFFER_VALUE;
-        ret = out->error_code;
+        ret = ECJP_EMPTY_STRING;
         return ret;
     }
 
     vsize = 0;
-    open_brackets = 0;
     
-    // set to input buffer start position
-    ptr = (char *)&input[in->pos + in->length + 1]; // skip key and quote
-    // find colon
-    while (*ptr != ':' && *ptr != '\0') {
-        ptr++;
-    }
-    if(*ptr == ':') {
-        ptr++; // skip colon
-    }
+    ptr = ecjp_find_key_value(input, end, in);
     // calculate value size
     switch (in->type) {
         case ECJP_TYPE_STRING:
-            out->type = ECJP_TYPE_STRING;
-            while(ecjp_is_whitespace(*ptr) == ECJP_BOOL_TRUE) {
+            view->type = ECJP_TYPE_STRING;
+            while(ecjp_has_char(ptr, end) && ecjp_is_whitespace(*ptr) == ECJP_BOOL_TRUE) {
                 ptr++;
             }
-            if (*ptr == '"') {
-                ptr++;
-                ptr_value = ptr;
-                while (*ptr != '"' && *ptr != '\0') {
-                    vsize++;
-                    ptr++;
-                }
-                out->error_code = ECJP_NO_ERROR;
+            if (ecjp_has_char(ptr, end) && *ptr == '"') {
+                view->ptr = ptr + 1;
+                ecjp_stage1_init(&stage1, ptr, (end != NULL) ? (int)(end - ptr) : -1, ECJP_BOOL_FALSE);
+                last = ecjp_skip_string(&stage1, 0);
+                // a string not closed takes the rest of the input
+                vsize = (last < 0) ? (size_t)(stage1.len - 1) : (size_t)(last - 1);
             }   
             break;
 
         case ECJP_TYPE_NUMBER:
-            out->type = ECJP_TYPE_NUMBER;
-            while(ecjp_is_whitespace(*ptr) == ECJP_BOOL_TRUE) {
+            view->type = ECJP_TYPE_NUMBER;
+            while(ecjp_has_char(ptr, end) && ecjp_is_whitespace(*ptr) == ECJP_BOOL_TRUE) {
                 ptr++;
             }
-            ptr_value = ptr;
-            while ((*ptr >= '0' && *ptr <= '9') || *ptr == '-' || *ptr == '+' || *ptr == '.' || *ptr == 'e' || *ptr == 'E') {
+            view->ptr = ptr;
+            while (ecjp_has_char(ptr, end) && ((*ptr >= '0' && *ptr <= '9') || *ptr == '-' || *ptr == '+' || *ptr == '.' || *ptr == 'e' || *ptr == 'E')) {
                 vsize++;
                 ptr++;
             }
-            out->error_code = ECJP_NO_ERROR;
             break;
         
         case ECJP_TYPE_BOOL:
-            out->type = ECJP_TYPE_BOOL;
-            while(ecjp_is_whitespace(*ptr) == ECJP_BOOL_TRUE) {
+            view->type = ECJP_TYPE_BOOL;
+            while(ecjp_has_char(ptr, end) && ecjp_is_whitespace(*ptr) == ECJP_BOOL_TRUE) {
                 ptr++;
             }
-            ptr_value = ptr;
-            if (strncmp(ptr, "true", 4) == 0 || strncmp(ptr, "false", 5) == 0) {
-                vsize = (strncmp(ptr, "true", 4) == 0) ? 4 : 5;
+            view->ptr = ptr;
+            if (ecjp_has_chars(ptr, end, 4) && strncmp(ptr, "true", 4) == 0) {
+                vsize = 4;
+            } else if (ecjp_has_chars(ptr, end, 5) && strncmp(ptr, "false", 5) == 0) {
+                vsize = 5;
             }
-            out->error_code = ECJP_NO_ERROR;
             break;
 
         case ECJP_TYPE_NULL:
-            out->type = ECJP_TYPE_NULL;
-            while(ecjp_is_whitespace(*ptr) == ECJP_BOOL_TRUE) {
+            view->type = ECJP_TYPE_NULL;
+            while(ecjp_has_char(ptr, end) && ecjp_is_whitespace(*ptr) == ECJP_BOOL_TRUE) {
                 ptr++;
             }
-            ptr_value = ptr;
-            vsize = 4; // "null"
-            out->error_code = ECJP_NO_ERROR;
+            view->ptr = ptr;
+            vsize = ecjp_has_chars(ptr, end, 4) ? 4 : 0; // "null"
             break;
 
         case ECJP_TYPE_OBJECT:
-            out->type = ECJP_TYPE_OBJECT;
-            while(ecjp_is_whitespace(*ptr) == ECJP_BOOL_TRUE) {
+            view->type = ECJP_TYPE_OBJECT;
+            while(ecjp_has_char(ptr, end) && ecjp_is_whitespace(*ptr) == ECJP_BOOL_TRUE) {
                 ptr++;
             }
-            ptr_value = ptr;
-            if(*ptr == '{') {
-                vsize = 1; // at least the opening bracket
-                open_brackets = 1;
-                ptr++;
-                while ((open_brackets != 0) && (*ptr != '\0')) {
-                    if(*ptr == '}') {
-                        open_brackets--;
-                    } else if (*ptr == '{') {
-                        open_brackets++;
-                    }
-                    vsize++;
-                    ptr++;
-                    out->error_code = ECJP_NO_ERROR;
-                }
+            view->ptr = ptr;
+            if(ecjp_has_char(ptr, end) && *ptr == '{') {
+                ecjp_stage1_init(&stage1, ptr, (end != NULL) ? (int)(end - ptr) : -1, ECJP_BOOL_FALSE);
+                last = ecjp_skip_container(&stage1, 0, 0, NULL);
+                // an object not closed takes the rest of the input
+                vsize = (last < 0) ? (size_t)stage1.len : (size_t)(last + 1);
             } else {
                 vsize = 0;
-                out->error_code = ECJP_EMPTY_STRING;
+                ret = ECJP_EMPTY_STRING;
             }   
             break;
 
         case ECJP_TYPE_ARRAY:
-            out->type = ECJP_TYPE_ARRAY;
-            while(ecjp_is_whitespace(*ptr) == ECJP_BOOL_TRUE) {
+            view->type = ECJP_TYPE_ARRAY;
+            while(ecjp_has_char(ptr, end) && ecjp_is_whitespace(*ptr) == ECJP_BOOL_TRUE) {
                 ptr++;
             }
-            ptr_value = ptr;
-            if(*ptr == '[') {
-                vsize = 1; // at least the opening bracket
-                open_brackets = 1;
-                ptr++;
-                while ((open_brackets != 0) && (*ptr != '\0')) {
-                    if(*ptr == ']') {
-                        open_brackets--;
-                    } else if (*ptr == '[') {
-                        open_brackets++;
-                    }   
-                    vsize++;
-                    ptr++;
-                }
-                out->error_code = ECJP_NO_ERROR;
+            view->ptr = ptr;
+            if(ecjp_has_char(ptr, end) && *ptr == '[') {
+                ecjp_stage1_init(&stage1, ptr, (end != NULL) ? (int)(end - ptr) : -1, ECJP_BOOL_FALSE);
+                last = ecjp_skip_container(&stage1, 0, 0, NULL);
+                // an array not closed takes the rest of the input
+                vsize = (last < 0) ? (size_t)stage1.len : (size_t)(last + 1);
             } else {
                 vsize = 0;
-                out->error_code = ECJP_EMPTY_STRING;
+                ret = ECJP_EMPTY_STRING;
             }
             break;
 
         default:
             vsize = 0;
-            out->type = ECJP_TYPE_UNDEFINED;
-            out->error_code = ECJP_EMPTY_STRING;
+            ret = ECJP_EMPTY_STRING;
             break;
     }
     // sanity check
-    if (ptr_value == NULL) {
-        ecjp_printf("%s - %d: Internal error, value pointer is NULL\n", __FUNCTION__,__LINE__);
-        out->error_code = ECJP_GENERIC_ERROR;
+    if (view->ptr == NULL) {
+        ecjp_printf("%s - %d: Value not found\n", __FUNCTION__,__LINE__);
+        ret = ECJP_GENERIC_ERROR;
+        return ret;
+    }
+    view->len = vsize;
+#ifdef ECJP_STATS
+    // the value is found again from its key
+    if (view->ptr >= &input[in->pos]) {
+        ECJP_STATS_RESCAN("ecjp_read_key", bytes_rescanned, input, ECJP_INPUT_SIZE(input, end), (view->ptr - &input[in->pos]) + vsize);
+    }
+#endif
+
+    return ret;
+}
+
+/*
+ Function: ecjp_internal_read_key()
+    This function reads the value associated with a specific key from a JSON-like input string
+    and copies it in the output structure.
+    Parameters:
+    - input: The JSON-like input string.
+    - end: Pointer to the first character after the input string, NULL if the input is NUL-terminated.
+    - in: Pointer to an input structure containing key details.
+    - out: Pointer to an output structure to store the key's value details.
+    Returns:
+    - ECJP_NO_ERROR if the key's value is successfully read and stored in out.
+    - ECJP_NULL_POINTER if any input pointer is NULL.
+    - ECJP_NO_SPACE_IN_BUFFER_VALUE if the output buffer is insufficient.
+    - ECJP_EMPTY_STRING if the key has no associated value (should not happen in well-formed JSON).
+*/
+static ecjp_return_code_t ecjp_internal_read_key(const char input[],const char *end,ecjp_indata_t *in,ecjp_outdata_t *out)
+{
+    ecjp_return_code_t ret = ECJP_NO_ERROR;
+    ecjp_value_view_t view;
+    size_t vsize;
+
+    if (in == NULL || out == NULL) {
+        ecjp_printf("%s - %d: NULL pointer in/out",__FUNCTION__,__LINE__);
+        ret = ECJP_NULL_POINTER;
+        return ret;
+    }
+    if (input == NULL) {
+        ecjp_printf("%s - %d: No input, NULL pointer",__FUNCTION__,__LINE__);
+        ret = ECJP_NULL_POINTER;
+        return ret;
+    }
+
+    if (in->type == ECJP_TYPE_UNDEFINED) {
+        // skip research
+        out->type = ECJP_TYPE_UNDEFINED;
+        out->error_code = ECJP_EMPTY_STRING;
+        ret = out->error_code;
+        return ret;
+    }
+
+    if(out->value == NULL || out->value_size == 0) {
+        ecjp_printf("%s - %d: No buffer supplied for store value\n", __FUNCTION__,__LINE__);
+        out->error_code = ECJP_NO_SPACE_IN_BUFFER_VALUE;
         ret = out->error_code;
         return ret;
     }
+
+    ret = ecjp_internal_read_key_view(input, end, in, &view);
+    out->type = view.type;
+    out->error_code = ret;
+    if (view.ptr == NULL) {
+        return ret;
+    }
+    vsize = view.len;
     if (out->value_size <= vsize) {
         vsize = out->value_size - 1; // leave space for null terminator
-        memcpy(out->value, ptr_value, out->value_size);
+        memcpy(out->value, view.ptr, vsize);
         ((char *)out->value)[vsize] = '\0';
         ecjp_printf("%s - %d: Value buffer too small, truncated to %d bytes\n", __FUNCTION__,__LINE__,(int)vsize);
         out->error_code = ECJP_NO_SPACE_IN_BUFFER_VALUE;
     }
     else
-        memcpy(out->value, ptr_value, vsize);
+        memcpy(out->value, view.ptr, vsize);
+    ECJP_STATS_ADD(bytes_copied, vsize);
 
     out->last_pos = in->pos;
     out->length = in->length;
@@ -2114,9 +8861,279 @@ ecjp_return_code_t ecjp_read_key(const char input[],ecjp_indata_t *in,ecjp_outda
     ecjp_printf("%s - %d: Find key %s of type %s with value: %s\n",__FUNCTION__,__LINE__,in->key,ecjp_type[out->type],(char *)out->value);
 #endif
 
-    ret = out->error_code;
+    ret = out->error_code;
+
+    return ret;
+}
+
+/*
+ Function: ecjp_read_key()
+    This function reads the value associated with a specific key from a NUL-terminated JSON-like input string.
+    See ecjp_internal_read_key().
+*/
+ecjp_return_code_t ecjp_read_key(const char input[],ecjp_indata_t *in,ecjp_outdata_t *out)
+{
+    return ecjp_internal_read_key(input, NULL, in, out);
+}
+
+/*
+ Function: ecjp_read_key_n()
+    Same as ecjp_read_key(), the input string is delimited by its length (len) and doesn't need to be NUL-terminated.
+*/
+ecjp_return_code_t ecjp_read_key_n(const char input[],size_t len,ecjp_indata_t *in,ecjp_outdata_t *out)
+{
+    return ecjp_internal_read_key(input, (input != NULL) ? (input + len) : NULL, in, out);
+}
+
+/*
+ Function: ecjp_read_key_view()
+    This function finds the value associated with a specific key in a NUL-terminated JSON-like input string,
+    without copying it: the view points to the same characters that ecjp_read_key() copies.
+    No output buffer is needed and the value is never truncated.
+    See ecjp_internal_read_key_view().
+*/
+ecjp_return_code_t ecjp_read_key_view(const char input[],ecjp_indata_t *in,ecjp_value_view_t *view)
+{
+    return ecjp_internal_read_key_view(input, NULL, in, view);
+}
+
+/*
+ Function: ecjp_read_key_view_n()
+    Same as ecjp_read_key_view(), the input string is delimited by its length (len) and doesn't need to be NUL-terminated.
+*/
+ecjp_return_code_t ecjp_read_key_view_n(const char input[],size_t len,ecjp_indata_t *in,ecjp_value_view_t *view)
+{
+    return ecjp_internal_read_key_view(input, (input != NULL) ? (input + len) : NULL, in, view);
+}
+
+/*
+ Function: ecjp_internal_read_key_scalar()
+    This function finds the first character of the value associated with a specific key,
+    checking that the key has the expected type.
+    Parameters:
+    - input: The JSON-like input string.
+    - end: Pointer to the first character after the input string, NULL if the input is NUL-terminated.
+    - in: Pointer to an input structure containing key details.
+    - type: The type expected for the value.
+    - value: Pointer to store the position of the first character of the value.
+    Returns:
+    - ECJP_NO_ERROR if the value is found.
+    - ECJP_NULL_POINTER if any input pointer is NULL.
+    - ECJP_EMPTY_STRING if the key has no associated value.
+    - ECJP_SYNTAX_ERROR if the value has a different type.
+*/
+static ecjp_return_code_t ecjp_internal_read_key_scalar(const char input[],const char *end,ecjp_indata_t *in,ecjp_value_type_t type,const char **value)
+{
+    const char *ptr;
+
+    if (in == NULL || input == NULL) {
+        ecjp_printf("%s - %d: NULL pointer input/in",__FUNCTION__,__LINE__);
+        return ECJP_NULL_POINTER;
+    }
+    if (in->type == ECJP_TYPE_UNDEFINED) {
+        return ECJP_EMPTY_STRING;
+    }
+    if (in->type != type) {
+        ecjp_printf("%s - %d: Key %s is of type %s\n",__FUNCTION__,__LINE__,in->key,ecjp_type[in->type]);
+        return ECJP_SYNTAX_ERROR;
+    }
+    ptr = ecjp_find_key_value(input, end, in);
+    while (ecjp_has_char(ptr, end) && ecjp_is_whitespace(*ptr) == ECJP_BOOL_TRUE) {
+        ptr++;
+    }
+    if (!ecjp_has_char(ptr, end)) {
+        return ECJP_EMPTY_STRING;
+    }
+    *value = ptr;
+    return ECJP_NO_ERROR;
+}
+
+/*
+ Function: ecjp_is_value_end()
+    This function checks that the character at ptr can follow a value: end of input, whitespace,
+    comma or closing bracket.
+*/
+static inline ecjp_bool_t ecjp_is_value_end(const char *ptr, const char *end)
+{
+    if (!ecjp_has_char(ptr, end) || (ecjp_is_whitespace(*ptr) == ECJP_BOOL_TRUE) || (*ptr == ',') || (*ptr == '}') || (*ptr == ']')) {
+        return ECJP_BOOL_TRUE;
+    }
+    return ECJP_BOOL_FALSE;
+}
+
+/*
+ Function: ecjp_internal_read_key_number()
+    This function reads the number associated with a specific key. The number is checked
+    and decoded in a single walk over its characters (see ecjp_read_number()).
+    Parameters:
+    - input: The JSON-like input string.
+    - end: Pointer to the first character after the input string, NULL if the input is NUL-terminated.
+    - in: Pointer to an input structure containing key details (found with ecjp_get_key()).
+    - number: Pointer to the structure to store the number.
+    Returns:
+    - ECJP_NO_ERROR on success.
+    - ECJP_NULL_POINTER if any input pointer is NULL.
+    - ECJP_EMPTY_STRING if the key has no associated value.
+    - ECJP_SYNTAX_ERROR if the value is not a valid number.
+*/
+static ecjp_return_code_t ecjp_internal_read_key_number(const char input[],const char *end,ecjp_indata_t *in,ecjp_number_t *number)
+{
+    ecjp_return_code_t ret;
+    ecjp_number_parts_t parts;
+    const char *ptr = NULL;
+    int pos = 0;
+
+    if (number == NULL) {
+        return ECJP_NULL_POINTER;
+    }
+    ret = ecjp_internal_read_key_scalar(input, end, in, ECJP_TYPE_NUMBER, &ptr);
+    if (ret != ECJP_NO_ERROR) {
+        return ret;
+    }
+    // a NUL-terminated input ends the walk at the NUL character
+    if ((end != NULL) && (end - ptr < INT_MAX)) {
+        if (ecjp_scan_number(ptr, (int)(end - ptr), &pos, &parts) == ECJP_BOOL_FALSE) {
+            return ECJP_SYNTAX_ERROR;
+        }
+    } else if (ecjp_scan_number(ptr, INT_MAX, &pos, &parts) == ECJP_BOOL_FALSE) {
+        return ECJP_SYNTAX_ERROR;
+    }
+    if (ecjp_is_value_end(&ptr[pos], end) == ECJP_BOOL_FALSE) {
+        ecjp_printf("%s - %d: Character %c unexpected after number\n",__FUNCTION__,__LINE__,ptr[pos]);
+        return ECJP_SYNTAX_ERROR;
+    }
+    ecjp_decode_number(ptr, &parts, number);
+    return ECJP_NO_ERROR;
+}
+
+/*
+ Function: ecjp_read_key_number()
+    This function reads the number associated with a specific key from a NUL-terminated JSON-like input string.
+    See ecjp_internal_read_key_number().
+*/
+ecjp_return_code_t ecjp_read_key_number(const char input[],ecjp_indata_t *in,ecjp_number_t *number)
+{
+    return ecjp_internal_read_key_number(input, NULL, in, number);
+}
+
+/*
+ Function: ecjp_read_key_number_n()
+    Same as ecjp_read_key_number(), the input string is delimited by its length (len) and doesn't need to be NUL-terminated.
+*/
+ecjp_return_code_t ecjp_read_key_number_n(const char input[],size_t len,ecjp_indata_t *in,ecjp_number_t *number)
+{
+    return ecjp_internal_read_key_number(input, (input != NULL) ? (input + len) : NULL, in, number);
+}
+
+/*
+ Function: ecjp_internal_read_key_bool()
+    This function reads the boolean associated with a specific key.
+    Parameters:
+    - input: The JSON-like input string.
+    - end: Pointer to the first character after the input string, NULL if the input is NUL-terminated.
+    - in: Pointer to an input structure containing key details (found with ecjp_get_key()).
+    - value: Pointer to store the boolean.
+    Returns:
+    - ECJP_NO_ERROR on success.
+    - ECJP_NULL_POINTER if any input pointer is NULL.
+    - ECJP_EMPTY_STRING if the key has no associated value.
+    - ECJP_SYNTAX_ERROR if the value is not true or false.
+*/
+static ecjp_return_code_t ecjp_internal_read_key_bool(const char input[],const char *end,ecjp_indata_t *in,ecjp_bool_t *value)
+{
+    ecjp_return_code_t ret;
+    const char *ptr = NULL;
+
+    if (value == NULL) {
+        return ECJP_NULL_POINTER;
+    }
+    ret = ecjp_internal_read_key_scalar(input, end, in, ECJP_TYPE_BOOL, &ptr);
+    if (ret != ECJP_NO_ERROR) {
+        return ret;
+    }
+    if (ecjp_has_chars(ptr, end, 4) && (strncmp(ptr, "true", 4) == 0) && (ecjp_is_value_end(&ptr[4], end) == ECJP_BOOL_TRUE)) {
+        *value = ECJP_BOOL_TRUE;
+    } else if (ecjp_has_chars(ptr, end, 5) && (strncmp(ptr, "false", 5) == 0) && (ecjp_is_value_end(&ptr[5], end) == ECJP_BOOL_TRUE)) {
+        *value = ECJP_BOOL_FALSE;
+    } else {
+        return ECJP_SYNTAX_ERROR;
+    }
+    return ECJP_NO_ERROR;
+}
+
+/*
+ Function: ecjp_read_key_bool()
+    This function reads the boolean associated with a specific key from a NUL-terminated JSON-like input string.
+    See ecjp_internal_read_key_bool().
+*/
+ecjp_return_code_t ecjp_read_key_bool(const char input[],ecjp_indata_t *in,ecjp_bool_t *value)
+{
+    return ecjp_internal_read_key_bool(input, NULL, in, value);
+}
+
+/*
+ Function: ecjp_read_key_bool_n()
+    Same as ecjp_read_key_bool(), the input string is delimited by its length (len) and doesn't need to be NUL-terminated.
+*/
+ecjp_return_code_t ecjp_read_key_bool_n(const char input[],size_t len,ecjp_indata_t *in,ecjp_bool_t *value)
+{
+    return ecjp_internal_read_key_bool(input, (input != NULL) ? (input + len) : NULL, in, value);
+}
+
+/*
+ Function: ecjp_internal_read_key_string()
+    This function reads the string associated with a specific key and decodes its escape sequences.
+    See ecjp_read_string().
+    Parameters:
+    - input: The JSON-like input string.
+    - end: Pointer to the first character after the input string, NULL if the input is NUL-terminated.
+    - in: Pointer to an input structure containing key details (found with ecjp_get_key()).
+    - buffer: The buffer for the decoded string, NULL to read only the strings without escapes (without copying them).
+    - buffer_size: The size of the buffer.
+    - string: Pointer to the structure to store the decoded string.
+    Returns:
+    - ECJP_NO_ERROR on success.
+    - ECJP_NULL_POINTER if any input pointer is NULL.
+    - ECJP_EMPTY_STRING if the key has no associated value.
+    - ECJP_SYNTAX_ERROR if the value is not a valid string.
+    - ECJP_NO_SPACE_IN_BUFFER_VALUE if the decoded string doesn't fit in the buffer.
+*/
+static ecjp_return_code_t ecjp_internal_read_key_string(const char input[],const char *end,ecjp_indata_t *in,char *buffer,size_t buffer_size,ecjp_string_t *string)
+{
+    ecjp_return_code_t ret;
+    const char *ptr = NULL;
+
+    if (string == NULL) {
+        return ECJP_NULL_POINTER;
+    }
+    ret = ecjp_internal_read_key_scalar(input, end, in, ECJP_TYPE_STRING, &ptr);
+    if (ret != ECJP_NO_ERROR) {
+        return ret;
+    }
+    if (*ptr != '"') {
+        return ECJP_SYNTAX_ERROR;
+    }
+    ptr++;
+    return ecjp_internal_read_string(ptr, (end != NULL) ? (size_t)(end - ptr) : SIZE_MAX, ECJP_BOOL_TRUE, buffer, buffer_size, string);
+}
+
+/*
+ Function: ecjp_read_key_string()
+    This function reads the string associated with a specific key from a NUL-terminated JSON-like input string.
+    See ecjp_internal_read_key_string().
+*/
+ecjp_return_code_t ecjp_read_key_string(const char input[],ecjp_indata_t *in,char *buffer,size_t buffer_size,ecjp_string_t *string)
+{
+    return ecjp_internal_read_key_string(input, NULL, in, buffer, buffer_size, string);
+}
 
-    return ret;
+/*
+ Function: ecjp_read_key_string_n()
+    Same as ecjp_read_key_string(), the input string is delimited by its length (len) and doesn't need to be NUL-terminated.
+*/
+ecjp_return_code_t ecjp_read_key_string_n(const char input[],size_t len,ecjp_indata_t *in,char *buffer,size_t buffer_size,ecjp_string_t *string)
+{
+    return ecjp_internal_read_key_string(input, (input != NULL) ? (input + len) : NULL, in, buffer, buffer_size, string);
 }
 
 /*
@@ -2128,6 +9145,7 @@ ecjp_return_code_t ecjp_read_key(const char input[],ecjp_indata_t *in,ecjp_outda
         Returns:
         - ECJP_NO_ERROR on success.
         - ECJP_NO_MORE_KEY when all keys have been processed.
+        - ECJP_GENERIC_ERROR if the buffers of the values can't be allocated.
 */
 ecjp_return_code_t ecjp_get_keys_and_value(char *ptr,ecjp_key_elem_t *key_list)
 {
@@ -2139,19 +9157,21 @@ ecjp_return_code_t ecjp_get_keys_and_value(char *ptr,ecjp_key_elem_t *key_list)
     int key_count = 0;
 
     memset(&out_get,0,sizeof(out_get));
-    out_get.value = malloc(ECJP_MAX_KEY_LEN);
-    out_get.value_size = ECJP_MAX_KEY_LEN;
-    memset(out_get.value,0,out_get.value_size);
-
     memset(&out_read,0,sizeof(out_read));
-    out_read.value = malloc(ECJP_MAX_KEY_VALUE_LEN);
-    out_read.value_size = ECJP_MAX_KEY_VALUE_LEN;
-    memset(out_read.value,0,out_read.value_size);
-
     memset(&out_array,0,sizeof(out_array));
-    out_array.value = malloc(ECJP_MAX_ARRAY_ELEM_LEN);
+    out_get.value = ecjp_calloc(1,ECJP_MAX_KEY_LEN);
+    out_read.value = ecjp_calloc(1,ECJP_MAX_KEY_VALUE_LEN);
+    out_array.value = ecjp_calloc(1,ECJP_MAX_ARRAY_ELEM_LEN);
+    if(out_get.value == NULL || out_read.value == NULL || out_array.value == NULL) {
+        ecjp_printf("%s - %d: Memory allocation failed\n",__FUNCTION__,__LINE__);
+        ecjp_free(out_get.value);
+        ecjp_free(out_read.value);
+        ecjp_free(out_array.value);
+        return ECJP_GENERIC_ERROR;
+    }
+    out_get.value_size = ECJP_MAX_KEY_LEN;
+    out_read.value_size = ECJP_MAX_KEY_VALUE_LEN;
     out_array.value_size = ECJP_MAX_ARRAY_ELEM_LEN;
-    memset(out_array.value,0,out_array.value_size);
 
     memset(&in,0,sizeof(in));
 
@@ -2216,58 +9236,75 @@ ecjp_return_code_t ecjp_get_keys_and_value(char *ptr,ecjp_key_elem_t *key_list)
         }        
     } while(ret != ECJP_NO_MORE_KEY);
     
-    free(out_get.value);
-    free(out_read.value);
+    ecjp_free(out_get.value);
+    ecjp_free(out_read.value);
+    ecjp_free(out_array.value);
 
     return ret;
 }
 
 /*
-    Function: ecjp_read_array_element()
-        This function reads a specific element from a JSON-like array string.
+    Function: ecjp_internal_scan_array()
+        This function finds a specific element in a JSON-like array string.
+        The elements are not copied while the array is parsed: only their position and length are kept.
+        If array_index is not NULL the whole array is parsed and every element is appended to the index.
         Parameters:
         - input: The JSON-like array string.
+        - end: Pointer to the first character after the array string, NULL if the string is NUL-terminated.
         - index: The index of the element to read. If use ECJP_ARRAY_NO_INDEX the function returns an error.
-        - out: Pointer to an output structure to store the element's details.
+          Not used if array_index is not NULL.
+        - array_index: Pointer to the array index to load, NULL to find only the requested element.
+        - view: Pointer to the view to store the position, length and type of the requested element,
+          can be NULL if array_index is not NULL. If the element is not found the position is NULL
+          and the type is the one of the last element found.
         Returns:
-        - ECJP_NO_ERROR if the element is successfully read and stored in out.
+        - ECJP_NO_ERROR if the element is found and stored in the view (or the array index is loaded).
         - ECJP_NULL_POINTER if any input pointer is NULL.
         - ECJP_EMPTY_STRING if no index is specified.
+        - ECJP_GENERIC_ERROR on memory allocation failure.
 */
-ecjp_return_code_t ecjp_read_array_element(const char input[],int index,ecjp_outdata_t *out)
+static ecjp_return_code_t ecjp_internal_scan_array(const char input[],const char *end,int index,ecjp_array_index_t *array_index,ecjp_value_view_t *view)
 {
     ecjp_return_code_t ret = ECJP_NO_ERROR;
     ecjp_parser_data_t *p;
     ecjp_parser_data_t parser_data;
-    char buffer[ECJP_MAX_ARRAY_ELEM_LEN];
-    int p_buffer = 0;
+    int elem_start = 0;
+    unsigned int elem_len = 0;
+    ecjp_value_type_t elem_type = ECJP_TYPE_UNDEFINED;
     int num_elements = 0;
+    ecjp_stage1_t stage1;
+    int last;
 
     memset(&parser_data, 0, sizeof(ecjp_parser_data_t));
     p =  &parser_data;
     p->parse_stack.top = -1;
     
-    if (out == NULL) {
-        ecjp_printf("%s - %d: NULL pointer out",__FUNCTION__,__LINE__);
+    if (input == NULL || (view == NULL && array_index == NULL)) {
+        ecjp_printf("%s - %d: NULL pointer input/view",__FUNCTION__,__LINE__);
         ret = ECJP_NULL_POINTER;
         return ret;
     }
-    if (index == ECJP_ARRAY_NO_INDEX) {
+    if (view != NULL) {
+        view->ptr = NULL;
+        view->len = 0;
+        view->type = ECJP_TYPE_UNDEFINED;
+    }
+    if (array_index == NULL && index == ECJP_ARRAY_NO_INDEX) {
         ecjp_printf("%s - %d: No index specified",__FUNCTION__,__LINE__);
         ret = ECJP_EMPTY_STRING;
         return ret;
     }
 
 #ifdef DEBUG_VERBOSE        
-    ecjp_printf("%s - %d: input %s\n", __FUNCTION__,__LINE__, input);
+    ecjp_printf("%s - %d: input %.*s\n", __FUNCTION__,__LINE__, (end != NULL) ? (int)(end - input) : (int)strlen(input), input);
 #endif
 
-    memset(buffer, 0, sizeof(buffer));
-
+    // the nested elements are skipped on the masks of stage 1
+    ecjp_stage1_init(&stage1, input, (end != NULL) ? (int)(end - input) : -1, ECJP_BOOL_FALSE);
     p->index = 0;
     p->flags.all = 0;
     p->status = ECJP_PS_START;
-    while ((input[p->index] != '\0') && (p->status != ECJP_PA_END) && (p->status != ECJP_PA_ERROR)) {
+    while (ecjp_has_char(&input[p->index], end) && (p->status != ECJP_PA_END) && (p->status != ECJP_PA_ERROR)) {
         // walk through the string
 #ifdef DEBUG_VERBOSE        
         ecjp_printf("%s - %d: Index %d, Status %d, Char '%c'\n", __FUNCTION__,__LINE__, p->index, p->status, input[p->index]);
@@ -2363,45 +9400,43 @@ ecjp_return_code_t ecjp_read_array_element(const char input[],int index,ecjp_out
                         break;
 
                     case '[':
-                        p->open_square_brackets++;
-                        p->num_arrays++;
-                        if(ecjp_push_parse_stack(&(p->parse_stack), '[') == ECJP_BOOL_FALSE) {
-                            p->status = ECJP_PA_ERROR;
-                            break;
-                        }
-                        // copy character in buffer
-                        buffer[p_buffer] = input[p->index];
-                        p_buffer++;
-                        p->status = ECJP_PA_ARRAY_ELEM;
-                        out->type = ECJP_TYPE_ARRAY;
-                        if(p->flags.trailing_comma) {
-                            p->flags.trailing_comma = 0;
-                        }
-                        break;
-
                     case '{':
-                        p->open_brackets++;
-                        p->num_objects++;
-                        if(ecjp_push_parse_stack(&(p->parse_stack), '{') == ECJP_BOOL_FALSE) {
+                        // the whole element is skipped on the masks, the parse stack checks its brackets
+                        if (input[p->index] == '[') {
+                            p->num_arrays++;
+                            elem_type = ECJP_TYPE_ARRAY;
+                        } else {
+                            p->num_objects++;
+                            elem_type = ECJP_TYPE_OBJECT;
+                        }
+                        elem_start = p->index;
+                        last = ecjp_skip_container(&stage1, p->index, 0, &(p->parse_stack));
+                        if (last < 0) {
+                            ecjp_printf("%s - %d: Element at index %d not closed\n", __FUNCTION__,__LINE__,p->index);
                             p->status = ECJP_PA_ERROR;
                             break;
                         }
-                        // copy character in buffer
-                        buffer[p_buffer] = input[p->index];
-                        p_buffer++;
-                        p->status = ECJP_PA_OBJ_ELEM;
-                        out->type = ECJP_TYPE_OBJECT;
+                        elem_len = last - elem_start + 1;
+                        p->index = last;
+                        p->status = ECJP_PA_WAIT_COMMA;
                         if(p->flags.trailing_comma) {
                             p->flags.trailing_comma = 0;
                         }
                         break;
                     
                     case '"':
-                        // copy character in buffer
-                        buffer[p_buffer] = input[p->index];
-                        p_buffer++;
-                        p->status = ECJP_PA_IN_STRING;
-                        out->type = ECJP_TYPE_STRING;
+                        // start of the element
+                        elem_start = p->index;
+                        elem_type = ECJP_TYPE_STRING;
+                        last = ecjp_skip_string(&stage1, p->index);
+                        if (last < 0) {
+                            ecjp_printf("%s - %d: String at index %d not closed\n", __FUNCTION__,__LINE__,p->index);
+                            p->status = ECJP_PA_ERROR;
+                            break;
+                        }
+                        elem_len = last - elem_start + 1;
+                        p->index = last;
+                        p->status = ECJP_PA_WAIT_COMMA;
                         if(p->flags.trailing_comma) {
                             p->flags.trailing_comma = 0;
                         }
@@ -2418,11 +9453,11 @@ ecjp_return_code_t ecjp_read_array_element(const char input[],int index,ecjp_out
                     case '8':
                     case '9':
                     case '-':
-                        // copy character in buffer
-                        buffer[p_buffer] = input[p->index];
-                        p_buffer++;
+                        // start of the element
+                        elem_start = p->index;
+                        elem_len = 1;
                         p->status = ECJP_PA_IN_NUMBER;
-                        out->type = ECJP_TYPE_NUMBER;
+                        elem_type = ECJP_TYPE_NUMBER;
                         if(p->flags.trailing_comma) {
                             p->flags.trailing_comma = 0;
                         }
@@ -2430,22 +9465,22 @@ ecjp_return_code_t ecjp_read_array_element(const char input[],int index,ecjp_out
 
                     case 't':
                     case 'f':
-                        // copy character in buffer
-                        buffer[p_buffer] = input[p->index];
-                        p_buffer++;
+                        // start of the element
+                        elem_start = p->index;
+                        elem_len = 1;
                         p->status = ECJP_PA_IN_BOOL;
-                        out->type = ECJP_TYPE_BOOL;
+                        elem_type = ECJP_TYPE_BOOL;
                         if(p->flags.trailing_comma) {
                             p->flags.trailing_comma = 0;
                         }
                         break;
 
                     case 'n':
-                        // copy character in buffer
-                        buffer[p_buffer] = input[p->index];
-                        p_buffer++;
+                        // start of the element
+                        elem_start = p->index;
+                        elem_len = 1;
                         p->status = ECJP_PA_IN_NULL;
-                        out->type = ECJP_TYPE_NULL;
+                        elem_type = ECJP_TYPE_NULL;
                         if(p->flags.trailing_comma) {
                             p->flags.trailing_comma = 0;
                         }
@@ -2455,320 +9490,116 @@ ecjp_return_code_t ecjp_read_array_element(const char input[],int index,ecjp_out
                         ecjp_printf("%s - %d: Character %c unexpected\n", __FUNCTION__,__LINE__,input[p->index]);
                         p->status = ECJP_PA_ERROR;
                         break;
-                }
-                break;
-
-            case ECJP_PA_IN_STRING:
-                switch(input[p->index]) {
-                    case '"':
-                        // copy closing quote
-                        buffer[p_buffer] = input[p->index];
-                        p_buffer++;
-                        p->status = ECJP_PA_WAIT_COMMA;
-                        break;
-
-                    default:
-                        // copy character in buffer
-                        buffer[p_buffer] = input[p->index];
-                        p_buffer++;
-                        break;
-                }
-                break;
-
-            case ECJP_PA_IN_NUMBER:
-                switch(input[p->index]) {
-                    case '0':
-                    case '1':
-                    case '2':
-                    case '3':
-                    case '4':
-                    case '5':
-                    case '6':
-                    case '7':
-                    case '8':
-                    case '9':
-                    case '-':
-                    case '+':
-                    case '.':
-                    case 'e':
-                    case 'E':
-                        // copy character in buffer
-                        buffer[p_buffer] = input[p->index];
-                        p_buffer++;
-                        break;
-
-                    case ',':
-                        if (p->flags.trailing_comma) {
-                            ecjp_printf("%s - %d: Multiple trailing commas\n", __FUNCTION__,__LINE__);
-                            p->status = ECJP_PA_ERROR;
-                            break;
-                        }
-                        p->flags.trailing_comma = 1;
-                        p->status = ECJP_PA_IN_ARRAY;
-                        // check if this is the requested element
-                        num_elements++;
-                        ret = ecjp_internal_copy_array_element(buffer, p_buffer, index, num_elements, out);
-                        if (ret != ECJP_INDEX_NOT_FOUND) {
-                            // found requested element, can exit
-                            return ret;
-                        }
-                        // reset buffer for next element
-                        memset(buffer, 0, sizeof(buffer));
-                        p_buffer = 0;
-                        break;
-
-                    case ' ':
-                    case '\n':
-                    case '\r':
-                    case '\t':
-                        // whitespace breaks number
-                        p->status = ECJP_PA_WAIT_COMMA;
-                        continue;
-
-                    default:
-                        ecjp_printf("%s - %d: Character %c unexpected\n", __FUNCTION__,__LINE__,input[p->index]);
-                        p->status = ECJP_PA_ERROR;
-                        break;
-                }
-                break;
-
-            case ECJP_PA_IN_BOOL:
-                if (buffer[p_buffer - 1] == 't') {
-                    // already have first character
-                    if (strncmp(&input[p->index], "rue", 3) == 0) {
-                        // copy the remaing characters of "true"
-                        buffer[p_buffer++] = 'r';
-                        buffer[p_buffer++] = 'u';
-                        buffer[p_buffer++] = 'e';
-                        p->index += 3;
-                        p->status = ECJP_PA_WAIT_COMMA;
-                        continue;
-                    } else {
-                        ecjp_printf("%s - %d: Character %c unexpected\n", __FUNCTION__,__LINE__,input[p->index]);
-                        p->status = ECJP_PA_ERROR;
-                    }                
-                } else if (buffer[p_buffer - 1] == 'f') {
-                    // already have first character
-                    if (strncmp(&input[p->index], "alse", 4) == 0) {
-                        // copy the remaining characters of "false"
-                        buffer[p_buffer++] = 'a';
-                        buffer[p_buffer++] = 'l';
-                        buffer[p_buffer++] = 's';
-                        buffer[p_buffer++] = 'e';
-                        p->index += 4;
-                        p->status = ECJP_PA_WAIT_COMMA;
-                        continue;
-                    } else {
-                        ecjp_printf("%s - %d: Character %c unexpected\n", __FUNCTION__,__LINE__,input[p->index]);
-                        p->status = ECJP_PA_ERROR;
-                    }
-                } else {
-                    ecjp_printf("%s - %d: Character %c unexpected\n", __FUNCTION__,__LINE__,input[p->index]);
-                    p->status = ECJP_PA_ERROR;
-                }   
-                break;
-
-            case ECJP_PA_IN_NULL:
-                if (buffer[p_buffer - 1] == 'n' || buffer[p_buffer - 1] == 'N') {
-                    // already have first character
-                    if (strncmp(&input[p->index], "ull", 3) == 0) {
-                        // copy the remaing characters of "null"
-                        buffer[p_buffer++] = 'u';
-                        buffer[p_buffer++] = 'l';
-                        buffer[p_buffer++] = 'l';
-                        p->index += 3;
-                        p->status = ECJP_PA_WAIT_COMMA;
-                        continue;
-                    } else {
-                        ecjp_printf("%s - %d: Character %c unexpected\n", __FUNCTION__,__LINE__,input[p->index]);
-                        p->status = ECJP_PA_ERROR;
-                    }                
-                } else {
-                    ecjp_printf("%s - %d: Character %c unexpected\n", __FUNCTION__,__LINE__,input[p->index]);
-                    p->status = ECJP_PA_ERROR;
-                }
-                break;
-
-            case ECJP_PA_OBJ_ELEM:
-                switch(input[p->index]) {
-                    case '}':
-                        p->open_brackets--;
-                        if (p->open_brackets < 0) {
-                            ecjp_printf("%s - %d: Mismatched closing bracket\n", __FUNCTION__,__LINE__);
-                            p->status = ECJP_PA_ERROR;
-                            break;
-                        }
-                        if (p->flags.trailing_comma) {
-                            ecjp_printf("%s - %d: Trailing comma before closing bracket\n", __FUNCTION__,__LINE__);
-                            p->status = ECJP_PA_ERROR;
-                            break;
-                        }
-                        if (ecjp_pop_parse_stack(&(p->parse_stack), '{') == ECJP_BOOL_FALSE) {
-                            ecjp_printf("%s - %d: Unexpected closing bracket\n", __FUNCTION__,__LINE__);
-                            p->status = ECJP_PA_ERROR;
-                            break;
-                        }
-                        if (p->open_brackets == 0 && p->open_square_brackets == 0) {
-                            p->status = ECJP_PA_END;
-                        } else {
-                            // copy character in buffer
-                            buffer[p_buffer] = input[p->index];
-                            p_buffer++;
-                            // check if this bracket closes the current object
-                            if (ecjp_peek_parse_stack(&(p->parse_stack),'[') == ECJP_BOOL_TRUE && p->open_square_brackets == 1) {
-                                p->status = ECJP_PA_WAIT_COMMA;
-                            }
-                        }
-                        break;
-
-                    case '{':
-                        p->open_brackets++;
-                        p->num_objects++;
-                        if(ecjp_push_parse_stack(&(p->parse_stack), '{') == ECJP_BOOL_FALSE) {
-                            p->status = ECJP_PA_ERROR;
-                            break;
-                        }   
-                        // copy character in buffer
-                        buffer[p_buffer] = input[p->index];
-                        p_buffer++;
-                        break;
-
-                    case '[':
-                        p->open_square_brackets++;
-                        p->num_arrays++;
-                        if(ecjp_push_parse_stack(&(p->parse_stack), '[') == ECJP_BOOL_FALSE) {
-                            p->status = ECJP_PA_ERROR;
-                            break;
-                        }   
-                        // copy character in buffer
-                        buffer[p_buffer] = input[p->index];
-                        p_buffer++;
-                        break;
-
-                    case ']':
-                        p->open_square_brackets--;
-                        if (p->open_square_brackets < 0) {
-                            ecjp_printf("%s - %d: Mismatched closing square bracket\n", __FUNCTION__,__LINE__);
-                            p->status = ECJP_PA_ERROR;
-                            break;
-                        }
-                        if (p->flags.trailing_comma) {
-                            ecjp_printf("%s - %d: Trailing comma before closing square bracket\n", __FUNCTION__,__LINE__);
-                            p->status = ECJP_PA_ERROR;
-                            break;
-                        }
-                        if (ecjp_pop_parse_stack(&(p->parse_stack), '[') == ECJP_BOOL_FALSE) {
-                            ecjp_printf("%s - %d: Unexpected closing square bracket\n", __FUNCTION__,__LINE__);
-                            p->status = ECJP_PA_ERROR;
-                            break;
-                        }
-                        if (p->open_brackets == 0 && p->open_square_brackets == 0) {
-                            p->status = ECJP_PA_END;
-                        } else {
-                            // copy character in buffer
-                            buffer[p_buffer] = input[p->index];
-                            p_buffer++;
-                        }
-                        break;
-
-                    default:
-                        // copy character in buffer
-                        buffer[p_buffer] = input[p->index];
-                        p_buffer++;
-                        break;
-                }
-                break;
-
-            case ECJP_PA_ARRAY_ELEM:
-                switch (input[p->index]) {
-                    case ']':
-                        p->open_square_brackets--;
-                        if (p->open_square_brackets < 0) {
-                            ecjp_printf("%s - %d: Mismatched closing square bracket\n", __FUNCTION__,__LINE__);
-                            p->status = ECJP_PA_ERROR;
-                            break;
-                        }
-                        if (p->flags.trailing_comma) {
-                            ecjp_printf("%s - %d: Trailing comma before closing square bracket\n", __FUNCTION__,__LINE__);
-                            p->status = ECJP_PA_ERROR;
-                            break;
-                        }
-                        if (ecjp_pop_parse_stack(&(p->parse_stack), '[') == ECJP_BOOL_FALSE) {
-                            ecjp_printf("%s - %d: Unexpected closing square bracket\n", __FUNCTION__,__LINE__);
-                            p->status = ECJP_PA_ERROR;
-                            break;
-                        }
-                        if (p->open_brackets == 0 && p->open_square_brackets == 0) {
-                            p->status = ECJP_PA_END;
-                        } else {
-                            // copy character in buffer
-                            buffer[p_buffer] = input[p->index];
-                            p_buffer++;
-                            // check if this bracket closes the current array
-                            if (p->open_square_brackets == 1) {
-                                p->status = ECJP_PA_WAIT_COMMA;
-                            }
-                        }
-                        break;
-
-                    case '{':
-                        p->open_brackets++;
-                        p->num_objects++;
-                        if(ecjp_push_parse_stack(&(p->parse_stack), '{') == ECJP_BOOL_FALSE) {
-                            p->status = ECJP_PA_ERROR;
-                            break;
-                        }   
-                        // copy character in buffer
-                        buffer[p_buffer] = input[p->index];
-                        p_buffer++;
-                        break;
+                }
+                break;
 
-                    case '[':
-                        p->open_square_brackets++;
-                        p->num_arrays++;
-                        if(ecjp_push_parse_stack(&(p->parse_stack), '[') == ECJP_BOOL_FALSE) {
-                            p->status = ECJP_PA_ERROR;
-                            break;
-                        }   
-                        // copy character in buffer
-                        buffer[p_buffer] = input[p->index];
-                        p_buffer++;
+            case ECJP_PA_IN_NUMBER:
+                switch(input[p->index]) {
+                    case '0':
+                    case '1':
+                    case '2':
+                    case '3':
+                    case '4':
+                    case '5':
+                    case '6':
+                    case '7':
+                    case '8':
+                    case '9':
+                    case '-':
+                    case '+':
+                    case '.':
+                    case 'e':
+                    case 'E':
+                        // the character is part of the element
+                        elem_len++;
                         break;
 
-                    case '}':
-                        p->open_brackets--;
-                        if (p->open_brackets < 0) {
-                            ecjp_printf("%s - %d: Mismatched closing bracket\n", __FUNCTION__,__LINE__);
-                            p->status = ECJP_PA_ERROR;
-                            break;
-                        }
+                    case ',':
                         if (p->flags.trailing_comma) {
-                            ecjp_printf("%s - %d: Trailing comma before closing bracket\n", __FUNCTION__,__LINE__);
-                            p->status = ECJP_PA_ERROR;
-                            break;
-                        }
-                        if (ecjp_pop_parse_stack(&(p->parse_stack), '{') == ECJP_BOOL_FALSE) {
-                            ecjp_printf("%s - %d: Unexpected closing bracket\n", __FUNCTION__,__LINE__);
+                            ecjp_printf("%s - %d: Multiple trailing commas\n", __FUNCTION__,__LINE__);
                             p->status = ECJP_PA_ERROR;
                             break;
                         }
-                        if (p->open_brackets == 0 && p->open_square_brackets == 0) {
-                            p->status = ECJP_PA_END;
-                        } else {
-                            // copy character in buffer
-                            buffer[p_buffer] = input[p->index];
-                            p_buffer++;
+                        p->flags.trailing_comma = 1;
+                        p->status = ECJP_PA_IN_ARRAY;
+                        // check if this is the requested element
+                        num_elements++;
+                        ret = ecjp_internal_end_array_element(input, end, elem_start, elem_len, elem_type, index, num_elements, array_index, view);
+                        if (ret != ECJP_INDEX_NOT_FOUND) {
+                            // found requested element, can exit
+                            return ret;
                         }
+                        // reset for next element
+                        elem_len = 0;
                         break;
 
+                    case ' ':
+                    case '\n':
+                    case '\r':
+                    case '\t':
+                    case ']':
+                    case '}':
+                        // whitespace or a closing bracket breaks number
+                        p->status = ECJP_PA_WAIT_COMMA;
+                        continue;
+
                     default:
-                        // copy character in buffer
-                        buffer[p_buffer] = input[p->index];
-                        p_buffer++;
+                        ecjp_printf("%s - %d: Character %c unexpected\n", __FUNCTION__,__LINE__,input[p->index]);
+                        p->status = ECJP_PA_ERROR;
                         break;
                 }
                 break;
 
+            case ECJP_PA_IN_BOOL:
+                if (input[elem_start] == 't') {
+                    // already have first character
+                    if (ecjp_has_chars(&input[p->index], end, 3) && strncmp(&input[p->index], "rue", 3) == 0) {
+                        // the remaining characters of "true" are part of the element
+                        elem_len += 3;
+                        p->index += 3;
+                        p->status = ECJP_PA_WAIT_COMMA;
+                        continue;
+                    } else {
+                        ecjp_printf("%s - %d: Character %c unexpected\n", __FUNCTION__,__LINE__,input[p->index]);
+                        p->status = ECJP_PA_ERROR;
+                    }                
+                } else if (input[elem_start] == 'f') {
+                    // already have first character
+                    if (ecjp_has_chars(&input[p->index], end, 4) && strncmp(&input[p->index], "alse", 4) == 0) {
+                        // the remaining characters of "false" are part of the element
+                        elem_len += 4;
+                        p->index += 4;
+                        p->status = ECJP_PA_WAIT_COMMA;
+                        continue;
+                    } else {
+                        ecjp_printf("%s - %d: Character %c unexpected\n", __FUNCTION__,__LINE__,input[p->index]);
+                        p->status = ECJP_PA_ERROR;
+                    }
+                } else {
+                    ecjp_printf("%s - %d: Character %c unexpected\n", __FUNCTION__,__LINE__,input[p->index]);
+                    p->status = ECJP_PA_ERROR;
+                }   
+                break;
+
+            case ECJP_PA_IN_NULL:
+                if (input[elem_start] == 'n') {
+                    // already have first character
+                    if (ecjp_has_chars(&input[p->index], end, 3) && strncmp(&input[p->index], "ull", 3) == 0) {
+                        // the remaining characters of "null" are part of the element
+                        elem_len += 3;
+                        p->index += 3;
+                        p->status = ECJP_PA_WAIT_COMMA;
+                        continue;
+                    } else {
+                        ecjp_printf("%s - %d: Character %c unexpected\n", __FUNCTION__,__LINE__,input[p->index]);
+                        p->status = ECJP_PA_ERROR;
+                    }                
+                } else {
+                    ecjp_printf("%s - %d: Character %c unexpected\n", __FUNCTION__,__LINE__,input[p->index]);
+                    p->status = ECJP_PA_ERROR;
+                }
+                break;
+
             case ECJP_PA_WAIT_COMMA:
                 switch(input[p->index]) {
                     case ' ':
@@ -2788,13 +9619,12 @@ ecjp_return_code_t ecjp_read_array_element(const char input[],int index,ecjp_out
                         p->status = ECJP_PA_IN_ARRAY;
                         // check if this is the requested element
                         num_elements++;
-                        ret = ecjp_internal_copy_array_element(buffer, p_buffer, index, num_elements, out);
+                        ret = ecjp_internal_end_array_element(input, end, elem_start, elem_len, elem_type, index, num_elements, array_index, view);
                         if (ret != ECJP_INDEX_NOT_FOUND) {
                             return ret;
                         }
-                        // reset buffer for next element
-                        memset(buffer, 0, sizeof(buffer));
-                        p_buffer = 0;
+                        // reset for next element
+                        elem_len = 0;
                         break;
 
                     case '[':
@@ -2827,115 +9657,439 @@ ecjp_return_code_t ecjp_read_array_element(const char input[],int index,ecjp_out
                         }   
                         break;
 
-                    case '}':
-                        p->open_brackets--;
-                        if (p->open_brackets < 0) {
-                            ecjp_printf("%s - %d: Mismatched closing bracket\n", __FUNCTION__,__LINE__);
-                            p->status = ECJP_PA_ERROR;
-                            break;
-                        }
-                        if (p->flags.trailing_comma) {
-                            ecjp_printf("%s - %d: Trailing comma before closing bracket\n", __FUNCTION__,__LINE__);
-                            p->status = ECJP_PA_ERROR;
-                            break;
-                        }
-                        if (ecjp_pop_parse_stack(&(p->parse_stack), '{') == ECJP_BOOL_FALSE) {
-                            ecjp_printf("%s - %d: Unexpected closing bracket\n", __FUNCTION__,__LINE__);
-                            p->status = ECJP_PA_ERROR;
-                            break;
-                        }
-                        if (p->open_brackets == 0 && p->open_square_brackets == 0) {
-                            p->status = ECJP_PA_END;
-                        } else {
-                            p->status = ECJP_PA_IN_ARRAY;
-                        }
-                        break;
+                    case '}':
+                        p->open_brackets--;
+                        if (p->open_brackets < 0) {
+                            ecjp_printf("%s - %d: Mismatched closing bracket\n", __FUNCTION__,__LINE__);
+                            p->status = ECJP_PA_ERROR;
+                            break;
+                        }
+                        if (p->flags.trailing_comma) {
+                            ecjp_printf("%s - %d: Trailing comma before closing bracket\n", __FUNCTION__,__LINE__);
+                            p->status = ECJP_PA_ERROR;
+                            break;
+                        }
+                        if (ecjp_pop_parse_stack(&(p->parse_stack), '{') == ECJP_BOOL_FALSE) {
+                            ecjp_printf("%s - %d: Unexpected closing bracket\n", __FUNCTION__,__LINE__);
+                            p->status = ECJP_PA_ERROR;
+                            break;
+                        }
+                        if (p->open_brackets == 0 && p->open_square_brackets == 0) {
+                            p->status = ECJP_PA_END;
+                        } else {
+                            p->status = ECJP_PA_IN_ARRAY;
+                        }
+                        break;
+
+                    default:
+                        ecjp_printf("%s - %d: Character %c unexpected (index %d)\n", __FUNCTION__,__LINE__,input[p->index],p->index);
+                        p->status = ECJP_PA_ERROR;
+                        break;
+                }
+                break;
+
+            case ECJP_PA_ERROR:
+                ecjp_printf("%s - %d: Fail to parse the array\n", __FUNCTION__,__LINE__);
+                ret = ECJP_SYNTAX_ERROR;
+                return ret;
+                break;
+
+            case ECJP_PA_END:
+                // copy the last element if needed
+                // check if this is the requested element
+                num_elements++;
+                ret = ecjp_internal_end_array_element(input, end, elem_start, elem_len, elem_type, index, num_elements, array_index, view);
+                if (ret != ECJP_INDEX_NOT_FOUND) {
+                    return ret;
+                }
+                // reset for next element
+                elem_len = 0;
+                // reached end of parsing
+#ifdef DEBUG_VERBOSE
+                ecjp_printf("%s - %d: End of array parsing\n", __FUNCTION__,__LINE__);
+#endif
+                break;
+
+            default:
+                break;
+        }
+        p->index++;
+    }
+
+    // the view keeps the type of the last element found, also if the array is not valid
+    if (array_index == NULL) {
+        view->type = elem_type;
+    }
+
+    // check if we reach the end of parsing without manage the last state
+    if (p->status == ECJP_PA_END && elem_len != 0) {
+        // copy the last element if needed
+        // check if this is the requested element
+        num_elements++;
+        ret = ecjp_internal_end_array_element(input, end, elem_start, elem_len, elem_type, index, num_elements, array_index, view);
+#ifdef DEBUG_VERBOSE
+        ecjp_printf("%s - %d: End of array parsing\n", __FUNCTION__,__LINE__);
+#endif
+    } else {
+        if (p->status != ECJP_PA_END) {
+            ecjp_printf("%s - %d: Incomplete JSON structure\n", __FUNCTION__,__LINE__);
+            return ECJP_SYNTAX_ERROR;
+        }
+        if ((p->open_brackets != 0) || (p->open_square_brackets != 0)) {
+            ecjp_printf("%s - %d: Mismatched brackets at end of input\n", __FUNCTION__,__LINE__);
+            return ECJP_BRACKETS_MISSING;
+        }
+    }
+    
+    if (array_index != NULL) {
+        // the whole array is loaded in the index
+        return (ret == ECJP_INDEX_NOT_FOUND) ? ECJP_NO_ERROR : ret;
+    }
+
+    if (index > (num_elements - 1)) {
+        ECJP_STATS_RESCAN("ecjp_read_array_element", bytes_rescanned, input, ECJP_INPUT_SIZE(input, end), p->index);
+#ifdef DEBUG_VERBOSE
+        ecjp_printf("%s - %d: Requested index %d exceeds number of elements %d\n", __FUNCTION__,__LINE__,index,(num_elements-1));
+#endif
+        return ECJP_INDEX_OUT_OF_BOUNDS;
+    }  
+
+    return ret;
+}
+
+/*
+    Function: ecjp_internal_read_array_element()
+        This function reads a specific element from a JSON-like array string and copies it in the output structure.
+        Parameters:
+        - input: The JSON-like array string.
+        - end: Pointer to the first character after the array string, NULL if the string is NUL-terminated.
+        - index: The index of the element to read. If use ECJP_ARRAY_NO_INDEX the function returns an error.
+        - out: Pointer to an output structure to store the element's details.
+        Returns:
+        - ECJP_NO_ERROR if the element is successfully read and stored in out.
+        - ECJP_NULL_POINTER if any input pointer is NULL.
+        - ECJP_EMPTY_STRING if no index is specified.
+        - ECJP_INDEX_OUT_OF_BOUNDS if the array has no element at index.
+        - ECJP_NO_SPACE_IN_BUFFER_VALUE if out has no buffer for the value.
+*/
+static ecjp_return_code_t ecjp_internal_read_array_element(const char input[],const char *end,int index,ecjp_outdata_t *out)
+{
+    ecjp_return_code_t ret;
+    ecjp_value_view_t view;
+
+    if (out == NULL) {
+        ecjp_printf("%s - %d: NULL pointer out",__FUNCTION__,__LINE__);
+        return ECJP_NULL_POINTER;
+    }
+    memset(&view, 0, sizeof(ecjp_value_view_t));
+    ret = ecjp_internal_scan_array(input, end, index, NULL, &view);
+    if (view.type != ECJP_TYPE_UNDEFINED) {
+        out->type = view.type;
+    }
+    if (ret == ECJP_NO_ERROR) {
+        ret = ecjp_internal_copy_array_element(view.ptr, view.len, index, index + 1, out);
+    }
+    return ret;
+}
+
+/*
+    Function: ecjp_read_array_element()
+        This function reads a specific element from a NUL-terminated JSON-like array string.
+        See ecjp_internal_read_array_element().
+*/
+ecjp_return_code_t ecjp_read_array_element(const char input[],int index,ecjp_outdata_t *out)
+{
+    return ecjp_internal_read_array_element(input, NULL, index, out);
+}
+
+/*
+    Function: ecjp_read_array_element_n()
+        Same as ecjp_read_array_element(), the array string is delimited by its length (len)
+        and doesn't need to be NUL-terminated.
+*/
+ecjp_return_code_t ecjp_read_array_element_n(const char input[],size_t len,int index,ecjp_outdata_t *out)
+{
+    return ecjp_internal_read_array_element(input, (input != NULL) ? (input + len) : NULL, index, out);
+}
+
+/*
+    Function: ecjp_read_array_element_view()
+        This function finds a specific element in a NUL-terminated JSON-like array string, without copying it:
+        the view points to the same characters that ecjp_read_array_element() copies.
+        No output buffer is needed and the element is never truncated.
+        See ecjp_internal_scan_array().
+*/
+ecjp_return_code_t ecjp_read_array_element_view(const char input[],int index,ecjp_value_view_t *view)
+{
+    return ecjp_internal_scan_array(input, NULL, index, NULL, view);
+}
+
+/*
+    Function: ecjp_read_array_element_view_n()
+        Same as ecjp_read_array_element_view(), the array string is delimited by its length (len)
+        and doesn't need to be NUL-terminated.
+*/
+ecjp_return_code_t ecjp_read_array_element_view_n(const char input[],size_t len,int index,ecjp_value_view_t *view)
+{
+    return ecjp_internal_scan_array(input, (input != NULL) ? (input + len) : NULL, index, NULL, view);
+}
+
+/*
+    Function: ecjp_init_array_index()
+        This function initializes an empty array index.
+        Parameters:
+        - array_index: Pointer to the index.
+        Returns:
+        - ECJP_NO_ERROR on success.
+        - ECJP_NULL_POINTER if array_index is NULL.
+*/
+ecjp_return_code_t ecjp_init_array_index(ecjp_array_index_t *array_index)
+{
+    if (array_index == NULL) {
+        return ECJP_NULL_POINTER;
+    }
+    memset(array_index, 0, sizeof(ecjp_array_index_t));
+    return ECJP_NO_ERROR;
+}
+
+/*
+    Function: ecjp_free_array_index()
+        This function frees the memory allocated for an array index and leaves it empty.
+        Parameters:
+        - array_index: Pointer to the index.
+        Returns:
+        - ECJP_NO_ERROR on success.
+*/
+ecjp_return_code_t ecjp_free_array_index(ecjp_array_index_t *array_index)
+{
+    if (array_index == NULL) {
+        return ECJP_NO_ERROR;
+    }
+    ecjp_free(array_index->elem);
+    array_index->elem = NULL;
+    array_index->capacity = 0;
+    array_index->count = 0;
+    return ECJP_NO_ERROR;
+}
+
+/*
+    Function: ecjp_index_array()
+        This function parses a NUL-terminated JSON-like array string once and loads the position,
+        length and type of all its elements in an array index.
+        The elements can then be read in constant time with ecjp_read_array_index().
+        The memory of the index is reused if it's loaded again.
+        Parameters:
+        - input: The JSON-like array string.
+        - array_index: Pointer to the index, initialized with ecjp_init_array_index().
+        Returns:
+        - ECJP_NO_ERROR if the array is valid and the index is loaded.
+        - ECJP_NULL_POINTER if any input pointer is NULL.
+        - ECJP_SYNTAX_ERROR or ECJP_BRACKETS_MISSING if the array is not valid.
+        - ECJP_GENERIC_ERROR on memory allocation failure.
+*/
+ecjp_return_code_t ecjp_index_array(const char input[],ecjp_array_index_t *array_index)
+{
+    if (array_index == NULL) {
+        return ECJP_NULL_POINTER;
+    }
+    array_index->count = 0;
+    return ecjp_internal_scan_array(input, NULL, ECJP_ARRAY_NO_INDEX, array_index, NULL);
+}
+
+/*
+    Function: ecjp_index_array_n()
+        Same as ecjp_index_array(), the array string is delimited by its length (len)
+        and doesn't need to be NUL-terminated.
+*/
+ecjp_return_code_t ecjp_index_array_n(const char input[],size_t len,ecjp_array_index_t *array_index)
+{
+    if (array_index == NULL) {
+        return ECJP_NULL_POINTER;
+    }
+    array_index->count = 0;
+    return ecjp_internal_scan_array(input, (input != NULL) ? (input + len) : NULL, ECJP_ARRAY_NO_INDEX, array_index, NULL);
+}
 
-                    default:
-                        ecjp_printf("%s - %d: Character %c unexpected (index %d)\n", __FUNCTION__,__LINE__,input[p->index],p->index);
-                        p->status = ECJP_PA_ERROR;
-                        break;
-                }
-                break;
+/*
+    Function: ecjp_read_array_index_view()
+        This function finds an element of an array from its index, in constant time, without copying it:
+        the view points to the same characters that ecjp_read_array_index() copies.
+        Parameters:
+        - input: The JSON-like array string used to load the index.
+        - array_index: Pointer to the index loaded by ecjp_index_array().
+        - index: The index of the element to find.
+        - view: Pointer to the view to store the position, length and type of the element.
+        Returns:
+        - ECJP_NO_ERROR if the element is found and stored in the view.
+        - ECJP_NULL_POINTER if any input pointer is NULL.
+        - ECJP_EMPTY_STRING if no index is specified.
+        - ECJP_INDEX_OUT_OF_BOUNDS if the array has no element at index.
+*/
+ecjp_return_code_t ecjp_read_array_index_view(const char input[],const ecjp_array_index_t *array_index,int index,ecjp_value_view_t *view)
+{
+    const ecjp_array_elem_token_t *elem;
 
-            case ECJP_PA_ERROR:
-                ecjp_printf("%s - %d: Fail to parse the array\n", __FUNCTION__,__LINE__);
-                ret = ECJP_SYNTAX_ERROR;
-                return ret;
-                break;
+    if (input == NULL || array_index == NULL || view == NULL) {
+        return ECJP_NULL_POINTER;
+    }
+    if (index == ECJP_ARRAY_NO_INDEX) {
+        return ECJP_EMPTY_STRING;
+    }
+    if ((index < 0) || (index >= array_index->count)) {
+        return ECJP_INDEX_OUT_OF_BOUNDS;
+    }
+    elem = &array_index->elem[index];
+    view->ptr = &input[elem->offset];
+    view->len = elem->length;
+    view->type = (ecjp_value_type_t)elem->type;
+    return ECJP_NO_ERROR;
+}
 
-            case ECJP_PA_END:
-                // copy the last element if needed
-                // check if this is the requested element
-                num_elements++;
-                ret = ecjp_internal_copy_array_element(buffer, p_buffer, index, num_elements, out);
-                if (ret != ECJP_INDEX_NOT_FOUND) {
-                    return ret;
-                }
-                // reset buffer for next element
-                memset(buffer, 0, sizeof(buffer));
-                p_buffer = 0;
-                // reached end of parsing
-#ifdef DEBUG_VERBOSE
-                ecjp_printf("%s - %d: End of array parsing\n", __FUNCTION__,__LINE__);
-#endif
-                break;
+/*
+    Function: ecjp_read_array_index()
+        This function reads an element of an array from its index, in constant time.
+        The output is the same as ecjp_read_array_element() on the same input string.
+        Parameters:
+        - input: The JSON-like array string used to load the index.
+        - array_index: Pointer to the index loaded by ecjp_index_array().
+        - index: The index of the element to read.
+        - out: Pointer to an output structure to store the element's details.
+        Returns:
+        - ECJP_NO_ERROR if the element is successfully read and stored in out.
+        - ECJP_NULL_POINTER if any input pointer is NULL.
+        - ECJP_EMPTY_STRING if no index is specified.
+        - ECJP_INDEX_OUT_OF_BOUNDS if the array has no element at index.
+        - ECJP_NO_SPACE_IN_BUFFER_VALUE if out has no buffer for the value.
+*/
+ecjp_return_code_t ecjp_read_array_index(const char input[],const ecjp_array_index_t *array_index,int index,ecjp_outdata_t *out)
+{
+    ecjp_return_code_t ret;
+    ecjp_value_view_t view;
 
-            default:
-                break;
+    if (out == NULL) {
+        return ECJP_NULL_POINTER;
+    }
+    ret = ecjp_read_array_index_view(input, array_index, index, &view);
+    if (ret != ECJP_NO_ERROR) {
+        return ret;
+    }
+    out->type = view.type;
+    return ecjp_internal_copy_array_element(view.ptr, view.len, index, index + 1, out);
+}
+
+/*
+ * Function: ecjp_key_index_insert()
+        This function stores a key in the first free slot of its probe sequence, or in the slot of
+        the same key if already present (the duplicate policy decides which one is kept).
+        Parameters:
+        - key_index: Pointer to the index, with at least one free slot.
+        - input: The JSON-like input string, used to compare the keys.
+        - key: Pointer to the key token.
+        - hash: The hash of the key.
+*/
+static void ecjp_key_index_insert(ecjp_key_index_t *key_index, const char *input, const ecjp_key_token_t *key, unsigned int hash)
+{
+    ecjp_key_slot_t *slot;
+    unsigned int mask = key_index->capacity - 1;
+    unsigned int i = hash & mask;
+
+    while (key_index->slot[i].key.type != ECJP_TYPE_UNDEFINED) {
+        slot = &key_index->slot[i];
+        if ((slot->hash == hash) && (slot->key.length == key->length) &&
+            (memcmp(&input[slot->key.start_pos], &input[key->start_pos], key->length) == 0)) {
+            // duplicate key
+            if (key_index->policy == ECJP_DUP_LAST_WINS) {
+                slot->key = *key;
+            }
+            return;
         }
-        p->index++;
+        i = (i + 1) & mask;
     }
+    key_index->slot[i].hash = hash;
+    key_index->slot[i].key = *key;
+    key_index->count++;
+}
 
-    // check if we reach the end of parsing without manage the last state
-    if (p->status == ECJP_PA_END && p_buffer != 0) {
-        // copy the last element if needed
-        // check if this is the requested element
-        num_elements++;
-        ret = ecjp_internal_copy_array_element(buffer, p_buffer, index, num_elements, out);
-#ifdef DEBUG_VERBOSE
-        ecjp_printf("%s - %d: End of array parsing\n", __FUNCTION__,__LINE__);
-#endif
-    } else {
-        if (p->status != ECJP_PA_END) {
-            ecjp_printf("%s - %d: Incomplete JSON structure\n", __FUNCTION__,__LINE__);
-            return ECJP_SYNTAX_ERROR;
+/*
+ * Function: ecjp_add_key_token()
+        This function adds a key token to the key list and, if used, to the key index.
+        The index is doubled when it's half full.
+        Parameters:
+        - key_list: Pointer to the head of the key list.
+        - key_index: Pointer to the index, NULL if not used.
+        - input: The JSON-like input string.
+        - key: Pointer to the key token to add.
+        - key_start: The position of the key in the input; a key beyond the range of ECJP_TYPE_POS_KEY
+          (start_pos != key_start) is not added to the index.
+        - hash: The hash of the key, computed while the key is parsed.
+        Returns:
+        - 0 on success.
+        - -1 on memory allocation failure.
+*/
+static int ecjp_add_key_token(ecjp_key_elem_t **key_list, ecjp_key_index_t *key_index, const char *input, ecjp_key_token_t *key, int key_start, unsigned int hash)
+{
+    ecjp_key_slot_t *old_slot;
+    int i, old_capacity;
+
+    if (ecjp_add_node_end(key_list, key) != 0) {
+        return -1;
+    }
+    if ((key_index == NULL) || (key->start_pos != key_start)) {
+        return 0;
+    }
+    if (((key_index->count + 1) * 2) > key_index->capacity) {
+        old_slot = key_index->slot;
+        old_capacity = key_index->capacity;
+        key_index->capacity = (old_capacity == 0) ? ECJP_LIST_MIN_CAPACITY : (old_capacity * 2);
+        key_index->slot = (ecjp_key_slot_t *)ecjp_calloc(key_index->capacity, sizeof(ecjp_key_slot_t));
+        if (key_index->slot == NULL) {
+            key_index->slot = old_slot;
+            key_index->capacity = old_capacity;
+            return -1;
         }
-        if ((p->open_brackets != 0) || (p->open_square_brackets != 0)) {
-            ecjp_printf("%s - %d: Mismatched brackets at end of input\n", __FUNCTION__,__LINE__);
-            return ECJP_BRACKETS_MISSING;
+        key_index->count = 0;
+        for (i = 0; i < old_capacity; i++) {
+            if (old_slot[i].key.type != ECJP_TYPE_UNDEFINED) {
+                ecjp_key_index_insert(key_index, input, &old_slot[i].key, old_slot[i].hash);
+            }
         }
+        ecjp_free(old_slot);
     }
-    
-    if (index > (num_elements - 1)) {
-#ifdef DEBUG_VERBOSE
-        ecjp_printf("%s - %d: Requested index %d exceeds number of elements %d\n", __FUNCTION__,__LINE__,index,(num_elements-1));
-#endif
-        return ECJP_INDEX_OUT_OF_BOUNDS;
-    }  
-
-    return ret;
+    ecjp_key_index_insert(key_index, input, key, hash);
+    return 0;
 }
 
 /*
-    Function: ecjp_check_and_load()
+    Function: ecjp_internal_check_and_load()
         This function checks the syntax of a JSON-like input string and prepares it for further processing.
+        The input is delimited by its length, so it can be a slice of a larger buffer not NUL-terminated.
         Parameters:
         - input: The JSON-like input string to be checked and loaded.
+        - len: The length of the input string; a '\0' found before len is a syntax error.
         - key_list: Pointer to a list of key elements loaded with the keys found in the input string.
+        - key_index: Pointer to a hash index of the keys added to key_list, NULL if not used.
         - res: Pointer to a structure to store the result of the check, including any error position.
         - level: The level of checking to be performed; used to manage keys inside nested structures.
+        - utf8: ECJP_BOOL_TRUE to validate the input as UTF-8 (see ecjp_ctx_t).
         Returns:
         - ECJP_NO_ERROR if the input string is valid.
         - ECJP_NULL_POINTER if any input pointer is NULL.
         - ECJP_EMPTY_STRING if the input string is empty.
         - ECJP_SYNTAX_ERROR if there is a syntax error in the input string.
 */
-ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_list, ecjp_check_result_t *res, unsigned short int level)
+static ecjp_return_code_t ecjp_internal_check_and_load(const char *input, size_t len, ecjp_key_elem_t **key_list, ecjp_key_index_t *key_index, ecjp_check_result_t *res, unsigned short int level, ecjp_bool_t utf8)
 {
     ecjp_parser_data_t parser_data;
     ecjp_parser_data_t *p;
     ecjp_key_token_t key_token;
+    ecjp_stage1_t stage1;
+    int run_end;
+    unsigned int key_hash = ECJP_HASH_INIT;
+    ecjp_bool_t key_escaped = ECJP_BOOL_FALSE;
+    int key_start = 0;
+#ifdef ECJP_STATS
+    int stats_status = -1;
+#endif
 
     memset(&key_token, 0, sizeof(ecjp_key_token_t));
     memset(&parser_data, 0, sizeof(ecjp_parser_data_t));
@@ -2946,22 +10100,31 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
         ecjp_printf("%s - %d: NULL pointer input/res\n",__FUNCTION__,__LINE__);
         return ECJP_NULL_POINTER;
     }
-    if (strlen(input) == 0) {
+    if (len == 0) {
         ecjp_printf("%s - %d: Empty string input\n",__FUNCTION__,__LINE__);
         return ECJP_EMPTY_STRING;
     }
 #ifdef DEBUG_VERBOSE
-    ecjp_printf("%s - %d:\nInput string: %s\n",__FUNCTION__,__LINE__,input);
+    ecjp_printf("%s - %d:\nInput string: %.*s\n",__FUNCTION__,__LINE__,(int)len,input);
 #endif
+    ecjp_stage1_init(&stage1, input, len, utf8);
+    ECJP_STATS_ADD(bytes_scanned, len);
 
     p->index = 0;
     p->flags.all = 0;
     p->status = ECJP_PS_START;
-    while (input[p->index] != '\0') {
+    while (p->index < (int)len) {
         // walk through the string
 #ifdef DEBUG_VERBOSE        
         ecjp_printf("%s - %d: Index %d, Status %d, Char '%c'\n", __FUNCTION__,__LINE__, p->index, p->status, input[p->index]);
 #endif
+        ECJP_STATS_STATUS(stats_status, p->status);
+        if (input[p->index] == '\0') {
+            // the length is given by the caller: a NUL inside the input is not valid
+            res->err_pos = p->index;
+            ecjp_printf("%s - %d: Unexpected NUL character in input\n", __FUNCTION__,__LINE__);
+            return ECJP_SYNTAX_ERROR;
+        }
         switch (p->status)
         {
             case ECJP_PS_START:
@@ -2971,7 +10134,7 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
                     case '\r':
                     case '\t':
                         // skip whitespace
-                        p->index++;
+                        p->index = ecjp_skip_whitespace(&stage1, p->index);
                         continue;
 
                     case '{':
@@ -3011,7 +10174,7 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
                     case '\r':
                     case '\t':
                         // skip whitespace
-                        p->index++;
+                        p->index = ecjp_skip_whitespace(&stage1, p->index);
                         continue;
 
                     case '{':
@@ -3064,6 +10227,9 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
                         p->flags.trailing_comma = 0;
                         // Record key position
                         key_token.start_pos = (p->index + 1) ; // skip initial quote
+                        key_start = (p->index + 1);
+                        key_hash = ECJP_HASH_INIT;
+                        key_escaped = ECJP_BOOL_FALSE;
                         break;
                     
                     default:
@@ -3081,7 +10247,7 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
                     case '\r':
                     case '\t':
                         // skip whitespace
-                        p->index++;
+                        p->index = ecjp_skip_whitespace(&stage1, p->index);
                         continue;
 
                     case '{':
@@ -3149,7 +10315,9 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
                         break;
 
                     default:
-                        if (strncmp(&input[p->index], "true", 4) == 0 || strncmp(&input[p->index], "false", 5) == 0 || strncmp(&input[p->index], "null", 4) == 0) {
+                        if ((ecjp_has_chars(&input[p->index], input + len, 4) && strncmp(&input[p->index], "true", 4) == 0) ||
+                            (ecjp_has_chars(&input[p->index], input + len, 5) && strncmp(&input[p->index], "false", 5) == 0) ||
+                            (ecjp_has_chars(&input[p->index], input + len, 4) && strncmp(&input[p->index], "null", 4) == 0)) {
                             // valid value
                             p->status = ECJP_PS_WAIT_COMMA;
                             p->index += (input[p->index] == 'f') ? 5 : 4; // move index forward
@@ -3161,9 +10329,8 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
                         if ((input[p->index] >= '0' && input[p->index] <= '9') || input[p->index] == '-') {
                             // valid value start
                             p->flags.in_number = 1;
-                            if (input[p->index] == '0') {
-                                p->flags.start_zero = 1;
-                            }
+                            // reset also the flag left by a number closed by a bracket
+                            p->flags.start_zero = (input[p->index] == '0') ? 1 : 0;
                             p->status = ECJP_PS_IN_VALUE;
                             if (p->flags.trailing_comma) {
                                 p->flags.trailing_comma = 0;
@@ -3182,8 +10349,9 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
                 switch (input[p->index]) {
                     case '\\':
                         // skip escaped character
+                        key_escaped = ECJP_BOOL_TRUE;
                         p->index++;
-                        switch(input[p->index]) {
+                        switch ((p->index < (int)len) ? input[p->index] : '\0') {
                             case '"':
                             case '\\':
                             case '/':
@@ -3196,7 +10364,8 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
                                 continue;
 
                             case 'u':
-                                if(ecjp_is_excode(input[p->index+1]) &&
+                                if((p->index + 4 < (int)len) &&
+                                   ecjp_is_excode(input[p->index+1]) &&
                                    ecjp_is_excode(input[p->index+2]) &&
                                    ecjp_is_excode(input[p->index+3]) &&
                                    ecjp_is_excode(input[p->index+4])) {
@@ -3220,6 +10389,10 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
                         p->flags.in_string = 0;
                         p->status = ECJP_PS_WAIT_COLON;
                         p->flags.in_key = 0;
+                        if ((key_index != NULL) && (key_escaped == ECJP_BOOL_TRUE)) {
+                            // the key length doesn't follow the escape sequences: hash the stored key
+                            key_hash = ecjp_hash_update(ECJP_HASH_INIT, &input[key_token.start_pos], key_token.length);
+                        }
                         break;
 
                     default:
@@ -3228,8 +10401,14 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
                             ecjp_printf("%s - %d: Invalid control character in key\n", __FUNCTION__,__LINE__);
                             return ECJP_SYNTAX_ERROR;
                         } else {
-                            // continue in key
-                            key_token.length++;
+                            // continue in key, the whole run of plain characters belongs to the key
+                            run_end = ecjp_skip_plain(&stage1, p->index + 1);
+                            if (key_index != NULL) {
+                                key_hash = ecjp_hash_update(key_hash, &input[p->index], run_end - p->index);
+                            }
+                            key_token.length += (run_end - p->index);
+                            p->index = run_end;
+                            continue;
                         }
                         break;
                 }
@@ -3242,7 +10421,7 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
                     case '\r':
                     case '\t':
                         // skip whitespace
-                        p->index++;
+                        p->index = ecjp_skip_whitespace(&stage1, p->index);
                         continue;
 
                     case ':':
@@ -3264,7 +10443,7 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
                     case '\r':
                     case '\t':
                         // skip whitespace
-                        p->index++;
+                        p->index = ecjp_skip_whitespace(&stage1, p->index);
                         continue;
 
                     case '{':
@@ -3280,7 +10459,7 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
                         // Add key token to the list
                         if (key_list != NULL && p->open_brackets <= level)
                         {
-                            if (ecjp_add_node_end(key_list, &key_token) != 0) {
+                            if (ecjp_add_key_token(key_list, key_index, input, &key_token, key_start, key_hash) != 0) {
                                 res->err_pos = p->index;
                                 ecjp_printf("%s - %d: Failed to add key token to the list\n", __FUNCTION__,__LINE__);
                                 return ECJP_GENERIC_ERROR;
@@ -3308,7 +10487,7 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
                         // Add key token to the list
                         if (key_list != NULL && p->open_brackets <= level)
                         {
-                            if (ecjp_add_node_end(key_list, &key_token) != 0) {
+                            if (ecjp_add_key_token(key_list, key_index, input, &key_token, key_start, key_hash) != 0) {
                                 res->err_pos = p->index;
                                 ecjp_printf("%s - %d: Failed to add key token to the list\n", __FUNCTION__,__LINE__);
                                 return ECJP_GENERIC_ERROR;
@@ -3331,7 +10510,7 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
                         // Add key token to the list
                         if (key_list != NULL && p->open_brackets <= level)
                         {
-                            if (ecjp_add_node_end(key_list, &key_token) != 0) {
+                            if (ecjp_add_key_token(key_list, key_index, input, &key_token, key_start, key_hash) != 0) {
                                 res->err_pos = p->index;
                                 ecjp_printf("%s - %d: Failed to add key token to the list\n", __FUNCTION__,__LINE__);
                                 return ECJP_GENERIC_ERROR;
@@ -3347,7 +10526,9 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
                         break;
 
                     default:
-                        if (strncmp(&input[p->index], "true", 4) == 0 || strncmp(&input[p->index], "false", 5) == 0 || strncmp(&input[p->index], "null", 4) == 0) {
+                        if ((ecjp_has_chars(&input[p->index], input + len, 4) && strncmp(&input[p->index], "true", 4) == 0) ||
+                            (ecjp_has_chars(&input[p->index], input + len, 5) && strncmp(&input[p->index], "false", 5) == 0) ||
+                            (ecjp_has_chars(&input[p->index], input + len, 4) && strncmp(&input[p->index], "null", 4) == 0)) {
                             // valid value
                             p->status = ECJP_PS_WAIT_COMMA;
                             // Record key type
@@ -3359,7 +10540,7 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
                             // Add key token to the list
                             if (key_list != NULL && p->open_brackets <= level)
                             {
-                                if (ecjp_add_node_end(key_list, &key_token) != 0) {
+                                if (ecjp_add_key_token(key_list, key_index, input, &key_token, key_start, key_hash) != 0) {
                                     res->err_pos = p->index;
                                     ecjp_printf("%s - %d: Failed to add key token to the list\n", __FUNCTION__,__LINE__);
                                     return ECJP_GENERIC_ERROR;
@@ -3378,16 +10559,15 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
                         if ((input[p->index] >= '0' && input[p->index] <= '9') || input[p->index] == '-') {
                             // valid value start
                             p->flags.in_number = 1;
-                            if (input[p->index] == '0') {
-                                p->flags.start_zero = 1;
-                            }
+                            // reset also the flag left by a number closed by a bracket
+                            p->flags.start_zero = (input[p->index] == '0') ? 1 : 0;
                             p->status = ECJP_PS_IN_VALUE;
                             // Record key type
                             key_token.type = ECJP_TYPE_NUMBER;
                             // Add key token to the list
                             if (key_list != NULL && p->open_brackets <= level)
                             {
-                                if (ecjp_add_node_end(key_list, &key_token) != 0) {
+                                if (ecjp_add_key_token(key_list, key_index, input, &key_token, key_start, key_hash) != 0) {
                                     res->err_pos = p->index;
                                     ecjp_printf("%s - %d: Failed to add key token to the list\n", __FUNCTION__,__LINE__);
                                     return ECJP_GENERIC_ERROR;
@@ -3427,7 +10607,7 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
                                 case '\\':
                                     // skip escaped character
                                     p->index++;
-                                    switch(input[p->index]) {
+                                    switch ((p->index < (int)len) ? input[p->index] : '\0') {
                                         case '"':
                                         case '\\':
                                         case '/':
@@ -3440,7 +10620,8 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
                                             continue;
 
                                         case 'u':
-                                            if(ecjp_is_excode(input[p->index+1]) &&
+                                            if((p->index + 4 < (int)len) &&
+                                               ecjp_is_excode(input[p->index+1]) &&
                                                ecjp_is_excode(input[p->index+2]) &&
                                                ecjp_is_excode(input[p->index+3]) &&
                                                ecjp_is_excode(input[p->index+4])) {
@@ -3466,7 +10647,9 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
                                         ecjp_printf("%s - %d: Invalid control character inside value\n", __FUNCTION__,__LINE__);
                                         return ECJP_SYNTAX_ERROR;
                                     }
-                                    break;
+                                    // skip the whole run of plain characters
+                                    p->index = ecjp_skip_plain(&stage1, p->index + 1);
+                                    continue;
                             }
                         } else {
                             switch (input[p->index]) {
@@ -3481,7 +10664,7 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
                                     }
                                     else {
                                         // skip whitespace
-                                        p->index++;
+                                        p->index = ecjp_skip_whitespace(&stage1, p->index);
                                         continue;
                                     }
                                     break;
@@ -3598,7 +10781,7 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
                     case '\r':
                     case '\t':
                         // skip whitespace
-                        p->index++;
+                        p->index = ecjp_skip_whitespace(&stage1, p->index);
                         continue;
                     
                     case '}':
@@ -3675,7 +10858,7 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
                     case '\r':
                     case '\t':
                         // skip whitespace
-                        p->index++;
+                        p->index = ecjp_skip_whitespace(&stage1, p->index);
                         continue;
 
                     default:
@@ -3691,6 +10874,7 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
 
         p->index++;
     }
+    ECJP_STATS_STATUS(stats_status, p->status);
 
     if (p->status != ECJP_PS_END) {
         ecjp_printf("%s - %d: Incomplete JSON structure\n", __FUNCTION__,__LINE__);
@@ -3701,6 +10885,11 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
         ecjp_printf("%s - %d: Mismatched brackets at end of input\n", __FUNCTION__,__LINE__);
         return ECJP_BRACKETS_MISSING;
     }
+    if (ecjp_stage1_utf8_error(&stage1) >= 0) {
+        res->err_pos = stage1.utf8_err_pos;
+        ecjp_printf("%s - %d: Invalid UTF-8 sequence at position %d\n", __FUNCTION__,__LINE__, res->err_pos);
+        return ECJP_SYNTAX_ERROR;
+    }
 
 #ifdef DEBUG_VERBOSE
     ecjp_print_check_summary(p);
@@ -3709,9 +10898,110 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
     return ECJP_NO_ERROR;
 };
 
+/*
+    Function: ecjp_check_and_load_n()
+        This function checks the syntax of a JSON-like input string and prepares it for further processing.
+        The input is delimited by its length, so it can be a slice of a larger buffer not NUL-terminated.
+        Parameters:
+        - input: The JSON-like input string to be checked and loaded.
+        - len: The length of the input string; a '\0' found before len is a syntax error.
+        - key_list: Pointer to a list of key elements loaded with the keys found in the input string.
+        - res: Pointer to a structure to store the result of the check, including any error position.
+        - level: The level of checking to be performed; used to manage keys inside nested structures.
+        Returns:
+        - ECJP_NO_ERROR if the input string is valid.
+        - ECJP_NULL_POINTER if any input pointer is NULL.
+        - ECJP_EMPTY_STRING if the input string is empty.
+        - ECJP_SYNTAX_ERROR if there is a syntax error in the input string.
+*/
+ecjp_return_code_t ecjp_check_and_load_n(const char *input, size_t len, ecjp_key_elem_t **key_list, ecjp_check_result_t *res, unsigned short int level)
+{
+    return ecjp_internal_check_and_load(input, len, key_list, NULL, res, level, ECJP_BOOL_FALSE);
+}
+
+/*
+    Function: ecjp_check_and_load_ctx()
+        Same as ecjp_check_and_load_n(), the input is validated as UTF-8 if the utf8_validation
+        field of the context is set.
+        The call counts in the counters of the context (see ecjp_get_stats()).
+        Returns also:
+        - ECJP_NULL_POINTER if ctx is NULL.
+*/
+ecjp_return_code_t ecjp_check_and_load_ctx(ecjp_ctx_t *ctx, const char *input, size_t len, ecjp_key_elem_t **key_list, ecjp_check_result_t *res, unsigned short int level)
+{
+    ecjp_return_code_t ret;
+#ifdef ECJP_STATS
+    ecjp_stats_t *stats_prev = ecjp_stats_cur;
+#endif
+
+    if (ctx == NULL) {
+        ecjp_printf("%s - %d: NULL pointer ctx\n",__FUNCTION__,__LINE__);
+        return ECJP_NULL_POINTER;
+    }
+    ECJP_STATS_USE(&ctx->stats);
+    ret = ecjp_internal_check_and_load(input, len, key_list, NULL, res, level, ctx->utf8_validation);
+    ECJP_STATS_USE(stats_prev);
+    return ret;
+}
+
+/*
+    Function: ecjp_check_and_load_indexed_n()
+        This function works as ecjp_check_and_load_n() and adds each key loaded in key_list to a hash index,
+        to find the keys by name in constant time with ecjp_find_key().
+        Parameters:
+        - input: The JSON-like input string to be checked and loaded.
+        - len: The length of the input string; a '\0' found before len is a syntax error.
+        - key_list: Pointer to a list of key elements loaded with the keys found in the input string.
+        - key_index: Pointer to the index, initialized with ecjp_init_key_index().
+        - res: Pointer to a structure to store the result of the check, including any error position.
+        - level: The level of checking to be performed; used to manage keys inside nested structures.
+        Returns:
+        - ECJP_NO_ERROR if the input string is valid.
+        - ECJP_NULL_POINTER if any input pointer is NULL.
+        - ECJP_EMPTY_STRING if the input string is empty.
+        - ECJP_SYNTAX_ERROR if there is a syntax error in the input string.
+*/
+ecjp_return_code_t ecjp_check_and_load_indexed_n(const char *input, size_t len, ecjp_key_elem_t **key_list, ecjp_key_index_t *key_index, ecjp_check_result_t *res, unsigned short int level)
+{
+    if ((key_list == NULL) || (key_index == NULL)) {
+        ecjp_printf("%s - %d: NULL pointer key_list/key_index\n",__FUNCTION__,__LINE__);
+        return ECJP_NULL_POINTER;
+    }
+    return ecjp_internal_check_and_load(input, len, key_list, key_index, res, level, ECJP_BOOL_FALSE);
+}
+
+/*
+    Function: ecjp_check_and_load_indexed()
+        This function calls ecjp_check_and_load_indexed_n() on a NUL-terminated input string.
+*/
+ecjp_return_code_t ecjp_check_and_load_indexed(const char *input, ecjp_key_elem_t **key_list, ecjp_key_index_t *key_index, ecjp_check_result_t *res, unsigned short int level)
+{
+    return ecjp_check_and_load_indexed_n(input, (input != NULL) ? strlen(input) : 0, key_list, key_index, res, level);
+}
+
+/*
+    Function: ecjp_check_and_load()
+        This function calls ecjp_check_and_load_n() on a NUL-terminated input string.
+        Parameters:
+        - input: The JSON-like input string to be checked and loaded.
+        - key_list: Pointer to a list of key elements loaded with the keys found in the input string.
+        - res: Pointer to a structure to store the result of the check, including any error position.
+        - level: The level of checking to be performed; used to manage keys inside nested structures.
+        Returns:
+        - ECJP_NO_ERROR if the input string is valid.
+        - ECJP_NULL_POINTER if any input pointer is NULL.
+        - ECJP_EMPTY_STRING if the input string is empty.
+        - ECJP_SYNTAX_ERROR if there is a syntax error in the input string.
+*/
+ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_list, ecjp_check_result_t *res, unsigned short int level)
+{
+    return ecjp_check_and_load_n(input, (input != NULL) ? strlen(input) : 0, key_list, res, level);
+}
+
 /*
     Function: ecjp_check_syntax
-    This function call ecjp_check_and_load() without pointer to store the keys to perform only syntax checking.
+    This function performs only syntax checking, with the same results as ecjp_check_and_load() without pointer
+    to store the keys (see ecjp_internal_check_syntax()).
     Parameters:
     - input: The JSON-like input string to be checked and loaded.
     - res: Pointer to a structure to store the result of the check, including any error position.
@@ -3723,7 +11013,41 @@ ecjp_return_code_t ecjp_check_and_load(const char *input, ecjp_key_elem_t **key_
 */
 ecjp_return_code_t ecjp_check_syntax(const char *input, ecjp_check_result_t *res)
 {
-    return ecjp_check_and_load(input, NULL, res, 0);
+    return ecjp_internal_check_syntax(input, (input != NULL) ? strlen(input) : 0, res, NULL, NULL, ECJP_BOOL_FALSE);
+}
+
+/*
+    Function: ecjp_check_syntax_n
+    Same as ecjp_check_syntax(), the input string is delimited by its length (len).
+*/
+ecjp_return_code_t ecjp_check_syntax_n(const char *input, size_t len, ecjp_check_result_t *res)
+{
+    return ecjp_internal_check_syntax(input, len, res, NULL, NULL, ECJP_BOOL_FALSE);
+}
+
+/*
+    Function: ecjp_check_syntax_ctx()
+        Same as ecjp_check_syntax_n(), the input is validated as UTF-8 if the utf8_validation
+        field of the context is set.
+        The call counts in the counters of the context (see ecjp_get_stats()).
+        Returns also:
+        - ECJP_NULL_POINTER if ctx is NULL.
+*/
+ecjp_return_code_t ecjp_check_syntax_ctx(ecjp_ctx_t *ctx, const char *input, size_t len, ecjp_check_result_t *res)
+{
+    ecjp_return_code_t ret;
+#ifdef ECJP_STATS
+    ecjp_stats_t *stats_prev = ecjp_stats_cur;
+#endif
+
+    if (ctx == NULL) {
+        ecjp_printf("%s - %d: NULL pointer ctx\n",__FUNCTION__,__LINE__);
+        return ECJP_NULL_POINTER;
+    }
+    ECJP_STATS_USE(&ctx->stats);
+    ret = ecjp_internal_check_syntax(input, len, res, NULL, NULL, ctx->utf8_validation);
+    ECJP_STATS_USE(stats_prev);
+    return ret;
 }
 
 /*
@@ -3746,24 +11070,15 @@ ecjp_return_code_t ecjp_load(const char *input, ecjp_key_elem_t **key_list, ecjp
     return ecjp_check_and_load(input, key_list, res, level);
 }
 
-#endif // ECJP_TOKEN_LIST
-
-/* TO DO: work in progress */
-#if 0
-ecjp_return_code_t ecjp_read_key_val_string(const char *input, ecjp_key_elem_t **key_list, char *string)
-{
-    return ECJP_NO_ERROR;
-}
-
-ecjp_return_code_t ecjp_read_key_val_number(const char *input, ecjp_key_elem_t **key_list, float *number)
+/*
+    Function: ecjp_load_n
+    Same as ecjp_load(), the input string is delimited by its length (len).
+*/
+ecjp_return_code_t ecjp_load_n(const char *input, size_t len, ecjp_key_elem_t **key_list, ecjp_check_result_t *res, unsigned short int level)
 {
-    return ECJP_NO_ERROR;
+    return ecjp_check_and_load_n(input, len, key_list, res, level);
 }
 
-ecjp_return_code_t ecjp_read_key_val_bool(const char *input, ecjp_key_elem_t **key_list, bool *boolean)
-{
-    return ECJP_NO_ERROR;
-}   
-#endif
+#endif // ECJP_TOKEN_LIST
 
 
@@ -0,0 +1,468 @@
+#include "ecjp.h"
+
+#include "sys/stat.h"
+#include <unistd.h>
+#include <time.h>
+
+// minimum time of each measure, in seconds
+#define BENCH_MIN_TIME              0.1
+// maximum number of keys read by the lookups
+#define BENCH_MAX_KEYS              1024
+// maximum number of elements read by the array sweep
+#define BENCH_MAX_ELEMENTS          1024
+// levels of ecjp_load() measured, from 1
+#define BENCH_NUM_LEVELS            3
+// sizes of the generated inputs (the ones larger than ECJP_MAX_INPUT_SIZE are replaced by it)
+#define BENCH_NUM_SIZES             4
+// the positions of the key list are stored in ECJP_TYPE_POS_KEY: larger inputs can't be loaded
+#define BENCH_MAX_KEY_POS           ((size_t)(ECJP_TYPE_POS_KEY)~0)
+
+#ifdef ECJP_RUN_ON_PC
+    #define BENCH_PROFILE           "pc"
+#else
+    #ifdef ECJP_RUN_ON_MCU
+        #define BENCH_PROFILE       "mcu"
+    #else
+        #define BENCH_PROFILE       "default"
+    #endif
+#endif
+
+typedef struct bench_counter {
+    long                calls;          // calls to malloc_fn() and realloc_fn()
+} bench_counter_t;
+
+typedef struct bench_input {
+    const char          *name;
+    char                *ptr;           // NUL-terminated
+    size_t              len;
+    int                 level;          // level of ecjp_load()
+#ifdef ECJP_TOKEN_LIST
+    ecjp_item_elem_t    *item_list;
+    char                key[BENCH_MAX_KEYS][ECJP_MAX_KEY_LEN];
+#else
+    ecjp_key_elem_t     *key_list;
+    ecjp_indata_t       key[BENCH_MAX_KEYS];
+#endif
+    int                 num_keys;
+    int                 num_elements;
+    ecjp_outdata_t      out;
+} bench_input_t;
+
+// runs the operation number i on the input
+typedef ecjp_return_code_t (*bench_op_t)(bench_input_t *in, long i);
+
+static const size_t bench_size[BENCH_NUM_SIZES] = { 1024, 60 * 1024, 1024 * 1024, 5 * 1024 * 1024 };
+static bench_counter_t counter;
+static int num_results = 0;
+
+void usage(char *prog_name)
+{
+    fprintf(stderr, "Usage: %s [filename ...]\n", prog_name);
+}
+
+void *counting_malloc(size_t size, void *user_data)
+{
+    ((bench_counter_t *)user_data)->calls++;
+    return malloc(size);
+}
+
+void *counting_realloc(void *ptr, size_t size, void *user_data)
+{
+    ((bench_counter_t *)user_data)->calls++;
+    return realloc(ptr, size);
+}
+
+void counting_free(void *ptr, void *user_data)
+{
+    free(ptr);
+}
+
+double now(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec / 1e9;
+}
+
+/*
+ * Print a string of the JSON output, with the quotes, backslashes and control characters escaped.
+*/
+void print_string(const char *s)
+{
+    putchar('"');
+    for (; *s != '\0'; s++) {
+        if ((*s == '"') || (*s == '\\')) {
+            printf("\\%c", *s);
+        } else if ((unsigned char)*s < 0x20) {
+            printf("\\u%04x", (unsigned char)*s);
+        } else {
+            putchar(*s);
+        }
+    }
+    putchar('"');
+}
+
+/*
+ * Run the operation until BENCH_MIN_TIME is elapsed (in batches of doubling size) and print its result:
+ * bytes is the number of characters processed by each operation, level is -1 if not used.
+*/
+void measure(bench_input_t *in, const char *function, int level, bench_op_t op, size_t bytes)
+{
+    ecjp_return_code_t ret = ECJP_NO_ERROR;
+    double start, elapsed;
+    long batch, ops, calls, k;
+
+    calls = counter.calls;
+    ops = 0;
+    batch = 1;
+    start = now();
+    do {
+        for (k = 0; k < batch; k++) {
+            ret = op(in, ops + k);
+        }
+        ops += batch;
+        batch *= 2;
+        elapsed = now() - start;
+    } while (elapsed < BENCH_MIN_TIME);
+    calls = counter.calls - calls;
+
+    printf("%s    {\"input\": ", (num_results++ > 0) ? ",\n" : "");
+    print_string(in->name);
+    printf(", \"bytes\": %zu, \"function\": \"%s\", \"level\": %d, \"ret\": %d, \"ops\": %ld, ", in->len, function, level, ret, ops);
+    printf("\"mb_per_s\": %.2f, \"ns_per_op\": %.1f, \"allocs_per_op\": %.2f}",
+           (bytes > 0) ? ((double)bytes * ops / elapsed / 1e6) : 0.0, elapsed * 1e9 / ops, (double)calls / ops);
+}
+
+ecjp_return_code_t op_sax_parse(bench_input_t *in, long i)
+{
+    static const ecjp_sax_handler_t handler = { NULL };
+
+    return ecjp_sax_parse(in->ptr, in->len, &handler, NULL);
+}
+
+ecjp_return_code_t op_load_tape(bench_input_t *in, long i)
+{
+    ecjp_check_result_t res;
+    ecjp_tape_t tape;
+    ecjp_return_code_t ret;
+
+    memset(&res, 0, sizeof(ecjp_check_result_t));
+    ecjp_init_tape(&tape);
+    ret = ecjp_load_tape_n(in->ptr, in->len, &tape, &res);
+    ecjp_free_tape(&tape);
+    return ret;
+}
+
+#ifdef ECJP_TOKEN_LIST
+
+ecjp_return_code_t op_check_syntax(bench_input_t *in, long i)
+{
+    ecjp_check_result_t res;
+
+    memset(&res, 0, sizeof(ecjp_check_result_t));
+    return ecjp_check_syntax_2_n(in->ptr, in->len, &res);
+}
+
+ecjp_return_code_t op_load(bench_input_t *in, long i)
+{
+    ecjp_check_result_t res;
+    ecjp_item_elem_t *item_list = NULL;
+    ecjp_return_code_t ret;
+
+    memset(&res, 0, sizeof(ecjp_check_result_t));
+    ret = ecjp_load_2_n(in->ptr, in->len, &item_list, &res);
+    ecjp_free_item_list(&item_list);
+    return ret;
+}
+
+ecjp_return_code_t op_read_key(bench_input_t *in, long i)
+{
+    in->out.value_size = ECJP_MAX_ITEM_LEN;
+    return ecjp_read_key_2(in->item_list, in->key[i % in->num_keys], 0, &in->out);
+}
+
+ecjp_return_code_t op_read_element(bench_input_t *in, long i)
+{
+    in->out.value_size = ECJP_MAX_ITEM_LEN;
+    return ecjp_read_element(in->item_list, (int)(i % in->num_elements), &in->out);
+}
+
+/*
+ * Load the item list of the input and collect the keys of its pairs.
+*/
+void prepare(bench_input_t *in)
+{
+    ecjp_check_result_t res;
+    char value[ECJP_MAX_KEY_VALUE_LEN];
+    ecjp_item_elem_t *item;
+
+    in->item_list = NULL;
+    in->num_keys = 0;
+    in->num_elements = 0;
+    memset(&res, 0, sizeof(ecjp_check_result_t));
+    if (ecjp_load_2_n(in->ptr, in->len, &in->item_list, &res) != ECJP_NO_ERROR) {
+        return;
+    }
+    in->num_elements = ecjp_get_item_count(in->item_list);
+    for (item = in->item_list; (item != NULL) && (in->num_keys < BENCH_MAX_KEYS); item = item->next) {
+        if ((item->item.type == ECJP_TYPE_KEY_VALUE_PAIR) &&
+            (ecjp_split_key_and_value(item, in->key[in->num_keys], value, ECJP_BOOL_FALSE) == ECJP_NO_ERROR)) {
+            in->num_keys++;
+        }
+    }
+}
+
+void release(bench_input_t *in)
+{
+    ecjp_free_item_list(&in->item_list);
+}
+
+void run(bench_input_t *in)
+{
+    measure(in, "ecjp_check_syntax_2_n", -1, op_check_syntax, in->len);
+    measure(in, "ecjp_sax_parse", -1, op_sax_parse, in->len);
+    measure(in, "ecjp_load_tape_n", -1, op_load_tape, in->len);
+    measure(in, "ecjp_load_2_n", -1, op_load, in->len);
+    prepare(in);
+    if (in->num_keys > 0) {
+        measure(in, "ecjp_read_key_2", -1, op_read_key, 0);
+    }
+    if (in->num_elements > 0) {
+        measure(in, "ecjp_read_element", -1, op_read_element, 0);
+    }
+    release(in);
+}
+
+#else
+
+ecjp_return_code_t op_check_syntax(bench_input_t *in, long i)
+{
+    ecjp_check_result_t res;
+
+    memset(&res, 0, sizeof(ecjp_check_result_t));
+    return ecjp_check_syntax_n(in->ptr, in->len, &res);
+}
+
+ecjp_return_code_t op_load(bench_input_t *in, long i)
+{
+    ecjp_check_result_t res;
+    ecjp_key_elem_t *key_list = NULL;
+    ecjp_return_code_t ret;
+
+    memset(&res, 0, sizeof(ecjp_check_result_t));
+    ret = ecjp_load_n(in->ptr, in->len, &key_list, &res, (unsigned short int)in->level);
+    ecjp_free_key_list(&key_list);
+    return ret;
+}
+
+ecjp_return_code_t op_get_key(bench_input_t *in, long i)
+{
+    in->out.value_size = ECJP_MAX_KEY_LEN;
+    return ecjp_get_key(in->ptr, in->key[i % in->num_keys].key, &in->key_list, 0, &in->out);
+}
+
+ecjp_return_code_t op_read_key(bench_input_t *in, long i)
+{
+    ecjp_indata_t key = in->key[i % in->num_keys];
+
+    in->out.value_size = ECJP_MAX_KEY_VALUE_LEN;
+    return ecjp_read_key_n(in->ptr, in->len, &key, &in->out);
+}
+
+ecjp_return_code_t op_read_array_element(bench_input_t *in, long i)
+{
+    in->out.value_size = ECJP_MAX_ARRAY_ELEM_LEN;
+    return ecjp_read_array_element_n(in->ptr, in->len, (int)(i % in->num_elements), &in->out);
+}
+
+/*
+ * Load the keys of the first level of the input and count the elements of the root array.
+*/
+void prepare(bench_input_t *in)
+{
+    ecjp_check_result_t res;
+    ecjp_indata_t *key;
+    ECJP_TYPE_POS_KEY start = 0;
+
+    in->key_list = NULL;
+    in->num_keys = 0;
+    in->num_elements = 0;
+    memset(&res, 0, sizeof(ecjp_check_result_t));
+    if (ecjp_load_n(in->ptr, in->len, &in->key_list, &res, 1) != ECJP_NO_ERROR) {
+        return;
+    }
+    if (res.struct_type == ECJP_ST_ARRAY) {
+        while (in->num_elements < BENCH_MAX_ELEMENTS) {
+            in->out.value_size = ECJP_MAX_ARRAY_ELEM_LEN;
+            if (ecjp_read_array_element_n(in->ptr, in->len, in->num_elements, &in->out) != ECJP_NO_ERROR) {
+                break;
+            }
+            in->num_elements++;
+        }
+        return;
+    }
+    while ((in->key_list != NULL) && (in->num_keys < BENCH_MAX_KEYS)) {
+        in->out.value_size = ECJP_MAX_KEY_LEN;
+        if (ecjp_get_key(in->ptr, NULL, &in->key_list, start, &in->out) != ECJP_NO_ERROR) {
+            break;
+        }
+        key = &in->key[in->num_keys++];
+        memset(key, 0, sizeof(ecjp_indata_t));
+        strncpy(key->key, (char *)in->out.value, ECJP_MAX_KEY_LEN - 1);
+        key->type = in->out.type;
+        key->pos = in->out.last_pos;
+        key->length = in->out.length;
+        start = in->out.last_pos;
+    }
+}
+
+void release(bench_input_t *in)
+{
+    ecjp_free_key_list(&in->key_list);
+}
+
+void run(bench_input_t *in)
+{
+    measure(in, "ecjp_check_syntax_n", -1, op_check_syntax, in->len);
+    measure(in, "ecjp_sax_parse", -1, op_sax_parse, in->len);
+    measure(in, "ecjp_load_tape_n", -1, op_load_tape, in->len);
+    if (in->len > BENCH_MAX_KEY_POS) {
+        return;
+    }
+    for (in->level = 1; in->level <= BENCH_NUM_LEVELS; in->level++) {
+        measure(in, "ecjp_load_n", in->level, op_load, in->len);
+    }
+    prepare(in);
+    if (in->num_keys > 0) {
+        measure(in, "ecjp_get_key", -1, op_get_key, 0);
+        measure(in, "ecjp_read_key_n", -1, op_read_key, 0);
+    }
+    if (in->num_elements > 0) {
+        measure(in, "ecjp_read_array_element_n", -1, op_read_array_element, 0);
+    }
+    release(in);
+}
+
+#endif  // ECJP_TOKEN_LIST
+
+/*
+ * Fill the buffer with a document of about size characters: an array of records like
+ * tests/valid_24_db_example.json (records), or an object with many keys (object).
+ * The content depends only on the size.
+*/
+size_t generate(char *buffer, size_t size, int records)
+{
+    size_t len = 0;
+    int n = 0;
+
+    buffer[len++] = records ? '[' : '{';
+    while (len + 128 < size) {
+        if (n > 0) {
+            buffer[len++] = ',';
+        }
+        if (records) {
+            len += sprintf(&buffer[len], "{\"id\": %d, \"name\": \"item %d\", \"price\": %d.%02d, \"tags\": [\"a\", \"b\\n\"], \"active\": %s}",
+                           n, n, n * 7 % 1000, n % 100, (n % 3 == 0) ? "true" : "false");
+        } else {
+            len += sprintf(&buffer[len], "\"key_%d\": %s", n, (n % 4 == 0) ? "null" : (n % 4 == 1) ? "-12.5e3" : (n % 4 == 2) ? "\"value\"" : "[1, 2]");
+        }
+        n++;
+    }
+    buffer[len++] = records ? ']' : '}';
+    buffer[len] = '\0';
+    return len;
+}
+
+int main(int argc, char *argv[])
+{
+    static bench_input_t in;
+    ecjp_allocator_t allocator;
+    char version_string[16];
+    char name[64];
+    struct stat strstat;
+    size_t size, last_size;
+    int i, records;
+
+    for (i = 1; i < argc; i++) {
+        if (argv[i][0] == '-') {
+            usage(argv[0]);
+            return -1;
+        }
+    }
+    allocator.malloc_fn = counting_malloc;
+    allocator.realloc_fn = counting_realloc;
+    allocator.free_fn = counting_free;
+    allocator.user_data = &counter;
+    ecjp_set_allocator(&allocator);
+    memset(version_string, 0, sizeof(version_string));
+    ecjp_get_version_string(version_string, sizeof(version_string));
+    in.out.value = malloc(ECJP_MAX_ITEM_LEN + ECJP_MAX_KEY_VALUE_LEN + ECJP_MAX_ARRAY_ELEM_LEN);
+    if (in.out.value == NULL) {
+        fprintf(stderr, "Memory allocation failed for the output buffer\n");
+        return -1;
+    }
+
+    printf("{\"version\": \"%s\", \"profile\": \"%s\", ", version_string, BENCH_PROFILE);
+#ifdef ECJP_TOKEN_LIST
+    printf("\"implementation\": \"token-list\", ");
+#else
+    printf("\"implementation\": \"key-position\", ");
+#endif
+    printf("\"max_input_size\": %d, \"results\": [\n", ECJP_MAX_INPUT_SIZE);
+
+    // the input files
+    for (i = 1; i < argc; i++) {
+        memset(&strstat, 0, sizeof(struct stat));
+        if (stat(argv[i], &strstat) != 0) {
+            fprintf(stderr, "stat() failed for file %s\n", argv[i]);
+            continue;
+        }
+        in.ptr = (char *)malloc(strstat.st_size + 1);
+        if (in.ptr == NULL) {
+            fprintf(stderr, "Memory allocation failed for JSON file %s\n", argv[i]);
+            continue;
+        }
+        FILE *f = fopen(argv[i], "r");
+        if (f == NULL) {
+            fprintf(stderr, "Failed to open file %s\n", argv[i]);
+            free(in.ptr);
+            continue;
+        }
+        in.len = fread(in.ptr, 1, strstat.st_size, f);
+        in.ptr[in.len] = '\0';
+        fclose(f);
+        in.name = argv[i];
+        if (in.len > 0) {
+            run(&in);
+        }
+        free(in.ptr);
+    }
+
+    // the generated inputs, up to ECJP_MAX_INPUT_SIZE
+    for (records = 1; records >= 0; records--) {
+        last_size = 0;
+        for (i = 0; i < BENCH_NUM_SIZES; i++) {
+            size = (bench_size[i] < ECJP_MAX_INPUT_SIZE) ? bench_size[i] : ECJP_MAX_INPUT_SIZE;
+            if (size == last_size) {
+                break;
+            }
+            last_size = size;
+            in.ptr = (char *)malloc(size + 1);
+            if (in.ptr == NULL) {
+                fprintf(stderr, "Memory allocation failed for the generated input\n");
+                break;
+            }
+            in.len = generate(in.ptr, size, records);
+            snprintf(name, sizeof(name), "generated:%s:%zu", records ? "records" : "object", size);
+            in.name = name;
+            run(&in);
+            free(in.ptr);
+        }
+    }
+    printf("\n]}\n");
+
+    ecjp_set_allocator(NULL);
+    free(in.out.value);
+    return 0;
+}
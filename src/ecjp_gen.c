@@ -0,0 +1,385 @@
+#include "ecjp.h"
+
+// characters collected before writing them to the output
+#define GEN_BUF_SIZE                (64 * 1024)
+// size of the documents when not given
+#define GEN_DEFAULT_SIZE            1024
+// maximum length of an element written by a shape
+#define GEN_MAX_ELEM_LEN            512
+// maximum position of a key in the key list
+#define GEN_MAX_KEY_POS             ((unsigned long)(ECJP_TYPE_POS_KEY)~0)
+
+typedef struct gen_state {
+    FILE                *f;
+    char                buf[GEN_BUF_SIZE];
+    size_t              used;           // characters in buf
+    size_t              written;        // characters written, buf included
+    size_t              size;           // size requested
+    unsigned long long  seed;
+} gen_state_t;
+
+typedef struct gen_shape {
+    const char          *name;
+    void                (*generate)(gen_state_t *g);
+    const char          *description;
+} gen_shape_t;
+
+static const char *const gen_word[] = {
+    "Roma", "Milano", "Firenze", "Torino", "Napoli", "Via Roma", "Corso Venezia", "Piazza Dante", "Giuseppe", "Leonardo",
+    "Galileo", "Enrico", "Garibaldi", "Da Vinci", "Galilei", "Fermi"
+};
+
+// escape sequences of the escape-heavy strings
+static const char *const gen_escape[] = {
+    "\\n", "\\t", "\\\"", "\\\\", "\\/", "\\u00e8", "\\u20ac", "\\ud83d\\ude00", "\\r", "\\b", "\\f"
+};
+
+/*
+ * Write the characters of the buffer to the output.
+*/
+void gen_flush(gen_state_t *g)
+{
+    if (g->used > 0) {
+        fwrite(g->buf, 1, g->used, g->f);
+        g->used = 0;
+    }
+}
+
+/*
+ * Append a formatted string to the output (at most GEN_MAX_ELEM_LEN characters).
+*/
+void gen_printf(gen_state_t *g, const char *format, ...)
+{
+    va_list args;
+    int n;
+
+    if (g->used + GEN_MAX_ELEM_LEN + 1 > GEN_BUF_SIZE) {
+        gen_flush(g);
+    }
+    va_start(args, format);
+    n = vsnprintf(&g->buf[g->used], GEN_MAX_ELEM_LEN + 1, format, args);
+    va_end(args);
+    if (n > GEN_MAX_ELEM_LEN) {
+        n = GEN_MAX_ELEM_LEN;
+    }
+    g->used += n;
+    g->written += n;
+}
+
+/*
+ * Append n copies of the character c to the output.
+*/
+void gen_repeat(gen_state_t *g, char c, size_t n)
+{
+    size_t k;
+
+    while (n > 0) {
+        if (g->used == GEN_BUF_SIZE) {
+            gen_flush(g);
+        }
+        k = GEN_BUF_SIZE - g->used;
+        if (k > n) {
+            k = n;
+        }
+        memset(&g->buf[g->used], c, k);
+        g->used += k;
+        g->written += k;
+        n -= k;
+    }
+}
+
+/*
+ * Next pseudo-random number of the sequence of the seed (the same for every platform).
+*/
+unsigned long gen_random(gen_state_t *g, unsigned long range)
+{
+    g->seed = (g->seed * 6364136223846793005ULL + 1442695040888963407ULL) & 0xFFFFFFFFFFFFFFFFULL;
+    return (unsigned long)((g->seed >> 33) % range);
+}
+
+/*
+ * TRUE while another element of about len characters fits in the size requested
+ * (the closing characters included).
+*/
+ecjp_bool_t gen_room(gen_state_t *g, size_t len)
+{
+    return (g->written + len + 2 <= g->size) ? ECJP_BOOL_TRUE : ECJP_BOOL_FALSE;
+}
+
+/*
+ * Append a number of one of the forms of the JSON syntax
+ * (the random numbers are drawn one at a time: the order of the arguments is not defined).
+*/
+void gen_number(gen_state_t *g)
+{
+    unsigned long form, a, b, c;
+
+    form = gen_random(g, 6);
+    a = gen_random(g, 1000000);
+    b = gen_random(g, 1000);
+    c = gen_random(g, 300);
+    switch (form) {
+        case 0:
+            gen_printf(g, "%lu", a % 10);
+            break;
+        case 1:
+            gen_printf(g, "-%lu", a * 1000 + b);
+            break;
+        case 2:
+            gen_printf(g, "%lu.%03lu", a % 100000, b);
+            break;
+        case 3:
+            gen_printf(g, "-0.%06lue-%lu", a, c);
+            break;
+        case 4:
+            gen_printf(g, "%lu.%luE+%lu", 1 + b % 9, a, c);
+            break;
+        default:
+            gen_printf(g, "%lu%06lu%03lu", 1 + c, a, b);
+            break;
+    }
+}
+
+/*
+ * Append a record with the keys of tests/valid_24_db_example.json and some more.
+*/
+void gen_record(gen_state_t *g, unsigned long n)
+{
+    unsigned long name, surname, age, address, number, city, zip, active;
+
+    name = gen_random(g, 4);
+    surname = gen_random(g, 4);
+    age = gen_random(g, 70);
+    address = gen_random(g, 3);
+    number = gen_random(g, 200);
+    city = gen_random(g, 5);
+    zip = gen_random(g, 100000);
+    active = gen_random(g, 2);
+    gen_printf(g, "{\"Id\": %lu, \"Name\": \"%s\", \"Surname\": \"%s\", \"Age\": %lu, \"Address\": \"%s %lu\", \"City\": \"%s\", \"Zip\": \"%05lu\", \"Active\": %s, \"Manager\": null}",
+               n, gen_word[8 + name], gen_word[12 + surname], 18 + age, gen_word[5 + address], 1 + number, gen_word[city], zip,
+               active ? "true" : "false");
+}
+
+/*
+ * Object with one key for each value, the values of every type.
+*/
+void gen_wide_object(gen_state_t *g)
+{
+    unsigned long n;
+
+    gen_printf(g, "{");
+    for (n = 0; (n == 0) || gen_room(g, 48); n++) {
+        gen_printf(g, "%s\"key_%08lu\": ", (n > 0) ? ", " : "", n);
+        switch (gen_random(g, 5)) {
+            case 0:  gen_number(g); break;
+            case 1:  gen_printf(g, "\"%s\"", gen_word[gen_random(g, 16)]); break;
+            case 2:  gen_printf(g, "%s", gen_random(g, 2) ? "true" : "false"); break;
+            case 3:  gen_printf(g, "null"); break;
+            default: gen_printf(g, "[%lu, %lu]", n % 100, gen_random(g, 100)); break;
+        }
+    }
+    gen_printf(g, "}");
+}
+
+/*
+ * Array of records with the same keys, like tests/valid_24_db_example.json.
+*/
+void gen_records(gen_state_t *g)
+{
+    unsigned long n;
+
+    gen_printf(g, "[");
+    for (n = 0; (n == 0) || gen_room(g, 200); n++) {
+        gen_printf(g, "%s\n  ", (n > 0) ? "," : "");
+        gen_record(g, n);
+    }
+    gen_printf(g, "\n]");
+}
+
+/*
+ * Array of numbers of every form: integers, fractions and exponents.
+*/
+void gen_numbers(gen_state_t *g)
+{
+    unsigned long n;
+
+    gen_printf(g, "[");
+    for (n = 0; (n == 0) || gen_room(g, 32); n++) {
+        if (n > 0) {
+            gen_printf(g, "%s", (n % 16 == 0) ? ",\n" : ", ");
+        }
+        gen_number(g);
+    }
+    gen_printf(g, "]");
+}
+
+/*
+ * Array of strings with many escape sequences (surrogate pairs included) between short runs of characters.
+*/
+void gen_escapes(gen_state_t *g)
+{
+    unsigned long n, k, num, run;
+
+    gen_printf(g, "[");
+    for (n = 0; (n == 0) || gen_room(g, 200); n++) {
+        gen_printf(g, "%s\"", (n > 0) ? ",\n" : "");
+        num = 4 + gen_random(g, 12);
+        for (k = 0; k < num; k++) {
+            run = gen_random(g, 8);
+            gen_printf(g, "%.*s%s", (int)run, "abcdefgh", gen_escape[gen_random(g, 11)]);
+        }
+        gen_printf(g, "\"");
+    }
+    gen_printf(g, "]");
+}
+
+/*
+ * Array of structures nested up to half of ECJP_MAX_PARSE_STACK_DEPTH, objects and arrays alternated.
+*/
+void gen_deep(gen_state_t *g)
+{
+    unsigned long n, k, depth, max_depth;
+
+    gen_printf(g, "[");
+    for (n = 0; (n == 0) || gen_room(g, 64); n++) {
+        gen_printf(g, "%s", (n > 0) ? ",\n" : "");
+        // each level takes up to 16 characters
+        max_depth = (g->written + 64 < g->size) ? (g->size - g->written - 32) / 16 : 1;
+        if (max_depth > ECJP_MAX_PARSE_STACK_DEPTH / 2) {
+            max_depth = ECJP_MAX_PARSE_STACK_DEPTH / 2;
+        }
+        depth = 1 + gen_random(g, max_depth);
+        for (k = 0; k < depth; k++) {
+            if (k % 2 == 0) {
+                gen_printf(g, "{\"l%lu\": ", k);
+            } else {
+                gen_printf(g, "[%lu, ", k);
+            }
+        }
+        gen_number(g);
+        while (k-- > 0) {
+            gen_printf(g, "%c", (k % 2 == 0) ? '}' : ']');
+        }
+    }
+    gen_printf(g, "]");
+}
+
+/*
+ * Records on separate lines (NDJSON), to be checked with ecjp_check_documents().
+*/
+void gen_ndjson(gen_state_t *g)
+{
+    unsigned long n;
+
+    for (n = 0; (n == 0) || gen_room(g, 200); n++) {
+        gen_record(g, n);
+        gen_printf(g, "\n");
+    }
+}
+
+/*
+ * Arrays nested exactly ECJP_MAX_PARSE_STACK_DEPTH times: the deepest input accepted (the size is not used).
+*/
+void gen_depth_limit(gen_state_t *g)
+{
+    gen_repeat(g, '[', ECJP_MAX_PARSE_STACK_DEPTH);
+    gen_repeat(g, ']', ECJP_MAX_PARSE_STACK_DEPTH);
+}
+
+/*
+ * Arrays nested ECJP_MAX_PARSE_STACK_DEPTH + 1 times: the parse stack overflows (the size is not used).
+*/
+void gen_depth_over(gen_state_t *g)
+{
+    gen_repeat(g, '[', ECJP_MAX_PARSE_STACK_DEPTH + 1);
+    gen_repeat(g, ']', ECJP_MAX_PARSE_STACK_DEPTH + 1);
+}
+
+/*
+ * Object with a long string and a last key that starts at the position pos.
+*/
+void gen_key_at(gen_state_t *g, unsigned long pos)
+{
+    // {"fill": "..." , "last": 1}: the key starts after the string and the 3 characters ", "
+    gen_printf(g, "{\"fill\": \"");
+    gen_repeat(g, 'x', pos - g->written - 4);
+    gen_printf(g, "\", \"last\": 1}");
+}
+
+/*
+ * The last key starts at the maximum position of ECJP_TYPE_POS_KEY (the size is not used).
+*/
+void gen_key_pos_limit(gen_state_t *g)
+{
+    gen_key_at(g, GEN_MAX_KEY_POS);
+}
+
+/*
+ * The last key starts after the maximum position of ECJP_TYPE_POS_KEY (the size is not used).
+*/
+void gen_key_pos_over(gen_state_t *g)
+{
+    gen_key_at(g, GEN_MAX_KEY_POS + 1);
+}
+
+static const gen_shape_t gen_shape[] = {
+    { "wide_object",    gen_wide_object,    "object with many keys and values of every type" },
+    { "records",        gen_records,        "array of records with the same keys" },
+    { "numbers",        gen_numbers,        "array of integers, fractions and exponents" },
+    { "escapes",        gen_escapes,        "array of strings with many escape sequences" },
+    { "deep",           gen_deep,           "array of structures nested up to half of the parse stack" },
+    { "ndjson",         gen_ndjson,         "records on separate lines" },
+    { "depth_limit",    gen_depth_limit,    "arrays nested as deep as the parse stack (fixed size)" },
+    { "depth_over",     gen_depth_over,     "arrays nested deeper than the parse stack (fixed size)" },
+    { "key_pos_limit",  gen_key_pos_limit,  "last key at the maximum position of the key list (fixed size)" },
+    { "key_pos_over",   gen_key_pos_over,   "last key after the maximum position of the key list (fixed size)" },
+    { NULL, NULL, NULL }
+};
+
+void usage(char *prog_name)
+{
+    int i;
+
+    fprintf(stderr, "Usage: %s <shape> [size[k|m|g]] [seed]\n", prog_name);
+    fprintf(stderr, "Write a JSON document of about size characters (default %d) to stdout. Shapes:\n", GEN_DEFAULT_SIZE);
+    for (i = 0; gen_shape[i].name != NULL; i++) {
+        fprintf(stderr, "  %-16s%s\n", gen_shape[i].name, gen_shape[i].description);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    static gen_state_t g;
+    char *end;
+    unsigned long long size = GEN_DEFAULT_SIZE;
+    int i;
+
+    if ((argc < 2) || (argc > 4)) {
+        usage(argv[0]);
+        return -1;
+    }
+    for (i = 0; (gen_shape[i].name != NULL) && (strcmp(gen_shape[i].name, argv[1]) != 0); i++);
+    if (gen_shape[i].name == NULL) {
+        usage(argv[0]);
+        return -1;
+    }
+    if (argc > 2) {
+        size = strtoull(argv[2], &end, 10);
+        switch (*end) {
+            case 'k': case 'K': size <<= 10; end++; break;
+            case 'm': case 'M': size <<= 20; end++; break;
+            case 'g': case 'G': size <<= 30; end++; break;
+            default: break;
+        }
+        if ((*end != '\0') || (size == 0) || (size > SIZE_MAX)) {
+            usage(argv[0]);
+            return -1;
+        }
+    }
+    g.f = stdout;
+    g.size = (size_t)size;
+    g.seed = (argc > 3) ? strtoull(argv[3], NULL, 10) : 1;
+    gen_shape[i].generate(&g);
+    gen_flush(&g);
+    return (fflush(stdout) == 0) ? 0 : -1;
+}
@@ -63,6 +63,7 @@ int main(int argc, char *argv[])
 {
     int major, minor, patch;
     int array_index;
+    ecjp_array_index_t elements;
     ecjp_return_code_t ret;
     ecjp_check_result_t results;
     char *ptr;
@@ -163,12 +164,16 @@ int main(int argc, char *argv[])
                                 return -1;
                             }
                             ecjp_fprint("\nReading array elements:\n");
-                            while (ecjp_read_array_element(ptr,array_index,&out) == ECJP_NO_ERROR) {
+                            // parse the array once, then read the elements from the index
+                            ecjp_init_array_index(&elements);
+                            ecjp_index_array(ptr,&elements);
+                            while (ecjp_read_array_index(ptr,&elements,array_index,&out) == ECJP_NO_ERROR) {
                                 ecjp_fprintf("Array element #%d read successfully.\n",array_index);
                                 ecjp_fprintf("Type = %d, Value = %s\n", out.type, (char *)out.value);
                                 out.value_size = ECJP_MAX_ARRAY_ELEM_LEN;
                                 array_index++;
                             }
+                            ecjp_free_array_index(&elements);
                             free(out.value);
                             out.value = NULL;
                         } else {
@@ -0,0 +1,320 @@
+#include "ecjp.h"
+
+#include "sys/stat.h"
+#include <unistd.h>
+
+#ifdef ECJP_RUN_ON_PC
+    #define ecjp_fprintf(format, ...)    fprintf(stdout, format, __VA_ARGS__)
+    #define ecjp_fprint(format)          fprintf(stdout, format)
+#else
+    #define ecjp_fprintf(format, ...)
+    #define ecjp_fprint(format)
+#endif
+
+// returned when the results or the allocations depend on the allocator
+#define TEST_ALLOCATOR_MISMATCH     2
+// maximum number of values collected by run_parser()
+#define TEST_MAX_VALUES             16
+// maximum number of runs with a failing allocation
+#define TEST_MAX_FAILURES           64
+
+typedef struct test_summary {
+    int                 value[TEST_MAX_VALUES];
+    int                 count;
+} test_summary_t;
+
+typedef struct test_counter {
+    long                allocs;         // blocks allocated
+    long                frees;          // blocks released
+    long                calls;          // calls to malloc_fn() and realloc_fn()
+    long                fail_after;     // calls that succeed before the failures, -1 never fail
+    size_t              live;           // bytes allocated now
+    size_t              peak;           // maximum of live
+} test_counter_t;
+
+// the size of the block is saved before the block
+typedef union test_header {
+    size_t              size;
+    long double         align;
+} test_header_t;
+
+void usage(char *prog_name)
+{
+    ecjp_fprintf("Usage: %s [filename]\n", prog_name);
+}
+
+void *counting_malloc(size_t size, void *user_data)
+{
+    test_counter_t *counter = (test_counter_t *)user_data;
+    test_header_t *h;
+
+    if ((counter->fail_after >= 0) && (counter->calls >= counter->fail_after)) {
+        return NULL;
+    }
+    counter->calls++;
+    h = (test_header_t *)malloc(sizeof(test_header_t) + size);
+    if (h == NULL) {
+        return NULL;
+    }
+    h->size = size;
+    counter->allocs++;
+    counter->live += size;
+    if (counter->live > counter->peak) {
+        counter->peak = counter->live;
+    }
+    return h + 1;
+}
+
+void *counting_realloc(void *ptr, size_t size, void *user_data)
+{
+    test_counter_t *counter = (test_counter_t *)user_data;
+    test_header_t *h = (test_header_t *)ptr - 1;
+    size_t old_size = h->size;
+
+    if ((counter->fail_after >= 0) && (counter->calls >= counter->fail_after)) {
+        return NULL;
+    }
+    counter->calls++;
+    h = (test_header_t *)realloc(h, sizeof(test_header_t) + size);
+    if (h == NULL) {
+        return NULL;
+    }
+    h->size = size;
+    counter->live = counter->live - old_size + size;
+    if (counter->live > counter->peak) {
+        counter->peak = counter->live;
+    }
+    return h + 1;
+}
+
+void counting_free(void *ptr, void *user_data)
+{
+    test_counter_t *counter = (test_counter_t *)user_data;
+    test_header_t *h = (test_header_t *)ptr - 1;
+
+    counter->frees++;
+    counter->live -= h->size;
+    free(h);
+}
+
+void add_value(test_summary_t *summary, int value)
+{
+    if (summary->count < TEST_MAX_VALUES) {
+        summary->value[summary->count++] = value;
+    }
+}
+
+/*
+ * Parse the input with the functions that allocate memory, release everything
+ * and collect the return codes and the number of elements found.
+*/
+void run_parser(const char *input, size_t len, test_summary_t *summary)
+{
+    ecjp_check_result_t results;
+    ecjp_tape_t tape;
+    ecjp_return_code_t ret;
+#ifdef ECJP_TOKEN_LIST
+    ecjp_item_elem_t *item_list = NULL;
+#else
+    ecjp_key_elem_t *key_list = NULL;
+    ecjp_key_index_t key_index;
+    ecjp_array_index_t array_index;
+#endif
+
+    memset(summary, 0, sizeof(test_summary_t));
+
+    ecjp_init_tape(&tape);
+    ret = ecjp_load_tape_n(input, len, &tape, &results);
+    add_value(summary, ret);
+    add_value(summary, (ret == ECJP_NO_ERROR) ? tape.count : 0);
+    ecjp_free_tape(&tape);
+
+#ifdef ECJP_TOKEN_LIST
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    ret = ecjp_check_and_load_2_n(input, len, &item_list, &results);
+    add_value(summary, ret);
+    add_value(summary, ecjp_get_item_count(item_list));
+    ecjp_free_item_list(&item_list);
+
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    ret = ecjp_check_and_load_2_arena_n(input, len, &item_list, &results);
+    add_value(summary, ret);
+    add_value(summary, ecjp_get_item_count(item_list));
+    ecjp_free_item_list(&item_list);
+#else
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    ret = ecjp_check_and_load_n(input, len, &key_list, &results, ECJP_MAX_NESTED_LEVEL);
+    add_value(summary, ret);
+    add_value(summary, ecjp_get_key_count(key_list));
+    ecjp_free_key_list(&key_list);
+
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    ecjp_init_key_index(&key_index, ECJP_DUP_FIRST_WINS);
+    ret = ecjp_check_and_load_indexed_n(input, len, &key_list, &key_index, &results, ECJP_MAX_NESTED_LEVEL);
+    add_value(summary, ret);
+    add_value(summary, key_index.count);
+    ecjp_free_key_list(&key_list);
+    ecjp_free_key_index(&key_index);
+
+    if ((ret == ECJP_NO_ERROR) && (results.struct_type == ECJP_ST_ARRAY)) {
+        ecjp_init_array_index(&array_index);
+        ret = ecjp_index_array_n(input, len, &array_index);
+        add_value(summary, ret);
+        add_value(summary, array_index.count);
+        ecjp_free_array_index(&array_index);
+    }
+#endif
+}
+
+/*
+ * Parse the input with the allocator and check that the results are the same
+ * found with malloc().
+*/
+int check_allocator(const char *name, const ecjp_allocator_t *allocator, const char *input, size_t len,
+                    const test_summary_t *expected)
+{
+    test_summary_t summary;
+
+    ecjp_set_allocator(allocator);
+    run_parser(input, len, &summary);
+    ecjp_set_allocator(NULL);
+    if ((summary.count != expected->count) || (memcmp(summary.value, expected->value, summary.count * sizeof(int)) != 0)) {
+        ecjp_fprintf("%s: results differ from the default allocator\n", name);
+        return TEST_ALLOCATOR_MISMATCH;
+    }
+    return 0;
+}
+
+/*
+ * Make the allocation number n fail, for a sample of the allocations of the parsing:
+ * the library must report the error and release all the memory allocated before.
+*/
+int check_failures(const char *input, size_t len, long calls)
+{
+    ecjp_allocator_t allocator;
+    test_counter_t counter;
+    test_summary_t summary;
+    long n, step;
+
+    step = (calls > TEST_MAX_FAILURES) ? (calls / TEST_MAX_FAILURES) : 1;
+    for (n = 0; n < calls; n += step) {
+        memset(&counter, 0, sizeof(test_counter_t));
+        counter.fail_after = n;
+        allocator.malloc_fn = counting_malloc;
+        allocator.realloc_fn = counting_realloc;
+        allocator.free_fn = counting_free;
+        allocator.user_data = &counter;
+        ecjp_set_allocator(&allocator);
+        run_parser(input, len, &summary);
+        ecjp_set_allocator(NULL);
+        if ((counter.allocs != counter.frees) || (counter.live != 0)) {
+            ecjp_fprintf("Failure at allocation %ld: %ld blocks allocated, %ld released\n", n, counter.allocs, counter.frees);
+            return TEST_ALLOCATOR_MISMATCH;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    ecjp_return_code_t ret;
+    ecjp_check_result_t results;
+    ecjp_allocator_t allocator, current;
+    test_counter_t counter;
+    test_summary_t expected;
+    void *block;
+    char *ptr;
+    struct stat strstat;
+    int status = 0;
+
+    // check arguments and open test files
+    if(argc != 2) {
+        usage(argv[0]);
+        return -1;
+    }
+    memset(&strstat, 0, sizeof(struct stat));
+    if (stat(argv[1], &strstat) != 0) {
+        ecjp_fprintf("stat() failed for file %s\n", argv[1]);
+        return -1;
+    }
+    long file_size = strstat.st_size;
+    ptr = (char *)malloc(file_size + 1);
+    if (ptr == NULL) {
+        ecjp_fprint("Memory allocation failed for JSON file\n");
+        return -1;
+    }
+    FILE *f = fopen(argv[1], "r");
+    if (f == NULL) {
+        ecjp_fprintf("Failed to open file %s\n", argv[1]);
+        free(ptr);
+        return -1;
+    }
+    size_t read_bytes = fread(ptr, 1, file_size, f);
+    ptr[read_bytes] = '\0';
+    fclose(f);
+    ecjp_fprintf("\nTesting JSON file (%s) of size %ld bytes:\n", argv[1], file_size);
+
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    results.err_pos = -1;
+#ifdef ECJP_TOKEN_LIST
+    ret = ecjp_check_syntax_2(ptr, &results);
+#else
+    ret = ecjp_check_syntax(ptr, &results);
+#endif
+    run_parser(ptr, read_bytes, &expected);
+
+    // an incomplete allocator is refused
+    memset(&allocator, 0, sizeof(ecjp_allocator_t));
+    if ((ecjp_set_allocator(&allocator) != ECJP_GENERIC_ERROR) || (ecjp_get_allocator(&current) != ECJP_NO_ERROR) ||
+        (current.malloc_fn == NULL)) {
+        ecjp_fprint("Incomplete allocator accepted\n");
+        status = TEST_ALLOCATOR_MISMATCH;
+    }
+
+    // every block allocated by the library is released with the same allocator
+    memset(&counter, 0, sizeof(test_counter_t));
+    counter.fail_after = -1;
+    allocator.malloc_fn = counting_malloc;
+    allocator.realloc_fn = counting_realloc;
+    allocator.free_fn = counting_free;
+    allocator.user_data = &counter;
+    if (status == 0) {
+        status = check_allocator("Counting allocator", &allocator, ptr, read_bytes, &expected);
+    }
+    if ((status == 0) && ((counter.allocs != counter.frees) || (counter.live != 0))) {
+        ecjp_fprintf("Counting allocator: %ld blocks allocated, %ld released\n", counter.allocs, counter.frees);
+        status = TEST_ALLOCATOR_MISMATCH;
+    }
+    ecjp_fprintf("Counting allocator: %ld blocks, %ld calls, peak %zu bytes\n", counter.allocs, counter.calls, counter.peak);
+    if (status == 0) {
+        status = check_failures(ptr, read_bytes, counter.calls);
+    }
+
+    // the pool is used only if the document fits with the worst fragmentation
+    if ((status == 0) && (counter.peak * 4 <= ECJP_POOL_SIZE)) {
+        status = check_allocator("Pool allocator", &ecjp_pool_allocator, ptr, read_bytes, &expected);
+        // when all the blocks are released the pool is a single block again
+        block = ecjp_pool_allocator.malloc_fn(ECJP_POOL_SIZE / 2, NULL);
+        if (block == NULL) {
+            ecjp_fprint("Pool allocator: the free blocks are not merged\n");
+            status = TEST_ALLOCATOR_MISMATCH;
+        } else {
+            ecjp_pool_allocator.free_fn(block, NULL);
+        }
+    }
+#ifdef ECJP_RUN_ON_PC
+    // the second run reuses the blocks cached by the first one
+    if (status == 0) {
+        status = check_allocator("Thread cache allocator", &ecjp_thread_cache_allocator, ptr, read_bytes, &expected);
+    }
+    if (status == 0) {
+        status = check_allocator("Thread cache allocator", &ecjp_thread_cache_allocator, ptr, read_bytes, &expected);
+    }
+#endif
+    ecjp_set_allocator(NULL);
+    free(ptr);
+    if (status != 0) {
+        return status;
+    }
+    return (ret == ECJP_NO_ERROR) ? 0 : -1;
+}
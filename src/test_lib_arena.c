@@ -0,0 +1,155 @@
+#include "ecjp.h"
+
+#include "sys/stat.h"
+#include <unistd.h>
+
+#ifdef ECJP_RUN_ON_PC
+    #define ecjp_fprintf(format, ...)    fprintf(stdout, format, __VA_ARGS__)
+    #define ecjp_fprint(format)          fprintf(stdout, format)
+#else
+    #define ecjp_fprintf(format, ...)
+    #define ecjp_fprint(format)
+#endif
+
+#ifndef ECJP_TOKEN_LIST
+
+int main(int argc, char *argv[])
+{
+    ecjp_fprint("This example is for token list implementation. Compile with ECJP_TOKEN_LIST defined.\n");
+    return -1;
+}
+
+#else
+
+// returned when the list loaded in the arena differs from the list loaded with malloc()
+#define TEST_ARENA_MISMATCH         2
+
+void usage(char *prog_name)
+{
+    ecjp_fprintf("Usage: %s [filename]\n", prog_name);
+}
+
+/*
+ * Check that the items of the list from index first are the same items of the reference list.
+*/
+int same_items(ecjp_item_elem_t *ref_list, ecjp_item_elem_t *item_list, int first)
+{
+    ecjp_item_token_t *ref, *item;
+    int i, count;
+
+    count = ecjp_get_item_count(ref_list);
+    for (i = 0; i < count; i++) {
+        ref = ecjp_get_item_token(ref_list, i);
+        item = ecjp_get_item_token(item_list, first + i);
+        if ((item == NULL) || (item->type != ref->type) || (item->value_size != ref->value_size) ||
+            ((ref->value != NULL) && (memcmp(item->value, ref->value, ref->value_size) != 0))) {
+            ecjp_fprintf("Item %d: differs from the item loaded with malloc()\n", first + i);
+            return TEST_ARENA_MISMATCH;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Load the input with and without the arena and compare the lists.
+ * Load it again in the same arena, then check that the lists can't be mixed.
+*/
+int check_arena(const char *input, ecjp_return_code_t *ret)
+{
+    ecjp_item_elem_t *ref_list = NULL;
+    ecjp_item_elem_t *item_list = NULL;
+    ecjp_check_result_t ref_results, results;
+    ecjp_return_code_t ret_arena;
+    int i, count, values;
+    int status = 0;
+
+    memset(&ref_results, 0, sizeof(ecjp_check_result_t));
+    ref_results.err_pos = -1;
+    *ret = ecjp_check_and_load_2(input, &ref_list, &ref_results);
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    results.err_pos = -1;
+    ret_arena = ecjp_check_and_load_2_arena(input, &item_list, &results);
+    count = ecjp_get_item_count(ref_list);
+    ecjp_fprintf("ret = %d, items = %d, memory used = %d bytes, with the arena: ret = %d, items = %d, memory used = %d bytes\n",
+                 *ret, count, ref_results.memory_used, ret_arena, ecjp_get_item_count(item_list), results.memory_used);
+    if ((ret_arena != *ret) || (results.err_pos != ref_results.err_pos) || (results.num_keys != ref_results.num_keys) ||
+        (ecjp_get_item_count(item_list) != count)) {
+        ecjp_fprint("The arena gives a different result\n");
+        status = TEST_ARENA_MISMATCH;
+    }
+    if (status == 0) {
+        status = same_items(ref_list, item_list, 0);
+    }
+    // the arena holds at least the values and the vector the elements
+    values = 0;
+    for (i = 0; (status == 0) && (i < count); i++) {
+        values += (int)ecjp_get_item_token(item_list, i)->value_size;
+    }
+    if ((status == 0) && (count > 0) && (results.memory_used < values + count * (int)sizeof(ecjp_item_elem_t))) {
+        ecjp_fprint("Memory used by the arena too small\n");
+        status = TEST_ARENA_MISMATCH;
+    }
+    if ((status == 0) && (count > 0)) {
+        // the second load is added to the same arena, the lists can't be mixed
+        ret_arena = ecjp_check_and_load_2_arena(input, &item_list, &results);
+        if ((ret_arena != *ret) || (ecjp_get_item_count(item_list) != 2 * count) || (same_items(ref_list, item_list, count) != 0)) {
+            ecjp_fprint("Second load in the arena failed\n");
+            status = TEST_ARENA_MISMATCH;
+        }
+        if ((ecjp_check_and_load_2(input, &item_list, &results) != ECJP_GENERIC_ERROR) ||
+            (ecjp_check_and_load_2_arena(input, &ref_list, &results) != ECJP_GENERIC_ERROR)) {
+            ecjp_fprint("Lists with and without the arena mixed\n");
+            status = TEST_ARENA_MISMATCH;
+        }
+    }
+    ecjp_free_item_list(&ref_list);
+    ecjp_free_item_list(&item_list);
+    if ((ref_list != NULL) || (item_list != NULL)) {
+        status = TEST_ARENA_MISMATCH;
+    }
+    return status;
+}
+
+int main(int argc, char *argv[])
+{
+    ecjp_return_code_t ret;
+    char *ptr;
+    struct stat strstat;
+    int status;
+
+    // check arguments and open test files
+    if(argc != 2) {
+        usage(argv[0]);
+        return -1;
+    }
+    memset(&strstat, 0, sizeof(struct stat));
+    if (stat(argv[1], &strstat) != 0) {
+        ecjp_fprintf("stat() failed for file %s\n", argv[1]);
+        return -1;
+    }
+    long file_size = strstat.st_size;
+    ptr = (char *)malloc(file_size + 1);
+    if (ptr == NULL) {
+        ecjp_fprint("Memory allocation failed for JSON file\n");
+        return -1;
+    }
+    FILE *f = fopen(argv[1], "r");
+    if (f == NULL) {
+        ecjp_fprintf("Failed to open file %s\n", argv[1]);
+        free(ptr);
+        return -1;
+    }
+    size_t read_bytes = fread(ptr, 1, file_size, f);
+    ptr[read_bytes] = '\0';
+    fclose(f);
+    ecjp_fprintf("\nTesting JSON file (%s) of size %ld bytes:\n", argv[1], file_size);
+
+    status = check_arena(ptr, &ret);
+    free(ptr);
+    if (status != 0) {
+        return status;
+    }
+    return (ret == ECJP_NO_ERROR) ? 0 : -1;
+}
+
+#endif // ECJP_TOKEN_LIST
@@ -0,0 +1,180 @@
+#include "ecjp.h"
+
+#include "sys/stat.h"
+#include <unistd.h>
+
+#ifdef ECJP_RUN_ON_PC
+    #define ecjp_fprintf(format, ...)    fprintf(stdout, format, __VA_ARGS__)
+    #define ecjp_fprint(format)          fprintf(stdout, format)
+#else
+    #define ecjp_fprintf(format, ...)
+    #define ecjp_fprint(format)
+#endif
+
+#ifdef ECJP_TOKEN_LIST
+
+int main(int argc, char *argv[])
+{
+    ecjp_fprint("This example is for key list implementation. Compile without ECJP_TOKEN_LIST defined.\n");
+    return -1;
+}
+
+#else
+
+// returned when the array index doesn't agree with ecjp_read_array_element()
+#define TEST_INDEX_MISMATCH         2
+// number of elements of the generated array
+#define TEST_NUM_ELEMENTS           (ECJP_LIST_MIN_CAPACITY * 100)
+
+void usage(char *prog_name)
+{
+    ecjp_fprintf("Usage: %s [filename]\n", prog_name);
+}
+
+/*
+ * Read every element of the array with ecjp_read_array_element() and check that
+ * ecjp_read_array_index() returns the same element.
+*/
+int check_array_index(const char *input)
+{
+    ecjp_array_index_t array_index;
+    ecjp_outdata_t out_elem, out_index;
+    ecjp_return_code_t ret;
+    int index = 0;
+    int status = 0;
+
+    out_elem.value = malloc(ECJP_MAX_ARRAY_ELEM_LEN);
+    out_index.value = malloc(ECJP_MAX_ARRAY_ELEM_LEN);
+    if ((out_elem.value == NULL) || (out_index.value == NULL)) {
+        ecjp_fprint("Memory allocation failed for array element value buffer\n");
+        free(out_elem.value);
+        free(out_index.value);
+        return -1;
+    }
+    out_elem.value_size = ECJP_MAX_ARRAY_ELEM_LEN;
+    out_index.value_size = ECJP_MAX_ARRAY_ELEM_LEN;
+
+    ecjp_init_array_index(&array_index);
+    ret = ecjp_index_array(input, &array_index);
+    ecjp_fprintf("ecjp_index_array(): ret = %d, elements = %d\n", ret, array_index.count);
+
+    while ((status == 0) && (ecjp_read_array_element(input, index, &out_elem) == ECJP_NO_ERROR)) {
+        if ((ecjp_read_array_index(input, &array_index, index, &out_index) != ECJP_NO_ERROR) ||
+            (out_index.type != out_elem.type) || (out_index.length != out_elem.length) ||
+            (strcmp((char *)out_index.value, (char *)out_elem.value) != 0)) {
+            ecjp_fprintf("Element #%d: index returns type %d '%s', expected type %d '%s'\n",
+                         index, out_index.type, (char *)out_index.value, out_elem.type, (char *)out_elem.value);
+            status = TEST_INDEX_MISMATCH;
+        }
+        index++;
+    }
+    if ((status == 0) && (ret == ECJP_NO_ERROR) &&
+        ((array_index.count != index) || (ecjp_read_array_index(input, &array_index, index, &out_index) != ECJP_INDEX_OUT_OF_BOUNDS))) {
+        ecjp_fprintf("Index has %d elements, expected %d\n", array_index.count, index);
+        status = TEST_INDEX_MISMATCH;
+    }
+
+    ecjp_free_array_index(&array_index);
+    free(out_elem.value);
+    free(out_index.value);
+    return status;
+}
+
+/*
+ * Index a generated array of TEST_NUM_ELEMENTS numbers and read them back in order.
+*/
+int check_large_array(void)
+{
+    ecjp_array_index_t array_index;
+    ecjp_outdata_t out;
+    char value[16];
+    char *input;
+    int i, pos;
+    int status = 0;
+
+    input = (char *)malloc(TEST_NUM_ELEMENTS * 8 + 2);
+    if (input == NULL) {
+        ecjp_fprint("Memory allocation failed for generated array\n");
+        return -1;
+    }
+    pos = 0;
+    input[pos++] = '[';
+    for (i = 0; i < TEST_NUM_ELEMENTS; i++) {
+        pos += sprintf(&input[pos], "%d, ", i);
+    }
+    sprintf(&input[pos - 2], " ]");
+
+    memset(&out, 0, sizeof(ecjp_outdata_t));
+    out.value = value;
+    out.value_size = sizeof(value);
+    ecjp_init_array_index(&array_index);
+    if ((ecjp_index_array(input, &array_index) != ECJP_NO_ERROR) || (array_index.count != TEST_NUM_ELEMENTS)) {
+        ecjp_fprintf("Generated array: index has %d elements, expected %d\n", array_index.count, TEST_NUM_ELEMENTS);
+        status = TEST_INDEX_MISMATCH;
+    }
+    for (i = 0; (i < array_index.count) && (status == 0); i++) {
+        if ((ecjp_read_array_index(input, &array_index, i, &out) != ECJP_NO_ERROR) ||
+            (out.type != ECJP_TYPE_NUMBER) || (atoi(value) != i)) {
+            ecjp_fprintf("Generated array: element #%d is '%s'\n", i, value);
+            status = TEST_INDEX_MISMATCH;
+        }
+    }
+    ecjp_free_array_index(&array_index);
+    free(input);
+    return status;
+}
+
+int main(int argc, char *argv[])
+{
+    ecjp_return_code_t ret;
+    ecjp_check_result_t results;
+    ecjp_key_elem_t *key_list = NULL;
+    char *ptr;
+    struct stat strstat;
+    int status = 0;
+
+    // check arguments and open test files
+    if(argc != 2) {
+        usage(argv[0]);
+        return -1;
+    }
+    memset(&strstat, 0, sizeof(struct stat));
+    if (stat(argv[1], &strstat) != 0) {
+        ecjp_fprintf("stat() failed for file %s\n", argv[1]);
+        return -1;
+    }
+    long file_size = strstat.st_size;
+    ptr = (char *)malloc(file_size + 1);
+    if (ptr == NULL) {
+        ecjp_fprint("Memory allocation failed for JSON file\n");
+        return -1;
+    }
+    FILE *f = fopen(argv[1], "r");
+    if (f == NULL) {
+        ecjp_fprintf("Failed to open file %s\n", argv[1]);
+        free(ptr);
+        return -1;
+    }
+    size_t read_bytes = fread(ptr, 1, file_size, f);
+    ptr[read_bytes] = '\0';
+    fclose(f);
+    ecjp_fprintf("\nTesting JSON file (%s) of size %ld bytes:\n", argv[1], file_size);
+
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    results.err_pos = -1;
+    ret = ecjp_check_and_load(ptr, &key_list, &results, ECJP_MAX_NESTED_LEVEL);
+    ecjp_free_key_list(&key_list);
+    if ((ret == ECJP_NO_ERROR) && (results.struct_type == ECJP_ST_ARRAY)) {
+        status = check_array_index(ptr);
+    }
+    if (status == 0) {
+        status = check_large_array();
+    }
+    free(ptr);
+    if (status != 0) {
+        return status;
+    }
+    return (ret == ECJP_NO_ERROR) ? 0 : -1;
+}
+
+#endif // ECJP_TOKEN_LIST
@@ -0,0 +1,164 @@
+#include "ecjp.h"
+
+#include "sys/stat.h"
+#include <unistd.h>
+
+#ifdef ECJP_RUN_ON_PC
+    #define ecjp_fprintf(format, ...)    fprintf(stdout, format, __VA_ARGS__)
+    #define ecjp_fprint(format)          fprintf(stdout, format)
+#else
+    #define ecjp_fprintf(format, ...)
+    #define ecjp_fprint(format)
+#endif
+
+#ifndef ECJP_TOKEN_LIST
+
+int main(int argc, char *argv[])
+{
+    ecjp_fprint("This example is for token list implementation. Compile with ECJP_TOKEN_LIST defined.\n");
+    return -1;
+}
+
+#else
+
+// returned when the list loaded with the context differs from the list loaded without it
+#define TEST_CTX_MISMATCH           2
+// number of times the input is loaded with the same context
+#define TEST_NUM_RUNS               3
+
+void usage(char *prog_name)
+{
+    ecjp_fprintf("Usage: %s [filename]\n", prog_name);
+}
+
+/*
+ * Check that the two lists have the same items.
+*/
+int same_list(ecjp_item_elem_t *list, ecjp_item_elem_t *expected)
+{
+    ecjp_item_token_t *a, *b;
+    int i, count;
+
+    count = ecjp_get_item_count(expected);
+    if (ecjp_get_item_count(list) != count) {
+        ecjp_fprintf("List has %d items, expected %d\n", ecjp_get_item_count(list), count);
+        return 0;
+    }
+    for (i = 0; i < count; i++) {
+        a = ecjp_get_item_token(list, i);
+        b = ecjp_get_item_token(expected, i);
+        if ((a->type != b->type) || (a->value_size != b->value_size) || (memcmp(a->value, b->value, b->value_size) != 0)) {
+            ecjp_fprintf("Item #%d: '%s', expected '%s'\n", i, (char *)a->value, (char *)b->value);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Load the input many times with the same context: the results are the same of
+ * ecjp_check_and_load_2_n() and the scratch memory is allocated only once.
+*/
+int check_ctx(const char *input, size_t len, ecjp_item_elem_t *expected, ecjp_return_code_t expected_ret)
+{
+    ecjp_ctx_t ctx;
+    ecjp_check_result_t results;
+    ecjp_item_elem_t *item_list;
+    ecjp_return_code_t ret;
+    char *scratch = NULL;
+    int run;
+    int status = 0;
+
+    ecjp_init_ctx(&ctx);
+    for (run = 0; (run < TEST_NUM_RUNS) && (status == 0); run++) {
+        item_list = NULL;
+        memset(&results, 0, sizeof(ecjp_check_result_t));
+        results.err_pos = -1;
+        ret = ecjp_check_and_load_2_ctx(&ctx, input, len, &item_list, &results);
+        if ((ret != expected_ret) || !same_list(item_list, expected)) {
+            ecjp_fprintf("Run %d: ret = %d, expected %d\n", run, ret, expected_ret);
+            status = TEST_CTX_MISMATCH;
+        }
+        // the scratch memory is sized on the input and reused by the next runs
+        if ((status == 0) && (len > 0)) {
+            if ((ctx.scratch == NULL) || (ctx.scratch_size > len + 1) || ((run > 0) && (ctx.scratch != scratch))) {
+                ecjp_fprintf("Run %d: scratch memory of %zu bytes not reused\n", run, ctx.scratch_size);
+                status = TEST_CTX_MISMATCH;
+            }
+            scratch = ctx.scratch;
+        }
+        ecjp_free_item_list(&item_list);
+    }
+    // a smaller input doesn't need more scratch memory
+    if ((status == 0) && (len > 1)) {
+        ecjp_check_and_load_2_ctx(&ctx, input, len / 2, &item_list, &results);
+        ecjp_free_item_list(&item_list);
+        if (ctx.scratch != scratch) {
+            ecjp_fprint("Scratch memory allocated again for a smaller input\n");
+            status = TEST_CTX_MISMATCH;
+        }
+    }
+    ecjp_free_ctx(&ctx);
+    if ((status == 0) && ((ctx.scratch != NULL) || (ecjp_check_and_load_2_ctx(NULL, input, len, &item_list, &results) != ECJP_NULL_POINTER))) {
+        ecjp_fprint("Context not released or NULL context accepted\n");
+        status = TEST_CTX_MISMATCH;
+    }
+    return status;
+}
+
+int main(int argc, char *argv[])
+{
+    ecjp_return_code_t ret;
+    ecjp_check_result_t results;
+    ecjp_item_elem_t *item_list = NULL;
+    char *ptr;
+    struct stat strstat;
+    int status = 0;
+
+    // check arguments and open test files
+    if(argc != 2) {
+        usage(argv[0]);
+        return -1;
+    }
+    memset(&strstat, 0, sizeof(struct stat));
+    if (stat(argv[1], &strstat) != 0) {
+        ecjp_fprintf("stat() failed for file %s\n", argv[1]);
+        return -1;
+    }
+    long file_size = strstat.st_size;
+    ptr = (char *)malloc(file_size + 1);
+    if (ptr == NULL) {
+        ecjp_fprint("Memory allocation failed for JSON file\n");
+        return -1;
+    }
+    FILE *f = fopen(argv[1], "r");
+    if (f == NULL) {
+        ecjp_fprintf("Failed to open file %s\n", argv[1]);
+        free(ptr);
+        return -1;
+    }
+    size_t read_bytes = fread(ptr, 1, file_size, f);
+    ptr[read_bytes] = '\0';
+    fclose(f);
+    ecjp_fprintf("\nTesting JSON file (%s) of size %ld bytes:\n", argv[1], file_size);
+
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    results.err_pos = -1;
+    ret = ecjp_check_and_load_2_n(ptr, read_bytes, &item_list, &results);
+    ecjp_fprintf("ecjp_check_and_load_2_n(): ret = %d, items = %d\n", ret, ecjp_get_item_count(item_list));
+    status = check_ctx(ptr, read_bytes, item_list, ret);
+    ecjp_free_item_list(&item_list);
+
+    // the input is not copied to show the error, its size is not limited by the stack
+    if (ecjp_show_error_n(ptr, read_bytes, (results.err_pos >= 0) ? results.err_pos : 0) != ECJP_NO_ERROR) {
+        ecjp_fprint("ecjp_show_error_n() failed\n");
+        status = TEST_CTX_MISMATCH;
+    }
+    free(ptr);
+    if (status != 0) {
+        return status;
+    }
+    return (ret == ECJP_NO_ERROR) ? 0 : -1;
+}
+
+#endif // ECJP_TOKEN_LIST
@@ -0,0 +1,244 @@
+#include "ecjp.h"
+
+#include "sys/stat.h"
+#include <unistd.h>
+#ifdef ECJP_RUN_ON_PC
+#include <time.h>
+#endif
+
+#ifdef ECJP_RUN_ON_PC
+    #define ecjp_fprintf(format, ...)    fprintf(stdout, format, __VA_ARGS__)
+    #define ecjp_fprint(format)          fprintf(stdout, format)
+#else
+    #define ecjp_fprintf(format, ...)
+    #define ecjp_fprint(format)
+#endif
+
+// returned when the DFA and the state machine of the loader don't agree on the result
+#define TEST_DFA_MISMATCH           2
+// documents changed at random for each input
+#define TEST_NUM_MUTATIONS          3000
+// maximum length of the part of the input that is changed
+#define TEST_MAX_DOC_LEN            4096
+// characters checked by each parser in the timing
+#define TEST_BENCH_BYTES            (4 * 1024 * 1024)
+
+// inputs at the limits of the syntax (some of them accepted by both parsers, see the README)
+static const char *const fixed_doc[] = {
+    "{}", "[]", " [ ] ", "{\"a\":[]}", "[[], {}]", "[1,]", "{\"a\":1,}", "{,\"a\":1}", "{{}}", "[1-2]", "[0.0.0]",
+    "[1e+e]", "[-]", "[0]", "[01]", "[-0]", "[00]", "[0.5]", "[[0],12]", "[[0],-1]", "[[0],0.1]", "{\"a\":[0],\"b\":12}",
+    "[0 ,1]", "[0,12]", "[true,false,null]", "[tru]", "[nul", "[fals]", "[true", "{\"a\":true}x", "[1]]", "[1}",
+    "{\"a\":1]", "{\"a\" 1}", "{\"a\":}", "{\"\\u00e8\":\"\\t\\\"\\/\"}", "[\"\\u00\"]", "[\"\\x\"]", "[\"\\", "[\"\\u",
+    "[\"a\x01\"]", "[\"a\x7f\"]", "[\"a\tb\nc\"]", "[1,,2]", "{\"a\":1,,\"b\":2}", "[[1],]", "[{},]", "[1 2]", "[\"a\"\"b\"]",
+    "{\"a\":{\"b\":[1,{\"c\":\"}\"}]},\"d\":[]}", "[\"]\"]", "{\"a\":\"}\"}", "{\"a\":1}   ", "{\"a\":1} {}", "\t\n{\r}",
+    "x", "", " ", "[", "{\"a\"", NULL
+};
+
+void usage(char *prog_name)
+{
+    ecjp_fprintf("Usage: %s [filename]\n", prog_name);
+}
+
+/*
+ * Check the input with the DFA of ecjp_check_syntax_n() and with the state machine of the loader
+ * (without list), and compare the results.
+*/
+int check_doc(const char *input, size_t len)
+{
+    ecjp_check_result_t dfa_res, switch_res;
+    ecjp_return_code_t dfa_ret, switch_ret;
+
+    memset(&dfa_res, 0, sizeof(ecjp_check_result_t));
+    dfa_res.err_pos = -1;
+    memset(&switch_res, 0, sizeof(ecjp_check_result_t));
+    switch_res.err_pos = -1;
+#ifdef ECJP_TOKEN_LIST
+    dfa_ret = ecjp_check_syntax_2_n(input, len, &dfa_res);
+    switch_ret = ecjp_check_and_load_2_n(input, len, NULL, &switch_res);
+#else
+    dfa_ret = ecjp_check_syntax_n(input, len, &dfa_res);
+    switch_ret = ecjp_check_and_load_n(input, len, NULL, &switch_res, 0);
+#endif
+    if ((dfa_ret != switch_ret) || (dfa_res.err_pos != switch_res.err_pos) || (dfa_res.struct_type != switch_res.struct_type)) {
+        ecjp_fprintf("Input '%.*s': DFA ret = %d, err_pos = %d, switch ret = %d, err_pos = %d\n",
+                     (int)((len < 80) ? len : 80), input, dfa_ret, dfa_res.err_pos, switch_ret, switch_res.err_pos);
+        return TEST_DFA_MISMATCH;
+    }
+    return 0;
+}
+
+/*
+ * Check the fixed inputs, each one cut at every length, and a structure nested deeper than the parse stack.
+*/
+int check_fixed(void)
+{
+    static char deep[ECJP_MAX_PARSE_STACK_DEPTH + 2];
+    size_t len;
+    int i;
+
+    for (i = 0; fixed_doc[i] != NULL; i++) {
+        for (len = strlen(fixed_doc[i]); len > 0; len--) {
+            if (check_doc(fixed_doc[i], len) != 0) {
+                return TEST_DFA_MISMATCH;
+            }
+        }
+    }
+    memset(deep, '[', sizeof(deep) - 1);
+    return check_doc(deep, sizeof(deep) - 1);
+}
+
+/*
+ * Change the first part of the input at random with a fixed seed: each document has some characters
+ * replaced, inserted or removed (with characters that change the status of the parsers) and is cut
+ * at a random length.
+*/
+int check_mutations(const char *input, size_t len)
+{
+    static const char chars[] = "{}[]\":,\\ \n0123456789.-+eEtrufalsn\x01\x7f\xC3";
+    char doc[TEST_MAX_DOC_LEN + 8];
+    unsigned long seed = 12345;
+    int i, k, n, pos, doc_len;
+
+    if (len > TEST_MAX_DOC_LEN) {
+        len = TEST_MAX_DOC_LEN;
+    }
+    for (i = 0; i < TEST_NUM_MUTATIONS; i++) {
+        memcpy(doc, input, len);
+        doc_len = (int)len;
+        seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+        n = 1 + (int)((seed >> 33) % 3);
+        for (k = 0; (k < n) && (doc_len > 0); k++) {
+            seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+            pos = (int)((seed >> 33) % doc_len);
+            switch ((seed >> 20) % 3) {
+                case 0:
+                    doc[pos] = chars[(seed >> 40) % (sizeof(chars) - 1)];
+                    break;
+                case 1:
+                    if (doc_len < TEST_MAX_DOC_LEN + 4) {
+                        memmove(&doc[pos + 1], &doc[pos], doc_len - pos);
+                        doc[pos] = chars[(seed >> 40) % (sizeof(chars) - 1)];
+                        doc_len++;
+                    }
+                    break;
+                default:
+                    memmove(&doc[pos], &doc[pos + 1], doc_len - pos - 1);
+                    doc_len--;
+                    break;
+            }
+        }
+        // half of the documents are cut
+        if ((i % 2 == 1) && (doc_len > 0)) {
+            seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+            doc_len = 1 + (int)((seed >> 33) % doc_len);
+        }
+        if (check_doc(doc, doc_len) != 0) {
+            return TEST_DFA_MISMATCH;
+        }
+    }
+    return 0;
+}
+
+#ifdef ECJP_RUN_ON_PC
+/*
+ * Print the speed of the DFA and of the state machine of the loader on the input.
+*/
+void bench(const char *input, size_t len)
+{
+    ecjp_check_result_t results;
+    struct timespec t0, t1;
+    double elapsed[2];
+    long reps, r;
+    int k;
+
+    reps = (len < TEST_BENCH_BYTES) ? (TEST_BENCH_BYTES / (long)len) : 1;
+    for (k = 0; k < 2; k++) {
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for (r = 0; r < reps; r++) {
+            memset(&results, 0, sizeof(ecjp_check_result_t));
+#ifdef ECJP_TOKEN_LIST
+            if (k == 0) {
+                ecjp_check_syntax_2_n(input, len, &results);
+            } else {
+                ecjp_check_and_load_2_n(input, len, NULL, &results);
+            }
+#else
+            if (k == 0) {
+                ecjp_check_syntax_n(input, len, &results);
+            } else {
+                ecjp_check_and_load_n(input, len, NULL, &results, 0);
+            }
+#endif
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        elapsed[k] = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+    }
+    ecjp_fprintf("DFA: %.1f MB/s, switch: %.1f MB/s\n",
+                 (elapsed[0] > 0) ? ((double)len * reps / elapsed[0] / 1e6) : 0.0,
+                 (elapsed[1] > 0) ? ((double)len * reps / elapsed[1] / 1e6) : 0.0);
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+    ecjp_return_code_t ret;
+    ecjp_check_result_t results;
+    char *ptr;
+    struct stat strstat;
+    int status = 0;
+
+    // check arguments and open test files
+    if(argc != 2) {
+        usage(argv[0]);
+        return -1;
+    }
+    memset(&strstat, 0, sizeof(struct stat));
+    if (stat(argv[1], &strstat) != 0) {
+        ecjp_fprintf("stat() failed for file %s\n", argv[1]);
+        return -1;
+    }
+    long file_size = strstat.st_size;
+    ptr = (char *)malloc(file_size + 1);
+    if (ptr == NULL) {
+        ecjp_fprint("Memory allocation failed for JSON file\n");
+        return -1;
+    }
+    FILE *f = fopen(argv[1], "r");
+    if (f == NULL) {
+        ecjp_fprintf("Failed to open file %s\n", argv[1]);
+        free(ptr);
+        return -1;
+    }
+    size_t read_bytes = fread(ptr, 1, file_size, f);
+    ptr[read_bytes] = '\0';
+    fclose(f);
+    ecjp_fprintf("\nTesting JSON file (%s) of size %ld bytes:\n", argv[1], file_size);
+
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    results.err_pos = -1;
+#ifdef ECJP_TOKEN_LIST
+    ret = ecjp_check_syntax_2(ptr, &results);
+#else
+    ret = ecjp_check_syntax(ptr, &results);
+#endif
+    ecjp_fprintf("Check syntax: ret = %d, err_pos = %d\n", ret, results.err_pos);
+
+    status = check_fixed();
+    if (status == 0) {
+        status = check_doc(ptr, read_bytes);
+    }
+    if ((status == 0) && (read_bytes > 0)) {
+        status = check_mutations(ptr, read_bytes);
+    }
+    ecjp_fprintf("DFA and switch: %s\n", (status == 0) ? "same results" : "mismatch");
+#ifdef ECJP_RUN_ON_PC
+    if ((status == 0) && (read_bytes > 0)) {
+        bench(ptr, read_bytes);
+    }
+#endif
+    free(ptr);
+    if (status != 0) {
+        return status;
+    }
+    return (ret == ECJP_NO_ERROR) ? 0 : -1;
+}
@@ -0,0 +1,254 @@
+#include "ecjp.h"
+
+#include "sys/stat.h"
+#include <unistd.h>
+
+#ifdef ECJP_RUN_ON_PC
+    #define ecjp_fprintf(format, ...)    fprintf(stdout, format, __VA_ARGS__)
+    #define ecjp_fprint(format)          fprintf(stdout, format)
+#else
+    #define ecjp_fprintf(format, ...)
+    #define ecjp_fprint(format)
+#endif
+
+// returned when the documents found are not the expected ones
+#define TEST_DOCUMENTS_MISMATCH     2
+// maximum number of documents stored by the callback
+#define TEST_MAX_DOCUMENTS          8
+// a line with a document not valid, between the copies of the file
+#define TEST_BROKEN_LINE            "{\"broken\": ]\n"
+// a pretty-printed document not valid, before the file
+#define TEST_BROKEN_DOCUMENT        "{\n \"a\": 1,,\n \"b\": {\"c\": 2}\n}\n"
+
+typedef struct test_documents {
+    ecjp_document_t doc[TEST_MAX_DOCUMENTS];
+    int             count;
+    int             stop_after;
+} test_documents_t;
+
+void usage(char *prog_name)
+{
+    ecjp_fprintf("Usage: %s [filename]\n", prog_name);
+}
+
+/*
+ * Store the documents found, stop after stop_after documents.
+*/
+ecjp_bool_t store_document(const char *input, const ecjp_document_t *doc, void *user_data)
+{
+    test_documents_t *t = (test_documents_t *)user_data;
+
+    ecjp_fprintf("Document %d: start %d, length %d, error %d, err_pos %d, keys %d\n",
+                 t->count, doc->start, doc->length, doc->error, doc->err_pos, doc->num_keys);
+    if (t->count < TEST_MAX_DOCUMENTS) {
+        t->doc[t->count] = *doc;
+    }
+    t->count++;
+    return (t->count < t->stop_after) ? ECJP_BOOL_TRUE : ECJP_BOOL_FALSE;
+}
+
+/*
+ * Check a document found against the expected start, length and result of ecjp_load_tape_n().
+*/
+int check_document(const ecjp_document_t *doc, int start, int length, ecjp_return_code_t ret, ecjp_check_result_t *res)
+{
+    if ((doc->start != start) || (doc->error != ret) ||
+        ((ret == ECJP_NO_ERROR) && ((doc->length != length) || (doc->num_keys != res->num_keys) || (doc->struct_type != res->struct_type))) ||
+        ((ret != ECJP_NO_ERROR) && ((doc->err_pos != start + res->err_pos) || (doc->err_pos >= start + doc->length)))) {
+        ecjp_fprintf("Document at %d: start %d, length %d, error %d, expected length %d, error %d\n",
+                     start, doc->start, doc->length, doc->error, length, ret);
+        return TEST_DOCUMENTS_MISMATCH;
+    }
+    return 0;
+}
+
+/*
+ * Check the documents of a NDJSON input made of: the file, the file, a broken line, the file.
+ * The file must be a valid document on its own, starting at lead (after the leading whitespaces)
+ * and ending at len (before the trailing whitespaces).
+*/
+int check_ndjson(const char *input, size_t len, int lead, ecjp_check_result_t *res)
+{
+    test_documents_t t;
+    ecjp_check_result_t broken_res;
+    ecjp_tape_t tape;
+    ecjp_return_code_t ret, broken_ret;
+    size_t broken_len = strlen(TEST_BROKEN_LINE);
+    size_t total = 3 * (len + 1) + broken_len;
+    char *ndjson;
+    int num_documents, pos;
+    int status = 0;
+
+    ndjson = (char *)malloc(total);
+    if (ndjson == NULL) {
+        ecjp_fprint("Memory allocation failed for NDJSON input\n");
+        return -1;
+    }
+    pos = 0;
+    memcpy(&ndjson[pos], input, len);
+    pos += len;
+    ndjson[pos++] = '\n';
+    memcpy(&ndjson[pos], input, len);
+    pos += len;
+    ndjson[pos++] = '\n';
+    memcpy(&ndjson[pos], TEST_BROKEN_LINE, broken_len);
+    pos += broken_len;
+    memcpy(&ndjson[pos], input, len);
+    pos += len;
+    ndjson[pos++] = '\n';
+
+    ecjp_init_tape(&tape);
+    broken_ret = ecjp_load_tape_n(TEST_BROKEN_LINE, broken_len, &tape, &broken_res);
+    ecjp_free_tape(&tape);
+
+    memset(&t, 0, sizeof(test_documents_t));
+    t.stop_after = TEST_MAX_DOCUMENTS;
+    ret = ecjp_check_documents_n(ndjson, total, store_document, &t, &num_documents);
+    if ((ret != broken_ret) || (num_documents != 4) || (t.count != 4)) {
+        ecjp_fprintf("NDJSON: ret = %d, %d documents, expected ret = %d, 4 documents\n", ret, num_documents, broken_ret);
+        status = TEST_DOCUMENTS_MISMATCH;
+    }
+    if (status == 0) {
+        status = check_document(&t.doc[0], lead, (int)len - lead, ECJP_NO_ERROR, res);
+    }
+    if (status == 0) {
+        status = check_document(&t.doc[1], (int)len + 1 + lead, (int)len - lead, ECJP_NO_ERROR, res);
+    }
+    if (status == 0) {
+        status = check_document(&t.doc[2], 2 * ((int)len + 1), (int)broken_len - 1, broken_ret, &broken_res);
+    }
+    if (status == 0) {
+        status = check_document(&t.doc[3], 2 * ((int)len + 1) + (int)broken_len + lead, (int)len - lead, ECJP_NO_ERROR, res);
+    }
+
+    // the callback stops the parsing
+    memset(&t, 0, sizeof(test_documents_t));
+    t.stop_after = 1;
+    ret = ecjp_check_documents_n(ndjson, total, store_document, &t, &num_documents);
+    if ((status == 0) && ((ret != ECJP_NO_ERROR) || (num_documents != 1) || (t.count != 1))) {
+        ecjp_fprintf("NDJSON stopped after the first document: ret = %d, %d documents\n", ret, num_documents);
+        status = TEST_DOCUMENTS_MISMATCH;
+    }
+    free(ndjson);
+    return status;
+}
+
+/*
+ * Check the documents of an input made of a broken document on many lines and the file: the rest
+ * of the broken document is not taken for other documents.
+ * The file must be a valid document on its own, from its first character to len.
+*/
+int check_broken_document(const char *input, size_t len, ecjp_check_result_t *res)
+{
+    test_documents_t t;
+    ecjp_check_result_t broken_res;
+    ecjp_tape_t tape;
+    ecjp_return_code_t ret, broken_ret;
+    size_t broken_len = strlen(TEST_BROKEN_DOCUMENT);
+    size_t total = broken_len + len;
+    char *concat;
+    int num_documents;
+    int status = 0;
+
+    concat = (char *)malloc(total);
+    if (concat == NULL) {
+        ecjp_fprint("Memory allocation failed for the concatenated input\n");
+        return -1;
+    }
+    memcpy(concat, TEST_BROKEN_DOCUMENT, broken_len);
+    memcpy(&concat[broken_len], input, len);
+
+    ecjp_init_tape(&tape);
+    broken_ret = ecjp_load_tape_n(TEST_BROKEN_DOCUMENT, broken_len, &tape, &broken_res);
+    ecjp_free_tape(&tape);
+
+    memset(&t, 0, sizeof(test_documents_t));
+    t.stop_after = TEST_MAX_DOCUMENTS;
+    ret = ecjp_check_documents_n(concat, total, store_document, &t, &num_documents);
+    if ((ret != broken_ret) || (num_documents != 2) || (t.count != 2)) {
+        ecjp_fprintf("Broken document: ret = %d, %d documents, expected ret = %d, 2 documents\n", ret, num_documents, broken_ret);
+        status = TEST_DOCUMENTS_MISMATCH;
+    }
+    if (status == 0) {
+        status = check_document(&t.doc[0], 0, (int)broken_len - 1, broken_ret, &broken_res);
+    }
+    if (status == 0) {
+        status = check_document(&t.doc[1], (int)broken_len, (int)len, ECJP_NO_ERROR, res);
+    }
+    free(concat);
+    return status;
+}
+
+int is_space(char c)
+{
+    return (c == ' ') || (c == '\n') || (c == '\r') || (c == '\t');
+}
+
+int main(int argc, char *argv[])
+{
+    ecjp_return_code_t ret;
+    ecjp_check_result_t results;
+    ecjp_tape_t tape;
+    int num_documents, lead, len;
+    char *ptr;
+    struct stat strstat;
+    int status = 0;
+
+    // check arguments and open test files
+    if(argc != 2) {
+        usage(argv[0]);
+        return -1;
+    }
+    memset(&strstat, 0, sizeof(struct stat));
+    if (stat(argv[1], &strstat) != 0) {
+        ecjp_fprintf("stat() failed for file %s\n", argv[1]);
+        return -1;
+    }
+    long file_size = strstat.st_size;
+    ptr = (char *)malloc(file_size + 1);
+    if (ptr == NULL) {
+        ecjp_fprint("Memory allocation failed for JSON file\n");
+        return -1;
+    }
+    FILE *f = fopen(argv[1], "r");
+    if (f == NULL) {
+        ecjp_fprintf("Failed to open file %s\n", argv[1]);
+        free(ptr);
+        return -1;
+    }
+    size_t read_bytes = fread(ptr, 1, file_size, f);
+    ptr[read_bytes] = '\0';
+    fclose(f);
+    ecjp_fprintf("\nTesting JSON file (%s) of size %ld bytes:\n", argv[1], file_size);
+
+    ecjp_init_tape(&tape);
+    ret = ecjp_load_tape_n(ptr, read_bytes, &tape, &results);
+    ecjp_free_tape(&tape);
+    if (ret == ECJP_NO_ERROR) {
+        // a valid file is a single document, without the trailing whitespaces
+        lead = 0;
+        while (is_space(ptr[lead])) {
+            lead++;
+        }
+        len = (int)read_bytes;
+        while (is_space(ptr[len - 1])) {
+            len--;
+        }
+        status = check_ndjson(ptr, len, lead, &results);
+        if (status == 0) {
+            status = check_broken_document(&ptr[lead], len - lead, &results);
+        }
+    } else {
+        // a file not valid has at least a document not valid
+        ret = ecjp_check_documents(ptr, NULL, NULL, &num_documents);
+        ecjp_fprintf("ecjp_check_documents(): ret = %d, %d documents\n", ret, num_documents);
+        if (ret == ECJP_NO_ERROR) {
+            status = TEST_DOCUMENTS_MISMATCH;
+        }
+    }
+    free(ptr);
+    if (status != 0) {
+        return status;
+    }
+    return (ret == ECJP_NO_ERROR) ? 0 : -1;
+}
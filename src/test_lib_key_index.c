@@ -0,0 +1,149 @@
+#include "ecjp.h"
+
+#include "sys/stat.h"
+#include <unistd.h>
+
+#ifdef ECJP_RUN_ON_PC
+    #define ecjp_fprintf(format, ...)    fprintf(stdout, format, __VA_ARGS__)
+    #define ecjp_fprint(format)          fprintf(stdout, format)
+#else
+    #define ecjp_fprintf(format, ...)
+    #define ecjp_fprint(format)
+#endif
+
+#ifdef ECJP_TOKEN_LIST
+
+int main(int argc, char *argv[])
+{
+    ecjp_fprint("This example is for key list implementation. Compile without ECJP_TOKEN_LIST defined.\n");
+    return -1;
+}
+
+#else
+
+// returned when the index doesn't agree with the key list
+#define TEST_INDEX_MISMATCH         2
+
+void usage(char *prog_name)
+{
+    ecjp_fprintf("Usage: %s [filename]\n", prog_name);
+}
+
+/*
+ * Search in the key list the first (or the last) key with the same name of key.
+*/
+ecjp_key_token_t *find_in_list(const char *input, ecjp_key_elem_t *key_list, ecjp_key_token_t *key, ecjp_dup_policy_t policy)
+{
+    ecjp_key_elem_t *current;
+    ecjp_key_token_t *found = NULL;
+
+    for (current = key_list; current != NULL; current = current->next) {
+        if ((current->key.length == key->length) &&
+            (memcmp(&input[current->key.start_pos], &input[key->start_pos], key->length) == 0)) {
+            found = &current->key;
+            if (policy == ECJP_DUP_FIRST_WINS) {
+                break;
+            }
+        }
+    }
+    return found;
+}
+
+/*
+ * Load the input with the index and check that every key of the list is found in the index,
+ * at the position given by the duplicate policy.
+*/
+int check_index(const char *input, ecjp_dup_policy_t policy, ecjp_return_code_t *ret)
+{
+    ecjp_key_elem_t *key_list = NULL;
+    ecjp_key_elem_t *current;
+    ecjp_key_index_t key_index;
+    ecjp_check_result_t results;
+    ecjp_key_token_t *expected;
+    ecjp_outdata_t out;
+    char name[ECJP_MAX_KEY_LEN];
+    int status = 0;
+
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    results.err_pos = -1;
+    ecjp_init_key_index(&key_index, policy);
+    *ret = ecjp_check_and_load_indexed(input, &key_list, &key_index, &results, ECJP_MAX_NESTED_LEVEL);
+    ecjp_fprintf("Policy %d: ret = %d, keys in the list = %d, names in the index = %d\n", policy, *ret, ecjp_get_key_count(key_list), key_index.count);
+
+    for (current = key_list; (current != NULL) && (status == 0); current = current->next) {
+        if (current->key.length >= ECJP_MAX_KEY_LEN) {
+            continue;
+        }
+        memcpy(name, &input[current->key.start_pos], current->key.length);
+        name[current->key.length] = '\0';
+        if (strlen(name) != current->key.length) {
+            continue;
+        }
+        memset(&out, 0, sizeof(ecjp_outdata_t));
+        expected = find_in_list(input, key_list, &current->key, policy);
+        if ((ecjp_find_key(&key_index, input, name, &out) != ECJP_NO_ERROR) ||
+            (out.last_pos != expected->start_pos) || (out.type != expected->type)) {
+            ecjp_fprintf("Key '%s': index returns position %d, expected %d\n", name, out.last_pos, expected->start_pos);
+            status = TEST_INDEX_MISMATCH;
+        }
+    }
+    if ((status == 0) && (ecjp_find_key(&key_index, input, "\x01 not a key", &out) != ECJP_NO_MORE_KEY)) {
+        ecjp_fprint("Missing key found in the index\n");
+        status = TEST_INDEX_MISMATCH;
+    }
+    ecjp_free_key_index(&key_index);
+    ecjp_free_key_list(&key_list);
+    return status;
+}
+
+int main(int argc, char *argv[])
+{
+    ecjp_return_code_t ret;
+    char *ptr;
+    struct stat strstat;
+    int status;
+
+    // check arguments and open test files
+    if(argc != 2) {
+        usage(argv[0]);
+        return -1;
+    }
+    memset(&strstat, 0, sizeof(struct stat));
+    if (stat(argv[1], &strstat) != 0) {
+        ecjp_fprintf("stat() failed for file %s\n", argv[1]);
+        return -1;
+    }
+    long file_size = strstat.st_size;
+    ptr = (char *)malloc(file_size + 1);
+    if (ptr == NULL) {
+        ecjp_fprint("Memory allocation failed for JSON file\n");
+        return -1;
+    }
+    FILE *f = fopen(argv[1], "r");
+    if (f == NULL) {
+        ecjp_fprintf("Failed to open file %s\n", argv[1]);
+        free(ptr);
+        return -1;
+    }
+    size_t read_bytes = fread(ptr, 1, file_size, f);
+    ptr[read_bytes] = '\0';
+    fclose(f);
+    ecjp_fprintf("\nTesting JSON file (%s) of size %ld bytes:\n", argv[1], file_size);
+
+    status = check_index(ptr, ECJP_DUP_FIRST_WINS, &ret);
+    if (status == 0) {
+        status = check_index(ptr, ECJP_DUP_LAST_WINS, &ret);
+    }
+    if (read_bytes > (ECJP_TYPE_POS_KEY)(-1)) {
+        // the key positions don't fit in ECJP_TYPE_POS_KEY: only the first keys are in the index
+        ecjp_fprint("Input too large to check the whole index\n");
+        status = 0;
+    }
+    free(ptr);
+    if (status != 0) {
+        return status;
+    }
+    return (ret == ECJP_NO_ERROR) ? 0 : -1;
+}
+
+#endif // ECJP_TOKEN_LIST
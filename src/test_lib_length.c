@@ -0,0 +1,117 @@
+#include "ecjp.h"
+
+#include "sys/stat.h"
+#include <unistd.h>
+
+#ifdef ECJP_RUN_ON_PC
+    #define ecjp_fprintf(format, ...)    fprintf(stdout, format, __VA_ARGS__)
+    #define ecjp_fprint(format)          fprintf(stdout, format)
+#else
+    #define ecjp_fprintf(format, ...)
+    #define ecjp_fprint(format)
+#endif
+
+// returned when the length-delimited API doesn't agree with the NUL-terminated one
+#define TEST_LENGTH_MISMATCH        2
+// bytes after the slice: they must never be read by the parser
+#define TEST_GUARD_SIZE             16
+
+void usage(char *prog_name)
+{
+    ecjp_fprintf("Usage: %s [filename]\n", prog_name);
+}
+
+ecjp_return_code_t check_string(const char *input, ecjp_check_result_t *results)
+{
+    memset(results, 0, sizeof(ecjp_check_result_t));
+    results->err_pos = -1;
+#ifdef ECJP_TOKEN_LIST
+    return ecjp_check_syntax_2(input, results);
+#else
+    return ecjp_check_syntax(input, results);
+#endif
+}
+
+ecjp_return_code_t check_slice(const char *input, size_t len, ecjp_check_result_t *results)
+{
+    memset(results, 0, sizeof(ecjp_check_result_t));
+    results->err_pos = -1;
+#ifdef ECJP_TOKEN_LIST
+    return ecjp_check_syntax_2_n(input, len, results);
+#else
+    return ecjp_check_syntax_n(input, len, results);
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+    ecjp_return_code_t ret, ret_n;
+    ecjp_check_result_t results, results_n;
+    char *ptr, *slice;
+    struct stat strstat;
+    size_t half;
+
+    // check arguments and open test files
+    if(argc != 2) {
+        usage(argv[0]);
+        return -1;
+    }
+    memset(&strstat, 0, sizeof(struct stat));
+    if (stat(argv[1], &strstat) != 0) {
+        ecjp_fprintf("stat() failed for file %s\n", argv[1]);
+        return -1;
+    }
+    long file_size = strstat.st_size;
+    ptr = (char *)malloc(file_size + 1);
+    slice = (char *)malloc(file_size + TEST_GUARD_SIZE);
+    if (ptr == NULL || slice == NULL) {
+        ecjp_fprint("Memory allocation failed for JSON file\n");
+        free(ptr);
+        free(slice);
+        return -1;
+    }
+    FILE *f = fopen(argv[1], "r");
+    if (f == NULL) {
+        ecjp_fprintf("Failed to open file %s\n", argv[1]);
+        free(ptr);
+        free(slice);
+        return -1;
+    }
+    size_t read_bytes = fread(ptr, 1, file_size, f);
+    ptr[read_bytes] = '\0';
+    fclose(f);
+    ecjp_fprintf("\nTesting JSON file (%s) of size %ld bytes:\n", argv[1], file_size);
+
+    // same content without the terminator, followed by characters that break the syntax if read
+    memcpy(slice, ptr, read_bytes);
+    memset(&slice[read_bytes], '{', TEST_GUARD_SIZE);
+
+    ret = check_string(ptr, &results);
+    ret_n = check_slice(slice, read_bytes, &results_n);
+    ecjp_fprintf("NUL-terminated    : ret = %d, err_pos = %d, num_keys = %d\n", ret, results.err_pos, results.num_keys);
+    ecjp_fprintf("Length-delimited  : ret = %d, err_pos = %d, num_keys = %d\n", ret_n, results_n.err_pos, results_n.num_keys);
+    if ((ret != ret_n) || (results.err_pos != results_n.err_pos) || (results.num_keys != results_n.num_keys)) {
+        ecjp_fprint("Length-delimited result differs from NUL-terminated result\n");
+        free(ptr);
+        free(slice);
+        return TEST_LENGTH_MISMATCH;
+    }
+
+    // a NUL inside the slice must be reported as a syntax error
+    if ((ret == ECJP_NO_ERROR) && (read_bytes > 1)) {
+        half = read_bytes / 2;
+        slice[half] = '\0';
+        ret_n = check_slice(slice, read_bytes, &results_n);
+        ecjp_fprintf("Embedded NUL at %d: ret = %d, err_pos = %d\n", (int)half, ret_n, results_n.err_pos);
+        if ((ret_n == ECJP_NO_ERROR) || (results_n.err_pos < 0) || (results_n.err_pos > (int)half)) {
+            ecjp_fprint("Embedded NUL not detected\n");
+            free(ptr);
+            free(slice);
+            return TEST_LENGTH_MISMATCH;
+        }
+    }
+    free(ptr);
+    free(slice);
+
+    return (ret == ECJP_NO_ERROR) ? 0 : -1;
+}
@@ -0,0 +1,309 @@
+#include "ecjp.h"
+
+#include "sys/stat.h"
+#include <unistd.h>
+#include <errno.h>
+
+#ifdef ECJP_RUN_ON_PC
+    #define ecjp_fprintf(format, ...)    fprintf(stdout, format, __VA_ARGS__)
+    #define ecjp_fprint(format)          fprintf(stdout, format)
+#else
+    #define ecjp_fprintf(format, ...)
+    #define ecjp_fprint(format)
+#endif
+
+// returned when a number is decoded differently from strtod()
+#define TEST_NUMBER_MISMATCH        2
+// numbers generated for each run
+#define TEST_NUM_GENERATED          20000
+// maximum length of a number
+#define TEST_MAX_NUMBER_LEN         1024
+
+// numbers that are hard to round: halfway cases, limits of the denormals and of the doubles
+static const char *hard_numbers[] = {
+    "0", "-0", "1", "-1", "0.0", "-0.0e5", "1e0", "1E+2", "1e-2",
+    "9223372036854775807", "-9223372036854775808", "9223372036854775808", "-9223372036854775809",
+    "18446744073709551615", "18446744073709551616", "12345678901234567890123",
+    "9007199254740992", "9007199254740993", "9007199254740995", "9007199254740993.0000000000000000001",
+    "0.1", "0.2", "0.3", "0.1000000000000000055511151231257827021181583404541015625",
+    "0.1000000000000000055511151231257827021181583404541015624",
+    "0.1000000000000000055511151231257827021181583404541015626",
+    "2.2250738585072011e-308", "2.2250738585072012e-308", "2.2250738585072014e-308",
+    "4.9406564584124654e-324", "2.4703282292062327e-324", "2.4703282292062328e-324",
+    "1e-400", "-1e-400", "1.7976931348623157e308", "1.7976931348623158e308", "1.7976931348623159e308",
+    "1e309", "-1e400", "1e99999999999", "0e99999999999", "1e-99999999999",
+    "7.3177701707893310e+15", "5.0216813883093446110686315385661331328818843555712276103534e-7",
+    "1448997445238699", "3.5844466002796428e+298", "8.988465674311580536566680e307",
+    "4.35679527860594e-309", "1.00000000000000011102230246251565404236316680908203125",
+    "1.00000000000000011102230246251565404236316680908203124",
+    "1.00000000000000011102230246251565404236316680908203126",
+    "0.00000000000000000000000000000000000000000000000000000000000000000000000000000000000001",
+    "100000000000000000000000000000000000000000000000000000000000000000000000000000000000000e-80",
+    NULL
+};
+
+// texts that are not exactly one JSON number
+static const char *bad_numbers[] = {
+    "-", "+1", "01", "-01", "1.", ".5", "1e", "1e+", "1.e5", "0x10", "1 ", " 1", "1-", "--1", "1.5.2",
+    "NaN", "Infinity", "1ee5", "true",
+    NULL
+};
+
+void usage(char *prog_name)
+{
+    ecjp_fprintf("Usage: %s [filename]\n", prog_name);
+}
+
+/*
+ * Decode the text with ecjp_read_number() and compare the result with strtod()
+ * (bit by bit) and, for the integers, with strtoll().
+*/
+int check_number(const char *text, size_t len)
+{
+    char copy[TEST_MAX_NUMBER_LEN];
+    ecjp_number_t number;
+    double expected;
+    long long expected_integer;
+    int is_integer;
+
+    if (len >= TEST_MAX_NUMBER_LEN) {
+        return 0;
+    }
+    memcpy(copy, text, len);
+    copy[len] = '\0';
+    if (ecjp_read_number(text, len, &number) != ECJP_NO_ERROR) {
+        ecjp_fprintf("Number %s not decoded\n", copy);
+        return TEST_NUMBER_MISMATCH;
+    }
+    expected = strtod(copy, NULL);
+    if (memcmp(&expected, &number.real, sizeof(double)) != 0) {
+        ecjp_fprintf("Number %s: %.17g, expected %.17g\n", copy, number.real, expected);
+        return TEST_NUMBER_MISMATCH;
+    }
+    errno = 0;
+    expected_integer = strtoll(copy, NULL, 10);
+    is_integer = (strpbrk(copy, ".eE") == NULL) && (errno == 0);
+    if ((number.kind == ECJP_NUMBER_INTEGER) != is_integer) {
+        ecjp_fprintf("Number %s: kind %d\n", copy, number.kind);
+        return TEST_NUMBER_MISMATCH;
+    }
+    if (is_integer && (number.integer != expected_integer)) {
+        ecjp_fprintf("Number %s: %lld, expected %lld\n", copy, (long long)number.integer, expected_integer);
+        return TEST_NUMBER_MISMATCH;
+    }
+    return 0;
+}
+
+/*
+ * Generate numbers with a fixed seed: mantissas of 1 to 25 digits, with or without fraction,
+ * and exponents in all the range of the doubles, also around the denormals.
+*/
+int check_generated(void)
+{
+    char text[TEST_MAX_NUMBER_LEN];
+    unsigned long seed = 12345;
+    int i, k, n, digits, point;
+
+    for (i = 0; i < TEST_NUM_GENERATED; i++) {
+        n = 0;
+        seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+        if ((seed >> 60) & 1) {
+            text[n++] = '-';
+        }
+        digits = 1 + (int)((seed >> 40) % 25);
+        point = (int)((seed >> 20) % (digits + 1));
+        for (k = 0; k < digits; k++) {
+            seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+            text[n++] = (char)('0' + ((k == 0) ? (1 + (seed >> 33) % 9) : ((seed >> 33) % 10)));
+            if ((k + 1 == point) && (k + 1 < digits)) {
+                text[n++] = '.';
+            }
+        }
+        seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+        if ((seed >> 62) != 0) {
+            n += sprintf(&text[n], "e%d", (int)((seed >> 20) % 680) - 350);
+        }
+        if (check_number(text, n) != 0) {
+            return TEST_NUMBER_MISMATCH;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Decode the fixed numbers and check that the texts that are not numbers are refused.
+*/
+int check_fixed(void)
+{
+    ecjp_number_t number;
+    char text[TEST_MAX_NUMBER_LEN];
+    int i;
+
+    for (i = 0; hard_numbers[i] != NULL; i++) {
+        if (check_number(hard_numbers[i], strlen(hard_numbers[i])) != 0) {
+            return TEST_NUMBER_MISMATCH;
+        }
+    }
+    // more digits than the slow path keeps
+    memset(text, '1', sizeof(text) - 8);
+    strcpy(&text[sizeof(text) - 8], "e-1000");
+    if (check_number(text, strlen(text)) != 0) {
+        return TEST_NUMBER_MISMATCH;
+    }
+    for (i = 0; bad_numbers[i] != NULL; i++) {
+        if (ecjp_read_number(bad_numbers[i], strlen(bad_numbers[i]), &number) != ECJP_SYNTAX_ERROR) {
+            ecjp_fprintf("Text '%s' decoded as a number\n", bad_numbers[i]);
+            return TEST_NUMBER_MISMATCH;
+        }
+    }
+    if ((ecjp_read_number("1", 0, &number) != ECJP_EMPTY_STRING) || (ecjp_read_number(NULL, 1, &number) != ECJP_NULL_POINTER)) {
+        ecjp_fprint("Empty or NULL number accepted\n");
+        return TEST_NUMBER_MISMATCH;
+    }
+    return 0;
+}
+
+/*
+ * Decode every number of the tape of the document.
+*/
+int check_tape(const char *input, size_t len)
+{
+    ecjp_check_result_t results;
+    ecjp_tape_t tape;
+    ecjp_value_view_t view;
+    int i, count;
+    int status = 0;
+
+    ecjp_init_tape(&tape);
+    if (ecjp_load_tape_n(input, len, &tape, &results) == ECJP_NO_ERROR) {
+        count = 0;
+        for (i = 0; (i < tape.count) && (status == 0); i++) {
+            if (tape.entry[i].type == ECJP_TYPE_NUMBER) {
+                ecjp_tape_view(&tape, input, i, &view);
+                status = check_number(view.ptr, view.len);
+                count++;
+            }
+        }
+        ecjp_fprintf("Tape: %d numbers decoded\n", count);
+    }
+    ecjp_free_tape(&tape);
+    return status;
+}
+
+#ifndef ECJP_TOKEN_LIST
+int same_number(const ecjp_number_t *a, const ecjp_number_t *b)
+{
+    return (a->kind == b->kind) && (a->integer == b->integer) && (memcmp(&a->real, &b->real, sizeof(double)) == 0);
+}
+
+/*
+ * Read the numbers and the booleans of every key with the typed readers and check
+ * that they agree with the characters of the value.
+*/
+int check_keys(const char *input, size_t len, ecjp_key_elem_t *key_list)
+{
+    ecjp_key_elem_t *current;
+    ecjp_indata_t in;
+    ecjp_value_view_t view;
+    ecjp_number_t number, expected;
+    ecjp_bool_t value;
+
+    for (current = key_list; current != NULL; current = current->next) {
+        memset(&in, 0, sizeof(ecjp_indata_t));
+        in.pos = current->key.start_pos;
+        in.length = current->key.length;
+        in.type = current->key.type;
+        if (in.type == ECJP_TYPE_NUMBER) {
+            if ((ecjp_read_key_number(input, &in, &number) != ECJP_NO_ERROR) ||
+                (ecjp_read_key_number_n(input, len, &in, &expected) != ECJP_NO_ERROR) ||
+                !same_number(&number, &expected) ||
+                (ecjp_read_key_view(input, &in, &view) != ECJP_NO_ERROR) ||
+                (ecjp_read_number(view.ptr, view.len, &expected) != ECJP_NO_ERROR) ||
+                !same_number(&number, &expected)) {
+                ecjp_fprintf("Key at %d: number not decoded\n", in.pos);
+                return TEST_NUMBER_MISMATCH;
+            }
+        } else if (in.type == ECJP_TYPE_BOOL) {
+            if ((ecjp_read_key_bool_n(input, len, &in, &value) != ECJP_NO_ERROR) ||
+                (ecjp_read_key_view(input, &in, &view) != ECJP_NO_ERROR) ||
+                ((value == ECJP_BOOL_TRUE) != (view.ptr[0] == 't'))) {
+                ecjp_fprintf("Key at %d: boolean not decoded\n", in.pos);
+                return TEST_NUMBER_MISMATCH;
+            }
+        } else if ((in.type != ECJP_TYPE_UNDEFINED) && (ecjp_read_key_number(input, &in, &number) != ECJP_SYNTAX_ERROR)) {
+            ecjp_fprintf("Key at %d: value of type %s decoded as a number\n", in.pos, ecjp_type[in.type]);
+            return TEST_NUMBER_MISMATCH;
+        }
+    }
+    return 0;
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+    ecjp_return_code_t ret;
+    ecjp_check_result_t results;
+    char *ptr;
+    struct stat strstat;
+    int status = 0;
+#ifndef ECJP_TOKEN_LIST
+    ecjp_key_elem_t *key_list = NULL;
+    ecjp_tape_t tape;
+#endif
+
+    // check arguments and open test files
+    if(argc != 2) {
+        usage(argv[0]);
+        return -1;
+    }
+    memset(&strstat, 0, sizeof(struct stat));
+    if (stat(argv[1], &strstat) != 0) {
+        ecjp_fprintf("stat() failed for file %s\n", argv[1]);
+        return -1;
+    }
+    long file_size = strstat.st_size;
+    ptr = (char *)malloc(file_size + 1);
+    if (ptr == NULL) {
+        ecjp_fprint("Memory allocation failed for JSON file\n");
+        return -1;
+    }
+    FILE *f = fopen(argv[1], "r");
+    if (f == NULL) {
+        ecjp_fprintf("Failed to open file %s\n", argv[1]);
+        free(ptr);
+        return -1;
+    }
+    size_t read_bytes = fread(ptr, 1, file_size, f);
+    ptr[read_bytes] = '\0';
+    fclose(f);
+    ecjp_fprintf("\nTesting JSON file (%s) of size %ld bytes:\n", argv[1], file_size);
+
+    status = check_fixed();
+    if (status == 0) {
+        status = check_generated();
+    }
+    if (status == 0) {
+        status = check_tape(ptr, read_bytes);
+    }
+
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    results.err_pos = -1;
+#ifdef ECJP_TOKEN_LIST
+    ret = ecjp_check_syntax_2(ptr, &results);
+#else
+    ret = ecjp_check_and_load(ptr, &key_list, &results, ECJP_MAX_NESTED_LEVEL);
+    // the typed readers need the numbers checked by the tape (the key list accepts e.g. "4.")
+    ecjp_init_tape(&tape);
+    if ((status == 0) && (ret == ECJP_NO_ERROR) && (read_bytes <= (ECJP_TYPE_POS_KEY)(-1)) &&
+        (ecjp_load_tape_n(ptr, read_bytes, &tape, &results) == ECJP_NO_ERROR)) {
+        status = check_keys(ptr, read_bytes, key_list);
+    }
+    ecjp_free_tape(&tape);
+    ecjp_free_key_list(&key_list);
+#endif
+    free(ptr);
+    if (status != 0) {
+        return status;
+    }
+    return (ret == ECJP_NO_ERROR) ? 0 : -1;
+}
@@ -0,0 +1,217 @@
+#include "ecjp.h"
+
+#include "sys/stat.h"
+#include <unistd.h>
+
+#ifdef ECJP_RUN_ON_PC
+    #define ecjp_fprintf(format, ...)    fprintf(stdout, format, __VA_ARGS__)
+    #define ecjp_fprint(format)          fprintf(stdout, format)
+#else
+    #define ecjp_fprintf(format, ...)
+    #define ecjp_fprint(format)
+#endif
+
+// returned when the projection finds values different from ecjp_query()
+#define TEST_PROJECTION_MISMATCH    2
+// maximum number of paths collected from the tape
+#define TEST_MAX_PATHS              256
+// maximum length of the paths collected from the tape
+#define TEST_MAX_PATH_LEN           256
+
+static const char fixed_doc[] =
+    "{\"id\": 7, \"skip\": {\"a\": [\"}\", {\"b\": \"]\"}]}, \"user\": {\"name\": \"x\", \"tags\": [\"a\", \"b\"]},\n"
+    "  \"events\": [{\"t\": 1}, {\"t\": 2, \"k\": \"v\"}], \"a/b\": null, \"id\": 8, \"last\": true}";
+
+static const char *const fixed_paths[] = {
+    "/id", "user.name", "/user/tags/1", "user.tags[0]", "/user", "events[1].k", "/events/1/t",
+    "/a~1b", "user.name", "/last", "/nope", "/user/tags/2", "/id/x", ""
+};
+
+void usage(char *prog_name)
+{
+    ecjp_fprintf("Usage: %s [filename]\n", prog_name);
+}
+
+/*
+ * Project the paths on the input and compare each view with the value found by ecjp_query().
+*/
+int check_projection(const char *input, size_t len, const char *const paths[], int num_paths)
+{
+    ecjp_projection_t proj;
+    ecjp_value_view_t views[TEST_MAX_PATHS];
+    ecjp_value_view_t view;
+    ecjp_return_code_t ret, ret_query;
+    int i, all_found;
+    int status = 0;
+
+    if (ecjp_projection_compile(&proj, paths, num_paths) != ECJP_NO_ERROR) {
+        ecjp_fprint("Projection not compiled\n");
+        return TEST_PROJECTION_MISMATCH;
+    }
+    ret = ecjp_project(&proj, input, len, views);
+    all_found = 1;
+    for (i = 0; (i < num_paths) && (status == 0); i++) {
+        ret_query = ecjp_query(input, len, paths[i], &view);
+        if (ret_query != ECJP_NO_ERROR) {
+            all_found = 0;
+        }
+        if ((view.ptr != views[i].ptr) || (view.len != views[i].len) || (view.type != views[i].type)) {
+            ecjp_fprintf("Path %s: projection '%.*s', query '%.*s' (ret = %d)\n", paths[i],
+                         (int)views[i].len, (views[i].ptr != NULL) ? views[i].ptr : "", (int)view.len, (view.ptr != NULL) ? view.ptr : "", ret_query);
+            status = TEST_PROJECTION_MISMATCH;
+        }
+    }
+    if ((status == 0) && (ret != (all_found ? ECJP_NO_ERROR : ECJP_NO_MORE_KEY))) {
+        ecjp_fprintf("Projection: ret = %d\n", ret);
+        status = TEST_PROJECTION_MISMATCH;
+    }
+    ecjp_free_projection(&proj);
+    return status;
+}
+
+/*
+ * Check the fixed paths, the errors and the reuse of a projection on many inputs.
+*/
+int check_fixed(void)
+{
+    static const char *const bad_paths[] = { "/id", "a..b" };
+    ecjp_projection_t proj;
+    ecjp_value_view_t views[2];
+    size_t len = strlen(fixed_doc);
+    int status;
+
+    status = check_projection(fixed_doc, len, fixed_paths, sizeof(fixed_paths) / sizeof(fixed_paths[0]));
+    if ((status == 0) && ((ecjp_projection_compile(&proj, bad_paths, 2) != ECJP_SYNTAX_ERROR) ||
+                          (ecjp_projection_compile(&proj, bad_paths, 0) != ECJP_EMPTY_STRING))) {
+        ecjp_fprint("Projection of bad paths compiled\n");
+        status = TEST_PROJECTION_MISMATCH;
+    }
+    // the same projection on the input cut at every length
+    if ((status == 0) && (ecjp_projection_compile(&proj, &fixed_paths[1], 2) == ECJP_NO_ERROR)) {
+        for (; (len > 0) && (status == 0); len--) {
+            if ((ecjp_project(&proj, fixed_doc, len, views) == ECJP_NO_ERROR) != (len > (size_t)(strstr(fixed_doc, "\"b\"]") - fixed_doc) + 2)) {
+                ecjp_fprintf("Projection on %zu characters: wrong result\n", len);
+                status = TEST_PROJECTION_MISMATCH;
+            }
+        }
+        ecjp_free_projection(&proj);
+    }
+    return status;
+}
+
+/*
+ * Collect the JSON Pointer of every value of the container at index i and of the nested containers,
+ * skipping the keys that have a duplicate before them (and the keys with escape sequences).
+ * Returns the index of the next entry.
+*/
+int collect_paths(const char *input, const ecjp_tape_t *tape, int i, const char *path, char paths[][TEST_MAX_PATH_LEN], int *num_paths)
+{
+    char child[TEST_MAX_PATH_LEN];
+    char name[TEST_MAX_PATH_LEN];
+    const ecjp_tape_entry_t *k;
+    int j, n, found;
+
+    n = 0;
+    j = i + 1;
+    while ((j < tape->entry[i].next) && (*num_paths < TEST_MAX_PATHS)) {
+        child[0] = '\0';
+        if (tape->entry[i].type == ECJP_TYPE_OBJECT) {
+            k = &tape->entry[j++];
+            if ((k->length + strlen(path) + 2 < TEST_MAX_PATH_LEN) && (memchr(&input[k->pos], '\\', k->length) == NULL) &&
+                (memchr(&input[k->pos], '~', k->length) == NULL) && (memchr(&input[k->pos], '/', k->length) == NULL)) {
+                memcpy(name, &input[k->pos], k->length);
+                name[k->length] = '\0';
+                if ((strlen(name) == k->length) && (ecjp_tape_find_key(tape, input, i, name, &found) == ECJP_NO_ERROR) && (found == j)) {
+                    snprintf(child, sizeof(child), "%s/%s", path, name);
+                }
+            }
+        } else if (strlen(path) + 16 < TEST_MAX_PATH_LEN) {
+            snprintf(child, sizeof(child), "%s/%d", path, n);
+        }
+        if (child[0] != '\0') {
+            strcpy(paths[(*num_paths)++], child);
+        }
+        if ((child[0] != '\0') && ((tape->entry[j].type == ECJP_TYPE_OBJECT) || (tape->entry[j].type == ECJP_TYPE_ARRAY))) {
+            j = collect_paths(input, tape, j, child, paths, num_paths);
+        } else {
+            j = tape->entry[j].next;
+        }
+        n++;
+    }
+    return tape->entry[i].next;
+}
+
+int main(int argc, char *argv[])
+{
+    static char paths[TEST_MAX_PATHS][TEST_MAX_PATH_LEN];
+    const char *path_list[TEST_MAX_PATHS];
+    ecjp_return_code_t ret;
+    ecjp_check_result_t results;
+    ecjp_tape_t tape;
+    char *ptr;
+    struct stat strstat;
+    int i, num_paths;
+    int status = 0;
+
+    // check arguments and open test files
+    if(argc != 2) {
+        usage(argv[0]);
+        return -1;
+    }
+    memset(&strstat, 0, sizeof(struct stat));
+    if (stat(argv[1], &strstat) != 0) {
+        ecjp_fprintf("stat() failed for file %s\n", argv[1]);
+        return -1;
+    }
+    long file_size = strstat.st_size;
+    ptr = (char *)malloc(file_size + 1);
+    if (ptr == NULL) {
+        ecjp_fprint("Memory allocation failed for JSON file\n");
+        return -1;
+    }
+    FILE *f = fopen(argv[1], "r");
+    if (f == NULL) {
+        ecjp_fprintf("Failed to open file %s\n", argv[1]);
+        free(ptr);
+        return -1;
+    }
+    size_t read_bytes = fread(ptr, 1, file_size, f);
+    ptr[read_bytes] = '\0';
+    fclose(f);
+    ecjp_fprintf("\nTesting JSON file (%s) of size %ld bytes:\n", argv[1], file_size);
+
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    results.err_pos = -1;
+#ifdef ECJP_TOKEN_LIST
+    ret = ecjp_check_syntax_2(ptr, &results);
+#else
+    ret = ecjp_check_syntax(ptr, &results);
+#endif
+
+    status = check_fixed();
+    // all the values of the tape in a single projection, with some paths not found
+    ecjp_init_tape(&tape);
+    if ((status == 0) && (ecjp_load_tape_n(ptr, read_bytes, &tape, &results) == ECJP_NO_ERROR)) {
+        strcpy(paths[0], "");
+        strcpy(paths[1], "/nope/0");
+        num_paths = 2;
+        if ((tape.entry[0].type == ECJP_TYPE_OBJECT) || (tape.entry[0].type == ECJP_TYPE_ARRAY)) {
+            collect_paths(ptr, &tape, 0, "", paths, &num_paths);
+        }
+        for (i = 0; i < num_paths; i++) {
+            path_list[i] = paths[i];
+        }
+        status = check_projection(ptr, read_bytes, path_list, num_paths);
+        // the last paths only: the projection stops before the end
+        if ((status == 0) && (num_paths > 4)) {
+            status = check_projection(ptr, read_bytes, &path_list[num_paths - 2], 2);
+        }
+        ecjp_fprintf("Projection of %d paths: %s\n", num_paths, (status == 0) ? "ok" : "mismatch");
+    }
+    ecjp_free_tape(&tape);
+    free(ptr);
+    if (status != 0) {
+        return status;
+    }
+    return (ret == ECJP_NO_ERROR) ? 0 : -1;
+}
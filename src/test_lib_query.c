@@ -0,0 +1,316 @@
+#include "ecjp.h"
+
+#include "sys/stat.h"
+#include <unistd.h>
+
+#ifdef ECJP_RUN_ON_PC
+    #define ecjp_fprintf(format, ...)    fprintf(stdout, format, __VA_ARGS__)
+    #define ecjp_fprint(format)          fprintf(stdout, format)
+#else
+    #define ecjp_fprintf(format, ...)
+    #define ecjp_fprint(format)
+#endif
+
+// returned when a query finds a value different from the tape
+#define TEST_QUERY_MISMATCH         2
+// maximum length of the paths built from the tape
+#define TEST_MAX_PATH_LEN           1024
+
+typedef struct test_query {
+    const char          *path;
+    ecjp_return_code_t  ret;
+    const char          *value;         // characters of the value found, NULL if not found
+} test_query_t;
+
+static const char fixed_doc[] =
+    "{\"db\": {\"skip\": \"}]{[\\\"\", \"list\": [{\"a\": \"]\"}, [], {}],\n"
+    "  \"tables\": [1, {\"t\": []}, \"s\", {\"name\": \"t3\", \"rows\": 10}],\n"
+    "  \"a/b\": 1, \"m~n\": 2, \"\\u00e8\": true, \"\": null, \"x.y\": -1.5e3}}";
+
+static const test_query_t fixed_query[] = {
+    { "/db/tables/3/name", ECJP_NO_ERROR, "t3" },
+    { "db.tables[3].name", ECJP_NO_ERROR, "t3" },
+    { "db.tables.3.rows", ECJP_NO_ERROR, "10" },
+    { "[0]", ECJP_NO_MORE_KEY, NULL },
+    { "/db/tables/1", ECJP_NO_ERROR, "{\"t\": []}" },
+    { "/db/list/0/a", ECJP_NO_ERROR, "]" },
+    { "/db/skip", ECJP_NO_ERROR, "}]{[\\\"" },
+    { "/db/a~1b", ECJP_NO_ERROR, "1" },
+    { "/db/m~0n", ECJP_NO_ERROR, "2" },
+    { "/db/\xC3\xA8", ECJP_NO_ERROR, "true" },
+    { "/db/", ECJP_NO_ERROR, "null" },
+    { "/db/x.y", ECJP_NO_ERROR, "-1.5e3" },
+    { "/db/tables/4", ECJP_INDEX_OUT_OF_BOUNDS, NULL },
+    { "/db/tables/01", ECJP_INDEX_OUT_OF_BOUNDS, NULL },
+    { "/db/tables/-", ECJP_INDEX_OUT_OF_BOUNDS, NULL },
+    { "db.tables[1].t[0]", ECJP_INDEX_OUT_OF_BOUNDS, NULL },
+    { "db.nope", ECJP_NO_MORE_KEY, NULL },
+    { "/db/a~1b/c", ECJP_NO_MORE_KEY, NULL },
+    { "db[0]", ECJP_NO_MORE_KEY, NULL },
+    { "/db/m~2n", ECJP_SYNTAX_ERROR, NULL },
+    { "db..tables", ECJP_SYNTAX_ERROR, NULL },
+    { "db.tables[x]", ECJP_SYNTAX_ERROR, NULL },
+    { "db.tables[1", ECJP_SYNTAX_ERROR, NULL },
+    { NULL, ECJP_NO_ERROR, NULL }
+};
+
+void usage(char *prog_name)
+{
+    ecjp_fprintf("Usage: %s [filename]\n", prog_name);
+}
+
+/*
+ * Run the fixed queries on the fixed document, and on the same document cut before its end:
+ * a value found before the cut is found again.
+*/
+int check_fixed(void)
+{
+    ecjp_value_view_t view;
+    ecjp_return_code_t ret;
+    size_t len = strlen(fixed_doc);
+    int i;
+
+    for (i = 0; fixed_query[i].path != NULL; i++) {
+        ret = ecjp_query(fixed_doc, len, fixed_query[i].path, &view);
+        if ((ret != fixed_query[i].ret) ||
+            ((fixed_query[i].value != NULL) &&
+             ((view.len != strlen(fixed_query[i].value)) || (memcmp(view.ptr, fixed_query[i].value, view.len) != 0)))) {
+            ecjp_fprintf("Query %s: ret = %d, expected %d\n", fixed_query[i].path, ret, fixed_query[i].ret);
+            return TEST_QUERY_MISMATCH;
+        }
+        if ((fixed_query[i].value == NULL) && (view.ptr != NULL)) {
+            ecjp_fprintf("Query %s: view not cleared\n", fixed_query[i].path);
+            return TEST_QUERY_MISMATCH;
+        }
+    }
+    // the object of the value is not closed
+    if ((ecjp_query(fixed_doc, strchr(fixed_doc, 'x') - fixed_doc, "/db/tables/3/name", &view) != ECJP_NO_ERROR) ||
+        (ecjp_query(fixed_doc, len - 2, "/db", &view) != ECJP_SYNTAX_ERROR) ||
+        (ecjp_query(fixed_doc, len - 2, "/db/nope", &view) != ECJP_SYNTAX_ERROR) ||
+        (ecjp_query("{\"a\":1x}", 8, "/a", &view) != ECJP_SYNTAX_ERROR) ||
+        (ecjp_query(" \n ", 3, "", &view) != ECJP_EMPTY_STRING) ||
+        (ecjp_query(fixed_doc, len, NULL, &view) != ECJP_NULL_POINTER)) {
+        ecjp_fprint("Query on a cut document or NULL path: wrong result\n");
+        return TEST_QUERY_MISMATCH;
+    }
+    return 0;
+}
+
+/*
+ * Run the queries on inputs cut before a value, copied in buffers of their exact size
+ * (no terminator): a read past the end is found by the sanitizers.
+*/
+int check_cut(void)
+{
+    static const struct {
+        const char          *input;
+        const char          *path;
+    } cut_query[] = {
+        { "{\"a\":", "/a/0" },
+        { "{\"a\": ", "/a/0" },
+        { "[", "/a/0" },
+        { "[ ", "/0" },
+        { "{\"a\":[1,", "/a/1" },
+        { "{\"a\":[1, ", "/a/1/b" },
+        { "{\"a\":{\"b\":", "/a/b" },
+        { NULL, NULL }
+    };
+    ecjp_value_view_t view;
+    ecjp_return_code_t ret;
+    char *buffer;
+    size_t len;
+    int i;
+
+    for (i = 0; cut_query[i].input != NULL; i++) {
+        len = strlen(cut_query[i].input);
+        buffer = (char *)malloc(len);
+        if (buffer == NULL) {
+            return -1;
+        }
+        memcpy(buffer, cut_query[i].input, len);
+        ret = ecjp_query(buffer, len, cut_query[i].path, &view);
+        free(buffer);
+        if ((ret != ECJP_SYNTAX_ERROR) || (view.ptr != NULL)) {
+            ecjp_fprintf("Query %s on cut input #%d: ret = %d, expected %d\n", cut_query[i].path, i, ret, ECJP_SYNTAX_ERROR);
+            return TEST_QUERY_MISMATCH;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Append a key to a JSON Pointer (~ and / escaped) and to a dotted path; dotted is NULL
+ * when the key can't be written in the dotted syntax.
+*/
+int append_key(const char *input, const ecjp_tape_entry_t *key, char *pointer, char *dotted)
+{
+    char name[TEST_MAX_PATH_LEN];
+    ecjp_string_t string;
+    size_t n, i;
+
+    if (ecjp_read_string(&input[key->pos], key->length, name, sizeof(name), &string) != ECJP_NO_ERROR) {
+        return -1;
+    }
+    n = strlen(pointer);
+    if ((n + 2 * string.len + 2 >= TEST_MAX_PATH_LEN) || ((dotted != NULL) && (strlen(dotted) + string.len + 2 >= TEST_MAX_PATH_LEN))) {
+        return -1;
+    }
+    pointer[n++] = '/';
+    for (i = 0; i < string.len; i++) {
+        if ((name[i] == '~') || (name[i] == '/')) {
+            pointer[n++] = '~';
+            pointer[n++] = (name[i] == '~') ? '0' : '1';
+        } else {
+            pointer[n++] = name[i];
+        }
+    }
+    pointer[n] = '\0';
+    if ((dotted == NULL) || (string.len == 0) || (strlen(name) != string.len) || (strpbrk(name, ".[") != NULL)) {
+        return 1;
+    }
+    sprintf(&dotted[strlen(dotted)], "%s%s", (dotted[0] != '\0') ? "." : "", name);
+    return 0;
+}
+
+/*
+ * Compare the value found by a query with the entry of the tape.
+*/
+int check_query(const char *input, size_t len, const ecjp_tape_t *tape, int entry, const char *path)
+{
+    ecjp_value_view_t view, expected;
+
+    ecjp_tape_view(tape, input, entry, &expected);
+    if ((ecjp_query(input, len, path, &view) != ECJP_NO_ERROR) ||
+        (view.ptr != expected.ptr) || (view.len != expected.len) || (view.type != expected.type)) {
+        ecjp_fprintf("Query %s: value at entry %d not found\n", path, entry);
+        return TEST_QUERY_MISMATCH;
+    }
+    return 0;
+}
+
+/*
+ * Query every value of the container at index i and of all the nested containers with its
+ * JSON Pointer and its dotted path (NULL if the path can't be written in the dotted syntax),
+ * skipping the keys that have a duplicate before them. Returns the index of the next entry.
+*/
+int check_container(const char *input, size_t len, const ecjp_tape_t *tape, int i, const char *pointer, const char *dotted, int *status)
+{
+    char name[TEST_MAX_PATH_LEN];
+    char child_pointer[TEST_MAX_PATH_LEN];
+    char child_dotted[TEST_MAX_PATH_LEN];
+    const ecjp_tape_entry_t *k;
+    const char *dotted_path;
+    int j, n, found, ret;
+
+    n = 0;
+    j = i + 1;
+    while ((j < tape->entry[i].next) && (*status == 0)) {
+        strcpy(child_pointer, pointer);
+        strcpy(child_dotted, (dotted != NULL) ? dotted : "");
+        dotted_path = (dotted != NULL) ? child_dotted : NULL;
+        if (tape->entry[i].type == ECJP_TYPE_OBJECT) {
+            k = &tape->entry[j++];
+            ret = -1;
+            if (k->length < TEST_MAX_PATH_LEN) {
+                memcpy(name, &input[k->pos], k->length);
+                name[k->length] = '\0';
+            }
+            if ((k->length < TEST_MAX_PATH_LEN) && (strlen(name) == k->length) && (ecjp_tape_find_key(tape, input, i, name, &found) == ECJP_NO_ERROR) && (found == j)) {
+                ret = append_key(input, k, child_pointer, (dotted != NULL) ? child_dotted : NULL);
+            }
+            if (ret < 0) {
+                // duplicate key or path too long
+                j = tape->entry[j].next;
+                continue;
+            }
+            if (ret > 0) {
+                dotted_path = NULL;
+            }
+        } else {
+            if (strlen(pointer) + 16 >= TEST_MAX_PATH_LEN) {
+                // path too long
+                j = tape->entry[j].next;
+                n++;
+                continue;
+            }
+            sprintf(&child_pointer[strlen(child_pointer)], "/%d", n);
+            sprintf(&child_dotted[strlen(child_dotted)], "[%d]", n);
+        }
+        *status = check_query(input, len, tape, j, child_pointer);
+        if ((*status == 0) && (dotted_path != NULL)) {
+            *status = check_query(input, len, tape, j, dotted_path);
+        }
+        if ((*status == 0) && ((tape->entry[j].type == ECJP_TYPE_OBJECT) || (tape->entry[j].type == ECJP_TYPE_ARRAY))) {
+            j = check_container(input, len, tape, j, child_pointer, dotted_path, status);
+        } else {
+            j = tape->entry[j].next;
+        }
+        n++;
+    }
+    return tape->entry[i].next;
+}
+
+int main(int argc, char *argv[])
+{
+    ecjp_return_code_t ret;
+    ecjp_check_result_t results;
+    ecjp_tape_t tape;
+    char *ptr;
+    struct stat strstat;
+    int status = 0;
+
+    // check arguments and open test files
+    if(argc != 2) {
+        usage(argv[0]);
+        return -1;
+    }
+    memset(&strstat, 0, sizeof(struct stat));
+    if (stat(argv[1], &strstat) != 0) {
+        ecjp_fprintf("stat() failed for file %s\n", argv[1]);
+        return -1;
+    }
+    long file_size = strstat.st_size;
+    ptr = (char *)malloc(file_size + 1);
+    if (ptr == NULL) {
+        ecjp_fprint("Memory allocation failed for JSON file\n");
+        return -1;
+    }
+    FILE *f = fopen(argv[1], "r");
+    if (f == NULL) {
+        ecjp_fprintf("Failed to open file %s\n", argv[1]);
+        free(ptr);
+        return -1;
+    }
+    size_t read_bytes = fread(ptr, 1, file_size, f);
+    ptr[read_bytes] = '\0';
+    fclose(f);
+    ecjp_fprintf("\nTesting JSON file (%s) of size %ld bytes:\n", argv[1], file_size);
+
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    results.err_pos = -1;
+#ifdef ECJP_TOKEN_LIST
+    ret = ecjp_check_syntax_2(ptr, &results);
+#else
+    ret = ecjp_check_syntax(ptr, &results);
+#endif
+
+    status = check_fixed();
+    if (status == 0) {
+        status = check_cut();
+    }
+    // every value of the tape is found by its paths
+    ecjp_init_tape(&tape);
+    if ((status == 0) && (ecjp_load_tape_n(ptr, read_bytes, &tape, &results) == ECJP_NO_ERROR)) {
+        status = check_query(ptr, read_bytes, &tape, 0, "");
+        if ((status == 0) && ((tape.entry[0].type == ECJP_TYPE_OBJECT) || (tape.entry[0].type == ECJP_TYPE_ARRAY))) {
+            check_container(ptr, read_bytes, &tape, 0, "", "", &status);
+        }
+        ecjp_fprintf("Queries on %d entries: %s\n", tape.count, (status == 0) ? "ok" : "mismatch");
+    }
+    ecjp_free_tape(&tape);
+    free(ptr);
+    if (status != 0) {
+        return status;
+    }
+    return (ret == ECJP_NO_ERROR) ? 0 : -1;
+}
@@ -0,0 +1,347 @@
+#include "ecjp.h"
+
+#include "sys/stat.h"
+#include <unistd.h>
+
+#ifdef ECJP_RUN_ON_PC
+    #define ecjp_fprintf(format, ...)    fprintf(stdout, format, __VA_ARGS__)
+    #define ecjp_fprint(format)          fprintf(stdout, format)
+#else
+    #define ecjp_fprintf(format, ...)
+    #define ecjp_fprint(format)
+#endif
+
+// returned when the events differ from the tape or from the syntax check
+#define TEST_SAX_MISMATCH           2
+// maximum number of events recorded
+#define TEST_MAX_EVENTS             (256 * 1024)
+
+typedef enum {
+    TEST_START_OBJECT = 0,
+    TEST_END_OBJECT,
+    TEST_START_ARRAY,
+    TEST_END_ARRAY,
+    TEST_KEY,
+    TEST_STRING,
+    TEST_NUMBER,
+    TEST_BOOL,
+    TEST_NULL
+} test_event_type_t;
+
+typedef struct test_event {
+    test_event_type_t   type;
+    int                 pos;
+    int                 length;
+} test_event_t;
+
+typedef struct test_events {
+    test_event_t        *event;
+    int                 count;
+    int                 overflow;       // events not recorded
+    int                 stop_after;     // events accepted before stopping the parsing, -1 never stop
+} test_events_t;
+
+typedef struct test_counter {
+    long                calls;          // calls to malloc_fn() and realloc_fn()
+} test_counter_t;
+
+static const char fixed_doc[] =
+    "{\"a\": [1, -2.5e3, \"s\\\"}\", true, false, null, {}, []], \"\": {\"b\\u00e8\": 0}, \"c\": [[0]]}";
+
+// one line for each event of fixed_doc
+static const char *const fixed_events[] = {
+    "0 {", "4 a", "2 [", "6 1", "6 -2.5e3", "5 s\\\"}", "7 true", "7 false", "8 null", "0 {", "1 }", "2 [", "3 ]",
+    "3 ]", "4 ", "0 {", "4 b\\u00e8", "6 0", "1 }", "4 c", "2 [", "2 [", "6 0", "3 ]", "3 ]", "1 }", NULL
+};
+
+void usage(char *prog_name)
+{
+    ecjp_fprintf("Usage: %s [filename]\n", prog_name);
+}
+
+ecjp_bool_t record(test_event_type_t type, int pos, int length, void *user_data)
+{
+    test_events_t *events = (test_events_t *)user_data;
+
+    if ((events->stop_after >= 0) && (events->count >= events->stop_after)) {
+        return ECJP_BOOL_FALSE;
+    }
+    if (events->count < TEST_MAX_EVENTS) {
+        events->event[events->count].type = type;
+        events->event[events->count].pos = pos;
+        events->event[events->count].length = length;
+        events->count++;
+    } else {
+        events->overflow++;
+    }
+    return ECJP_BOOL_TRUE;
+}
+
+ecjp_bool_t on_start_object(const char *input, int pos, int length, void *user_data)
+{
+    return record(TEST_START_OBJECT, pos, length, user_data);
+}
+
+ecjp_bool_t on_end_object(const char *input, int pos, int length, void *user_data)
+{
+    return record(TEST_END_OBJECT, pos, length, user_data);
+}
+
+ecjp_bool_t on_start_array(const char *input, int pos, int length, void *user_data)
+{
+    return record(TEST_START_ARRAY, pos, length, user_data);
+}
+
+ecjp_bool_t on_end_array(const char *input, int pos, int length, void *user_data)
+{
+    return record(TEST_END_ARRAY, pos, length, user_data);
+}
+
+ecjp_bool_t on_key(const char *input, int pos, int length, void *user_data)
+{
+    return record(TEST_KEY, pos, length, user_data);
+}
+
+ecjp_bool_t on_string(const char *input, int pos, int length, void *user_data)
+{
+    return record(TEST_STRING, pos, length, user_data);
+}
+
+ecjp_bool_t on_number(const char *input, int pos, int length, void *user_data)
+{
+    return record(TEST_NUMBER, pos, length, user_data);
+}
+
+ecjp_bool_t on_bool(const char *input, int pos, int length, void *user_data)
+{
+    return record(TEST_BOOL, pos, length, user_data);
+}
+
+ecjp_bool_t on_null(const char *input, int pos, int length, void *user_data)
+{
+    return record(TEST_NULL, pos, length, user_data);
+}
+
+static const ecjp_sax_handler_t handler = {
+    on_start_object, on_end_object, on_start_array, on_end_array, on_key, on_string, on_number, on_bool, on_null
+};
+
+void *counting_malloc(size_t size, void *user_data)
+{
+    ((test_counter_t *)user_data)->calls++;
+    return malloc(size);
+}
+
+void *counting_realloc(void *ptr, size_t size, void *user_data)
+{
+    ((test_counter_t *)user_data)->calls++;
+    return realloc(ptr, size);
+}
+
+void counting_free(void *ptr, void *user_data)
+{
+    free(ptr);
+}
+
+/*
+ * Parse the input recording its events, with the allocator that counts the allocations.
+*/
+ecjp_return_code_t parse(const char *input, size_t len, test_events_t *events, long *allocations)
+{
+    test_counter_t counter;
+    ecjp_allocator_t allocator;
+    ecjp_return_code_t ret;
+
+    counter.calls = 0;
+    allocator.malloc_fn = counting_malloc;
+    allocator.realloc_fn = counting_realloc;
+    allocator.free_fn = counting_free;
+    allocator.user_data = &counter;
+    ecjp_set_allocator(&allocator);
+    events->count = 0;
+    events->overflow = 0;
+    ret = ecjp_sax_parse(input, len, &handler, events);
+    ecjp_set_allocator(NULL);
+    *allocations = counter.calls;
+    return ret;
+}
+
+/*
+ * Compare the events of the entry at index i of the tape (and of its content) with the events
+ * starting at *n. Returns the index of the next entry, -1 on mismatch.
+*/
+int compare_entry(const ecjp_tape_t *tape, int i, const test_events_t *events, int *n)
+{
+    const ecjp_tape_entry_t *e = &tape->entry[i];
+    test_event_type_t type;
+    int j;
+
+    switch (e->type) {
+        case ECJP_TYPE_OBJECT:  type = TEST_START_OBJECT; break;
+        case ECJP_TYPE_ARRAY:   type = TEST_START_ARRAY; break;
+        case ECJP_TYPE_KEY:     type = TEST_KEY; break;
+        case ECJP_TYPE_STRING:  type = TEST_STRING; break;
+        case ECJP_TYPE_NUMBER:  type = TEST_NUMBER; break;
+        case ECJP_TYPE_BOOL:    type = TEST_BOOL; break;
+        default:                type = TEST_NULL; break;
+    }
+    if ((*n >= events->count) || (events->event[*n].type != type) || (events->event[*n].pos != (int)e->pos) ||
+        (events->event[*n].length != (((type == TEST_START_OBJECT) || (type == TEST_START_ARRAY)) ? 1 : (int)e->length))) {
+        ecjp_fprintf("Event %d doesn't match the entry %d of the tape\n", *n, i);
+        return -1;
+    }
+    (*n)++;
+    if ((type != TEST_START_OBJECT) && (type != TEST_START_ARRAY)) {
+        return i + 1;
+    }
+    for (j = i + 1; (j >= 0) && (j < e->next); ) {
+        j = compare_entry(tape, j, events, n);
+    }
+    if ((j < 0) || (*n >= events->count) || (events->event[*n].type != type + 1) ||
+        (events->event[*n].pos != (int)(e->pos + e->length - 1))) {
+        ecjp_fprintf("Event %d doesn't close the entry %d of the tape\n", *n, i);
+        return -1;
+    }
+    (*n)++;
+    return e->next;
+}
+
+/*
+ * Check the events of the fixed document, the stop from a callback and the NULL callbacks.
+*/
+int check_fixed(test_events_t *events)
+{
+    static const ecjp_sax_handler_t keys_only = { NULL, NULL, NULL, NULL, on_key, NULL, NULL, NULL, NULL };
+    char line[64];
+    long allocations;
+    int i;
+
+    if ((parse(fixed_doc, strlen(fixed_doc), events, &allocations) != ECJP_NO_ERROR) || (allocations != 0)) {
+        ecjp_fprint("Fixed document not parsed\n");
+        return TEST_SAX_MISMATCH;
+    }
+    for (i = 0; (fixed_events[i] != NULL) && (i < events->count); i++) {
+        snprintf(line, sizeof(line), "%d %.*s", events->event[i].type, events->event[i].length, &fixed_doc[events->event[i].pos]);
+        if (strcmp(line, fixed_events[i]) != 0) {
+            ecjp_fprintf("Event %d: '%s', expected '%s'\n", i, line, fixed_events[i]);
+            return TEST_SAX_MISMATCH;
+        }
+    }
+    if ((fixed_events[i] != NULL) || (i != events->count)) {
+        ecjp_fprintf("Fixed document: %d events\n", events->count);
+        return TEST_SAX_MISMATCH;
+    }
+    // a callback stops the parsing, the syntax error after the stop is not found
+    events->stop_after = 3;
+    if ((parse(fixed_doc, strlen(fixed_doc) - 1, events, &allocations) != ECJP_STOPPED) || (events->count != 3) ||
+        (parse(fixed_doc, strlen(fixed_doc), events, &allocations) != ECJP_STOPPED) || (events->count != 3)) {
+        ecjp_fprint("Parsing not stopped by the callback\n");
+        return TEST_SAX_MISMATCH;
+    }
+    events->stop_after = -1;
+    events->count = 0;
+    if ((ecjp_sax_parse(fixed_doc, strlen(fixed_doc), &keys_only, events) != ECJP_NO_ERROR) || (events->count != 4) ||
+        (ecjp_sax_parse(fixed_doc, strlen(fixed_doc), NULL, events) != ECJP_NULL_POINTER) ||
+        (ecjp_sax_parse(NULL, 0, &handler, events) != ECJP_NULL_POINTER) ||
+        (ecjp_sax_parse(fixed_doc, 0, &handler, events) != ECJP_EMPTY_STRING) ||
+        (ecjp_sax_parse("{\"a\":1]", 7, &handler, events) != ECJP_SYNTAX_ERROR)) {
+        ecjp_fprint("Wrong result with the keys only or the wrong parameters\n");
+        return TEST_SAX_MISMATCH;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    ecjp_return_code_t ret, sax_ret, cut_ret;
+    ecjp_check_result_t results;
+    test_events_t events;
+    ecjp_tape_t tape;
+    char *ptr;
+    struct stat strstat;
+    long allocations;
+    size_t len;
+    int i, n;
+    int status = 0;
+
+    // check arguments and open test files
+    if(argc != 2) {
+        usage(argv[0]);
+        return -1;
+    }
+    memset(&strstat, 0, sizeof(struct stat));
+    if (stat(argv[1], &strstat) != 0) {
+        ecjp_fprintf("stat() failed for file %s\n", argv[1]);
+        return -1;
+    }
+    long file_size = strstat.st_size;
+    ptr = (char *)malloc(file_size + 1);
+    if (ptr == NULL) {
+        ecjp_fprint("Memory allocation failed for JSON file\n");
+        return -1;
+    }
+    FILE *f = fopen(argv[1], "r");
+    if (f == NULL) {
+        ecjp_fprintf("Failed to open file %s\n", argv[1]);
+        free(ptr);
+        return -1;
+    }
+    size_t read_bytes = fread(ptr, 1, file_size, f);
+    ptr[read_bytes] = '\0';
+    fclose(f);
+    ecjp_fprintf("\nTesting JSON file (%s) of size %ld bytes:\n", argv[1], file_size);
+    events.event = (test_event_t *)malloc(TEST_MAX_EVENTS * sizeof(test_event_t));
+    events.stop_after = -1;
+    if (events.event == NULL) {
+        ecjp_fprint("Memory allocation failed for the events\n");
+        free(ptr);
+        return -1;
+    }
+
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    results.err_pos = -1;
+#ifdef ECJP_TOKEN_LIST
+    ret = ecjp_check_syntax_2_n(ptr, read_bytes, &results);
+#else
+    ret = ecjp_check_syntax_n(ptr, read_bytes, &results);
+#endif
+
+    status = check_fixed(&events);
+    // same result as the syntax check, without allocations
+    sax_ret = parse(ptr, read_bytes, &events, &allocations);
+    ecjp_fprintf("SAX: ret = %d, %d events, %ld allocations\n", sax_ret, events.count + events.overflow, allocations);
+    if ((status == 0) && ((sax_ret != ret) || (allocations != 0))) {
+        status = TEST_SAX_MISMATCH;
+    }
+    // the events of a valid input are the entries of its tape
+    ecjp_init_tape(&tape);
+    if ((status == 0) && (ret == ECJP_NO_ERROR) && (events.overflow == 0) &&
+        (ecjp_load_tape_n(ptr, read_bytes, &tape, &results) == ECJP_NO_ERROR)) {
+        n = 0;
+        if ((compare_entry(&tape, 0, &events, &n) < 0) || (n != events.count)) {
+            status = TEST_SAX_MISMATCH;
+        }
+        ecjp_fprintf("Events and tape: %s\n", (status == 0) ? "same" : "mismatch");
+    }
+    ecjp_free_tape(&tape);
+    // the input cut at some lengths
+    for (i = 1; (i < 16) && (status == 0); i++) {
+        len = read_bytes * i / 16;
+        memset(&results, 0, sizeof(ecjp_check_result_t));
+#ifdef ECJP_TOKEN_LIST
+        cut_ret = ecjp_check_syntax_2_n(ptr, len, &results);
+#else
+        cut_ret = ecjp_check_syntax_n(ptr, len, &results);
+#endif
+        if (parse(ptr, len, &events, &allocations) != cut_ret) {
+            ecjp_fprintf("Input cut at %zu: SAX and syntax check don't agree\n", len);
+            status = TEST_SAX_MISMATCH;
+        }
+    }
+    free(events.event);
+    free(ptr);
+    if (status != 0) {
+        return status;
+    }
+    return (ret == ECJP_NO_ERROR) ? 0 : -1;
+}
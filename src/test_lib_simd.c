@@ -0,0 +1,128 @@
+#include "ecjp.h"
+
+#include "sys/stat.h"
+#include <unistd.h>
+
+#ifdef ECJP_RUN_ON_PC
+    #define ecjp_fprintf(format, ...)    fprintf(stdout, format, __VA_ARGS__)
+    #define ecjp_fprint(format)          fprintf(stdout, format)
+#else
+    #define ecjp_fprintf(format, ...)
+    #define ecjp_fprint(format)
+#endif
+
+// returned when the kernels don't agree on the result
+#define TEST_KERNEL_MISMATCH        2
+
+const char *kernel_name[ECJP_SIMD_MAX_LEVEL] = {
+    "scalar",
+    "sse2",
+    "avx2",
+    "avx512"
+};
+
+void usage(char *prog_name)
+{
+    ecjp_fprintf("Usage: %s [filename]\n", prog_name);
+}
+
+/*
+ * Parse the input with the current kernel and store the result.
+ * In the key-position implementation the sum of the key positions and lengths is stored too,
+ * to check that all the kernels load the same keys.
+*/
+ecjp_return_code_t parse_with_kernel(const char *input, ecjp_check_result_t *results, unsigned long *keys_checksum)
+{
+    ecjp_return_code_t ret;
+
+    memset(results, 0, sizeof(ecjp_check_result_t));
+    results->err_pos = -1;
+    *keys_checksum = 0;
+#ifdef ECJP_TOKEN_LIST
+    ecjp_item_elem_t *item_list = NULL;
+    ecjp_item_elem_t *item;
+
+    ret = ecjp_load_2(input, &item_list, results);
+    for (item = item_list; item != NULL; item = item->next) {
+        *keys_checksum = (*keys_checksum * 31) + item->item.type + item->item.value_size;
+    }
+    ecjp_free_item_list(&item_list);
+#else
+    ecjp_key_elem_t *key_list = NULL;
+    ecjp_key_elem_t *key;
+
+    ret = ecjp_load(input, &key_list, results, ECJP_MAX_NESTED_LEVEL);
+    for (key = key_list; key != NULL; key = key->next) {
+        *keys_checksum = (*keys_checksum * 31) + key->key.start_pos + key->key.length + key->key.type;
+    }
+    ecjp_free_key_list(&key_list);
+#endif
+    return ret;
+}
+
+int main(int argc, char *argv[])
+{
+    ecjp_return_code_t ret, ref_ret;
+    ecjp_check_result_t results, ref_results;
+    unsigned long checksum, ref_checksum;
+    ecjp_simd_level_t level, best;
+    char *ptr;
+    struct stat strstat;
+    int status = 0;
+
+    // check arguments and open test files
+    if(argc != 2) {
+        usage(argv[0]);
+        return -1;
+    }
+    memset(&strstat, 0, sizeof(struct stat));
+    if (stat(argv[1], &strstat) != 0) {
+        ecjp_fprintf("stat() failed for file %s\n", argv[1]);
+        return -1;
+    }
+    long file_size = strstat.st_size;
+    ptr = (char *)malloc(file_size + 1);
+    if (ptr == NULL) {
+        ecjp_fprint("Memory allocation failed for JSON file\n");
+        return -1;
+    }
+    FILE *f = fopen(argv[1], "r");
+    if (f == NULL) {
+        ecjp_fprintf("Failed to open file %s\n", argv[1]);
+        free(ptr);
+        return -1;
+    }
+    size_t read_bytes = fread(ptr, 1, file_size, f);
+    ptr[read_bytes] = '\0';
+    fclose(f);
+    ecjp_fprintf("\nTesting JSON file (%s) of size %ld bytes:\n", argv[1], file_size);
+
+    best = ecjp_get_simd_level();
+    ecjp_fprintf("Best kernel for this CPU: %s\n", kernel_name[best]);
+
+    // the scalar kernel is the reference
+    ecjp_set_simd_level(ECJP_SIMD_SCALAR);
+    ref_ret = parse_with_kernel(ptr, &ref_results, &ref_checksum);
+    ecjp_fprintf("Kernel %-7s: ret = %d, err_pos = %d, num_keys = %d\n", kernel_name[ECJP_SIMD_SCALAR], ref_ret, ref_results.err_pos, ref_results.num_keys);
+
+    for (level = ECJP_SIMD_SSE2; level < ECJP_SIMD_MAX_LEVEL; level++) {
+        if (ecjp_set_simd_level(level) != ECJP_NO_ERROR) {
+            ecjp_fprintf("Kernel %-7s: not supported, skipped\n", kernel_name[level]);
+            continue;
+        }
+        ret = parse_with_kernel(ptr, &results, &checksum);
+        ecjp_fprintf("Kernel %-7s: ret = %d, err_pos = %d, num_keys = %d\n", kernel_name[level], ret, results.err_pos, results.num_keys);
+        if ((ret != ref_ret) || (results.err_pos != ref_results.err_pos) ||
+            (results.num_keys != ref_results.num_keys) || (checksum != ref_checksum)) {
+            ecjp_fprintf("Kernel %-7s: result differs from the scalar kernel\n", kernel_name[level]);
+            status = TEST_KERNEL_MISMATCH;
+        }
+    }
+    ecjp_set_simd_level(best);
+    free(ptr);
+
+    if (status != 0) {
+        return status;
+    }
+    return (ref_ret == ECJP_NO_ERROR) ? 0 : -1;
+}
@@ -0,0 +1,410 @@
+#include "ecjp.h"
+
+#include "sys/stat.h"
+#include <unistd.h>
+
+#ifdef ECJP_RUN_ON_PC
+    #define ecjp_fprintf(format, ...)    fprintf(stdout, format, __VA_ARGS__)
+    #define ecjp_fprint(format)          fprintf(stdout, format)
+#else
+    #define ecjp_fprintf(format, ...)
+    #define ecjp_fprint(format)
+#endif
+
+// returned when a counter differs from the work done by the parser
+#define TEST_STATS_MISMATCH         2
+
+#ifdef ECJP_RUN_ON_PC
+static const char *const status_name[ECJP_PS_MAX_STATUS] = {
+    "START", "IN_OBJECT", "IN_ARRAY", "IN_KEY", "WAIT_VALUE", "IN_VALUE", "WAIT_COLON", "WAIT_COMMA", "END"
+};
+#endif
+
+void usage(char *prog_name)
+{
+    ecjp_fprintf("Usage: %s [filename]\n", prog_name);
+}
+
+void print_stats(const char *title, const ecjp_stats_t *stats)
+{
+#ifdef ECJP_RUN_ON_PC
+    int i;
+#endif
+
+    ecjp_fprintf("%s: scanned %llu, depth %d, nodes %llu, copied %llu, rescanned %llu, revisited %llu\n", title,
+                 (unsigned long long)stats->bytes_scanned, stats->max_depth, (unsigned long long)stats->nodes_allocated,
+                 (unsigned long long)stats->bytes_copied, (unsigned long long)stats->bytes_rescanned,
+                 (unsigned long long)stats->nodes_revisited);
+#ifdef ECJP_RUN_ON_PC
+    for (i = 0; i < ECJP_PS_MAX_STATUS; i++) {
+        if (stats->transitions[i] != 0) {
+            ecjp_fprintf("    %s: %llu\n", status_name[i], (unsigned long long)stats->transitions[i]);
+        }
+    }
+#endif
+}
+
+/*
+ * Check the syntax of the input without counters: ecjp_get_stats() fails and gives zero counters.
+*/
+ecjp_return_code_t check_syntax(const char *input, size_t len, ecjp_check_result_t *results)
+{
+    memset(results, 0, sizeof(ecjp_check_result_t));
+    results->err_pos = -1;
+#ifdef ECJP_TOKEN_LIST
+    return ecjp_check_syntax_2_n(input, len, results);
+#else
+    return ecjp_check_syntax_n(input, len, results);
+#endif
+}
+
+#ifndef ECJP_STATS
+
+int check_counters(const char *input, size_t len, ecjp_return_code_t *ret)
+{
+    ecjp_check_result_t results;
+    ecjp_stats_t stats, zero;
+
+    *ret = check_syntax(input, len, &results);
+    memset(&zero, 0, sizeof(ecjp_stats_t));
+    memset(&stats, 0xFF, sizeof(ecjp_stats_t));
+    if ((ecjp_get_stats(NULL, &stats) != ECJP_GENERIC_ERROR) || (memcmp(&stats, &zero, sizeof(ecjp_stats_t)) != 0) ||
+        (ecjp_reset_stats(NULL) != ECJP_GENERIC_ERROR) || (ecjp_set_rescan_callback(NULL, 1, NULL) != ECJP_GENERIC_ERROR)) {
+        ecjp_fprint("Counters available without ECJP_STATS\n");
+        return TEST_STATS_MISMATCH;
+    }
+    ecjp_fprint("Library built without ECJP_STATS: no counters\n");
+    return 0;
+}
+
+#else
+
+/*
+ * Check the counters that every parser has in common: each byte of the input is given to the
+ * parser and a valid input has a depth. The parsers with the parse status (not the tape) start
+ * in START and a valid input ends in END.
+*/
+int check_parse(const char *title, const ecjp_stats_t *stats, size_t len, ecjp_return_code_t ret, ecjp_bool_t parse_status)
+{
+    print_stats(title, stats);
+    if (stats->bytes_scanned != len) {
+        ecjp_fprintf("%s: %llu bytes scanned, expected %zu\n", title, (unsigned long long)stats->bytes_scanned, len);
+        return TEST_STATS_MISMATCH;
+    }
+    if (ret != ECJP_NO_ERROR) {
+        return 0;
+    }
+    if ((stats->max_depth < 1) || (stats->max_depth > ECJP_MAX_PARSE_STACK_DEPTH) ||
+        ((parse_status == ECJP_BOOL_TRUE) && ((stats->transitions[ECJP_PS_START] != 1) || (stats->transitions[ECJP_PS_END] != 1)))) {
+        ecjp_fprintf("%s: wrong transitions or depth for a valid input\n", title);
+        return TEST_STATS_MISMATCH;
+    }
+    return 0;
+}
+
+// calls of the quadratic access detector
+typedef struct rescan_report {
+    int             calls;
+    const char      *function;
+    const void      *buffer;
+    uint64_t        revisited;
+    uint64_t        size;
+} rescan_report_t;
+
+void on_rescan(const char *function, const void *buffer, uint64_t revisited, uint64_t size, void *user_data)
+{
+    rescan_report_t *report = (rescan_report_t *)user_data;
+
+    ecjp_fprintf("%s read again %llu times the %llu elements of the list\n", function, (unsigned long long)revisited, (unsigned long long)size);
+    report->calls++;
+    report->function = function;
+    report->buffer = buffer;
+    report->revisited = revisited;
+    report->size = size;
+}
+
+/*
+ * The lookups on a list walk it again from its head: the detector is called once, by the lookup
+ * that reads again more elements than the list has.
+*/
+int check_rescan(const char *function, const void *list, int count, const rescan_report_t *report)
+{
+    ecjp_stats_t stats;
+
+    ecjp_get_stats(NULL, &stats);
+    print_stats(function, &stats);
+    ecjp_set_rescan_callback(NULL, 0, NULL);
+    if (stats.nodes_revisited <= (uint64_t)count) {
+        return (report->calls == 0) ? 0 : TEST_STATS_MISMATCH;
+    }
+    if ((report->calls != 1) || (strcmp(report->function, function) != 0) || (report->buffer != list) ||
+        (report->size != (uint64_t)count) || (report->revisited <= report->size) || (report->revisited > stats.nodes_revisited)) {
+        ecjp_fprintf("%s: detector called %d times, expected once\n", function, report->calls);
+        return TEST_STATS_MISMATCH;
+    }
+    return 0;
+}
+
+#ifdef ECJP_TOKEN_LIST
+
+/*
+ * Load the items with and without a context: each call counts only in its own counters.
+ * Reading the items copies their values.
+*/
+int check_load(const char *input, size_t len, const ecjp_stats_t *syntax)
+{
+    ecjp_ctx_t ctx;
+    ecjp_check_result_t results;
+    ecjp_item_elem_t *item_list = NULL;
+    ecjp_item_token_t *item;
+    ecjp_outdata_t out;
+    ecjp_stats_t stats, ctx_stats;
+    rescan_report_t report;
+    ecjp_return_code_t ret;
+    uint64_t copied = 0;
+    int i, count;
+    int status = 0;
+
+    ecjp_init_ctx(&ctx);
+    ecjp_reset_stats(NULL);
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    ret = ecjp_check_and_load_2_ctx(&ctx, input, len, &item_list, &results);
+    ecjp_get_stats(NULL, &stats);
+    ecjp_get_stats(&ctx, &ctx_stats);
+    status = check_parse("ecjp_check_and_load_2_ctx()", &ctx_stats, len, ret, ECJP_BOOL_TRUE);
+    if ((status == 0) && (stats.bytes_scanned != 0 || stats.nodes_allocated != 0)) {
+        ecjp_fprint("The call with a context counted in the counters of the thread\n");
+        status = TEST_STATS_MISMATCH;
+    }
+    count = ecjp_get_item_count(item_list);
+    if ((status == 0) && (ctx_stats.nodes_allocated != (uint64_t)count)) {
+        ecjp_fprintf("%llu nodes allocated, the list has %d items\n", (unsigned long long)ctx_stats.nodes_allocated, count);
+        status = TEST_STATS_MISMATCH;
+    }
+    if ((status == 0) && (ret == ECJP_NO_ERROR) && (memcmp(ctx_stats.transitions, syntax->transitions, sizeof(syntax->transitions)) != 0)) {
+        ecjp_fprint("The loader and the syntax check count different transitions\n");
+        status = TEST_STATS_MISMATCH;
+    }
+    ecjp_free_item_list(&item_list);
+
+    // the temporary context of ecjp_check_and_load_2_n() counts in the thread
+    if (status == 0) {
+        ecjp_reset_stats(&ctx);
+        ret = ecjp_check_and_load_2_n(input, len, &item_list, &results);
+        ecjp_get_stats(NULL, &stats);
+        ecjp_get_stats(&ctx, &ctx_stats);
+        status = check_parse("ecjp_check_and_load_2_n()", &stats, len, ret, ECJP_BOOL_TRUE);
+        if ((status == 0) && (ctx_stats.bytes_scanned != 0)) {
+            ecjp_fprint("The call without a context counted in the context\n");
+            status = TEST_STATS_MISMATCH;
+        }
+    }
+
+    if ((status == 0) && (ret == ECJP_NO_ERROR)) {
+        ecjp_reset_stats(NULL);
+        out.value = malloc(len + 1);
+        for (i = 0; (out.value != NULL) && (i < ecjp_get_item_count(item_list)); i++) {
+            item = ecjp_get_item_token(item_list, i);
+            out.value_size = len + 1;
+            ecjp_read_element(item_list, i, &out);
+            copied += item->value_size;
+        }
+        free(out.value);
+        ecjp_get_stats(NULL, &stats);
+        print_stats("ecjp_read_element()", &stats);
+        if (stats.bytes_copied != copied) {
+            ecjp_fprintf("%llu bytes copied, expected %llu\n", (unsigned long long)stats.bytes_copied, (unsigned long long)copied);
+            status = TEST_STATS_MISMATCH;
+        }
+    }
+
+    // a key looked up many times walks the list many times
+    if ((status == 0) && (ret == ECJP_NO_ERROR)) {
+        memset(&report, 0, sizeof(rescan_report_t));
+        if (ecjp_set_rescan_callback(on_rescan, 0, &report) != ECJP_GENERIC_ERROR) {
+            ecjp_fprint("Ratio 0 accepted\n");
+            status = TEST_STATS_MISMATCH;
+        }
+        ecjp_reset_stats(NULL);
+        ecjp_set_rescan_callback(on_rescan, 1, &report);
+        out.value = NULL;
+        for (i = 0; i < 3; i++) {
+            ecjp_read_key_2(item_list, "#missing#", 0, &out);
+        }
+        if (status == 0) {
+            status = check_rescan("ecjp_read_key_2", item_list, ecjp_get_item_count(item_list), &report);
+        }
+    }
+    ecjp_free_item_list(&item_list);
+    ecjp_free_ctx(&ctx);
+    return status;
+}
+
+#else
+
+/*
+ * Load all the keys: a node for each key. Reading the keys copies their values and
+ * reads again at least the copied characters.
+*/
+int check_load(const char *input, size_t len, const ecjp_stats_t *syntax)
+{
+    ecjp_check_result_t results;
+    ecjp_key_elem_t *key_list = NULL;
+    ecjp_key_elem_t *current;
+    ecjp_indata_t in;
+    ecjp_outdata_t out;
+    ecjp_stats_t stats;
+    rescan_report_t report;
+    char key[ECJP_MAX_KEY_LEN];
+    int i;
+    ecjp_return_code_t ret;
+    uint64_t copied = 0;
+    int count;
+    int status = 0;
+
+    ecjp_reset_stats(NULL);
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    ret = ecjp_check_and_load_n(input, len, &key_list, &results, ECJP_MAX_PARSE_STACK_DEPTH);
+    ecjp_get_stats(NULL, &stats);
+    status = check_parse("ecjp_check_and_load_n()", &stats, len, ret, ECJP_BOOL_TRUE);
+    count = ecjp_get_key_count(key_list);
+    if ((status == 0) && (stats.nodes_allocated != (uint64_t)count)) {
+        ecjp_fprintf("%llu nodes allocated, the list has %d keys\n", (unsigned long long)stats.nodes_allocated, count);
+        status = TEST_STATS_MISMATCH;
+    }
+    if ((status == 0) && (ret == ECJP_NO_ERROR) && (memcmp(stats.transitions, syntax->transitions, sizeof(syntax->transitions)) != 0)) {
+        ecjp_fprint("The loader and the syntax check count different transitions\n");
+        status = TEST_STATS_MISMATCH;
+    }
+
+    if ((status == 0) && (ret == ECJP_NO_ERROR)) {
+        ecjp_reset_stats(NULL);
+        out.value = malloc(len + 1);
+        for (current = key_list; (out.value != NULL) && (current != NULL); current = current->next) {
+            memset(&in, 0, sizeof(ecjp_indata_t));
+            in.pos = current->key.start_pos;
+            in.length = current->key.length;
+            in.type = current->key.type;
+            memset(out.value, 0, len + 1);
+            out.value_size = len + 1;
+            if (ecjp_read_key_n(input, len, &in, &out) == ECJP_NO_ERROR) {
+                copied += strlen((char *)out.value);
+            }
+        }
+        free(out.value);
+        ecjp_get_stats(NULL, &stats);
+        print_stats("ecjp_read_key_n()", &stats);
+        if ((stats.bytes_copied != copied) || (stats.bytes_rescanned < copied) || (stats.bytes_scanned != 0)) {
+            ecjp_fprintf("%llu bytes copied and %llu read again, expected %llu\n", (unsigned long long)stats.bytes_copied,
+                         (unsigned long long)stats.bytes_rescanned, (unsigned long long)copied);
+            status = TEST_STATS_MISMATCH;
+        }
+    }
+
+    // each call of ecjp_get_key() walks the list from its head to the last key found
+    if ((status == 0) && (ret == ECJP_NO_ERROR) && (key_list != NULL)) {
+        memset(&report, 0, sizeof(rescan_report_t));
+        ecjp_reset_stats(NULL);
+        ecjp_set_rescan_callback(on_rescan, 1, &report);
+        memset(&out, 0, sizeof(ecjp_outdata_t));
+        out.value = key;
+        out.value_size = sizeof(key);
+        // the positions of the keys can repeat when they wrap around: the calls are bounded
+        for (i = 0; (i <= count) && (ecjp_get_key(input, NULL, &key_list, (i == 0) ? 0 : out.last_pos, &out) == ECJP_NO_ERROR); i++);
+        status = check_rescan("ecjp_get_key", key_list, count, &report);
+    }
+    ecjp_free_key_list(&key_list);
+    return status;
+}
+
+#endif // ECJP_TOKEN_LIST
+
+/*
+ * Count the work of the syntax check, of the loader and of the tape.
+*/
+int check_counters(const char *input, size_t len, ecjp_return_code_t *ret)
+{
+    ecjp_check_result_t results;
+    ecjp_stats_t syntax, stats;
+    ecjp_tape_t tape;
+    ecjp_return_code_t tape_ret;
+    int status;
+
+    if (ecjp_get_stats(NULL, NULL) != ECJP_NULL_POINTER) {
+        ecjp_fprint("NULL pointer accepted\n");
+        return TEST_STATS_MISMATCH;
+    }
+    ecjp_reset_stats(NULL);
+    *ret = check_syntax(input, len, &results);
+    ecjp_get_stats(NULL, &syntax);
+    status = check_parse("syntax check", &syntax, len, *ret, ECJP_BOOL_TRUE);
+    if ((status == 0) && ((syntax.nodes_allocated != 0) || (syntax.bytes_copied != 0) || (syntax.bytes_rescanned != 0))) {
+        ecjp_fprint("The syntax check allocated or copied\n");
+        status = TEST_STATS_MISMATCH;
+    }
+    if (status == 0) {
+        status = check_load(input, len, &syntax);
+    }
+    if (status == 0) {
+        ecjp_reset_stats(NULL);
+        ecjp_init_tape(&tape);
+        memset(&results, 0, sizeof(ecjp_check_result_t));
+        tape_ret = ecjp_load_tape_n(input, len, &tape, &results);
+        ecjp_get_stats(NULL, &stats);
+        status = check_parse("ecjp_load_tape_n()", &stats, len, tape_ret, ECJP_BOOL_FALSE);
+        if ((status == 0) && (stats.nodes_allocated != (uint64_t)tape.count)) {
+            ecjp_fprintf("%llu nodes allocated, the tape has %d entries\n", (unsigned long long)stats.nodes_allocated, tape.count);
+            status = TEST_STATS_MISMATCH;
+        }
+        if ((status == 0) && (tape_ret == ECJP_NO_ERROR) && (stats.max_depth != syntax.max_depth)) {
+            ecjp_fprintf("Depth %d of the tape, %d of the syntax check\n", stats.max_depth, syntax.max_depth);
+            status = TEST_STATS_MISMATCH;
+        }
+        ecjp_free_tape(&tape);
+    }
+    return status;
+}
+
+#endif // ECJP_STATS
+
+int main(int argc, char *argv[])
+{
+    ecjp_return_code_t ret;
+    char *ptr;
+    struct stat strstat;
+    int status = 0;
+
+    // check arguments and open test files
+    if(argc != 2) {
+        usage(argv[0]);
+        return -1;
+    }
+    memset(&strstat, 0, sizeof(struct stat));
+    if (stat(argv[1], &strstat) != 0) {
+        ecjp_fprintf("stat() failed for file %s\n", argv[1]);
+        return -1;
+    }
+    long file_size = strstat.st_size;
+    ptr = (char *)malloc(file_size + 1);
+    if (ptr == NULL) {
+        ecjp_fprint("Memory allocation failed for JSON file\n");
+        return -1;
+    }
+    FILE *f = fopen(argv[1], "r");
+    if (f == NULL) {
+        ecjp_fprintf("Failed to open file %s\n", argv[1]);
+        free(ptr);
+        return -1;
+    }
+    size_t read_bytes = fread(ptr, 1, file_size, f);
+    ptr[read_bytes] = '\0';
+    fclose(f);
+    ecjp_fprintf("\nTesting JSON file (%s) of size %ld bytes:\n", argv[1], file_size);
+
+    status = check_counters(ptr, read_bytes, &ret);
+    free(ptr);
+    if (status != 0) {
+        return status;
+    }
+    return (ret == ECJP_NO_ERROR) ? 0 : -1;
+}
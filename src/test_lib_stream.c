@@ -0,0 +1,143 @@
+#include "ecjp.h"
+
+#include "sys/stat.h"
+#include <unistd.h>
+
+#ifdef ECJP_RUN_ON_PC
+    #define ecjp_fprintf(format, ...)    fprintf(stdout, format, __VA_ARGS__)
+    #define ecjp_fprint(format)          fprintf(stdout, format)
+#else
+    #define ecjp_fprintf(format, ...)
+    #define ecjp_fprint(format)
+#endif
+
+// returned when the stream doesn't agree with ecjp_load_tape_n()
+#define TEST_STREAM_MISMATCH        2
+
+void usage(char *prog_name)
+{
+    ecjp_fprintf("Usage: %s [filename]\n", prog_name);
+}
+
+/*
+ * Parse the input with a stream, in chunks of chunk_size characters (the whole input if 0).
+ * Each chunk is copied in its own buffer, released after ecjp_stream_feed().
+*/
+ecjp_return_code_t stream_input(const char *input, size_t len, size_t chunk_size, ecjp_tape_t *tape, ecjp_check_result_t *res)
+{
+    ecjp_stream_t *stream;
+    ecjp_return_code_t ret = ECJP_NO_ERROR;
+    char *chunk;
+    size_t pos, n;
+
+    stream = (ecjp_stream_t *)malloc(sizeof(ecjp_stream_t));
+    if (stream == NULL) {
+        return ECJP_GENERIC_ERROR;
+    }
+    ecjp_stream_init(stream, tape);
+    if (chunk_size == 0) {
+        chunk_size = (len > 0) ? len : 1;
+    }
+    for (pos = 0; (pos < len) && (ret == ECJP_NO_ERROR); pos += n) {
+        n = (len - pos < chunk_size) ? (len - pos) : chunk_size;
+        chunk = (char *)malloc(n);
+        if (chunk == NULL) {
+            free(stream);
+            return ECJP_GENERIC_ERROR;
+        }
+        memcpy(chunk, &input[pos], n);
+        ret = ecjp_stream_feed(stream, chunk, n);
+        free(chunk);
+    }
+    ret = ecjp_stream_finish(stream, res);
+    free(stream);
+    return ret;
+}
+
+/*
+ * Check that the stream returns the same result and the same tape of ecjp_load_tape_n(),
+ * with and without the tape.
+*/
+int check_stream(const char *input, size_t len, size_t chunk_size, ecjp_return_code_t ret_ref, ecjp_check_result_t *res_ref, ecjp_tape_t *tape_ref)
+{
+    ecjp_return_code_t ret, ret_no_tape;
+    ecjp_check_result_t res, res_no_tape;
+    ecjp_tape_t tape;
+    int i;
+    int status = 0;
+
+    ecjp_init_tape(&tape);
+    ret = stream_input(input, len, chunk_size, &tape, &res);
+    ret_no_tape = stream_input(input, len, chunk_size, NULL, &res_no_tape);
+    if ((ret != ret_ref) || (ret_no_tape != ret_ref) || (res.err_pos != res_ref->err_pos) || (res_no_tape.err_pos != res_ref->err_pos)) {
+        ecjp_fprintf("Chunks of %d: ret = %d/%d, err_pos = %d/%d, expected ret = %d, err_pos = %d\n", (int)chunk_size,
+                     ret, ret_no_tape, res.err_pos, res_no_tape.err_pos, ret_ref, res_ref->err_pos);
+        status = TEST_STREAM_MISMATCH;
+    } else if ((ret == ECJP_NO_ERROR) &&
+               ((tape.count != tape_ref->count) || (res.num_keys != res_ref->num_keys) || (res.struct_type != res_ref->struct_type))) {
+        ecjp_fprintf("Chunks of %d: %d entries, %d keys, expected %d entries, %d keys\n", (int)chunk_size,
+                     tape.count, res.num_keys, tape_ref->count, res_ref->num_keys);
+        status = TEST_STREAM_MISMATCH;
+    }
+    for (i = 0; (ret == ECJP_NO_ERROR) && (status == 0) && (i < tape.count); i++) {
+        if ((tape.entry[i].pos != tape_ref->entry[i].pos) || (tape.entry[i].length != tape_ref->entry[i].length) ||
+            (tape.entry[i].next != tape_ref->entry[i].next) || (tape.entry[i].type != tape_ref->entry[i].type)) {
+            ecjp_fprintf("Chunks of %d: entry %d is different\n", (int)chunk_size, i);
+            status = TEST_STREAM_MISMATCH;
+        }
+    }
+    ecjp_free_tape(&tape);
+    return status;
+}
+
+int main(int argc, char *argv[])
+{
+    const size_t chunk_sizes[] = { 1, 2, 3, 5, 7, 63, 64, 65, 1000, 0 };
+    ecjp_return_code_t ret;
+    ecjp_check_result_t results;
+    ecjp_tape_t tape;
+    char *ptr;
+    struct stat strstat;
+    int i;
+    int status = 0;
+
+    // check arguments and open test files
+    if(argc != 2) {
+        usage(argv[0]);
+        return -1;
+    }
+    memset(&strstat, 0, sizeof(struct stat));
+    if (stat(argv[1], &strstat) != 0) {
+        ecjp_fprintf("stat() failed for file %s\n", argv[1]);
+        return -1;
+    }
+    long file_size = strstat.st_size;
+    ptr = (char *)malloc(file_size + 1);
+    if (ptr == NULL) {
+        ecjp_fprint("Memory allocation failed for JSON file\n");
+        return -1;
+    }
+    FILE *f = fopen(argv[1], "r");
+    if (f == NULL) {
+        ecjp_fprintf("Failed to open file %s\n", argv[1]);
+        free(ptr);
+        return -1;
+    }
+    size_t read_bytes = fread(ptr, 1, file_size, f);
+    ptr[read_bytes] = '\0';
+    fclose(f);
+    ecjp_fprintf("\nTesting JSON file (%s) of size %ld bytes:\n", argv[1], file_size);
+
+    ecjp_init_tape(&tape);
+    ret = ecjp_load_tape_n(ptr, read_bytes, &tape, &results);
+    ecjp_fprintf("ecjp_load_tape_n(): ret = %d, entries = %d, err_pos = %d\n", ret, tape.count, results.err_pos);
+    for (i = 0; (i < (int)(sizeof(chunk_sizes) / sizeof(chunk_sizes[0]))) && (status == 0); i++) {
+        status = check_stream(ptr, read_bytes, chunk_sizes[i], ret, &results, &tape);
+    }
+    ecjp_free_tape(&tape);
+    free(ptr);
+    if (status != 0) {
+        return status;
+    }
+    return (ret == ECJP_NO_ERROR) ? 0 : -1;
+}
@@ -0,0 +1,423 @@
+#include "ecjp.h"
+
+#include "sys/stat.h"
+#include <unistd.h>
+#include <ctype.h>
+
+#ifdef ECJP_RUN_ON_PC
+    #define ecjp_fprintf(format, ...)    fprintf(stdout, format, __VA_ARGS__)
+    #define ecjp_fprint(format)          fprintf(stdout, format)
+#else
+    #define ecjp_fprintf(format, ...)
+    #define ecjp_fprint(format)
+#endif
+
+// returned when a string is decoded differently from the reference decoder
+#define TEST_STRING_MISMATCH        2
+// strings generated for each kernel
+#define TEST_NUM_GENERATED          2000
+// maximum length of a string (encoded)
+#define TEST_MAX_STRING_LEN         512
+
+typedef struct test_string {
+    const char          *input;         // characters after the opening quote
+    const char          *expected;      // decoded string, NULL if not valid
+    size_t              expected_len;
+    size_t              raw_len;
+} test_string_t;
+
+static const test_string_t fixed_strings[] = {
+    { "\"", "", 0, 0 },
+    { "abc\"", "abc", 3, 3 },
+    { "a\\\"b\\\\c\\/d\"", "a\"b\\c/d", 7, 10 },
+    { "\\b\\f\\n\\r\\t\"", "\b\f\n\r\t", 5, 10 },
+    { "tab\tin\"", "tab\tin", 6, 6 },
+    { "\\u0041\\u00e8\\u20AC\"", "A\xC3\xA8\xE2\x82\xAC", 6, 18 },
+    { "\\uD83D\\uDE00!\"", "\xF0\x9F\x98\x80!", 5, 13 },
+    { "\\uD83D!\"", "\xEF\xBF\xBD!", 4, 7 },
+    { "\\uDE00\\uD83D\"", "\xEF\xBF\xBD\xEF\xBF\xBD", 6, 12 },
+    { "\\uD83D\\u0041\"", "\xEF\xBF\xBD" "A", 4, 12 },
+    { "a\\u0000b\"", "a\0b", 3, 8 },
+    { "\xC3\xA8 UTF-8\"", "\xC3\xA8 UTF-8", 8, 8 },
+    { "bad \\x escape\"", NULL, 0, 0 },
+    { "bad \\u12G4\"", NULL, 0, 0 },
+    { "short \\u12", NULL, 0, 0 },
+    { "ends with \\", NULL, 0, 0 },
+    { "ctrl \x01 char\"", NULL, 0, 0 },
+    { "del \x7F char\"", NULL, 0, 0 },
+    { NULL, NULL, 0, 0 }
+};
+
+void usage(char *prog_name)
+{
+    ecjp_fprintf("Usage: %s [filename]\n", prog_name);
+}
+
+/*
+ * Reference decoder: one character at a time.
+ * Returns the number of characters read, or -1 if the string is not valid.
+*/
+long reference_decode(const char *input, size_t len, char *out, size_t *out_len)
+{
+    unsigned long cp, low;
+    size_t i = 0;
+    size_t w = 0;
+    int k;
+
+    while ((i < len) && (input[i] != '"')) {
+        if (input[i] == '\\') {
+            if (i + 1 >= len) {
+                return -1;
+            }
+            switch (input[i + 1]) {
+                case '"': case '\\': case '/': out[w++] = input[i + 1]; i += 2; continue;
+                case 'b': out[w++] = '\b'; i += 2; continue;
+                case 'f': out[w++] = '\f'; i += 2; continue;
+                case 'n': out[w++] = '\n'; i += 2; continue;
+                case 'r': out[w++] = '\r'; i += 2; continue;
+                case 't': out[w++] = '\t'; i += 2; continue;
+                case 'u': break;
+                default: return -1;
+            }
+            if ((i + 6 > len) || (sscanf(&input[i + 2], "%4lx", &cp) != 1)) {
+                return -1;
+            }
+            for (k = 2; k < 6; k++) {
+                if (!isxdigit((unsigned char)input[i + k])) {
+                    return -1;
+                }
+            }
+            i += 6;
+            if ((cp >= 0xD800) && (cp <= 0xDBFF)) {
+                if ((i + 6 <= len) && (input[i] == '\\') && (input[i + 1] == 'u') &&
+                    isxdigit((unsigned char)input[i + 2]) && isxdigit((unsigned char)input[i + 3]) &&
+                    isxdigit((unsigned char)input[i + 4]) && isxdigit((unsigned char)input[i + 5]) &&
+                    (sscanf(&input[i + 2], "%4lx", &low) == 1) && (low >= 0xDC00) && (low <= 0xDFFF)) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    i += 6;
+                } else {
+                    cp = 0xFFFD;
+                }
+            } else if ((cp >= 0xDC00) && (cp <= 0xDFFF)) {
+                cp = 0xFFFD;
+            }
+            if (cp < 0x80) {
+                out[w++] = (char)cp;
+            } else if (cp < 0x800) {
+                out[w++] = (char)(0xC0 | (cp >> 6));
+                out[w++] = (char)(0x80 | (cp & 0x3F));
+            } else if (cp < 0x10000) {
+                out[w++] = (char)(0xE0 | (cp >> 12));
+                out[w++] = (char)(0x80 | ((cp >> 6) & 0x3F));
+                out[w++] = (char)(0x80 | (cp & 0x3F));
+            } else {
+                out[w++] = (char)(0xF0 | (cp >> 18));
+                out[w++] = (char)(0x80 | ((cp >> 12) & 0x3F));
+                out[w++] = (char)(0x80 | ((cp >> 6) & 0x3F));
+                out[w++] = (char)(0x80 | (cp & 0x3F));
+            }
+        } else if ((((unsigned char)input[i] < 0x20) && (input[i] != '\t') && (input[i] != '\n') && (input[i] != '\r')) ||
+                   (input[i] == 0x7F)) {
+            return -1;
+        } else {
+            out[w++] = input[i++];
+        }
+    }
+    *out_len = w;
+    return (long)i;
+}
+
+/*
+ * Decode the string with ecjp_read_string() and compare it with the reference decoder:
+ * with a buffer large enough, with a buffer one byte too small and without a buffer.
+*/
+int check_string(const char *input, size_t len)
+{
+    char expected[TEST_MAX_STRING_LEN * 2];
+    char buffer[TEST_MAX_STRING_LEN * 2];
+    ecjp_string_t string;
+    ecjp_return_code_t ret;
+    size_t expected_len = 0;
+    long raw_len;
+
+    raw_len = reference_decode(input, len, expected, &expected_len);
+    ret = ecjp_read_string(input, len, buffer, sizeof(buffer), &string);
+    if (raw_len < 0) {
+        if (ret != ECJP_SYNTAX_ERROR) {
+            ecjp_fprintf("String '%.*s' not valid, ret = %d\n", (int)len, input, ret);
+            return TEST_STRING_MISMATCH;
+        }
+        return 0;
+    }
+    if ((ret != ECJP_NO_ERROR) || (string.ptr != buffer) || (string.len != expected_len) ||
+        (string.raw_len != (size_t)raw_len) || (memcmp(string.ptr, expected, expected_len) != 0) ||
+        (buffer[expected_len] != '\0')) {
+        ecjp_fprintf("String '%.*s': ret = %d, len = %zu, expected %zu\n", (int)len, input, ret, string.len, expected_len);
+        return TEST_STRING_MISMATCH;
+    }
+    // the length needed is returned when the buffer is too small
+    ret = ecjp_read_string(input, len, buffer, expected_len, &string);
+    if ((ret != ECJP_NO_SPACE_IN_BUFFER_VALUE) || (string.len != expected_len)) {
+        ecjp_fprintf("String '%.*s': ret = %d with a small buffer\n", (int)len, input, ret);
+        return TEST_STRING_MISMATCH;
+    }
+    // without buffer a string without escapes is the input itself
+    ret = ecjp_read_string(input, len, NULL, 0, &string);
+    if (string.escaped == ECJP_BOOL_FALSE) {
+        if ((ret != ECJP_NO_ERROR) || (string.ptr != input) || (string.len != expected_len) ||
+            (memchr(input, '\\', string.raw_len) != NULL)) {
+            ecjp_fprintf("String '%.*s': no zero-copy view, ret = %d\n", (int)len, input, ret);
+            return TEST_STRING_MISMATCH;
+        }
+    } else if ((ret != ECJP_NO_SPACE_IN_BUFFER_VALUE) || (string.len != expected_len)) {
+        ecjp_fprintf("String '%.*s': ret = %d without buffer\n", (int)len, input, ret);
+        return TEST_STRING_MISMATCH;
+    }
+    return 0;
+}
+
+/*
+ * Decode the fixed strings and check the invalid inputs.
+*/
+int check_fixed(void)
+{
+    char buffer[TEST_MAX_STRING_LEN];
+    ecjp_string_t string;
+    ecjp_return_code_t ret;
+    int i;
+
+    for (i = 0; fixed_strings[i].input != NULL; i++) {
+        ret = ecjp_read_string(fixed_strings[i].input, strlen(fixed_strings[i].input), buffer, sizeof(buffer), &string);
+        if (fixed_strings[i].expected == NULL) {
+            if (ret != ECJP_SYNTAX_ERROR) {
+                ecjp_fprintf("String '%s' accepted\n", fixed_strings[i].input);
+                return TEST_STRING_MISMATCH;
+            }
+        } else if ((ret != ECJP_NO_ERROR) || (string.len != fixed_strings[i].expected_len) ||
+                   (string.raw_len != fixed_strings[i].raw_len) ||
+                   (memcmp(string.ptr, fixed_strings[i].expected, string.len) != 0)) {
+            ecjp_fprintf("String '%s': ret = %d, len = %zu\n", fixed_strings[i].input, ret, string.len);
+            return TEST_STRING_MISMATCH;
+        }
+        if (check_string(fixed_strings[i].input, strlen(fixed_strings[i].input)) != 0) {
+            return TEST_STRING_MISMATCH;
+        }
+    }
+    if ((ecjp_read_string(NULL, 1, buffer, sizeof(buffer), &string) != ECJP_NULL_POINTER) ||
+        (ecjp_read_string("a", 1, buffer, sizeof(buffer), NULL) != ECJP_NULL_POINTER)) {
+        ecjp_fprint("NULL pointer accepted\n");
+        return TEST_STRING_MISMATCH;
+    }
+    return 0;
+}
+
+/*
+ * Generate strings with a fixed seed: runs of plain characters (also UTF-8 and tabs) of any
+ * length, with escape sequences at every offset of the blocks of the kernels.
+*/
+int check_generated(void)
+{
+    static const char plain[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 !#$%&'()*+,-.:;<=>?@[]^_`{|}~";
+    static const char *escapes[] = { "\\\"", "\\\\", "\\/", "\\n", "\\t", "\\u00e8", "\\u20ac", "\\ud83d\\ude00", "\\udc00", "\t" };
+    char text[TEST_MAX_STRING_LEN + 16];
+    unsigned long seed = 12345;
+    size_t n, run;
+    int i, k;
+
+    for (i = 0; i < TEST_NUM_GENERATED; i++) {
+        n = 0;
+        seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+        while (n < TEST_MAX_STRING_LEN - 64) {
+            seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+            run = (seed >> 33) % ((i % 4 == 0) ? 80 : 40);
+            for (k = 0; (k < (int)run) && (n < TEST_MAX_STRING_LEN - 64); k++) {
+                seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+                text[n++] = ((seed >> 60) == 0) ? (char)(0x80 | ((seed >> 40) & 0x3F)) : plain[(seed >> 33) % (sizeof(plain) - 1)];
+            }
+            if ((seed >> 58) == 0) {
+                break;
+            }
+            strcpy(&text[n], escapes[(seed >> 20) % (sizeof(escapes) / sizeof(escapes[0]))]);
+            n += strlen(&text[n]);
+        }
+        // a few strings are cut or have a wrong character
+        if (i % 50 == 1) {
+            text[(seed >> 8) % (n + 1)] = '\x1F';
+        }
+        text[n] = '"';
+        if (check_string(text, (i % 7 == 3) ? n : (n + 1)) != 0) {
+            return TEST_STRING_MISMATCH;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Run the generated strings with every kernel supported by the CPU and by the build.
+*/
+int check_kernels(void)
+{
+    ecjp_simd_level_t level, saved;
+    int status = 0;
+
+    saved = ecjp_get_simd_level();
+    for (level = ECJP_SIMD_SCALAR; (level < ECJP_SIMD_MAX_LEVEL) && (status == 0); level++) {
+        if (ecjp_set_simd_level(level) == ECJP_NO_ERROR) {
+            status = check_generated();
+            ecjp_fprintf("Kernel %d: %s\n", level, (status == 0) ? "ok" : "mismatch");
+        }
+    }
+    ecjp_set_simd_level(saved);
+    return status;
+}
+
+/*
+ * Decode every string (and key) of the tape of the document.
+*/
+int check_tape(const char *input, size_t len)
+{
+    ecjp_check_result_t results;
+    ecjp_tape_t tape;
+    ecjp_value_view_t view;
+    ecjp_string_t string;
+    char *buffer;
+    int i, count;
+    int status = 0;
+
+    buffer = (char *)malloc(len + 1);
+    if (buffer == NULL) {
+        return -1;
+    }
+    ecjp_init_tape(&tape);
+    if (ecjp_load_tape_n(input, len, &tape, &results) == ECJP_NO_ERROR) {
+        count = 0;
+        for (i = 0; (i < tape.count) && (status == 0); i++) {
+            if ((tape.entry[i].type == ECJP_TYPE_STRING) || (tape.entry[i].type == ECJP_TYPE_KEY)) {
+                ecjp_tape_view(&tape, input, i, &view);
+                if ((view.len < TEST_MAX_STRING_LEN) && (check_string(view.ptr, view.len) != 0)) {
+                    status = TEST_STRING_MISMATCH;
+                }
+                // the closing quote ends the string
+                if ((status == 0) && ((ecjp_read_string(view.ptr, len - (view.ptr - input), buffer, len + 1, &string) != ECJP_NO_ERROR) ||
+                                      (string.raw_len != view.len))) {
+                    ecjp_fprintf("Tape entry %d: string not decoded\n", i);
+                    status = TEST_STRING_MISMATCH;
+                }
+                count++;
+            }
+        }
+        ecjp_fprintf("Tape: %d strings decoded\n", count);
+    }
+    ecjp_free_tape(&tape);
+    free(buffer);
+    return status;
+}
+
+#ifndef ECJP_TOKEN_LIST
+/*
+ * Read the strings of every key with the typed readers and check that they agree
+ * with the decoding of the view of the value.
+*/
+int check_keys(const char *input, size_t len, ecjp_key_elem_t *key_list)
+{
+    char buffer[TEST_MAX_STRING_LEN * 2];
+    char expected[TEST_MAX_STRING_LEN * 2];
+    ecjp_key_elem_t *current;
+    ecjp_indata_t in;
+    ecjp_value_view_t view;
+    ecjp_string_t string, other;
+
+    for (current = key_list; current != NULL; current = current->next) {
+        memset(&in, 0, sizeof(ecjp_indata_t));
+        in.pos = current->key.start_pos;
+        in.length = current->key.length;
+        in.type = current->key.type;
+        if (in.type == ECJP_TYPE_STRING) {
+            if ((ecjp_read_key_view(input, &in, &view) != ECJP_NO_ERROR) || (view.len >= TEST_MAX_STRING_LEN)) {
+                continue;
+            }
+            if ((ecjp_read_string(view.ptr, view.len, expected, sizeof(expected), &other) != ECJP_NO_ERROR) ||
+                (ecjp_read_key_string(input, &in, buffer, sizeof(buffer), &string) != ECJP_NO_ERROR) ||
+                (string.len != other.len) || (string.raw_len != view.len) || (memcmp(buffer, expected, other.len) != 0) ||
+                (ecjp_read_key_string_n(input, len, &in, buffer, sizeof(buffer), &string) != ECJP_NO_ERROR) ||
+                (string.len != other.len) || (memcmp(buffer, expected, other.len) != 0)) {
+                ecjp_fprintf("Key at %d: string not decoded\n", in.pos);
+                return TEST_STRING_MISMATCH;
+            }
+        } else if ((in.type != ECJP_TYPE_UNDEFINED) && (ecjp_read_key_string(input, &in, buffer, sizeof(buffer), &string) != ECJP_SYNTAX_ERROR)) {
+            ecjp_fprintf("Key at %d: value of type %s decoded as a string\n", in.pos, ecjp_type[in.type]);
+            return TEST_STRING_MISMATCH;
+        }
+    }
+    return 0;
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+    ecjp_return_code_t ret;
+    ecjp_check_result_t results;
+    char *ptr;
+    struct stat strstat;
+    int status = 0;
+#ifndef ECJP_TOKEN_LIST
+    ecjp_key_elem_t *key_list = NULL;
+    ecjp_tape_t tape;
+#endif
+
+    // check arguments and open test files
+    if(argc != 2) {
+        usage(argv[0]);
+        return -1;
+    }
+    memset(&strstat, 0, sizeof(struct stat));
+    if (stat(argv[1], &strstat) != 0) {
+        ecjp_fprintf("stat() failed for file %s\n", argv[1]);
+        return -1;
+    }
+    long file_size = strstat.st_size;
+    ptr = (char *)malloc(file_size + 1);
+    if (ptr == NULL) {
+        ecjp_fprint("Memory allocation failed for JSON file\n");
+        return -1;
+    }
+    FILE *f = fopen(argv[1], "r");
+    if (f == NULL) {
+        ecjp_fprintf("Failed to open file %s\n", argv[1]);
+        free(ptr);
+        return -1;
+    }
+    size_t read_bytes = fread(ptr, 1, file_size, f);
+    ptr[read_bytes] = '\0';
+    fclose(f);
+    ecjp_fprintf("\nTesting JSON file (%s) of size %ld bytes:\n", argv[1], file_size);
+
+    status = check_fixed();
+    if (status == 0) {
+        status = check_kernels();
+    }
+    if (status == 0) {
+        status = check_tape(ptr, read_bytes);
+    }
+
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    results.err_pos = -1;
+#ifdef ECJP_TOKEN_LIST
+    ret = ecjp_check_syntax_2(ptr, &results);
+#else
+    ret = ecjp_check_and_load(ptr, &key_list, &results, ECJP_MAX_NESTED_LEVEL);
+    // the typed readers need the strings checked by the tape
+    ecjp_init_tape(&tape);
+    if ((status == 0) && (ret == ECJP_NO_ERROR) && (read_bytes <= (ECJP_TYPE_POS_KEY)(-1)) &&
+        (ecjp_load_tape_n(ptr, read_bytes, &tape, &results) == ECJP_NO_ERROR)) {
+        status = check_keys(ptr, read_bytes, key_list);
+    }
+    ecjp_free_tape(&tape);
+    ecjp_free_key_list(&key_list);
+#endif
+    free(ptr);
+    if (status != 0) {
+        return status;
+    }
+    return (ret == ECJP_NO_ERROR) ? 0 : -1;
+}
@@ -0,0 +1,171 @@
+#include "ecjp.h"
+
+#include "sys/stat.h"
+#include <unistd.h>
+
+#ifdef ECJP_RUN_ON_PC
+    #define ecjp_fprintf(format, ...)    fprintf(stdout, format, __VA_ARGS__)
+    #define ecjp_fprint(format)          fprintf(stdout, format)
+#else
+    #define ecjp_fprintf(format, ...)
+    #define ecjp_fprint(format)
+#endif
+
+// returned when the tape is not consistent with the input or with the syntax check
+#define TEST_TAPE_MISMATCH          2
+
+void usage(char *prog_name)
+{
+    ecjp_fprintf("Usage: %s [filename]\n", prog_name);
+}
+
+/*
+ * Check the entries of the container at index i and of all the nested containers:
+ * brackets at both ends, keys followed by a value in objects, children that end
+ * exactly where the container ends. The function returns the index of the next entry.
+*/
+int check_container(const char *input, const ecjp_tape_t *tape, int i, int *status)
+{
+    const ecjp_tape_entry_t *c = &tape->entry[i];
+    char open = (c->type == ECJP_TYPE_OBJECT) ? '{' : '[';
+    char close = (c->type == ECJP_TYPE_OBJECT) ? '}' : ']';
+    int j, n, found;
+
+    if ((input[c->pos] != open) || (input[c->pos + c->length - 1] != close) || (c->next <= i) || (c->next > tape->count)) {
+        ecjp_fprintf("Entry %d: wrong container (pos %u, length %u, next %d)\n", i, c->pos, c->length, c->next);
+        *status = TEST_TAPE_MISMATCH;
+        return tape->count;
+    }
+    n = 0;
+    j = i + 1;
+    while ((j < c->next) && (*status == 0)) {
+        if (c->type == ECJP_TYPE_OBJECT) {
+            if ((tape->entry[j].type != ECJP_TYPE_KEY) || (input[tape->entry[j].pos - 1] != '"')) {
+                ecjp_fprintf("Entry %d: key expected\n", j);
+                *status = TEST_TAPE_MISMATCH;
+                break;
+            }
+            j++;
+        } else if ((ecjp_tape_get_element(tape, i, n, &found) != ECJP_NO_ERROR) || (found != j)) {
+            ecjp_fprintf("Entry %d: element %d of array %d not found\n", j, n, i);
+            *status = TEST_TAPE_MISMATCH;
+            break;
+        }
+        if ((tape->entry[j].type == ECJP_TYPE_OBJECT) || (tape->entry[j].type == ECJP_TYPE_ARRAY)) {
+            j = check_container(input, tape, j, status);
+        } else {
+            j = tape->entry[j].next;
+        }
+        n++;
+    }
+    if ((*status == 0) && (j != c->next)) {
+        ecjp_fprintf("Entry %d: content ends at %d, expected %d\n", i, j, c->next);
+        *status = TEST_TAPE_MISMATCH;
+    }
+    return c->next;
+}
+
+/*
+ * Check that every key of every object is found by name in its object,
+ * skipping the keys that have a duplicate before them.
+*/
+int check_keys(const char *input, const ecjp_tape_t *tape)
+{
+    const ecjp_tape_entry_t *k;
+    char name[ECJP_MAX_KEY_LEN];
+    int parent[ECJP_MAX_PARSE_STACK_DEPTH];
+    int top = -1;
+    int i, found;
+
+    for (i = 0; i < tape->count; i++) {
+        while ((top >= 0) && (i >= tape->entry[parent[top]].next)) {
+            top--;
+        }
+        k = &tape->entry[i];
+        if ((k->type == ECJP_TYPE_KEY) && (top >= 0) && (k->length < ECJP_MAX_KEY_LEN)) {
+            memcpy(name, &input[k->pos], k->length);
+            name[k->length] = '\0';
+            if ((strlen(name) == k->length) &&
+                ((ecjp_tape_find_key(tape, input, parent[top], name, &found) != ECJP_NO_ERROR) ||
+                 (tape->entry[found - 1].length != k->length) ||
+                 (memcmp(&input[tape->entry[found - 1].pos], name, k->length) != 0) || (found - 1 > i))) {
+                ecjp_fprintf("Key '%s' at entry %d not found in object %d\n", name, i, parent[top]);
+                return TEST_TAPE_MISMATCH;
+            }
+        }
+        if ((k->type == ECJP_TYPE_OBJECT) || (k->type == ECJP_TYPE_ARRAY)) {
+            parent[++top] = i;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    ecjp_return_code_t ret, ret_check;
+    ecjp_check_result_t results, results_check;
+    ecjp_tape_t tape;
+    char *ptr;
+    struct stat strstat;
+    int status = 0;
+
+    // check arguments and open test files
+    if(argc != 2) {
+        usage(argv[0]);
+        return -1;
+    }
+    memset(&strstat, 0, sizeof(struct stat));
+    if (stat(argv[1], &strstat) != 0) {
+        ecjp_fprintf("stat() failed for file %s\n", argv[1]);
+        return -1;
+    }
+    long file_size = strstat.st_size;
+    ptr = (char *)malloc(file_size + 1);
+    if (ptr == NULL) {
+        ecjp_fprint("Memory allocation failed for JSON file\n");
+        return -1;
+    }
+    FILE *f = fopen(argv[1], "r");
+    if (f == NULL) {
+        ecjp_fprintf("Failed to open file %s\n", argv[1]);
+        free(ptr);
+        return -1;
+    }
+    size_t read_bytes = fread(ptr, 1, file_size, f);
+    ptr[read_bytes] = '\0';
+    fclose(f);
+    ecjp_fprintf("\nTesting JSON file (%s) of size %ld bytes:\n", argv[1], file_size);
+
+    ecjp_init_tape(&tape);
+    ret = ecjp_load_tape(ptr, &tape, &results);
+    ecjp_fprintf("ecjp_load_tape(): ret = %d, entries = %d, keys = %d, err_pos = %d\n", ret, tape.count, results.num_keys, results.err_pos);
+
+    // the tape doesn't accept a document rejected by the syntax check
+    // (the tape is stricter: e.g. it rejects numbers as "4." or "1-")
+    memset(&results_check, 0, sizeof(ecjp_check_result_t));
+    results_check.err_pos = -1;
+#ifdef ECJP_TOKEN_LIST
+    ret_check = ecjp_check_syntax_2(ptr, &results_check);
+#else
+    ret_check = ecjp_check_syntax(ptr, &results_check);
+#endif
+    if ((ret == ECJP_NO_ERROR) && (ret_check != ECJP_NO_ERROR)) {
+        ecjp_fprintf("Syntax check returns %d, tape returns %d\n", ret_check, ret);
+        status = TEST_TAPE_MISMATCH;
+    }
+    if ((status == 0) && (ret == ECJP_NO_ERROR)) {
+        if ((results.struct_type != results_check.struct_type) || (check_container(ptr, &tape, 0, &status) != tape.count)) {
+            ecjp_fprint("Root structure doesn't cover the whole tape\n");
+            status = TEST_TAPE_MISMATCH;
+        }
+        if (status == 0) {
+            status = check_keys(ptr, &tape);
+        }
+    }
+    ecjp_free_tape(&tape);
+    free(ptr);
+    if (status != 0) {
+        return status;
+    }
+    return (ret == ECJP_NO_ERROR) ? 0 : -1;
+}
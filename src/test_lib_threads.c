@@ -0,0 +1,312 @@
+#include "ecjp.h"
+
+#include "sys/stat.h"
+#include <unistd.h>
+#include <pthread.h>
+
+#ifdef ECJP_RUN_ON_PC
+    #define ecjp_fprintf(format, ...)    fprintf(stdout, format, __VA_ARGS__)
+    #define ecjp_fprint(format)          fprintf(stdout, format)
+#else
+    #define ecjp_fprintf(format, ...)
+    #define ecjp_fprint(format)
+#endif
+
+// returned when a thread finds results different from the single thread parsing
+#define TEST_THREADS_MISMATCH       2
+// number of threads parsing the same input at the same time
+#define TEST_NUM_THREADS            32
+// number of times each thread parses the input
+#define TEST_NUM_RUNS               2
+// size of the chunks given to the stream
+#define TEST_CHUNK_SIZE             61
+// maximum number of values collected by run_parser()
+#define TEST_MAX_VALUES             24
+// number of lookups of the same path, read again by the quadratic access detector
+#define TEST_NUM_LOOKUPS            8
+
+// paths of the projection shared by the threads
+static const char *const projection_paths[] = { "", "/0", "/1/0", "[2]", "/a", "/a/b" };
+static ecjp_projection_t projection;
+
+typedef struct test_summary {
+    long                value[TEST_MAX_VALUES];
+    int                 count;
+} test_summary_t;
+
+typedef struct test_thread {
+    pthread_t           thread;
+    const char          *input;
+    size_t              len;
+    const test_summary_t *expected;
+    int                 status;
+} test_thread_t;
+
+void usage(char *prog_name)
+{
+    ecjp_fprintf("Usage: %s [filename]\n", prog_name);
+}
+
+void add_value(test_summary_t *summary, long value)
+{
+    if (summary->count < TEST_MAX_VALUES) {
+        summary->value[summary->count++] = value;
+    }
+}
+
+/*
+ * Callback of the quadratic access detector: count the calls in the thread's counter.
+*/
+void count_rescan(const char *function, const void *buffer, uint64_t revisited, uint64_t size, void *user_data)
+{
+    (void)function;
+    (void)buffer;
+    (void)revisited;
+    (void)size;
+    (*(long *)user_data)++;
+}
+
+/*
+ * Add the counters of the context (of the thread if ctx is NULL): zero if the library
+ * is built without ECJP_STATS.
+*/
+void add_stats(test_summary_t *summary, const ecjp_ctx_t *ctx)
+{
+    ecjp_stats_t stats;
+
+    ecjp_get_stats(ctx, &stats);
+    add_value(summary, (long)stats.bytes_scanned);
+    add_value(summary, (long)stats.nodes_allocated);
+    add_value(summary, stats.max_depth);
+}
+
+/*
+ * Parse the input with the functions of the library, all the state is in local objects
+ * (and in the context of the thread): collect the return codes, the number of elements
+ * found, a checksum of their positions, the counters of the thread and of the context and
+ * the calls of the detector of the thread.
+*/
+void run_parser(ecjp_ctx_t *ctx, const char *input, size_t len, test_summary_t *summary)
+{
+    ecjp_check_result_t results;
+    ecjp_tape_t tape;
+    ecjp_stream_t stream;
+    ecjp_value_view_t views[sizeof(projection_paths) / sizeof(projection_paths[0])];
+    ecjp_return_code_t ret;
+    size_t pos, n;
+    long total, rescans = 0;
+    int i, num_documents;
+#ifdef ECJP_TOKEN_LIST
+    ecjp_item_elem_t *item_list = NULL;
+    ecjp_item_token_t *item;
+#else
+    ecjp_key_elem_t *key_list = NULL;
+    ecjp_key_elem_t *current;
+    ecjp_key_index_t key_index;
+#endif
+
+    memset(summary, 0, sizeof(test_summary_t));
+    ecjp_reset_stats(NULL);
+    ecjp_reset_stats(ctx);
+    // each thread has its own detector
+    ecjp_set_rescan_callback(count_rescan, 1, &rescans);
+
+    ecjp_init_tape(&tape);
+    ret = ecjp_load_tape_n(input, len, &tape, &results);
+    add_value(summary, ret);
+    add_value(summary, (ret == ECJP_NO_ERROR) ? tape.count : 0);
+    ecjp_free_tape(&tape);
+
+    ecjp_stream_init(&stream, NULL);
+    for (pos = 0; pos < len; pos += n) {
+        n = (len - pos < TEST_CHUNK_SIZE) ? (len - pos) : TEST_CHUNK_SIZE;
+        ecjp_stream_feed(&stream, &input[pos], n);
+    }
+    add_value(summary, ecjp_stream_finish(&stream, &results));
+
+    add_value(summary, ecjp_check_documents_n(input, len, NULL, NULL, &num_documents));
+    add_value(summary, num_documents);
+
+    add_value(summary, ecjp_project(&projection, input, len, views));
+    total = 0;
+    for (i = 0; i < (int)(sizeof(projection_paths) / sizeof(projection_paths[0])); i++) {
+        total += (views[i].ptr != NULL) ? ((views[i].ptr - input) + views[i].len + views[i].type) : -1;
+    }
+    add_value(summary, total);
+
+    for (i = 0; i < TEST_NUM_LOOKUPS; i++) {
+        ecjp_query(input, len, "/1/0", &views[0]);
+    }
+
+#ifdef ECJP_TOKEN_LIST
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    add_value(summary, ecjp_check_syntax_2_n(input, len, &results));
+
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    ret = ecjp_check_and_load_2_ctx(ctx, input, len, &item_list, &results);
+    add_value(summary, ret);
+    total = 0;
+    for (i = 0; (item = ecjp_get_item_token(item_list, i)) != NULL; i++) {
+        total += item->value_size + item->type;
+    }
+    add_value(summary, i);
+    add_value(summary, total);
+    ecjp_free_item_list(&item_list);
+
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    ret = ecjp_check_and_load_2_arena_n(input, len, &item_list, &results);
+    add_value(summary, ret);
+    add_value(summary, ecjp_get_item_count(item_list));
+    ecjp_free_item_list(&item_list);
+#else
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    add_value(summary, ecjp_check_syntax_n(input, len, &results));
+
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    ret = ecjp_check_and_load_ctx(ctx, input, len, &key_list, &results, ECJP_MAX_NESTED_LEVEL);
+    add_value(summary, ret);
+    total = 0;
+    i = 0;
+    for (current = key_list; current != NULL; current = current->next) {
+        total += current->key.start_pos + current->key.length + current->key.type;
+        i++;
+    }
+    add_value(summary, i);
+    add_value(summary, total);
+    ecjp_free_key_list(&key_list);
+
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    ecjp_init_key_index(&key_index, ECJP_DUP_FIRST_WINS);
+    add_value(summary, ecjp_check_and_load_indexed_n(input, len, &key_list, &key_index, &results, ECJP_MAX_NESTED_LEVEL));
+    add_value(summary, key_index.count);
+    ecjp_free_key_list(&key_list);
+    ecjp_free_key_index(&key_index);
+#endif
+    add_stats(summary, NULL);
+    add_stats(summary, ctx);
+    ecjp_set_rescan_callback(NULL, 0, NULL);
+    add_value(summary, rescans);
+}
+
+int same_summary(const test_summary_t *a, const test_summary_t *b)
+{
+    return (a->count == b->count) && (memcmp(a->value, b->value, a->count * sizeof(long)) == 0);
+}
+
+void *parse_thread(void *arg)
+{
+    test_thread_t *t = (test_thread_t *)arg;
+    test_summary_t summary;
+    ecjp_ctx_t ctx;
+    int run;
+
+    // each thread has its own context, reused by all its runs
+    ecjp_init_ctx(&ctx);
+    for (run = 0; (run < TEST_NUM_RUNS) && (t->status == 0); run++) {
+        run_parser(&ctx, t->input, t->len, &summary);
+        if (!same_summary(&summary, t->expected)) {
+            t->status = TEST_THREADS_MISMATCH;
+        }
+    }
+    ecjp_free_ctx(&ctx);
+    return NULL;
+}
+
+/*
+ * Parse the input from TEST_NUM_THREADS threads at the same time and check that
+ * every thread finds the results of the single thread parsing.
+*/
+int check_threads(const char *name, const char *input, size_t len, const test_summary_t *expected)
+{
+    test_thread_t t[TEST_NUM_THREADS];
+    int i, started;
+    int status = 0;
+
+    for (started = 0; started < TEST_NUM_THREADS; started++) {
+        t[started].input = input;
+        t[started].len = len;
+        t[started].expected = expected;
+        t[started].status = 0;
+        if (pthread_create(&t[started].thread, NULL, parse_thread, &t[started]) != 0) {
+            ecjp_fprintf("%s: failed to start thread %d\n", name, started);
+            status = -1;
+            break;
+        }
+    }
+    for (i = 0; i < started; i++) {
+        pthread_join(t[i].thread, NULL);
+        if ((t[i].status != 0) && (status == 0)) {
+            ecjp_fprintf("%s: thread %d found different results\n", name, i);
+            status = t[i].status;
+        }
+    }
+    return status;
+}
+
+int main(int argc, char *argv[])
+{
+    ecjp_return_code_t ret;
+    ecjp_check_result_t results;
+    test_summary_t expected;
+    ecjp_ctx_t ctx;
+    char *ptr;
+    struct stat strstat;
+    int status = 0;
+
+    // check arguments and open test files
+    if(argc != 2) {
+        usage(argv[0]);
+        return -1;
+    }
+    memset(&strstat, 0, sizeof(struct stat));
+    if (stat(argv[1], &strstat) != 0) {
+        ecjp_fprintf("stat() failed for file %s\n", argv[1]);
+        return -1;
+    }
+    long file_size = strstat.st_size;
+    ptr = (char *)malloc(file_size + 1);
+    if (ptr == NULL) {
+        ecjp_fprint("Memory allocation failed for JSON file\n");
+        return -1;
+    }
+    FILE *f = fopen(argv[1], "r");
+    if (f == NULL) {
+        ecjp_fprintf("Failed to open file %s\n", argv[1]);
+        free(ptr);
+        return -1;
+    }
+    size_t read_bytes = fread(ptr, 1, file_size, f);
+    ptr[read_bytes] = '\0';
+    fclose(f);
+    ecjp_fprintf("\nTesting JSON file (%s) of size %ld bytes:\n", argv[1], file_size);
+
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    results.err_pos = -1;
+#ifdef ECJP_TOKEN_LIST
+    ret = ecjp_check_syntax_2(ptr, &results);
+#else
+    ret = ecjp_check_syntax(ptr, &results);
+#endif
+
+    // the configuration is set and the projection compiled before the threads start
+    ecjp_get_simd_level();
+    ecjp_projection_compile(&projection, projection_paths, sizeof(projection_paths) / sizeof(projection_paths[0]));
+    ecjp_init_ctx(&ctx);
+    run_parser(&ctx, ptr, read_bytes, &expected);
+    ecjp_free_ctx(&ctx);
+
+    status = check_threads("Default allocator", ptr, read_bytes, &expected);
+#ifdef ECJP_RUN_ON_PC
+    if (status == 0) {
+        ecjp_set_allocator(&ecjp_thread_cache_allocator);
+        status = check_threads("Thread cache allocator", ptr, read_bytes, &expected);
+        ecjp_set_allocator(NULL);
+    }
+#endif
+    ecjp_free_projection(&projection);
+    free(ptr);
+    if (status != 0) {
+        return status;
+    }
+    return (ret == ECJP_NO_ERROR) ? 0 : -1;
+}
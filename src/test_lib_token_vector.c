@@ -0,0 +1,127 @@
+#include "ecjp.h"
+
+#include "sys/stat.h"
+#include <unistd.h>
+
+#ifdef ECJP_RUN_ON_PC
+    #define ecjp_fprintf(format, ...)    fprintf(stdout, format, __VA_ARGS__)
+    #define ecjp_fprint(format)          fprintf(stdout, format)
+#else
+    #define ecjp_fprintf(format, ...)
+    #define ecjp_fprint(format)
+#endif
+
+// returned when the list view and the indexed access don't agree
+#define TEST_VECTOR_MISMATCH        2
+
+void usage(char *prog_name)
+{
+    ecjp_fprintf("Usage: %s [filename]\n", prog_name);
+}
+
+/*
+ * Load the input and check that walking the list with the next pointer
+ * gives the same tokens, in the same order, as the indexed access.
+*/
+int check_vector(const char *input, ecjp_return_code_t *ret)
+{
+    ecjp_check_result_t results;
+    int count, index;
+
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    results.err_pos = -1;
+#ifdef ECJP_TOKEN_LIST
+    ecjp_item_elem_t *item_list = NULL;
+    ecjp_item_elem_t *item;
+    ecjp_item_token_t *token;
+
+    *ret = ecjp_load_2(input, &item_list, &results);
+    count = ecjp_get_item_count(item_list);
+    index = 0;
+    for (item = item_list; item != NULL; item = item->next) {
+        token = ecjp_get_item_token(item_list, index);
+        if ((token != &item->item) || (token->type != item->item.type)) {
+            ecjp_fprintf("Item %d: indexed access differs from the list\n", index);
+            ecjp_free_item_list(&item_list);
+            return TEST_VECTOR_MISMATCH;
+        }
+        index++;
+    }
+    if ((ecjp_get_item_token(item_list, index) != NULL) || (ecjp_get_item_token(item_list, -1) != NULL)) {
+        ecjp_fprint("Item out of bounds returned\n");
+        ecjp_free_item_list(&item_list);
+        return TEST_VECTOR_MISMATCH;
+    }
+    ecjp_free_item_list(&item_list);
+#else
+    ecjp_key_elem_t *key_list = NULL;
+    ecjp_key_elem_t *key;
+    ecjp_key_token_t *token;
+
+    *ret = ecjp_load(input, &key_list, &results, ECJP_MAX_NESTED_LEVEL);
+    count = ecjp_get_key_count(key_list);
+    index = 0;
+    for (key = key_list; key != NULL; key = key->next) {
+        token = ecjp_get_key_token(key_list, index);
+        if ((token != &key->key) || (token->start_pos != key->key.start_pos)) {
+            ecjp_fprintf("Key %d: indexed access differs from the list\n", index);
+            ecjp_free_key_list(&key_list);
+            return TEST_VECTOR_MISMATCH;
+        }
+        index++;
+    }
+    if ((ecjp_get_key_token(key_list, index) != NULL) || (ecjp_get_key_token(key_list, -1) != NULL)) {
+        ecjp_fprint("Key out of bounds returned\n");
+        ecjp_free_key_list(&key_list);
+        return TEST_VECTOR_MISMATCH;
+    }
+    ecjp_free_key_list(&key_list);
+#endif
+    ecjp_fprintf("ret = %d, num_keys = %d, elements in the list = %d, elements in the vector = %d\n", *ret, results.num_keys, index, count);
+    if (index != count) {
+        return TEST_VECTOR_MISMATCH;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    ecjp_return_code_t ret;
+    char *ptr;
+    struct stat strstat;
+    int status;
+
+    // check arguments and open test files
+    if(argc != 2) {
+        usage(argv[0]);
+        return -1;
+    }
+    memset(&strstat, 0, sizeof(struct stat));
+    if (stat(argv[1], &strstat) != 0) {
+        ecjp_fprintf("stat() failed for file %s\n", argv[1]);
+        return -1;
+    }
+    long file_size = strstat.st_size;
+    ptr = (char *)malloc(file_size + 1);
+    if (ptr == NULL) {
+        ecjp_fprint("Memory allocation failed for JSON file\n");
+        return -1;
+    }
+    FILE *f = fopen(argv[1], "r");
+    if (f == NULL) {
+        ecjp_fprintf("Failed to open file %s\n", argv[1]);
+        free(ptr);
+        return -1;
+    }
+    size_t read_bytes = fread(ptr, 1, file_size, f);
+    ptr[read_bytes] = '\0';
+    fclose(f);
+    ecjp_fprintf("\nTesting JSON file (%s) of size %ld bytes:\n", argv[1], file_size);
+
+    status = check_vector(ptr, &ret);
+    free(ptr);
+    if (status != 0) {
+        return status;
+    }
+    return (ret == ECJP_NO_ERROR) ? 0 : -1;
+}
@@ -0,0 +1,312 @@
+#include "ecjp.h"
+
+#include "sys/stat.h"
+#include <unistd.h>
+
+#ifdef ECJP_RUN_ON_PC
+    #define ecjp_fprintf(format, ...)    fprintf(stdout, format, __VA_ARGS__)
+    #define ecjp_fprint(format)          fprintf(stdout, format)
+#else
+    #define ecjp_fprintf(format, ...)
+    #define ecjp_fprint(format)
+#endif
+
+// returned when the validation differs from the reference validator
+#define TEST_UTF8_MISMATCH          2
+// documents generated for each kernel
+#define TEST_NUM_GENERATED          3000
+// maximum length of a generated document
+#define TEST_MAX_DOC_LEN            600
+
+typedef struct test_utf8 {
+    const char          *bytes;         // content of a string value
+    int                 err_offset;     // offset of the first invalid sequence, -1 if valid
+} test_utf8_t;
+
+static const test_utf8_t fixed_utf8[] = {
+    { "plain ASCII", -1 },
+    { "\xC3\xA8 \xE2\x82\xAC \xF0\x9F\x98\x80 \xF4\x8F\xBF\xBF \xEF\xBF\xBF \xED\x9F\xBF", -1 },
+    { "ab\x80", 2 },                    // continuation without lead
+    { "\xC0\xAF", 0 },                  // overlong 2 bytes
+    { "\xC1\xBF", 0 },
+    { "\xE0\x80\xAF", 0 },              // overlong 3 bytes
+    { "\xE0\x9F\xBF", 0 },
+    { "\xF0\x80\x80\xAF", 0 },          // overlong 4 bytes
+    { "\xF0\x8F\xBF\xBF", 0 },
+    { "x\xED\xA0\x80", 1 },             // surrogates
+    { "x\xED\xBF\xBF", 1 },
+    { "\xF4\x90\x80\x80", 0 },          // above U+10FFFF
+    { "\xF5\x80\x80\x80", 0 },
+    { "\xFF", 0 },
+    { "\xC3", 0 },                      // truncated
+    { "\xE2\x82", 0 },
+    { "\xF0\x9F\x98", 0 },
+    { "\xE2\x82\xAC\xAC", 3 },          // one continuation too many
+    { "\xC3\xA8\xC3", 2 },
+    { NULL, 0 }
+};
+
+void usage(char *prog_name)
+{
+    ecjp_fprintf("Usage: %s [filename]\n", prog_name);
+}
+
+/*
+ * Reference validator: decode each sequence and check the range of its code point.
+ * Returns the position of the first invalid sequence, -1 if the input is valid.
+*/
+int reference_error(const unsigned char *s, int len)
+{
+    unsigned long cp, min;
+    int i = 0;
+    int k, n;
+
+    while (i < len) {
+        if (s[i] < 0x80) {
+            i++;
+            continue;
+        }
+        if ((s[i] & 0xE0) == 0xC0) {
+            n = 2; cp = s[i] & 0x1F; min = 0x80;
+        } else if ((s[i] & 0xF0) == 0xE0) {
+            n = 3; cp = s[i] & 0x0F; min = 0x800;
+        } else if ((s[i] & 0xF8) == 0xF0) {
+            n = 4; cp = s[i] & 0x07; min = 0x10000;
+        } else {
+            return i;
+        }
+        for (k = 1; k < n; k++) {
+            if ((i + k >= len) || ((s[i + k] & 0xC0) != 0x80)) {
+                return i;
+            }
+            cp = (cp << 6) | (s[i + k] & 0x3F);
+        }
+        if ((cp < min) || (cp > 0x10FFFF) || ((cp >= 0xD800) && (cp <= 0xDFFF))) {
+            return i;
+        }
+        i += n;
+    }
+    return -1;
+}
+
+/*
+ * Check the document with all the functions that validate the input with the settings of ctx:
+ * they must refuse it at expected_pos (-1 if valid).
+*/
+int check_doc(ecjp_ctx_t *ctx, const char *input, size_t len, int expected_pos)
+{
+    ecjp_check_result_t results;
+    ecjp_return_code_t ret, expected;
+    ecjp_tape_t tape;
+#ifdef ECJP_TOKEN_LIST
+    ecjp_item_elem_t *list = NULL;
+#else
+    ecjp_key_elem_t *list = NULL;
+#endif
+
+    expected = (expected_pos < 0) ? ECJP_NO_ERROR : ECJP_SYNTAX_ERROR;
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    results.err_pos = -1;
+#ifdef ECJP_TOKEN_LIST
+    ret = ecjp_check_syntax_2_ctx(ctx, input, len, &results);
+#else
+    ret = ecjp_check_syntax_ctx(ctx, input, len, &results);
+#endif
+    if ((ret != expected) || ((expected_pos >= 0) && (results.err_pos != expected_pos))) {
+        ecjp_fprintf("Check syntax: ret = %d, err_pos = %d, expected %d at %d\n", ret, results.err_pos, expected, expected_pos);
+        return TEST_UTF8_MISMATCH;
+    }
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    results.err_pos = -1;
+    ecjp_init_tape(&tape);
+    ret = ecjp_load_tape_ctx(ctx, input, len, &tape, &results);
+    ecjp_free_tape(&tape);
+    if ((ret != expected) || ((expected_pos >= 0) && (results.err_pos != expected_pos))) {
+        ecjp_fprintf("Tape: ret = %d, err_pos = %d, expected %d at %d\n", ret, results.err_pos, expected, expected_pos);
+        return TEST_UTF8_MISMATCH;
+    }
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    results.err_pos = -1;
+#ifdef ECJP_TOKEN_LIST
+    ret = ecjp_check_and_load_2_ctx(ctx, input, len, &list, &results);
+    ecjp_free_item_list(&list);
+#else
+    ret = ecjp_check_and_load_ctx(ctx, input, len, &list, &results, 0);
+    ecjp_free_key_list(&list);
+#endif
+    if ((ret != expected) || ((expected_pos >= 0) && (results.err_pos != expected_pos))) {
+        ecjp_fprintf("Check and load: ret = %d, err_pos = %d, expected %d at %d\n", ret, results.err_pos, expected, expected_pos);
+        return TEST_UTF8_MISMATCH;
+    }
+    return 0;
+}
+
+/*
+ * Check the fixed sequences in a string value, at every offset from a block boundary.
+*/
+int check_fixed(ecjp_ctx_t *ctx)
+{
+    char doc[TEST_MAX_DOC_LEN];
+    int i, pad, n, len;
+
+    for (i = 0; fixed_utf8[i].bytes != NULL; i++) {
+        if (reference_error((const unsigned char *)fixed_utf8[i].bytes, strlen(fixed_utf8[i].bytes)) != fixed_utf8[i].err_offset) {
+            ecjp_fprintf("Reference validator wrong for sequence #%d\n", i);
+            return TEST_UTF8_MISMATCH;
+        }
+        for (pad = 0; pad < 70; pad++) {
+            n = sprintf(doc, "{\"k\":\"%*s", pad, "");
+            len = n + sprintf(&doc[n], "%s\"}", fixed_utf8[i].bytes);
+            if (check_doc(ctx, doc, len, (fixed_utf8[i].err_offset < 0) ? -1 : (n + fixed_utf8[i].err_offset)) != 0) {
+                ecjp_fprintf("Sequence #%d at offset %d\n", i, n);
+                return TEST_UTF8_MISMATCH;
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ * Generate documents with a fixed seed: string values made of characters of 1 to 4 bytes,
+ * some with a random byte changed, so that the errors fall at every offset of the blocks.
+*/
+int check_generated(ecjp_ctx_t *ctx)
+{
+    static const char *chars[] = { "a", " ", "\xC3\xA8", "\xDF\xBF", "\xE2\x82\xAC", "\xEF\xBF\xBD", "\xED\x9F\xBF",
+                                   "\xE0\xA0\x80", "\xF0\x9F\x98\x80", "\xF0\x90\x80\x80", "\xF4\x8F\xBF\xBF" };
+    char doc[TEST_MAX_DOC_LEN + 16];
+    unsigned long seed = 12345;
+    int i, n, start, end, pos;
+
+    for (i = 0; i < TEST_NUM_GENERATED; i++) {
+        n = sprintf(doc, "{\"key\":[1,\"");
+        start = n;
+        seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+        end = start + 1 + (int)((seed >> 33) % (TEST_MAX_DOC_LEN - 32));
+        while (n < end) {
+            seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+            n += sprintf(&doc[n], "%s", chars[(seed >> 33) % (sizeof(chars) / sizeof(chars[0]))]);
+        }
+        // half of the documents have a byte changed (never a quote, backslash or control character)
+        if (i % 2 == 1) {
+            seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+            pos = start + (int)((seed >> 33) % (n - start));
+            doc[pos] = (char)(0x80 | ((seed >> 20) & 0x7F));
+        }
+        pos = reference_error((const unsigned char *)&doc[start], n - start);
+        n += sprintf(&doc[n], "\",true]}");
+        if (check_doc(ctx, doc, n, (pos < 0) ? -1 : (start + pos)) != 0) {
+            return TEST_UTF8_MISMATCH;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Run the checks with every kernel supported by the CPU and by the build.
+*/
+int check_kernels(ecjp_ctx_t *ctx)
+{
+    ecjp_simd_level_t level, saved;
+    int status = 0;
+
+    saved = ecjp_get_simd_level();
+    for (level = ECJP_SIMD_SCALAR; (level < ECJP_SIMD_MAX_LEVEL) && (status == 0); level++) {
+        if (ecjp_set_simd_level(level) == ECJP_NO_ERROR) {
+            status = check_fixed(ctx);
+            if (status == 0) {
+                status = check_generated(ctx);
+            }
+            ecjp_fprintf("Kernel %d: %s\n", level, (status == 0) ? "ok" : "mismatch");
+        }
+    }
+    ecjp_set_simd_level(saved);
+    return status;
+}
+
+int main(int argc, char *argv[])
+{
+    ecjp_return_code_t ret, strict_ret;
+    ecjp_check_result_t results;
+    ecjp_ctx_t ctx;
+    char *ptr;
+    struct stat strstat;
+    int expected_pos;
+    int status = 0;
+
+    // check arguments and open test files
+    if(argc != 2) {
+        usage(argv[0]);
+        return -1;
+    }
+    memset(&strstat, 0, sizeof(struct stat));
+    if (stat(argv[1], &strstat) != 0) {
+        ecjp_fprintf("stat() failed for file %s\n", argv[1]);
+        return -1;
+    }
+    long file_size = strstat.st_size;
+    ptr = (char *)malloc(file_size + 1);
+    if (ptr == NULL) {
+        ecjp_fprint("Memory allocation failed for JSON file\n");
+        return -1;
+    }
+    FILE *f = fopen(argv[1], "r");
+    if (f == NULL) {
+        ecjp_fprintf("Failed to open file %s\n", argv[1]);
+        free(ptr);
+        return -1;
+    }
+    size_t read_bytes = fread(ptr, 1, file_size, f);
+    ptr[read_bytes] = '\0';
+    fclose(f);
+    ecjp_fprintf("\nTesting JSON file (%s) of size %ld bytes:\n", argv[1], file_size);
+
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    results.err_pos = -1;
+#ifdef ECJP_TOKEN_LIST
+    ret = ecjp_check_syntax_2(ptr, &results);
+#else
+    ret = ecjp_check_syntax(ptr, &results);
+#endif
+
+    // the validation is disabled by default
+    ecjp_init_ctx(&ctx);
+    if (ctx.utf8_validation != ECJP_BOOL_FALSE) {
+        ecjp_fprint("UTF-8 validation enabled by default\n");
+        status = TEST_UTF8_MISMATCH;
+    }
+    ctx.utf8_validation = ECJP_BOOL_TRUE;
+    // a valid document is refused only if it's not valid UTF-8
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    results.err_pos = -1;
+#ifdef ECJP_TOKEN_LIST
+    strict_ret = ecjp_check_syntax_2_ctx(&ctx, ptr, read_bytes, &results);
+#else
+    strict_ret = ecjp_check_syntax_ctx(&ctx, ptr, read_bytes, &results);
+#endif
+    expected_pos = reference_error((const unsigned char *)ptr, (int)read_bytes);
+    ecjp_fprintf("Strict UTF-8: ret = %d, err_pos = %d\n", strict_ret, results.err_pos);
+    if ((status == 0) && (ret == ECJP_NO_ERROR) &&
+        ((strict_ret != ((expected_pos < 0) ? ECJP_NO_ERROR : ECJP_SYNTAX_ERROR)) || ((expected_pos >= 0) && (results.err_pos != expected_pos)))) {
+        ecjp_fprintf("Strict UTF-8: expected error at %d\n", expected_pos);
+        status = TEST_UTF8_MISMATCH;
+    }
+    if ((status == 0) && (ret != ECJP_NO_ERROR) && (strict_ret == ECJP_NO_ERROR)) {
+        ecjp_fprint("Strict UTF-8: invalid document accepted\n");
+        status = TEST_UTF8_MISMATCH;
+    }
+    if (status == 0) {
+        status = check_kernels(&ctx);
+    }
+    ctx.utf8_validation = ECJP_BOOL_FALSE;
+    // without validation only the syntax is checked
+    if ((status == 0) && (check_doc(&ctx, "{\"k\":\"\xC0\xAF\"}", 10, -1) != 0)) {
+        status = TEST_UTF8_MISMATCH;
+    }
+    ecjp_free_ctx(&ctx);
+    free(ptr);
+    if (status != 0) {
+        return status;
+    }
+    return (ret == ECJP_NO_ERROR) ? 0 : -1;
+}
@@ -0,0 +1,286 @@
+#include "ecjp.h"
+
+#include "sys/stat.h"
+#include <unistd.h>
+
+#ifdef ECJP_RUN_ON_PC
+    #define ecjp_fprintf(format, ...)    fprintf(stdout, format, __VA_ARGS__)
+    #define ecjp_fprint(format)          fprintf(stdout, format)
+#else
+    #define ecjp_fprintf(format, ...)
+    #define ecjp_fprint(format)
+#endif
+
+#ifdef ECJP_TOKEN_LIST
+
+int main(int argc, char *argv[])
+{
+    ecjp_fprint("This example is for key list implementation. Compile without ECJP_TOKEN_LIST defined.\n");
+    return -1;
+}
+
+#else
+
+// returned when a view doesn't agree with the copied value
+#define TEST_VIEW_MISMATCH          2
+
+static const char fixed_doc[] =
+    "{\"a\": \"}\", \"b\": {\"c\": \"}{\\\"]\", \"d\": [\"]\", {\"e\": \"[\"}, \"x\\\\\"]}, \"f\": [[1, \"]]\"], 2]}";
+
+void usage(char *prog_name)
+{
+    ecjp_fprintf("Usage: %s [filename]\n", prog_name);
+}
+
+/*
+ * Check that the view points to the same characters copied in out.
+*/
+int same_value(ecjp_value_view_t *view, ecjp_outdata_t *out)
+{
+    return (view->type == out->type) && (view->len == strlen((char *)out->value)) &&
+           (memcmp(view->ptr, out->value, view->len) == 0);
+}
+
+/*
+ * Read every element of the array with ecjp_read_array_element() and check that
+ * ecjp_read_array_element_view_n() finds the same element without copying it.
+*/
+int check_array_view(const char *array, size_t len, unsigned int value_size)
+{
+    ecjp_value_view_t view;
+    ecjp_outdata_t out;
+    char *copy;
+    int index = 0;
+    int status = 0;
+
+    copy = (char *)malloc(len + 1);
+    out.value = malloc(value_size);
+    if ((copy == NULL) || (out.value == NULL)) {
+        ecjp_fprint("Memory allocation failed for array element value buffer\n");
+        free(copy);
+        free(out.value);
+        return -1;
+    }
+    // the view variant doesn't need the terminator, the copy variant does
+    memcpy(copy, array, len);
+    copy[len] = '\0';
+    out.value_size = value_size;
+    while ((status == 0) && (ecjp_read_array_element(copy, index, &out) == ECJP_NO_ERROR)) {
+        if ((ecjp_read_array_element_view_n(array, len, index, &view) != ECJP_NO_ERROR) || !same_value(&view, &out)) {
+            ecjp_fprintf("Element #%d: view '%.*s', expected '%s'\n", index, (int)view.len, view.ptr, (char *)out.value);
+            status = TEST_VIEW_MISMATCH;
+        }
+        index++;
+    }
+    if ((status == 0) && (ecjp_read_array_element_view_n(array, len, index, &view) == ECJP_NO_ERROR)) {
+        ecjp_fprintf("Element #%d found only by the view\n", index);
+        status = TEST_VIEW_MISMATCH;
+    }
+    free(copy);
+    free(out.value);
+    return status;
+}
+
+/*
+ * Read the value of every key with ecjp_read_key() and check that ecjp_read_key_view()
+ * finds the same value without copying it, also when the value doesn't fit in a small buffer.
+*/
+int check_key_view(const char *input, ecjp_key_elem_t *key_list, unsigned int value_size)
+{
+    ecjp_key_elem_t *current;
+    ecjp_indata_t in;
+    ecjp_outdata_t out;
+    ecjp_value_view_t view;
+    ecjp_return_code_t ret, ret_view;
+    char small[2];
+    void *buffer;
+    int status = 0;
+
+    out.value = malloc(value_size);
+    if (out.value == NULL) {
+        ecjp_fprint("Memory allocation failed for key value buffer\n");
+        return -1;
+    }
+    for (current = key_list; (current != NULL) && (status == 0); current = current->next) {
+        memset(&in, 0, sizeof(ecjp_indata_t));
+        in.pos = current->key.start_pos;
+        in.length = current->key.length;
+        in.type = current->key.type;
+        memset(out.value, 0, value_size);
+        out.value_size = value_size;
+        ret = ecjp_read_key(input, &in, &out);
+        ret_view = ecjp_read_key_view(input, &in, &view);
+        if ((ret != ret_view) || ((ret == ECJP_NO_ERROR) && !same_value(&view, &out))) {
+            ecjp_fprintf("Key at %d: view '%.*s' (%d), expected '%s' (%d)\n", in.pos, (int)view.len, view.ptr, ret_view, (char *)out.value, ret);
+            status = TEST_VIEW_MISMATCH;
+            break;
+        }
+        if ((ret == ECJP_NO_ERROR) && (view.type == ECJP_TYPE_ARRAY)) {
+            status = check_array_view(view.ptr, view.len, value_size);
+        }
+        if ((status == 0) && (ret == ECJP_NO_ERROR) && (view.len >= sizeof(small))) {
+            // the copy is truncated, the view is not
+            buffer = out.value;
+            out.value = small;
+            out.value_size = sizeof(small);
+            ret = ecjp_read_key(input, &in, &out);
+            out.value = buffer;
+            if ((ret != ECJP_NO_SPACE_IN_BUFFER_VALUE) || (ecjp_read_key_view(input, &in, &view) != ECJP_NO_ERROR) ||
+                (view.len < sizeof(small))) {
+                ecjp_fprintf("Key at %d: truncated value not detected\n", in.pos);
+                status = TEST_VIEW_MISMATCH;
+            }
+        }
+    }
+    free(out.value);
+    return status;
+}
+
+/*
+ * Compare the value of every key and the elements of every array with the extents of the tape,
+ * which are found by the full syntax check: brackets and quotes inside strings don't end a value.
+*/
+int check_extents(const char *input, size_t len, ecjp_key_elem_t *key_list)
+{
+    ecjp_check_result_t results;
+    ecjp_tape_t tape;
+    ecjp_key_elem_t *current;
+    ecjp_indata_t in;
+    ecjp_value_view_t view, expected;
+    int i, j, n;
+    int status = 0;
+
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    ecjp_init_tape(&tape);
+    if (ecjp_load_tape_n(input, len, &tape, &results) != ECJP_NO_ERROR) {
+        ecjp_free_tape(&tape);
+        return 0;
+    }
+    // the keys of the list and of the tape are both in the order of the input
+    i = 0;
+    for (current = key_list; (current != NULL) && (status == 0); current = current->next) {
+        while ((i < tape.count) && ((tape.entry[i].type != ECJP_TYPE_KEY) || (tape.entry[i].pos != current->key.start_pos))) {
+            i++;
+        }
+        if (i == tape.count) {
+            break;
+        }
+        memset(&in, 0, sizeof(ecjp_indata_t));
+        in.pos = current->key.start_pos;
+        in.length = current->key.length;
+        in.type = current->key.type;
+        ecjp_tape_view(&tape, input, i + 1, &expected);
+        if ((ecjp_read_key_view(input, &in, &view) != ECJP_NO_ERROR) || (view.ptr != expected.ptr) || (view.len != expected.len)) {
+            ecjp_fprintf("Key at %d: view '%.*s', expected '%.*s'\n", in.pos, (int)view.len, view.ptr, (int)expected.len, expected.ptr);
+            status = TEST_VIEW_MISMATCH;
+        }
+    }
+    for (i = 0; (i < tape.count) && (status == 0); i++) {
+        if (tape.entry[i].type != ECJP_TYPE_ARRAY) {
+            continue;
+        }
+        n = 0;
+        for (j = i + 1; (j < tape.entry[i].next) && (status == 0); j = tape.entry[j].next) {
+            ecjp_tape_view(&tape, input, j, &expected);
+            if (expected.type == ECJP_TYPE_STRING) {
+                // the element keeps its quotes
+                expected.ptr--;
+                expected.len += 2;
+            }
+            if ((ecjp_read_array_element_view_n(&input[tape.entry[i].pos], tape.entry[i].length, n, &view) != ECJP_NO_ERROR) ||
+                (view.ptr != expected.ptr) || (view.len != expected.len)) {
+                ecjp_fprintf("Element #%d of the array at %d: view '%.*s', expected '%.*s'\n", n, tape.entry[i].pos,
+                             (int)view.len, (view.ptr != NULL) ? view.ptr : "", (int)expected.len, expected.ptr);
+                status = TEST_VIEW_MISMATCH;
+            }
+            n++;
+        }
+    }
+    ecjp_free_tape(&tape);
+    return status;
+}
+
+/*
+ * Check the extents on a document with brackets, quotes and backslashes inside its strings.
+*/
+int check_fixed(void)
+{
+    ecjp_check_result_t results;
+    ecjp_key_elem_t *key_list = NULL;
+    int status = TEST_VIEW_MISMATCH;
+
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    results.err_pos = -1;
+    if (ecjp_check_and_load(fixed_doc, &key_list, &results, ECJP_MAX_NESTED_LEVEL) == ECJP_NO_ERROR) {
+        status = check_extents(fixed_doc, strlen(fixed_doc), key_list);
+    }
+    ecjp_free_key_list(&key_list);
+    if (status != 0) {
+        ecjp_fprint("Extents of the fixed document: mismatch\n");
+    }
+    return status;
+}
+
+int main(int argc, char *argv[])
+{
+    ecjp_return_code_t ret;
+    ecjp_check_result_t results;
+    ecjp_key_elem_t *key_list = NULL;
+    char *ptr;
+    struct stat strstat;
+    int status = 0;
+
+    // check arguments and open test files
+    if(argc != 2) {
+        usage(argv[0]);
+        return -1;
+    }
+    memset(&strstat, 0, sizeof(struct stat));
+    if (stat(argv[1], &strstat) != 0) {
+        ecjp_fprintf("stat() failed for file %s\n", argv[1]);
+        return -1;
+    }
+    long file_size = strstat.st_size;
+    ptr = (char *)malloc(file_size + 1);
+    if (ptr == NULL) {
+        ecjp_fprint("Memory allocation failed for JSON file\n");
+        return -1;
+    }
+    FILE *f = fopen(argv[1], "r");
+    if (f == NULL) {
+        ecjp_fprintf("Failed to open file %s\n", argv[1]);
+        free(ptr);
+        return -1;
+    }
+    size_t read_bytes = fread(ptr, 1, file_size, f);
+    ptr[read_bytes] = '\0';
+    fclose(f);
+    ecjp_fprintf("\nTesting JSON file (%s) of size %ld bytes:\n", argv[1], file_size);
+
+    memset(&results, 0, sizeof(ecjp_check_result_t));
+    results.err_pos = -1;
+    ret = ecjp_check_and_load(ptr, &key_list, &results, ECJP_MAX_NESTED_LEVEL);
+    if ((ret == ECJP_NO_ERROR) && (read_bytes <= (ECJP_TYPE_POS_KEY)(-1))) {
+        // the values are copied in buffers as large as the whole input, so they are never truncated
+        if (results.struct_type == ECJP_ST_ARRAY) {
+            status = check_array_view(ptr, read_bytes, read_bytes + 1);
+        }
+        if (status == 0) {
+            status = check_key_view(ptr, key_list, read_bytes + 1);
+        }
+        if (status == 0) {
+            status = check_extents(ptr, read_bytes, key_list);
+        }
+    }
+    if (status == 0) {
+        status = check_fixed();
+    }
+    ecjp_free_key_list(&key_list);
+    free(ptr);
+    if (status != 0) {
+        return status;
+    }
+    return (ret == ECJP_NO_ERROR) ? 0 : -1;
+}
+
+#endif // ECJP_TOKEN_LIST